@@ -27,7 +27,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelPluginCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -490,7 +490,9 @@ bool Exoplanets::backupJsonFile(bool deleteOriginal) const
 */
 void Exoplanets::readJsonFile(void)
 {
-	setEPMap(loadEPMap());
+	StelPluginCatalog catalog(jsonCatalogPath, "stars");
+	catalog.load();
+	setEPCatalog(catalog);
 }
 
 void Exoplanets::reloadCatalog(void)
@@ -516,29 +518,9 @@ void Exoplanets::reloadCatalog(void)
 }
 
 /*
-  Parse JSON file and load exoplanets to map
+  Set items for list of struct from the catalog
 */
-QVariantMap Exoplanets::loadEPMap(QString path)
-{
-	if (path.isEmpty())
-	    path = jsonCatalogPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Exoplanets] Cannot open " << QDir::toNativeSeparators(path);
-	else
-	{
-		map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-		jsonFile.close();
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Exoplanets::setEPMap(const QVariantMap& map)
+void Exoplanets::setEPCatalog(const StelPluginCatalog& catalog)
 {
 	StelCore* core = StelApp::getInstance().getCore();
 	StarMgr* smgr = GETSTELMODULE(StarMgr);
@@ -552,10 +534,10 @@ void Exoplanets::setEPMap(const QVariantMap& map)
 	EPRadiusAll.clear();
 	EPPeriodAll.clear();
 	EPAngleDistanceAll.clear();
-	QVariantMap epsMap = map.value("stars").toMap();
-	foreach(QString epsKey, epsMap.keys())
+	for (int i=0; i<catalog.size(); ++i)
 	{
-		QVariantMap epsData = epsMap.value(epsKey).toMap();
+		const QString epsKey = catalog.getName(i);
+		QVariantMap epsData = catalog.getEntry(i);
 		epsData["designation"] = epsKey;
 
 		PSCount++;
@@ -599,19 +581,10 @@ void Exoplanets::setEPMap(const QVariantMap& map)
 int Exoplanets::getJsonFileFormatVersion(void) const
 {
 	int jsonVersion = -1;
-	QFile jsonEPCatalogFile(jsonCatalogPath);
-	if (!jsonEPCatalogFile.open(QIODevice::ReadOnly))
+	const QVariantMap header = StelPluginCatalog::readHeader(jsonCatalogPath, QStringList("version"));
+	if (header.contains("version"))
 	{
-		qWarning() << "[Exoplanets] Cannot open " << QDir::toNativeSeparators(jsonCatalogPath);
-		return jsonVersion;
-	}
-
-	QVariantMap map;
-	map = StelJsonParser::parse(&jsonEPCatalogFile).toMap();
-	jsonEPCatalogFile.close();
-	if (map.contains("version"))
-	{
-		jsonVersion = map.value("version").toInt();
+		jsonVersion = header.value("version").toInt();
 	}
 
 	qDebug() << "[Exoplanets] Version of the format of the catalog:" << jsonVersion;
@@ -620,22 +593,10 @@ int Exoplanets::getJsonFileFormatVersion(void) const
 
 bool Exoplanets::checkJsonFileFormat() const
 {
-	QFile jsonEPCatalogFile(jsonCatalogPath);
-	if (!jsonEPCatalogFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Exoplanets] Cannot open " << QDir::toNativeSeparators(jsonCatalogPath);
-		return false;
-	}
-
-	QVariantMap map;
-	try
-	{
-		map = StelJsonParser::parse(&jsonEPCatalogFile).toMap();
-		jsonEPCatalogFile.close();
-	}
-	catch (std::runtime_error& e)
+	StelPluginCatalog catalog(jsonCatalogPath, "stars");
+	if (!catalog.load())
 	{
-		qDebug() << "[Exoplanets] File format is wrong! Error:" << e.what();
+		qDebug() << "[Exoplanets] File format is wrong!";
 		return false;
 	}
 
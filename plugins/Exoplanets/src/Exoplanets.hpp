@@ -36,6 +36,7 @@ class QSettings;
 class QTimer;
 class ExoplanetsDialog;
 class StelPainter;
+class StelPluginCatalog;
 class StelButton;
 
 /*! @defgroup exoplanets Exoplanets Plug-in
@@ -338,11 +339,8 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void) const;
 
-	//! parse JSON file and load exoplanets to map
-	QVariantMap loadEPMap(QString path=QString());
-
-	//! set items for list of struct from data map
-	void setEPMap(const QVariantMap& map);
+	//! set items for list of struct from the catalog
+	void setEPCatalog(const StelPluginCatalog& catalog);
 
 	//! A fake method for strings marked for translation.
 	//! Use it instead of translations.h for N_() strings, except perhaps for
@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
  */
 
+#include <QHash>
 #include <QtMath>
 
 #include "LandscapeMgr.hpp"
@@ -32,6 +33,9 @@
 
 const QString MeteorShower::METEORSHOWER_TYPE = QStringLiteral("MeteorShower");
 
+// Enough for the strongest storms, the arrays are only allocated when the shower is active
+static const int maxMeteors = 1024;
+
 MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 	: m_mgr(mgr)
 	, m_status(INVALID)
@@ -43,6 +47,7 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 	, m_pidx(0)
 	, m_radiantAlpha(0)
 	, m_radiantDelta(0)
+	, m_meteors(maxMeteors)
 {
 	if(!map.contains("showerID") || !map.contains("activity")
 		|| !map.contains("radiantAlpha") || !map.contains("radiantDelta"))
@@ -53,6 +58,8 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 	}
 
 	m_showerID = map.value("showerID").toString();
+	// the same shower produces the same meteors in each session
+	m_rng.seed(qHash(m_showerID));
 	m_designation  = map.value("designation").toString();
 	m_speed = map.value("speed").toInt();
 	m_radiantAlpha = StelUtils::getDecAngle(map.value("radiantAlpha").toString());
@@ -174,7 +181,7 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 			QVariantMap colorMap = ms.toMap();
 			QString color = colorMap.value("color").toString();
 			int intensity = colorMap.value("intensity").toInt();
-			m_colors.append(Meteor::ColorPair(color, intensity));
+			m_colors.append(MeteorPool::ColorPair(color, intensity));
 			totalIntensity += intensity;
 		}
 
@@ -188,7 +195,7 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 	}
 
 	if (m_colors.isEmpty()) {
-		m_colors.push_back(Meteor::ColorPair("white", 100));
+		m_colors.push_back(MeteorPool::ColorPair("white", 100));
 	}
 
 	m_status = UNDEFINED;
@@ -196,8 +203,6 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 
 MeteorShower::~MeteorShower()
 {
-	qDeleteAll(m_activeMeteors);
-	m_activeMeteors.clear();
 	m_colors.clear();
 }
 
@@ -265,16 +270,8 @@ void MeteorShower::update(StelCore* core, double deltaTime)
 		m_radiantDelta += m_driftDelta * daysToPeak;
 	}
 
-	// step through and update all active meteors
-	foreach (MeteorObj* m, m_activeMeteors)
-	{
-		if (!m->update(deltaTime))
-		{
-			//important to delete when no longer active
-			delete m;
-			m_activeMeteors.removeOne(m);
-		}
-	}
+	// update all active meteors
+	m_meteors.update(core, deltaTime);
 
 	// paused | forward | backward ?
 	// don't create new meteors
@@ -290,30 +287,17 @@ void MeteorShower::update(StelCore* core, double deltaTime)
 		return;
 	}
 
-	// average meteors per frame
-	float mpf = currentZHR * deltaTime / 3600.f;
-
-	// maximum amount of meteors for the current frame
-	int maxMpf = qRound(mpf);
-	maxMpf = maxMpf < 1 ? 1 : maxMpf;
-
-	float rate = mpf / (float) maxMpf;
-	for (int i = 0; i < maxMpf; ++i)
+	// number of meteors for the current frame, drawn once from the average meteors per frame
+	const int newMeteors = m_rng.poisson(currentZHR * deltaTime / 3600.f);
+	for (int i = 0; i < newMeteors; ++i)
 	{
-		float prob = (float) qrand() / (float) RAND_MAX;
-		if (prob < rate)
+		// if speed is zero, use a random value
+		float speed = m_speed;
+		if (!speed)
 		{
-			MeteorObj *m = new MeteorObj(core, m_speed, m_radiantAlpha, m_radiantDelta,
-						     m_pidx, m_colors, m_mgr->getBolideTexture());
-			if (m->isAlive())
-			{
-				m_activeMeteors.append(m);
-			}
-			else
-			{
-				delete m;
-			}
+			speed = 11 + m_rng.uniform() * 61;  // abs range 11-72 km/s
 		}
+		m_meteors.spawn(core, m_radiantAlpha, m_radiantDelta, speed, m_colors, m_pidx, m_rng);
 	}
 }
 
@@ -388,12 +372,14 @@ void MeteorShower::drawMeteors(StelCore *core)
 		return;
 	}
 
-	// step through and draw all active meteors
-	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
-	foreach (MeteorObj* m, m_activeMeteors)
+	if (m_meteors.size() == 0)
 	{
-		m->draw(core, painter);
+		return;
 	}
+
+	// draw all active meteors at once
+	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
+	m_meteors.draw(core, painter, m_mgr->getBolideTexture());
 }
 
 MeteorShower::Activity MeteorShower::hasGenericShower(QDate date, bool &found) const
@@ -20,7 +20,7 @@
 #ifndef _METEORSHOWER_HPP_
 #define _METEORSHOWER_HPP_
 
-#include "MeteorObj.hpp"
+#include "MeteorPool.hpp"
 #include "MeteorShowersMgr.hpp"
 #include "StelFader.hpp"
 #include "StelObject.hpp"
@@ -142,7 +142,7 @@ private:
 	float m_driftDelta;                //! Drift of Dec. for each day from peak
 	QString m_parentObj;               //! Parent object for meteor shower
 	float m_pidx;                      //! The population index
-	QList<Meteor::ColorPair> m_colors; //! <colorName, 0-100>
+	QList<MeteorPool::ColorPair> m_colors; //! <colorName, 0-100>
 
 	//current information
 	Vec3d m_position;                  //! Cartesian equatorial position
@@ -150,7 +150,8 @@ private:
 	double m_radiantDelta;             //! Current Dec. for radiant of meteor shower
 	Activity m_activity;               //! Current activity
 
-	QList<MeteorObj*> m_activeMeteors; //! List with all the active meteors
+	MeteorPool m_meteors;              //! All the active meteors
+	MeteorRandom m_rng;                //! Random numbers of the meteors, seeded by the shower ID
 
 	//! Draws the radiant
 	void drawRadiant(StelCore* core);
@@ -123,6 +123,7 @@ public:
 	virtual void update(double deltaTime);
 	virtual void draw(StelCore* core);
 	virtual double getCallOrder(StelModuleActionName actionName) const;
+	virtual bool isUpdateConcurrent() const {return true;}
 	virtual bool configureGui(bool show=true);
 
 signals:
@@ -24,7 +24,7 @@
 #include "StelLocaleMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelPluginCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
@@ -410,41 +410,23 @@ bool Novae::backupJsonFile(bool deleteOriginal)
 */
 void Novae::readJsonFile(void)
 {
-	setNovaeMap(loadNovaeMap());
+	StelPluginCatalog catalog(novaeJsonPath, "nova");
+	catalog.load();
+	setNovaeCatalog(catalog);
 }
 
 /*
-  Parse JSON file and load novae to map
+  Set items for list of struct from the catalog
 */
-QVariantMap Novae::loadNovaeMap(QString path)
-{
-	if (path.isEmpty())
-	    path = novaeJsonPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-		jsonFile.close();
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Novae::setNovaeMap(const QVariantMap& map)
+void Novae::setNovaeCatalog(const StelPluginCatalog& catalog)
 {
 	nova.clear();
 	novalist.clear();
 	NovaCnt=0;
-	QVariantMap novaeMap = map.value("nova").toMap();
-	foreach(QString novaeKey, novaeMap.keys())
+	for (int i=0; i<catalog.size(); ++i)
 	{
-		QVariantMap novaeData = novaeMap.value(novaeKey).toMap();
+		const QString novaeKey = catalog.getName(i);
+		QVariantMap novaeData = catalog.getEntry(i);
 		novaeData["designation"] = QString("%1").arg(novaeKey);
 
 		novalist.insert(novaeData.value("name").toString(), novaeData.value("peakJD").toDouble());
@@ -458,45 +440,24 @@ void Novae::setNovaeMap(const QVariantMap& map)
 }
 
 int Novae::getJsonFileVersion(void) const
-{	
+{
 	int jsonVersion = -1;
-	QFile novaeJsonFile(novaeJsonPath);
-	if (!novaeJsonFile.open(QIODevice::ReadOnly))
+	const QVariantMap header = StelPluginCatalog::readHeader(novaeJsonPath, QStringList("version"));
+	if (header.contains("version"))
 	{
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(novaeJsonPath);
-		return jsonVersion;
+		jsonVersion = header.value("version").toInt();
 	}
 
-	QVariantMap map;
-	map = StelJsonParser::parse(&novaeJsonFile).toMap();
-	if (map.contains("version"))
-	{
-		jsonVersion = map.value("version").toInt();
-	}
-
-	novaeJsonFile.close();
 	qDebug() << "[Novae] version of the catalog:" << jsonVersion;
 	return jsonVersion;
 }
 
 bool Novae::checkJsonFileFormat() const
 {
-	QFile novaeJsonFile(novaeJsonPath);
-	if (!novaeJsonFile.open(QIODevice::ReadOnly))
+	StelPluginCatalog catalog(novaeJsonPath, "nova");
+	if (!catalog.load())
 	{
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(novaeJsonPath);
-		return false;
-	}
-
-	QVariantMap map;
-	try
-	{
-		map = StelJsonParser::parse(&novaeJsonFile).toMap();
-		novaeJsonFile.close();
-	}
-	catch (std::runtime_error& e)
-	{
-		qDebug() << "[Novae] file format is wrong! Error:" << e.what();
+		qDebug() << "[Novae] file format is wrong!";
 		return false;
 	}
 
@@ -682,21 +643,12 @@ QString Novae::getNovaeList()
 float Novae::getLowerLimitBrightness()
 {
 	float lowerLimit = 10.f;
-	QFile novaeJsonFile(novaeJsonPath);
-	if (!novaeJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(novaeJsonPath);
-		return lowerLimit;
-	}
-
-	QVariantMap map;
-	map = StelJsonParser::parse(&novaeJsonFile).toMap();
-	if (map.contains("limit"))
+	const QVariantMap header = StelPluginCatalog::readHeader(novaeJsonPath, QStringList("limit"));
+	if (header.contains("limit"))
 	{
-		lowerLimit = map.value("limit").toFloat();
+		lowerLimit = header.value("limit").toFloat();
 	}
 
-	novaeJsonFile.close();
 	return lowerLimit;
 }
 
@@ -37,6 +37,7 @@ class QSettings;
 class QTimer;
 class NovaeDialog;
 class StelPainter;
+class StelPluginCatalog;
 
 /*! @defgroup brightNovae Bright Novae Plug-in
 @{
@@ -215,11 +216,8 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void) const;
 
-	//! Parse JSON file and load novae to map
-	QVariantMap loadNovaeMap(QString path=QString());
-
-	//! Set items for list of struct from data map
-	void setNovaeMap(const QVariantMap& map);
+	//! Set items for list of struct from the catalog
+	void setNovaeCatalog(const StelPluginCatalog& catalog);
 
 	QString novaeJsonPath;
 
@@ -26,7 +26,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelPluginCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -424,40 +424,22 @@ bool Pulsars::backupJsonFile(bool deleteOriginal)
 */
 void Pulsars::readJsonFile(void)
 {
-	setPSRMap(loadPSRMap());
+	StelPluginCatalog catalog(jsonCatalogPath, "pulsars");
+	catalog.load();
+	setPSRCatalog(catalog);
 }
 
 /*
-  Parse JSON file and load pulsars to map
+  Set items for list of struct from the catalog
 */
-QVariantMap Pulsars::loadPSRMap(QString path)
-{
-	if (path.isEmpty())
-	    path = jsonCatalogPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Pulsars] Cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-		jsonFile.close();
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Pulsars::setPSRMap(const QVariantMap& map)
+void Pulsars::setPSRCatalog(const StelPluginCatalog& catalog)
 {
 	psr.clear();
 	PsrCount = 0;
-	QVariantMap psrMap = map.value("pulsars").toMap();
-	foreach(QString psrKey, psrMap.keys())
+	for (int i=0; i<catalog.size(); ++i)
 	{
-		QVariantMap psrData = psrMap.value(psrKey).toMap();
+		const QString psrKey = catalog.getName(i);
+		QVariantMap psrData = catalog.getEntry(i);
 		psrData["designation"] = psrKey;
 
 		PsrCount++;
@@ -472,43 +454,22 @@ void Pulsars::setPSRMap(const QVariantMap& map)
 int Pulsars::getJsonFileFormatVersion(void)
 {
 	int jsonVersion = -1;
-	QFile jsonPSRCatalogFile(jsonCatalogPath);
-	if (!jsonPSRCatalogFile.open(QIODevice::ReadOnly))
+	const QVariantMap header = StelPluginCatalog::readHeader(jsonCatalogPath, QStringList("version"));
+	if (header.contains("version"))
 	{
-		qWarning() << "[Pulsars] Cannot open" << QDir::toNativeSeparators(jsonCatalogPath);
-		return jsonVersion;
+		jsonVersion = header.value("version").toInt();
 	}
 
-	QVariantMap map;
-	map = StelJsonParser::parse(&jsonPSRCatalogFile).toMap();
-	if (map.contains("version"))
-	{
-		jsonVersion = map.value("version").toInt();
-	}
-
-	jsonPSRCatalogFile.close();
 	qDebug() << "[Pulsars] Version of the format of the catalog:" << jsonVersion;
 	return jsonVersion;
 }
 
 bool Pulsars::checkJsonFileFormat()
 {
-	QFile jsonPSRCatalogFile(jsonCatalogPath);
-	if (!jsonPSRCatalogFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Pulsars] Cannot open" << QDir::toNativeSeparators(jsonCatalogPath);
-		return false;
-	}
-
-	QVariantMap map;
-	try
-	{
-		map = StelJsonParser::parse(&jsonPSRCatalogFile).toMap();
-		jsonPSRCatalogFile.close();
-	}
-	catch (std::runtime_error& e)
+	StelPluginCatalog catalog(jsonCatalogPath, "pulsars");
+	if (!catalog.load())
 	{
-		qDebug() << "[Pulsars] File format is wrong! Error:" << e.what();
+		qDebug() << "[Pulsars] File format is wrong!";
 		return false;
 	}
 
@@ -39,6 +39,7 @@ class StelButton;
 class PulsarsDialog;
 
 class StelPainter;
+class StelPluginCatalog;
 
 /*! @defgroup pulsars Pulsars Plug-in
 @{
@@ -260,11 +261,8 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void);
 
-	//! parse JSON file and load pulsars to map
-	QVariantMap loadPSRMap(QString path=QString());
-
-	//! set items for list of struct from data map
-	void setPSRMap(const QVariantMap& map);
+	//! set items for list of struct from the catalog
+	void setPSRCatalog(const StelPluginCatalog& catalog);
 
 	QString jsonCatalogPath;
 
@@ -27,7 +27,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelPluginCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -428,40 +428,22 @@ bool Quasars::backupJsonFile(bool deleteOriginal)
 */
 void Quasars::readJsonFile(void)
 {
-	setQSOMap(loadQSOMap());
+	StelPluginCatalog catalog(catalogJsonPath, "quasars");
+	catalog.load();
+	setQSOCatalog(catalog);
 }
 
 /*
-  Parse JSON file and load quasarss to map
+  Set items for list of struct from the catalog
 */
-QVariantMap Quasars::loadQSOMap(QString path)
-{
-	if (path.isEmpty())
-	    path = catalogJsonPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Quasars] Cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-		jsonFile.close();
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Quasars::setQSOMap(const QVariantMap& map)
+void Quasars::setQSOCatalog(const StelPluginCatalog& catalog)
 {
 	QSO.clear();
 	QsrCount = 0;
-	QVariantMap qsoMap = map.value("quasars").toMap();
-	foreach(QString qsoKey, qsoMap.keys())
+	for (int i=0; i<catalog.size(); ++i)
 	{
-		QVariantMap qsoData = qsoMap.value(qsoKey).toMap();
+		const QString qsoKey = catalog.getName(i);
+		QVariantMap qsoData = catalog.getEntry(i);
 		qsoData["designation"] = qsoKey;
 
 		QsrCount++;
@@ -476,43 +458,22 @@ void Quasars::setQSOMap(const QVariantMap& map)
 int Quasars::getJsonFileFormatVersion(void)
 {
 	int jsonVersion = -1;
-	QFile catalogJsonFile(catalogJsonPath);
-	if (!catalogJsonFile.open(QIODevice::ReadOnly))
+	const QVariantMap header = StelPluginCatalog::readHeader(catalogJsonPath, QStringList("version"));
+	if (header.contains("version"))
 	{
-		qWarning() << "[Quasars] Cannot open" << QDir::toNativeSeparators(catalogJsonPath);
-		return jsonVersion;
+		jsonVersion = header.value("version").toInt();
 	}
 
-	QVariantMap map;
-	map = StelJsonParser::parse(&catalogJsonFile).toMap();
-	if (map.contains("version"))
-	{
-		jsonVersion = map.value("version").toInt();
-	}
-
-	catalogJsonFile.close();
 	qDebug() << "[Quasars] Version of the format of the catalog:" << jsonVersion;
 	return jsonVersion;
 }
 
 bool Quasars::checkJsonFileFormat()
 {
-	QFile catalogJsonFile(catalogJsonPath);
-	if (!catalogJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Quasars] Cannot open" << QDir::toNativeSeparators(catalogJsonPath);
-		return false;
-	}
-
-	QVariantMap map;
-	try
-	{
-		map = StelJsonParser::parse(&catalogJsonFile).toMap();
-		catalogJsonFile.close();
-	}
-	catch (std::runtime_error& e)
+	StelPluginCatalog catalog(catalogJsonPath, "quasars");
+	if (!catalog.load())
 	{
-		qDebug() << "[Quasars] File format is wrong! Error:" << e.what();
+		qDebug() << "[Quasars] File format is wrong!";
 		return false;
 	}
 
@@ -30,6 +30,7 @@
 #include <QSharedPointer>
 
 class StelPainter;
+class StelPluginCatalog;
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -250,11 +251,8 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void);
 
-	//! parse JSON file and load quasars to map
-	QVariantMap loadQSOMap(QString path=QString());
-
-	//! set items for list of struct from data map
-	void setQSOMap(const QVariantMap& map);
+	//! set items for list of struct from the catalog
+	void setQSOCatalog(const StelPluginCatalog& catalog);
 
 	QString catalogJsonPath;
 
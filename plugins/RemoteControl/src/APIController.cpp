@@ -101,7 +101,9 @@ void APIController::service(HttpRequest &request, HttpResponse &response)
 #ifdef FORCE_THREADED_SERVICES
 			sv->get(operation, request.getParameterMap(), apiresponse);
 #else
-			if(sv->isThreadSafe())
+			//the services of the plugin may allow some of their GET operations in the HTTP thread
+			AbstractAPIService* asv = dynamic_cast<AbstractAPIService*>(sv);
+			if(asv ? asv->isThreadSafeGet(operation) : sv->isThreadSafe())
 			{
 				sv->get(operation,request.getParameterMap(), apiresponse);
 			}
@@ -30,6 +30,12 @@ bool AbstractAPIService::isThreadSafe() const
 	return false;
 }
 
+bool AbstractAPIService::isThreadSafeGet(const QByteArray &operation) const
+{
+	Q_UNUSED(operation);
+	return isThreadSafe();
+}
+
 void AbstractAPIService::get(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse& response)
 {
 	Q_UNUSED(operation);
@@ -39,6 +39,9 @@ public:
 
 	// Provides a default implementation which returns false.
 	virtual bool isThreadSafe() const Q_DECL_OVERRIDE;
+	//! Whether the GET \p operation can be called directly in the HTTP thread, even though the service as a whole is not thread safe
+	//! (for example because it only reads the StelStateSnapshot). The default implementation returns isThreadSafe().
+	virtual bool isThreadSafeGet(const QByteArray& operation) const;
 	//! Called in the main thread each frame. Default implementation does nothing.
 	//! Can be used for ongoing actions, for example movement control.
 	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
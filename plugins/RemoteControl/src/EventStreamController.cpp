@@ -0,0 +1,249 @@
+/*
+ * Stellarium Remote Control plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "EventStreamController.hpp"
+#include "MainService.hpp"
+
+#include "StelApp.hpp"
+#include "StelActionMgr.hpp"
+#include "StelPropertyMgr.hpp"
+#include "StelStatePublisher.hpp"
+
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QThread>
+
+EventStreamController::EventStreamController(MainService *mainService, QObject *parent)
+	: HttpRequestHandler(parent),
+	  mainService(mainService),
+	  events(eventCacheSize), streamCount(0), fullRequested(false), generation(0)
+{
+	//this is run in the main thread
+	actionMgr = StelApp::getInstance().getStelActionManager();
+	propMgr = StelApp::getInstance().getStelPropertyManager();
+	statePublisher = StelApp::getInstance().getStatePublisher();
+
+	connect(actionMgr,SIGNAL(actionToggled(QString,bool)),this,SLOT(actionToggled(QString,bool)));
+	connect(propMgr,SIGNAL(stelPropertyChanged(StelProperty*,QVariant)),this,SLOT(propertyChanged(StelProperty*,QVariant)));
+}
+
+void EventStreamController::actionToggled(const QString &id, bool val)
+{
+	actionChanges.insert(id,val);
+}
+
+void EventStreamController::propertyChanged(StelProperty *prop, const QVariant &val)
+{
+	propertyChanges.insert(prop->getId(),QJsonValue::fromVariant(val));
+}
+
+void EventStreamController::update(double deltaTime)
+{
+	Q_UNUSED(deltaTime);
+	Q_ASSERT(QThread::currentThread() == StelApp::getInstance().thread());
+
+	mutex.lock();
+	const bool listened = streamCount > 0;
+	const bool full = fullRequested;
+	mutex.unlock();
+
+	if(!listened)
+	{
+		//nobody listens, the next stream starts with the complete state anyway
+		actionChanges = QJsonObject();
+		propertyChanges = QJsonObject();
+		return;
+	}
+
+	StelStateSnapshot snapshot;
+	if(!statePublisher->getSnapshot(snapshot))
+		return;
+
+	QJsonObject obj = buildEvent(full, snapshot);
+	if(obj.isEmpty())
+		return;
+
+	Event event;
+	event.data = "data: " + QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n\n";
+	event.full = full;
+
+	mutex.lock();
+	events.append(event);
+	//cleared only now: the streams which started since fullRequested was read receive this event too
+	if(full)
+		fullRequested = false;
+	if(!events.areIndexesValid())
+	{
+		//the streams notice that their position is invalid and wait for the next complete event
+		events.clear();
+		fullRequested = true;
+	}
+	eventAdded.wakeAll();
+	mutex.unlock();
+}
+
+QJsonObject EventStreamController::buildEvent(bool full, const StelStateSnapshot &snapshot)
+{
+	QJsonObject obj;
+
+	//only the parts which changed
+	const QJsonObject status = mainService->getStatus(snapshot);
+	for(QJsonObject::const_iterator it = status.constBegin(); it!=status.constEnd(); ++it)
+	{
+		if(full || lastStatus.value(it.key()) != it.value())
+			obj.insert(it.key(),it.value());
+	}
+	lastStatus = status;
+
+	//the publisher already limits how often the info string is rebuilt
+	if(full || snapshot.selectionInfo != lastSelectionInfo)
+		obj.insert("selectioninfo",snapshot.selectionInfo);
+	lastSelectionInfo = snapshot.selectionInfo;
+
+	if(full)
+	{
+		//the snapshot is from the previous frame, the changes since then are applied over it
+		QJsonObject actions;
+		for(QMap<QString,bool>::const_iterator it = snapshot.actions.constBegin(); it!=snapshot.actions.constEnd(); ++it)
+			actions.insert(it.key(),it.value());
+		for(QJsonObject::const_iterator it = actionChanges.constBegin(); it!=actionChanges.constEnd(); ++it)
+			actions.insert(it.key(),it.value());
+		actionChanges = actions;
+
+		QJsonObject properties;
+		for(QVariantMap::const_iterator it = snapshot.properties.constBegin(); it!=snapshot.properties.constEnd(); ++it)
+			properties.insert(it.key(), QJsonValue::fromVariant(it.value()));
+		for(QJsonObject::const_iterator it = propertyChanges.constBegin(); it!=propertyChanges.constEnd(); ++it)
+			properties.insert(it.key(),it.value());
+		propertyChanges = properties;
+	}
+
+	if(!actionChanges.isEmpty())
+	{
+		obj.insert("actionChanges",actionChanges);
+		actionChanges = QJsonObject();
+	}
+	if(!propertyChanges.isEmpty())
+	{
+		obj.insert("propertyChanges",propertyChanges);
+		propertyChanges = QJsonObject();
+	}
+
+	return obj;
+}
+
+void EventStreamController::service(HttpRequest &request, HttpResponse &response)
+{
+	Q_UNUSED(request);
+
+	response.setHeader("Content-Type","text/event-stream");
+	response.setHeader("Cache-Control","no-cache");
+	//the stream ends with the connection
+	response.setHeader("Connection","close");
+
+	mutex.lock();
+	const int streamGeneration = generation;
+	++streamCount;
+	fullRequested = true;
+	//the position in the events
+	int next = events.lastIndex() + 1;
+	bool waitForFull = true;
+	//measures how long the client has not read any of the pending data
+	QElapsedTimer stallTimer;
+	qint64 stallPending = 0;
+
+	QByteArray data;
+	while(streamGeneration == generation)
+	{
+		bool timedOut = false;
+		if(next == events.lastIndex() + 1)
+			timedOut = !eventAdded.wait(&mutex, keepAliveInterval);
+		if(streamGeneration != generation)
+			break;
+
+		const qint64 pending = response.bytesToWrite();
+		if(pending > maxPendingBytes)
+		{
+			//the client does not read (e.g. a sleeping tablet), and writing more would block this thread until it does.
+			//Skip the events meanwhile, the stream resumes with a complete event.
+			if(!stallTimer.isValid() || pending < stallPending)
+				stallTimer.start();
+			else if(stallTimer.elapsed() > stallTimeout)
+				break;
+			stallPending = pending;
+			next = events.lastIndex() + 1;
+			waitForFull = true;
+			mutex.unlock();
+			response.flush();
+			const bool connected = response.isConnected();
+			mutex.lock();
+			if(!connected)
+				break;
+			continue;
+		}
+		if(stallTimer.isValid())
+		{
+			stallTimer.invalidate();
+			fullRequested = true;
+		}
+
+		if(next < events.firstIndex() || next > events.lastIndex() + 1)
+		{
+			//the events have been dropped before this stream could send them
+			next = events.lastIndex() + 1;
+			waitForFull = true;
+			fullRequested = true;
+			continue;
+		}
+
+		data.clear();
+		for(; next <= events.lastIndex(); ++next)
+		{
+			const Event& event = events.at(next);
+			if(waitForFull && !event.full)
+				continue;
+			waitForFull = false;
+			data.append(event.data);
+		}
+		if(data.isEmpty())
+		{
+			if(!timedOut)
+				continue;
+			//a comment, ignored by the client
+			data = ":\n\n";
+		}
+
+		//the writing may wait for the client, don't block the main thread meanwhile
+		mutex.unlock();
+		response.write(data);
+		response.flush();
+		const bool connected = response.isConnected();
+		mutex.lock();
+		if(!connected)
+			break;
+	}
+	--streamCount;
+	mutex.unlock();
+}
+
+void EventStreamController::close()
+{
+	QMutexLocker locker(&mutex);
+	++generation;
+	eventAdded.wakeAll();
+}
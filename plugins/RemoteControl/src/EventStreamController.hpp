@@ -0,0 +1,108 @@
+/*
+ * Stellarium Remote Control plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef EVENTSTREAMCONTROLLER_HPP_
+#define EVENTSTREAMCONTROLLER_HPP_
+
+#include "httpserver/httprequesthandler.h"
+
+#include <QContiguousCache>
+#include <QJsonObject>
+#include <QMutex>
+#include <QWaitCondition>
+
+class MainService;
+class StelActionMgr;
+class StelProperty;
+class StelPropertyMgr;
+class StelStatePublisher;
+struct StelStateSnapshot;
+
+//! @ingroup remoteControl
+//! Pushes the changes of the program state to the web clients as Server-Sent Events (request path \c /api/events),
+//! so that they do not have to poll the \c main/status operation.
+//!
+//! Each frame in which something changed, update() builds a single event in the main thread from the StelStateSnapshot. It is a JSON object holding
+//! the parts of the status which changed since the previous event (\c location, \c time, \c view, \c selectioninfo), and
+//! the StelAction and StelProperty values which changed meanwhile (\c actionChanges, \c propertyChanges, which map the IDs to the new values).
+//! The event is serialized once and written to each stream by its HTTP worker thread.
+//! The first event received by a stream holds the complete state, including all the actions and properties.
+//! A stream which falls too far behind (the network is too slow) also skips to the next complete event.
+//! So does a stream whose client stops reading without closing the connection, which ends after a while.
+class EventStreamController : public HttpRequestHandler
+{
+	Q_OBJECT
+public:
+	EventStreamController(MainService* mainService, QObject* parent = Q_NULLPTR);
+
+	//! Called in the main thread each frame. Builds the event of the frame if any stream is open.
+	void update(double deltaTime);
+
+	//! Streams the events until the client disconnects or close() is called.
+	//! @note This runs in an HTTP worker thread, which is occupied until the stream ends.
+	virtual void service(HttpRequest& request, HttpResponse& response) Q_DECL_OVERRIDE;
+
+	//! Ends the open streams. Must be called before the HttpListener is deleted, as it waits for its worker threads.
+	void close();
+
+private slots:
+	void actionToggled(const QString& id, bool val);
+	void propertyChanged(StelProperty* prop, const QVariant& val);
+
+private:
+	struct Event
+	{
+		QByteArray data;
+		//! Whether the event holds the complete state
+		bool full;
+	};
+
+	//! Builds the JSON object of the event, empty if nothing changed
+	QJsonObject buildEvent(bool full, const StelStateSnapshot& snapshot);
+
+	//! Number of events kept for the streams which are late
+	static const int eventCacheSize = 32;
+	//! Interval after which a comment is sent when nothing changed, to find out the disconnected clients [ms]
+	static const unsigned long keepAliveInterval = 15000;
+	//! Amount of unsent data from which the events are skipped, as HttpResponse::write() would block [bytes]
+	static const qint64 maxPendingBytes = 16384;
+	//! Time after which a stream whose client does not read anymore is ended [ms]
+	static const qint64 stallTimeout = 60000;
+
+	MainService* mainService;
+	StelActionMgr* actionMgr;
+	StelPropertyMgr* propMgr;
+	StelStatePublisher* statePublisher;
+
+	// used only in the main thread
+	QJsonObject lastStatus;
+	QString lastSelectionInfo;
+	QJsonObject actionChanges;
+	QJsonObject propertyChanges;
+
+	// guarded by mutex
+	QMutex mutex;
+	QWaitCondition eventAdded;
+	QContiguousCache<Event> events;
+	int streamCount;
+	bool fullRequested;
+	//! Incremented by close(), the streams started before end when it changes
+	int generation;
+};
+
+#endif
@@ -31,6 +31,7 @@
 #include "StelPropertyMgr.hpp"
 #include "StelScriptMgr.hpp"
 #include "StelSkyCultureMgr.hpp"
+#include "StelStatePublisher.hpp"
 #include "StelTranslator.hpp"
 #include "StelUtils.hpp"
 
@@ -56,6 +57,7 @@ MainService::MainService(QObject *parent)
 	propMgr = StelApp::getInstance().getStelPropertyManager();
 	scriptMgr = &StelApp::getInstance().getScriptMgr();
 	skyCulMgr = &StelApp::getInstance().getSkyCultureMgr();
+	statePublisher = StelApp::getInstance().getStatePublisher();
 
 	connect(actionMgr,SIGNAL(actionToggled(QString,bool)),this,SLOT(actionToggled(QString,bool)));
 	connect(propMgr,SIGNAL(stelPropertyChanged(StelProperty*,QVariant)),this,SLOT(propertyChanged(StelProperty*,QVariant)));
@@ -97,11 +99,24 @@ void MainService::update(double deltaTime)
 	}
 }
 
+bool MainService::isThreadSafeGet(const QByteArray &operation) const
+{
+	//the status is built from the state snapshot, without waiting for the main thread
+	return operation=="status";
+}
+
 void MainService::get(const QByteArray& operation, const APIParameters &parameters, APIServiceResponse &response)
 {
 	if(operation=="status")
 	{
 		//a listing of the most common stuff that can change often
+		//this runs in the HTTP thread, so only the snapshot and the change caches may be used here
+		StelStateSnapshot snapshot;
+		if(!statePublisher->getSnapshot(snapshot))
+		{
+			response.writeRequestError("state not available");
+			return;
+		}
 
 		QString sActionId = QString::fromUtf8(parameters.value("actionId"));
 		bool actionOk;
@@ -111,79 +126,17 @@ void MainService::get(const QByteArray& operation, const APIParameters &paramete
 		bool propOk;
 		int propId = sPropId.toInt(&propOk);
 
-		QJsonObject obj;
-
-		//// Location
-		const StelLocation& loc = core->getCurrentLocation();
-		{
-			QJsonObject obj2;
-			obj2.insert("name",loc.name);
-			obj2.insert("role",QString(loc.role));
-			obj2.insert("planet",loc.planetName);
-			obj2.insert("latitude",loc.latitude);
-			obj2.insert("longitude",loc.longitude);
-			obj2.insert("altitude",loc.altitude);
-			obj2.insert("country",loc.country);
-			obj2.insert("state",loc.state);
-			obj2.insert("landscapeKey",loc.landscapeKey);
-			obj.insert("location",obj2);
-		}
-
-		//// Time related stuff
-		{
-			double jday = core->getJD();
-			double deltaT = core->getDeltaT() * StelCore::JD_SECOND;
-
-			double gmtShift = core->getUTCOffset(jday) / 24.0;
-
-			QString utcIso = StelUtils::julianDayToISO8601String(jday,true).append('Z');
-			QString localIso = StelUtils::julianDayToISO8601String(jday+gmtShift,true);
-
-			//time zone string
-			QString timeZone = localeMgr->getPrintableTimeZoneLocal(jday);
-
-			QJsonObject obj2;
-			obj2.insert("jday",jday);
-			obj2.insert("deltaT",deltaT);
-			obj2.insert("gmtShift",gmtShift);
-			obj2.insert("timeZone",timeZone);
-			obj2.insert("utc",utcIso);
-			obj2.insert("local",localIso);
-			obj2.insert("isTimeNow",core->getIsTimeNow());
-			obj2.insert("timerate",core->getTimeRate());
-			obj.insert("time",obj2);
-		}
+		QJsonObject obj = getStatus(snapshot);
 
 		//// Info about selected object (only primary)
-		{
-			QString infoStr;
-			QMetaObject::invokeMethod(this,"getInfoString",SERVICE_DEFAULT_INVOKETYPE,
-						  Q_RETURN_ARG(QString,infoStr));
-			obj.insert("selectioninfo",infoStr);
-		}
-
-		//// Info about current view
-		{
-			QJsonObject obj2;
-
-			// the aim fov may lie outside the min/max bounds, so constrain it
-			double fov = mvmgr->getAimFov();
-			if(fov < mvmgr->getMinFov())
-				fov = mvmgr->getMinFov();
-			else if (fov>mvmgr->getMaxFov())
-				fov = mvmgr->getMaxFov();
-
-			obj2.insert("fov",fov);
-
-			obj.insert("view",obj2);
-		}
+		obj.insert("selectioninfo",snapshot.selectionInfo);
 
 		//// Info about changed actions & props (if requested)
 		{
 			if(actionOk)
-				obj.insert("actionChanges",getActionChangesSinceID(actionId));
+				obj.insert("actionChanges",getActionChangesSinceID(actionId, snapshot));
 			if(propOk)
-				obj.insert("propertyChanges",getPropertyChangesSinceID(propId));
+				obj.insert("propertyChanges",getPropertyChangesSinceID(propId, snapshot));
 		}
 
 		response.writeJSON(QJsonDocument(obj));
@@ -221,6 +174,65 @@ void MainService::get(const QByteArray& operation, const APIParameters &paramete
 	}
 }
 
+QJsonObject MainService::getStatus(const StelStateSnapshot &snapshot)
+{
+	QJsonObject obj;
+
+	//// Location
+	const StelLocation& loc = snapshot.location;
+	{
+		QJsonObject obj2;
+		obj2.insert("name",loc.name);
+		obj2.insert("role",QString(loc.role));
+		obj2.insert("planet",loc.planetName);
+		obj2.insert("latitude",loc.latitude);
+		obj2.insert("longitude",loc.longitude);
+		obj2.insert("altitude",loc.altitude);
+		obj2.insert("country",loc.country);
+		obj2.insert("state",loc.state);
+		obj2.insert("landscapeKey",loc.landscapeKey);
+		obj.insert("location",obj2);
+	}
+
+	//// Time related stuff
+	{
+		double jday = snapshot.jd;
+		double gmtShift = snapshot.utcOffset / 24.0;
+
+		QString utcIso = StelUtils::julianDayToISO8601String(jday,true).append('Z');
+		QString localIso = StelUtils::julianDayToISO8601String(jday+gmtShift,true);
+
+		QJsonObject obj2;
+		obj2.insert("jday",jday);
+		obj2.insert("deltaT",snapshot.deltaT);
+		obj2.insert("gmtShift",gmtShift);
+		obj2.insert("timeZone",snapshot.timeZone);
+		obj2.insert("utc",utcIso);
+		obj2.insert("local",localIso);
+		obj2.insert("isTimeNow",snapshot.isTimeNow);
+		obj2.insert("timerate",snapshot.timeRate);
+		obj.insert("time",obj2);
+	}
+
+	//// Info about current view
+	{
+		QJsonObject obj2;
+
+		obj2.insert("fov",snapshot.fov);
+
+		const Vec3d& dir = snapshot.viewDirectionJ2000;
+		QJsonArray j2000;
+		j2000.append(dir[0]);
+		j2000.append(dir[1]);
+		j2000.append(dir[2]);
+		obj2.insert("j2000",j2000);
+
+		obj.insert("view",obj2);
+	}
+
+	return obj;
+}
+
 void MainService::post(const QByteArray& operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response)
 {
 	Q_UNUSED(data);
@@ -445,14 +457,6 @@ StelObjectP MainService::getSelectedObject()
 	return list.first();
 }
 
-QString MainService::getInfoString()
-{
-	StelObjectP selectedObject = getSelectedObject();
-	if(selectedObject.isNull())
-		return QString();
-	return selectedObject->getInfoString(core,StelObject::AllInfo | StelObject::NoFont);
-}
-
 bool MainService::focusObject(const QString &name, SelectionMode mode)
 {
 	//StelDialog::gotoObject
@@ -566,7 +570,7 @@ void MainService::propertyChanged(StelProperty* prop, const QVariant& val)
 	propMutex.unlock();
 }
 
-QJsonObject MainService::getActionChangesSinceID(int changeId)
+QJsonObject MainService::getActionChangesSinceID(int changeId, const StelStateSnapshot &snapshot)
 {
 	//changeId is the last id the interface is available
 	//or -2 if the interface just started
@@ -585,13 +589,10 @@ QJsonObject MainService::getActionChangesSinceID(int changeId)
 			//this is either the initial state (-2) or
 			//something is "broken", probably from an existing web interface that reconnected after restart
 			//force a full reload
-
-			foreach(StelAction* ac, actionMgr->getActionList())
+			//nothing changed since the snapshot, else the cache would not be empty
+			for(QMap<QString,bool>::const_iterator it = snapshot.actions.constBegin(); it!=snapshot.actions.constEnd(); ++it)
 			{
-				if(ac->isCheckable())
-				{
-					changes.insert(ac->getId(),ac->isChecked());
-				}
+				changes.insert(it.key(),it.value());
 			}
 			newId = -1;
 		}
@@ -602,12 +603,15 @@ QJsonObject MainService::getActionChangesSinceID(int changeId)
 		{
 			//this is either the initial state (-2) or
 			//"broken" state again, force full reload
-			foreach(StelAction* ac, actionMgr->getActionList())
+			for(QMap<QString,bool>::const_iterator it = snapshot.actions.constBegin(); it!=snapshot.actions.constEnd(); ++it)
 			{
-				if(ac->isCheckable())
-				{
-					changes.insert(ac->getId(),ac->isChecked());
-				}
+				changes.insert(it.key(),it.value());
+			}
+			//the snapshot may be one frame older than the cache, so replay the whole cache over it
+			for(int i = actionCache.firstIndex();i<=actionCache.lastIndex();++i)
+			{
+				const ActionCacheEntry& e = actionCache.at(i);
+				changes.insert(e.action,e.val);
 			}
 			newId = actionCache.lastIndex();
 		}
@@ -631,7 +635,7 @@ QJsonObject MainService::getActionChangesSinceID(int changeId)
 	return obj;
 }
 
-QJsonObject MainService::getPropertyChangesSinceID(int changeId)
+QJsonObject MainService::getPropertyChangesSinceID(int changeId, const StelStateSnapshot &snapshot)
 {
 	//changeId is the last id the interface is available
 	//or -2 if the interface just started
@@ -648,11 +652,10 @@ QJsonObject MainService::getPropertyChangesSinceID(int changeId)
 			//this is either the initial state (-2) or
 			//something is "broken", probably from an existing web interface that reconnected after restart
 			//force a full reload
-			const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
-			for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin();
-			    it!=map.constEnd();++it)
+			//nothing changed since the snapshot, else the cache would not be empty
+			for(QVariantMap::const_iterator it = snapshot.properties.constBegin(); it!=snapshot.properties.constEnd(); ++it)
 			{
-				changes.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
+				changes.insert(it.key(), QJsonValue::fromVariant(it.value()));
 			}
 			newId = -1;
 		}
@@ -663,11 +666,15 @@ QJsonObject MainService::getPropertyChangesSinceID(int changeId)
 		{
 			//this is either the initial state (-2) or
 			//"broken" state again, force full reload
-			const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
-			for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin();
-			    it!=map.constEnd();++it)
+			for(QVariantMap::const_iterator it = snapshot.properties.constBegin(); it!=snapshot.properties.constEnd(); ++it)
+			{
+				changes.insert(it.key(), QJsonValue::fromVariant(it.value()));
+			}
+			//the snapshot may be one frame older than the cache, so replay the whole cache over it
+			for(int i = propCache.firstIndex();i<=propCache.lastIndex();++i)
 			{
-				changes.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
+				const PropertyCacheEntry& e = propCache.at(i);
+				changes.insert(e.id,QJsonValue::fromVariant(e.val));
 			}
 			newId = propCache.lastIndex();
 		}
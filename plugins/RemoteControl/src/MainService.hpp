@@ -39,10 +39,13 @@ class StelPropertyMgr;
 class StelProperty;
 class StelScriptMgr;
 class StelSkyCultureMgr;
+class StelStatePublisher;
+struct StelStateSnapshot;
 
 //! @ingroup remoteControl
 //! Implements the main API services, including the \c status operation which can be repeatedly polled to find the current state of the main program,
 //! including time, view, location, StelAction and StelProperty state changes, movement, script status ...
+//! The \c status operation is served in the HTTP thread from the StelStateSnapshot published each frame, so that polling it never blocks the main thread.
 //!
 //! @see @ref rcMainService
 class MainService : public AbstractAPIService
@@ -63,6 +66,8 @@ public:
 	//! Used to implement move functionality
 	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
 	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("main"); }
+	//! The \c status operation can be called in the HTTP thread
+	virtual bool isThreadSafeGet(const QByteArray& operation) const Q_DECL_OVERRIDE;
 	//! @brief Implements the GET operations
 	//! @see @ref rcMainServiceGET
 	virtual void get(const QByteArray& operation,const APIParameters &parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
@@ -70,12 +75,13 @@ public:
 	//! @see @ref rcMainServicePOST
 	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
 
+	//! Returns the \c location, \c time and \c view parts of the \c status operation, built from the given snapshot.
+	//! Also used by EventStreamController to build the pushed events.
+	QJsonObject getStatus(const StelStateSnapshot& snapshot);
+
 private slots:
 	StelObjectP getSelectedObject();
 
-	//! Returns the info string of the currently selected object
-	QString getInfoString();
-
 	//! Like StelDialog::gotoObject
 	bool focusObject(const QString& name, SelectionMode mode);
 	void focusPosition(const Vec3d& pos);
@@ -98,6 +104,7 @@ private:
 	StelPropertyMgr* propMgr;
 	StelScriptMgr* scriptMgr;
 	StelSkyCultureMgr* skyCulMgr;
+	StelStatePublisher* statePublisher;
 
 	double moveX,moveY;
 	qint64 lastMoveUpdateTime;
@@ -112,7 +119,7 @@ private:
 	//lists the recently toggled actions - this is a pseudo-circular buffer
 	QContiguousCache<ActionCacheEntry> actionCache;
 	QMutex actionMutex;
-	QJsonObject getActionChangesSinceID(int changeId);
+	QJsonObject getActionChangesSinceID(int changeId, const StelStateSnapshot& snapshot);
 
 	struct PropertyCacheEntry
 	{
@@ -122,7 +129,7 @@ private:
 	};
 	QContiguousCache<PropertyCacheEntry> propCache;
 	QMutex propMutex;
-	QJsonObject getPropertyChangesSinceID(int changeId);
+	QJsonObject getPropertyChangesSinceID(int changeId, const StelStateSnapshot& snapshot);
 
 };
 
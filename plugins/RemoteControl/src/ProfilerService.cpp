@@ -0,0 +1,103 @@
+/*
+ * Stellarium Remote Control plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ProfilerService.hpp"
+
+#include "StelApp.hpp"
+#include "StelFrameProfiler.hpp"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+ProfilerService::ProfilerService(QObject *parent) : AbstractAPIService(parent)
+{
+	//this is run in the main thread
+	profiler = StelApp::getInstance().getFrameProfiler();
+}
+
+void ProfilerService::get(const QByteArray& operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	Q_UNUSED(parameters);
+
+	if(operation=="stats")
+	{
+		//the histories are written by the main thread in each frame, so read them there
+		QVariantMap stats;
+		QMetaObject::invokeMethod(profiler,"getStatistics",SERVICE_DEFAULT_INVOKETYPE,
+					  Q_RETURN_ARG(QVariantMap, stats));
+
+		QJsonObject obj = QJsonObject::fromVariantMap(stats);
+		obj.insert("enabled", profiler->isEnabled());
+		obj.insert("historySize", profiler->getHistorySize());
+		response.writeJSON(QJsonDocument(obj));
+	}
+	else
+	{
+		//TODO some sort of service description?
+		response.writeRequestError("unsupported operation. GET: stats POST: enable, reset");
+	}
+}
+
+void ProfilerService::post(const QByteArray& operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response)
+{
+	Q_UNUSED(data);
+
+	if(operation == "enable")
+	{
+		QString enabled = QString::fromUtf8(parameters.value("enabled"));
+		QString overlay = QString::fromUtf8(parameters.value("overlay"));
+		QString historySize = QString::fromUtf8(parameters.value("historysize"));
+
+		if(enabled.isEmpty() && overlay.isEmpty() && historySize.isEmpty())
+		{
+			response.writeRequestError("requires 'enabled', 'overlay' or 'historysize' parameter");
+			return;
+		}
+
+		if(!historySize.isEmpty())
+		{
+			bool ok;
+			int size = historySize.toInt(&ok);
+			if(!ok)
+			{
+				response.writeRequestError("invalid 'historysize' parameter");
+				return;
+			}
+			QMetaObject::invokeMethod(profiler,"setHistorySize",SERVICE_DEFAULT_INVOKETYPE,
+						  Q_ARG(int, size));
+		}
+		if(!enabled.isEmpty())
+			QMetaObject::invokeMethod(profiler,"setEnabled",SERVICE_DEFAULT_INVOKETYPE,
+						  Q_ARG(bool, enabled == "true"));
+		if(!overlay.isEmpty())
+			QMetaObject::invokeMethod(profiler,"setOverlayVisible",SERVICE_DEFAULT_INVOKETYPE,
+						  Q_ARG(bool, overlay == "true"));
+
+		response.setData("ok");
+	}
+	else if(operation == "reset")
+	{
+		QMetaObject::invokeMethod(profiler,"reset",SERVICE_DEFAULT_INVOKETYPE);
+		response.setData("ok");
+	}
+	else
+	{
+		//TODO some sort of service description?
+		response.writeRequestError("unsupported operation. GET: stats POST: enable, reset");
+	}
+}
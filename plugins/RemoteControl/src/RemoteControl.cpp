@@ -21,6 +21,7 @@
 #include "StelProjector.hpp"
 #include "StelPainter.hpp"
 #include "StelApp.hpp"
+#include "StelStatePublisher.hpp"
 #include "StelCore.hpp"
 #include "StelFileMgr.hpp"
 #include "StelIniParser.hpp"
@@ -92,8 +93,10 @@ RemoteControl::~RemoteControl()
 	{
 		//we manually delete the listener here to make sure
 		//all connections are closed before the requesthandler is deleted
+		requestHandler->closeEventStreams();
 		delete httpListener;
 		httpListener = Q_NULLPTR;
+		StelApp::getInstance().getStatePublisher()->removeUser();
 	}
 }
 
@@ -243,6 +246,9 @@ void RemoteControl::startServer()
 	//set request handler password settings
 	requestHandler->setPassword(password);
 	requestHandler->setUsePassword(usePassword);
+	//the status is served from the state snapshots
+	StelApp::getInstance().getStatePublisher()->addUser();
+
 	HttpListenerSettings settings;
 	settings.port = port;
 	settings.minThreads = minThreads;
@@ -254,8 +260,11 @@ void RemoteControl::stopServer()
 {
 	if(httpListener)
 	{
+		//the listener waits for the threads of its connections
+		requestHandler->closeEventStreams();
 		delete httpListener;
 		httpListener = Q_NULLPTR;
+		StelApp::getInstance().getStatePublisher()->removeUser();
 	}
 }
 
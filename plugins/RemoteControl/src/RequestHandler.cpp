@@ -22,10 +22,12 @@
 #include "templateengine/template.h"
 
 #include "APIController.hpp"
+#include "EventStreamController.hpp"
 #include "LocationService.hpp"
 #include "LocationSearchService.hpp"
 #include "MainService.hpp"
 #include "ObjectService.hpp"
+#include "ProfilerService.hpp"
 #include "ScriptService.hpp"
 #include "SimbadService.hpp"
 #include "StelActionService.hpp"
@@ -92,7 +94,8 @@ RequestHandler::RequestHandler(const StaticFileControllerSettings& settings, QOb
 	//register the services
 	//they "live" in the main thread in the QObject sense, but their service methods are actually
 	//executed in the HTTP handler threads
-	apiController->registerService(new MainService(apiController));
+	MainService* mainService = new MainService(apiController);
+	apiController->registerService(mainService);
 	apiController->registerService(new ObjectService(apiController));
 	apiController->registerService(new ScriptService(apiController));
 	apiController->registerService(new SimbadService(apiController));
@@ -101,6 +104,9 @@ RequestHandler::RequestHandler(const StaticFileControllerSettings& settings, QOb
 	apiController->registerService(new LocationService(apiController));
 	apiController->registerService(new LocationSearchService(apiController));
 	apiController->registerService(new ViewService(apiController));
+	apiController->registerService(new ProfilerService(apiController));
+
+	eventStream = new EventStreamController(mainService,this);
 
 	connect(&StelApp::getInstance().getModuleMgr(), SIGNAL(extensionsAdded(QObjectList)), this, SLOT(addExtensionServices(QObjectList)));
 	addExtensionServices(StelApp::getInstance().getModuleMgr().getExtensionList());
@@ -130,6 +136,12 @@ void RequestHandler::addExtensionServices(QObjectList services)
 void RequestHandler::update(double deltaTime)
 {
 	apiController->update(deltaTime);
+	eventStream->update(deltaTime);
+}
+
+void RequestHandler::closeEventStreams()
+{
+	eventStream->close();
 }
 
 void RequestHandler::service(HttpRequest &request, HttpResponse &response)
@@ -160,7 +172,12 @@ void RequestHandler::service(HttpRequest &request, HttpResponse &response)
 	QByteArray path = request.getPath();
 	//qDebug()<<"Request path:"<<rawPath<<" decoded:"<<path;
 
-	if(path.startsWith("/api/"))
+	if(path == "/api/events")
+	{
+		//this blocks until the client disconnects
+		eventStream->service(request,response);
+	}
+	else if(path.startsWith("/api/"))
 	{
 		//this is an API request, pass it on
 		apiController->service(request,response);
@@ -24,6 +24,7 @@
 #include "httpserver/staticfilecontroller.h"
 
 class APIController;
+class EventStreamController;
 class StaticFileController;
 
 //! This is the main request handler for the remote control plugin, receiving and dispatching the HTTP requests.
@@ -41,14 +42,18 @@ public:
 	//! The internal APIController, and all registered services are deleted
 	virtual ~RequestHandler();
 
-	//! Called in the main thread each frame, only passed on to APIController::update
+	//! Called in the main thread each frame, only passed on to APIController::update and EventStreamController::update
 	void update(double deltaTime);
+	//! Ends the open event streams, which occupy HTTP worker threads. Must be called before the HttpListener is deleted.
+	void closeEventStreams();
 
 	//! Receives the HttpRequest from the HttpListener.
 	//! It checks the optional HTTP authentication and sets the keep-alive header if requested
 	//! by the client.
 	//!
 	//! If the authentication is correct, the request is processed according to the following rules:
+	//!  - If the request path is @c "/api/events", the request is passed to the \ref EventStreamController,
+	//! which pushes the state changes to the client until it disconnects.
 	//!  - If the request path starts with the string @c "/api/", then the request is passed to
 	//! the \ref APIController without further processing.
 	//!  - If a file specified in the special \c translate_files file is requested, the cached translated version
@@ -82,6 +87,7 @@ private:
 	QString password;
 	QByteArray passwordReply;
 	APIController* apiController;
+	EventStreamController* eventStream;
 	StaticFileController* staticFiles;
 	QMutex templateMutex;
 
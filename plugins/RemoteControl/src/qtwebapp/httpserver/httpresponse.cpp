@@ -200,3 +200,9 @@ bool HttpResponse::isConnected() const
 {
     return socket->isOpen();
 }
+
+
+qint64 HttpResponse::bytesToWrite() const
+{
+    return socket->bytesToWrite();
+}
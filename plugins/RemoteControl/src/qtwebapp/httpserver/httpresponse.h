@@ -122,6 +122,12 @@ public:
      */
     bool isConnected() const;
 
+    /**
+     * Number of bytes written to the socket but not sent yet.
+     * write() blocks until the client received the data when this exceeds 16 KB.
+     */
+    qint64 bytesToWrite() const;
+
 private:
 
     /** Request headers */
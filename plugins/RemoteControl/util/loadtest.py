@@ -0,0 +1,159 @@
+#!/usr/bin/python
+#
+# Load test of the RemoteControl web server.
+# Polls main/status from several connections at once and reports the request
+# throughput and latency, and the frame time of Stellarium (measured by the
+# StelFrameProfiler through the profiler service) without and with the load.
+
+import argparse
+import base64
+import json
+import sys
+import threading
+import time
+
+try:
+	import http.client as httplib
+	from urllib.parse import urlencode
+except ImportError:
+	import httplib
+	from urllib import urlencode
+
+
+class Client(object):
+	'''A keep-alive connection to the server'''
+
+	def __init__(self, args):
+		self.args = args
+		self.headers = {}
+		if args.password:
+			auth = base64.b64encode((':' + args.password).encode('utf-8')).decode('ascii')
+			self.headers['Authorization'] = 'Basic ' + auth
+		self.connection = None
+
+	def request(self, method, path, params=None):
+		body = None
+		headers = dict(self.headers)
+		if params:
+			body = urlencode(params)
+			headers['Content-Type'] = 'application/x-www-form-urlencoded'
+		for attempt in range(2):
+			if self.connection is None:
+				self.connection = httplib.HTTPConnection(self.args.host, self.args.port, timeout=10)
+			try:
+				self.connection.request(method, '/api/' + path, body, headers)
+				response = self.connection.getresponse()
+				data = response.read()
+				if response.getheader('Connection', '').lower() == 'close':
+					self.close()
+				if response.status != 200:
+					raise RuntimeError('%s %s: HTTP %d %s' % (method, path, response.status, data.decode('utf-8', 'replace')))
+				return data
+			except (httplib.HTTPException, IOError):
+				#the server may have closed the idle connection, retry once
+				self.close()
+				if attempt == 1:
+					raise
+
+	def close(self):
+		if self.connection is not None:
+			self.connection.close()
+			self.connection = None
+
+
+def percentile(values, p):
+	if not values:
+		return 0.0
+	values = sorted(values)
+	return values[min(len(values) - 1, int(p * len(values)))]
+
+
+def poll(args, stop, latencies, errors):
+	client = Client(args)
+	while not stop.is_set():
+		start = time.time()
+		try:
+			client.request('GET', 'main/status')
+			latencies.append(time.time() - start)
+		except Exception as e:
+			errors.append(str(e))
+			time.sleep(0.1)
+	client.close()
+
+
+def frame_times(client, duration):
+	'''Resets the profiler statistics, waits and returns the (mean, p95, p99) CPU time of the update and draw of the frames [ms]'''
+	client.request('POST', 'profiler/reset')
+	time.sleep(duration)
+	stats = json.loads(client.request('GET', 'profiler/stats').decode('utf-8'))
+	result = {}
+	for phase in ('update', 'draw'):
+		for entry in stats[phase]:
+			if entry['name'] == 'total':
+				cpu = entry['cpu']
+				result[phase] = (cpu['mean'], cpu['p95'], cpu['p99'])
+	return result, stats['frames']
+
+
+def print_frame_times(title, times, frames):
+	print('%s (%d frames)' % (title, frames))
+	for phase in ('update', 'draw'):
+		if phase in times:
+			print('  %-6s mean %7.3f ms  p95 %7.3f ms  p99 %7.3f ms' % ((phase,) + times[phase]))
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Load test of the RemoteControl main/status operation')
+	parser.add_argument('--host', default='localhost')
+	parser.add_argument('--port', type=int, default=8090)
+	parser.add_argument('--password', default='', help='the password of the remote control, if one is required')
+	parser.add_argument('--connections', type=int, default=8, help='number of concurrent polling connections')
+	parser.add_argument('--duration', type=float, default=10.0, help='duration of each measure [s]')
+	parser.add_argument('--no-profile', action='store_true', help='do not measure the frame times')
+	args = parser.parse_args()
+
+	control = Client(args)
+	profile = not args.no_profile
+	if profile:
+		control.request('POST', 'profiler/enable', {'enabled': 'true'})
+		baseline, frames = frame_times(control, args.duration)
+		print_frame_times('Frame times without load', baseline, frames)
+
+	stop = threading.Event()
+	latencies = []
+	errors = []
+	threads = [threading.Thread(target=poll, args=(args, stop, latencies, errors)) for i in range(args.connections)]
+	start = time.time()
+	for t in threads:
+		t.start()
+
+	try:
+		if profile:
+			loaded, frames = frame_times(control, args.duration)
+		else:
+			time.sleep(args.duration)
+	finally:
+		stop.set()
+		for t in threads:
+			t.join()
+	elapsed = time.time() - start
+
+	if profile:
+		print_frame_times('Frame times with %d polling connections' % args.connections, loaded, frames)
+		control.request('POST', 'profiler/enable', {'enabled': 'false'})
+	control.close()
+
+	count = len(latencies)
+	print('main/status: %d requests in %.1f s, %.1f requests/s, %d errors' % (count, elapsed, count / elapsed, len(errors)))
+	if count:
+		ms = [l * 1000.0 for l in latencies]
+		print('  latency mean %.2f ms  p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms'
+		      % (sum(ms) / count, percentile(ms, 0.5), percentile(ms, 0.95), percentile(ms, 0.99), max(ms)))
+	if errors:
+		print('  first error: ' + errors[0])
+		return 1
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -11,6 +11,14 @@ define(["jquery", "settings", "translationdata"], function($, settings, Translat
     var lastActionId = -2;
     var lastPropId = -2;
 
+    //the event stream, if the updates are pushed by the server
+    var eventSource;
+    //the state merged from the pushed events, in the format of the status operation
+    var pushedState = {};
+    //the pushed StelAction & StelProperty changes not handled yet
+    var pendingActionChanges = {};
+    var pendingPropChanges = {};
+
     // Translates a string using Stellariums current locale.
     // String must be present in translationdata.js
     // All strings from tr() calls in the .js files will be written in translationdata.js when update_translationdata.py is executed
@@ -96,6 +104,55 @@ define(["jquery", "settings", "translationdata"], function($, settings, Translat
         });
     }
 
+    //triggers the change event with the pending changes, which are kept if it is not handled yet
+    function triggerPendingChanges(eventName, pending) {
+        if ($.isEmptyObject(pending)) {
+            return pending;
+        }
+        var evt = $.Event(eventName);
+        $(rc).trigger(evt, pending, -2);
+        if (evt.isDefaultPrevented()) {
+            //the actions/properties are not loaded yet, send the changes again with the next event
+            return pending;
+        }
+        return {};
+    }
+
+    //receives the changes pushed by the server, instead of polling with update()
+    function listen() {
+        eventSource = new EventSource("/api/events");
+
+        eventSource.onmessage = function(e) {
+            var data = JSON.parse(e.data);
+            lastDataTime = $.now();
+
+            $.each(["location", "time", "view", "selectioninfo"], function(i, key) {
+                if (key in data) {
+                    pushedState[key] = data[key];
+                }
+            });
+
+            //the first event holds the complete state
+            if ("time" in pushedState) {
+                $(rc).trigger('serverDataReceived', pushedState);
+            }
+
+            $.extend(pendingActionChanges, data.actionChanges);
+            $.extend(pendingPropChanges, data.propertyChanges);
+            pendingActionChanges = triggerPendingChanges("stelActionsChanged", pendingActionChanges);
+            pendingPropChanges = triggerPendingChanges("stelPropertiesChanged", pendingPropChanges);
+
+            connectionLost = false;
+        };
+
+        eventSource.onerror = function() {
+            //the browser reconnects by itself, and the server starts again with the complete state
+            $(rc).trigger("serverDataError", "event stream error");
+            connectionLost = true;
+            console.log("Error receiving the event stream");
+        };
+    }
+
     //remove panels for disabled plugins and load additional JS files if required for enabled ones
     function processPluginInfo(data) {
         //iterate over all stelplugin elements
@@ -164,7 +221,11 @@ define(["jquery", "settings", "translationdata"], function($, settings, Translat
         tr: tr,
         //Kicks off the update loop. If the loop is disabled, this still requests the data one time
         startUpdateLoop: function() {
-            update(true);
+            if (settings.updatePush && window.EventSource) {
+                listen();
+            } else {
+                update(true);
+            }
         },
         isConnectionLost: function() {
             return connectionLost;
@@ -188,7 +249,10 @@ define(["jquery", "settings", "translationdata"], function($, settings, Translat
                             alert(data);
                         }
                     }
-                    update();
+                    //the changes are pushed by the server
+                    if (!eventSource) {
+                        update();
+                    }
                 },
                 error: function(xhr, status, errorThrown) {
                     console.log("Error posting command " + url);
@@ -9,6 +9,8 @@ define(function() {
   data.updatePoll = true;
   //the interval for automatic polling
   data.updateInterval = 1000;
+  //Receive the updates pushed by the server instead of polling, if the browser supports it
+  data.updatePush = true;
   //use the Browser's requestAnimationFrame for animation instead of setTimeout
   data.useAnimationFrame = true;
   //If animation frame is not used, this is the delay between 2 animation steps
@@ -60,6 +60,9 @@ StelPluginInfo RemoteSyncStelPluginInterface::getPluginInfo() const
 RemoteSync::RemoteSync()
 	: clientServerPort(20180)
 	, serverPort(20180)
+	, serverCompression(true)
+	, clientClusterMode(false)
+	, clientSwapBarrier(false)
 	, connectionLostBehavior(ClientBehavior::RECONNECT)
 	, quitBehavior(ClientBehavior::NONE)
 	, state(IDLE)
@@ -101,6 +104,8 @@ void RemoteSync::init()
 	QString syncMode = CLIProcessor::argsGetOptionWithArg(args,"","--syncMode","").toString();
 	QString syncHost = CLIProcessor::argsGetOptionWithArg(args,"","--syncHost","").toString();
 	int syncPort = CLIProcessor::argsGetOptionWithArg(args,"","--syncPort",0).toInt();
+	bool syncCluster = CLIProcessor::argsGetOption(args,"","--syncCluster");
+	bool syncBarrier = CLIProcessor::argsGetOption(args,"","--syncBarrier");
 
 	if(syncMode=="server")
 	{
@@ -115,6 +120,11 @@ void RemoteSync::init()
 			setClientServerHost(syncHost);
 		if(syncPort!=0)
 			setClientServerPort(syncPort);
+		if(syncCluster || syncBarrier)
+		{
+			setClientClusterMode(true);
+			setClientSwapBarrier(syncBarrier);
+		}
 		qCDebug(remoteSync)<<"Connecting to server from command line";
 		connectToServer();
 	}
@@ -125,15 +135,28 @@ void RemoteSync::update(double deltaTime)
 	Q_UNUSED(deltaTime);
 	if(server)
 	{
-		//pass update on to server, client does not need this
 		server->update();
 	}
+	else if(client)
+	{
+		//applies the frames of the server in cluster mode
+		client->update();
+	}
+}
+
+void RemoteSync::draw(StelCore *core)
+{
+	Q_UNUSED(core);
+	if(server)
+		server->endFrame();
+	else if(client)
+		client->endFrame();
 }
 
 double RemoteSync::getCallOrder(StelModuleActionName actionName) const
 {
-	//we want update() to be called as late as possible
-	if(actionName == ActionUpdate)
+	//we want update() to be called as late as possible, and draw() after everything is drawn
+	if(actionName == ActionUpdate || actionName == ActionDraw)
 		return 100000.0;
 
 	return StelModule::getCallOrder(actionName);
@@ -167,6 +190,15 @@ void RemoteSync::setServerPort(const int port)
 	}
 }
 
+void RemoteSync::setServerCompression(bool b)
+{
+	if(b!=serverCompression)
+	{
+		serverCompression = b;
+		emit serverCompressionChanged(b);
+	}
+}
+
 void RemoteSync::setClientSyncOptions(SyncClient::SyncOptions options)
 {
 	if(options!=syncOptions)
@@ -176,6 +208,31 @@ void RemoteSync::setClientSyncOptions(SyncClient::SyncOptions options)
 	}
 }
 
+void RemoteSync::setClientClusterMode(bool b)
+{
+	if(b!=clientClusterMode)
+	{
+		clientClusterMode = b;
+		emit clientClusterModeChanged(b);
+	}
+}
+
+void RemoteSync::setClientSwapBarrier(bool b)
+{
+	if(b!=clientSwapBarrier)
+	{
+		clientSwapBarrier = b;
+		emit clientSwapBarrierChanged(b);
+	}
+}
+
+QVariantMap RemoteSync::getClusterStatistics() const
+{
+	if(client)
+		return client->getClusterStatistics();
+	return QVariantMap();
+}
+
 void RemoteSync::setStelPropFilter(const QStringList &stelPropFilter)
 {
 	if(stelPropFilter!=this->stelPropFilter)
@@ -208,6 +265,7 @@ void RemoteSync::startServer()
 	if(state == IDLE)
 	{
 		server = new SyncServer(this);
+		server->setCompression(serverCompression);
 		if(server->start(serverPort))
 			setState(SERVER);
 		else
@@ -238,7 +296,7 @@ void RemoteSync::connectToServer()
 {
 	if(state == IDLE || state == CLIENT_WAIT_RECONNECT)
 	{
-		client = new SyncClient(syncOptions, stelPropFilter, this);
+		client = new SyncClient(syncOptions, stelPropFilter, clientClusterMode, clientSwapBarrier, this);
 		connect(client, SIGNAL(connected()), this, SLOT(clientConnected()));
 		connect(client, SIGNAL(disconnected(bool)), this, SLOT(clientDisconnected(bool)));
 		setState(CLIENT_CONNECTING);
@@ -320,7 +378,10 @@ void RemoteSync::loadSettings()
 	setClientServerHost(conf->value("clientServerHost","127.0.0.1").toString());
 	setClientServerPort(conf->value("clientServerPort",20180).toInt());
 	setServerPort(conf->value("serverPort",20180).toInt());
+	setServerCompression(conf->value("serverCompression", true).toBool());
 	setClientSyncOptions(SyncClient::SyncOptions(conf->value("clientSyncOptions", SyncClient::ALL).toInt()));
+	setClientClusterMode(conf->value("clientClusterMode", false).toBool());
+	setClientSwapBarrier(conf->value("clientSwapBarrier", false).toBool());
 	setStelPropFilter(unpackStringList(conf->value("stelPropFilter").toString()));
 	setConnectionLostBehavior(static_cast<ClientBehavior>(conf->value("connectionLostBehavior",1).toInt()));
 	setQuitBehavior(static_cast<ClientBehavior>(conf->value("quitBehavior").toInt()));
@@ -334,7 +395,10 @@ void RemoteSync::saveSettings()
 	conf->setValue("clientServerHost",clientServerHost);
 	conf->setValue("clientServerPort",clientServerPort);
 	conf->setValue("serverPort",serverPort);
+	conf->setValue("serverCompression",serverCompression);
 	conf->setValue("clientSyncOptions",static_cast<int>(syncOptions));
+	conf->setValue("clientClusterMode", clientClusterMode);
+	conf->setValue("clientSwapBarrier", clientSwapBarrier);
 	conf->setValue("stelPropFilter", packStringList(stelPropFilter));
 	conf->setValue("connectionLostBehavior", connectionLostBehavior);
 	conf->setValue("quitBehavior", quitBehavior);
@@ -67,8 +67,12 @@ public:
 	// Methods defined in the StelModule class
 	virtual void init() Q_DECL_OVERRIDE;
 	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
+	//! Runs the swap barrier of the cluster mode, after everything else is drawn
+	virtual void draw(StelCore* core) Q_DECL_OVERRIDE;
 
 	virtual double getCallOrder(StelModuleActionName actionName) const Q_DECL_OVERRIDE;
+	//! The server sends the state of the whole program, so wait for all the updates
+	virtual QStringList getUpdateReads() const Q_DECL_OVERRIDE {return QStringList("*");}
 
 	virtual bool configureGui(bool show=true) Q_DECL_OVERRIDE;
 	///////////////////////////////////////////////////////////////////////////
@@ -76,7 +80,10 @@ public:
 	QString getClientServerHost() const { return clientServerHost; }
 	int getClientServerPort() const { return clientServerPort; }
 	int getServerPort() const { return serverPort; }
+	bool getServerCompression() const { return serverCompression; }
 	SyncClient::SyncOptions getClientSyncOptions() const { return syncOptions; }
+	bool getClientClusterMode() const { return clientClusterMode; }
+	bool getClientSwapBarrier() const { return clientSwapBarrier; }
 	QStringList getStelPropFilter() const { return stelPropFilter; }
 	ClientBehavior getConnectionLostBehavior() const { return connectionLostBehavior; }
 	ClientBehavior getQuitBehavior() const { return quitBehavior; }
@@ -87,7 +94,15 @@ public slots:
 	void setClientServerHost(const QString& clientServerHost);
 	void setClientServerPort(const int port);
 	void setServerPort(const int port);
+	//! If enabled, the server compresses large messages. Takes effect when the server is started.
+	void setServerCompression(bool b);
 	void setClientSyncOptions(SyncClient::SyncOptions options);
+	//! In cluster mode, the client follows the time and view of each frame of the server.
+	//! Takes effect with the next connection.
+	void setClientClusterMode(bool b);
+	//! In cluster mode, the client and the server wait for each other at the end of each frame.
+	//! Takes effect with the next connection.
+	void setClientSwapBarrier(bool b);
 	void setStelPropFilter(const QStringList& stelPropFilter);
 	void setConnectionLostBehavior(const ClientBehavior bh);
 	void setQuitBehavior(const ClientBehavior bh);
@@ -125,12 +140,19 @@ public slots:
 	//! Uses internally loadSettings() and saveSettings().
 	void restoreDefaultSettings();
 
+	//! The measures of the synchronization of the client in cluster mode (see SyncClusterClient::getStatistics).
+	//! Empty when not connected in cluster mode.
+	QVariantMap getClusterStatistics() const;
+
 signals:
 	void errorOccurred(const QString& errorString);
 	void clientServerHostChanged(const QString& clientServerHost);
 	void clientServerPortChanged(const int port);
 	void serverPortChanged(const int port);
+	void serverCompressionChanged(bool b);
 	void clientSyncOptionsChanged(const SyncClient::SyncOptions options);
+	void clientClusterModeChanged(bool b);
+	void clientSwapBarrierChanged(bool b);
 	void stelPropFilterChanged(const QStringList& stelPropFilter);
 	void connectionLostBehaviorChanged(const ClientBehavior bh);
 	void quitBehaviorChanged(const ClientBehavior bh);
@@ -155,7 +177,10 @@ private:
 	int clientServerPort;
 	//the port used in server mode
 	int serverPort;
+	bool serverCompression;
 	SyncClient::SyncOptions syncOptions;
+	bool clientClusterMode;
+	bool clientSwapBarrier;
 	QStringList stelPropFilter;
 	ClientBehavior connectionLostBehavior;
 	ClientBehavior quitBehavior;
@@ -19,6 +19,7 @@
 
 #include "SyncClient.hpp"
 #include "SyncClientHandlers.hpp"
+#include "SyncCluster.hpp"
 #include "SyncMessages.hpp"
 
 #include "StelTranslator.hpp"
@@ -31,13 +32,16 @@ Q_LOGGING_CATEGORY(syncClient,"stel.plugin.remoteSync.client")
 
 using namespace SyncProtocol;
 
-SyncClient::SyncClient(SyncOptions options, const QStringList &excludeProperties, QObject *parent)
+SyncClient::SyncClient(SyncOptions options, const QStringList &excludeProperties, bool clusterMode, bool swapBarrier, QObject *parent)
 	: QObject(parent),
 	  options(options),
 	  stelPropFilter(excludeProperties),
 	  isConnecting(false),
 	  server(Q_NULLPTR),
-	  timeoutTimerId(-1)
+	  timeoutTimerId(-1),
+	  cluster(Q_NULLPTR),
+	  clockSyncTimerId(-1),
+	  clockSyncCount(0)
 {
 	handlerList.resize(MSGTYPE_SIZE);
 	handlerList[ERROR] = new ClientErrorHandler(this);
@@ -46,6 +50,16 @@ SyncClient::SyncClient(SyncOptions options, const QStringList &excludeProperties
 	handlerList[ALIVE] = new ClientAliveHandler();
 
 	//these are the actual sync handlers
+	if(clusterMode)
+	{
+		//the time, view and fov come with the frames, the TIME, VIEW and FOV messages are ignored
+		cluster = new SyncClusterClient(swapBarrier);
+		handlerList[CLOCK_SYNC] = new ClientClockSyncHandler(cluster);
+		handlerList[FRAME] = new ClientFrameHandler(cluster);
+		handlerList[BARRIER] = new ClientBarrierHandler(cluster);
+		options &= ~(SyncTime | SyncView | SyncFov);
+		this->options = options;
+	}
 	if(options.testFlag(SyncTime))
 		handlerList[TIME] = new ClientTimeHandler();
 	if(options.testFlag(SyncLocation))
@@ -59,6 +73,8 @@ SyncClient::SyncClient(SyncOptions options, const QStringList &excludeProperties
 	if(options.testFlag(SyncFov))
 		handlerList[FOV] = new ClientFovHandler();
 
+	connect(this, SIGNAL(connected()), this, SLOT(serverAuthenticated()));
+
 	//fill unused handlers with dummies
 	for(int t = TIME;t<MSGTYPE_SIZE;++t)
 	{
@@ -78,6 +94,7 @@ SyncClient::~SyncClient()
 			delete h;
 	}
 	handlerList.clear();
+	delete cluster;
 
 	qCDebug(syncClient)<<"Destroyed";
 }
@@ -115,6 +132,36 @@ void SyncClient::timerEvent(QTimerEvent *evt)
 		checkTimeout();
 		evt->accept();
 	}
+	else if(evt->timerId() == clockSyncTimerId)
+	{
+		if(server)
+		{
+			cluster->sendClockSync(*server);
+			//log the measures all 5 seconds
+			if(++clockSyncCount % 10 == 0)
+				qCInfo(syncClient)<<"Cluster sync:"<<cluster->getReport();
+		}
+		evt->accept();
+	}
+}
+
+void SyncClient::update()
+{
+	if(cluster && server && server->isAuthenticated())
+		cluster->update();
+}
+
+void SyncClient::endFrame()
+{
+	if(cluster && server && server->isAuthenticated())
+		cluster->endFrame(*server);
+}
+
+QVariantMap SyncClient::getClusterStatistics() const
+{
+	if(cluster)
+		return cluster->getStatistics();
+	return QVariantMap();
 }
 
 void SyncClient::checkTimeout()
@@ -128,6 +175,11 @@ void SyncClient::checkTimeout()
 void SyncClient::serverDisconnected(bool clean)
 {
 	qCDebug(syncClient)<<"Disconnected from server";
+	if(clockSyncTimerId != -1)
+	{
+		killTimer(clockSyncTimerId);
+		clockSyncTimerId = -1;
+	}
 	if(!clean)
 		errorStr = server->getError();
 	server->deleteLater();
@@ -135,6 +187,16 @@ void SyncClient::serverDisconnected(bool clean)
 	emit disconnected(errorStr.isEmpty());
 }
 
+void SyncClient::serverAuthenticated()
+{
+	if(cluster)
+	{
+		qCDebug(syncClient)<<"Joining the cluster, swap barrier:"<<cluster->usesSwapBarrier();
+		cluster->join(*server);
+		clockSyncTimerId = startTimer(500);
+	}
+}
+
 void SyncClient::socketConnected()
 {
 	qCDebug(syncClient)<<"Socket connected";
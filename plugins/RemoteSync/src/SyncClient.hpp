@@ -23,13 +23,17 @@
 #include <QLoggingCategory>
 #include <QObject>
 #include <QTcpSocket>
+#include <QVariantMap>
 
 Q_DECLARE_LOGGING_CATEGORY(syncClient)
 
 class SyncMessageHandler;
 class SyncRemotePeer;
+class SyncClusterClient;
 
-//! A client which can connect to a SyncServer to receive state changes, and apply them
+//! A client which can connect to a SyncServer to receive state changes, and apply them.
+//! In cluster mode, the time and view are taken from the FRAME messages of the server and applied
+//! in update() (see SyncClusterClient), and the other changes are received as usual.
 class SyncClient : public QObject
 {
 	Q_OBJECT
@@ -51,11 +55,20 @@ public:
 	};
 	Q_DECLARE_FLAGS(SyncOptions, SyncOption)
 
-	SyncClient(SyncOptions options, const QStringList& excludeProperties, QObject* parent = Q_NULLPTR);
+	//! @param clusterMode synchronize the time and view with each frame of the server
+	//! @param swapBarrier in cluster mode, also present each frame at the same time as the server
+	SyncClient(SyncOptions options, const QStringList& excludeProperties, bool clusterMode = false, bool swapBarrier = false, QObject* parent = Q_NULLPTR);
 	virtual ~SyncClient();
 
 	QString errorString() const { return errorStr; }
 
+	//! This should be called in the StelModule::update function
+	void update();
+	//! This should be called at the end of the drawing
+	void endFrame();
+	//! The measures of the cluster mode (see SyncClusterClient::getStatistics), empty if not used
+	QVariantMap getClusterStatistics() const;
+
 public slots:
 	void connectToServer(const QString& host, const int port);
 	void disconnectFromServer();
@@ -67,6 +80,7 @@ signals:
 	void disconnected(bool cleanExit);
 private slots:
 	void serverDisconnected(bool clean);
+	void serverAuthenticated();
 	void socketConnected();
 	void emitServerError(const QString& errorStr);
 
@@ -79,6 +93,9 @@ private:
 	bool isConnecting;
 	SyncRemotePeer* server;
 	int timeoutTimerId;
+	SyncClusterClient* cluster;
+	int clockSyncTimerId;
+	int clockSyncCount;
 	QVector<SyncMessageHandler*> handlerList;
 
 	friend class ClientErrorHandler;
@@ -19,6 +19,7 @@
 
 #include "SyncClientHandlers.hpp"
 #include "SyncClient.hpp"
+#include "SyncCluster.hpp"
 
 #include "SyncMessages.hpp"
 #include "StelApp.hpp"
@@ -308,14 +309,17 @@ bool ClientStelPropertyUpdateHandler::handleMessage(QDataStream &stream, SyncPro
 
 	qDebug()<<msg;
 
-	QRegularExpressionMatch match = filter.match(msg.propId);
-	if(match.hasMatch())
+	foreach(const StelPropertyUpdate::tChange& change, msg.changes)
 	{
-		//filtered property
-		qDebug()<<"Filtered"<<msg;
-		return true;
+		QRegularExpressionMatch match = filter.match(change.first);
+		if(match.hasMatch())
+		{
+			//filtered property
+			qDebug()<<"Filtered"<<change.first;
+			continue;
+		}
+		propMgr->setStelPropertyValue(change.first,change.second);
 	}
-	propMgr->setStelPropertyValue(msg.propId,msg.value);
 	return true;
 }
 
@@ -348,3 +352,44 @@ bool ClientFovHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayload
 	mvMgr->zoomTo(msg.fov, 0.0f);
 	return true;
 }
+
+ClientClusterHandler::ClientClusterHandler(SyncClusterClient *cluster)
+	: cluster(cluster)
+{
+	Q_ASSERT(cluster);
+}
+
+bool ClientClockSyncHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	const qint64 receiveTime = getClockTime();
+
+	ClockSync msg;
+	bool ok = msg.deserialize(stream, dataSize);
+	if(!ok) return false;
+
+	cluster->clockSyncReceived(msg, receiveTime);
+	return true;
+}
+
+bool ClientFrameHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	const qint64 receiveTime = getClockTime();
+
+	Frame msg;
+	bool ok = msg.deserialize(stream, dataSize);
+	if(!ok) return false;
+
+	//the frame is applied in the next update
+	cluster->frameReceived(msg, receiveTime);
+	return true;
+}
+
+bool ClientBarrierHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	Barrier msg;
+	bool ok = msg.deserialize(stream, dataSize);
+	if(!ok) return false;
+
+	cluster->barrierReleased(msg.frameNumber);
+	return true;
+}
@@ -25,6 +25,7 @@
 #include <QRegularExpression>
 
 class SyncClient;
+class SyncClusterClient;
 class StelCore;
 
 class ClientHandler : public QObject, public SyncMessageHandler
@@ -117,4 +118,34 @@ private:
 	StelMovementMgr* mvMgr;
 };
 
+//! Base class of the handlers of the cluster mode, which pass the messages on to the SyncClusterClient
+class ClientClusterHandler : public SyncMessageHandler
+{
+public:
+	ClientClusterHandler(SyncClusterClient* cluster);
+protected:
+	SyncClusterClient* cluster;
+};
+
+class ClientClockSyncHandler : public ClientClusterHandler
+{
+public:
+	ClientClockSyncHandler(SyncClusterClient* cluster) : ClientClusterHandler(cluster) {}
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
+class ClientFrameHandler : public ClientClusterHandler
+{
+public:
+	ClientFrameHandler(SyncClusterClient* cluster) : ClientClusterHandler(cluster) {}
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
+class ClientBarrierHandler : public ClientClusterHandler
+{
+public:
+	ClientBarrierHandler(SyncClusterClient* cluster) : ClientClusterHandler(cluster) {}
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
 #endif
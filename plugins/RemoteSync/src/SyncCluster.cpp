@@ -0,0 +1,290 @@
+/*
+ * Stellarium Remote Sync plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SyncCluster.hpp"
+#include "SyncMessages.hpp"
+
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelMovementMgr.hpp"
+
+#include <QElapsedTimer>
+
+using namespace SyncProtocol;
+
+ClockOffsetEstimator::ClockOffsetEstimator()
+	: next(0), best(0)
+{
+	samples.reserve(maxSamples);
+}
+
+void ClockOffsetEstimator::clear()
+{
+	samples.clear();
+	next = 0;
+	best = 0;
+}
+
+void ClockOffsetEstimator::addSample(const ClockSync &msg, qint64 receiveTime)
+{
+	Sample s;
+	s.offset = ((msg.serverReceiveTime - msg.clientSendTime) + (msg.serverSendTime - receiveTime)) / 2;
+	s.roundTrip = (receiveTime - msg.clientSendTime) - (msg.serverSendTime - msg.serverReceiveTime);
+
+	if(samples.size() < maxSamples)
+		samples.append(s);
+	else
+		samples[next] = s;
+	next = (next + 1) % maxSamples;
+
+	best = 0;
+	for(int i = 1; i<samples.size(); ++i)
+	{
+		if(samples.at(i).roundTrip < samples.at(best).roundTrip)
+			best = i;
+	}
+}
+
+qint64 ClockOffsetEstimator::getOffset() const
+{
+	return samples.isEmpty() ? 0 : samples.at(best).offset;
+}
+
+qint64 ClockOffsetEstimator::getRoundTrip() const
+{
+	return samples.isEmpty() ? 0 : samples.at(best).roundTrip;
+}
+
+SyncClusterClient::SyncClusterClient(bool swapBarrier)
+	: swapBarrier(swapBarrier),
+	  frameCount(0),
+	  jdAnchor(0.0),
+	  jdAnchorTime(0),
+	  timeRate(0.0),
+	  timeChanged(false),
+	  appliedOffset(0),
+	  appliedFrame(0),
+	  releasedFrame(0),
+	  lastUpdateTime(0),
+	  frameInterval(0),
+	  localLead(0),
+	  lastTransit(0),
+	  jitter(0.0),
+	  framesReceived(0),
+	  framesSkipped(0),
+	  barrierTimeouts(0),
+	  latency(300),
+	  extrapolation(300),
+	  barrierWait(300)
+{
+	core = StelApp::getInstance().getCore();
+	mvMgr = core->getMovementMgr();
+}
+
+void SyncClusterClient::join(SyncRemotePeer &server)
+{
+	ClusterJoin msg;
+	msg.swapBarrier = swapBarrier;
+	server.writeMessage(msg);
+	sendClockSync(server);
+}
+
+void SyncClusterClient::sendClockSync(SyncRemotePeer &server)
+{
+	ClockSync msg;
+	msg.clientSendTime = getClockTime();
+	server.writeMessage(msg);
+	server.flush();
+}
+
+void SyncClusterClient::clockSyncReceived(const ClockSync &msg, qint64 receiveTime)
+{
+	clock.addSample(msg, receiveTime);
+}
+
+void SyncClusterClient::frameReceived(const Frame &msg, qint64 receiveTime)
+{
+	++framesReceived;
+
+	//the transit time contains the unknown clock offset, but it cancels out in the differences (RFC 3550)
+	const qint64 transit = receiveTime - msg.frameTime;
+	if(framesReceived > 1)
+		jitter += (qAbs(transit - lastTransit) - jitter) / 16.0;
+	lastTransit = transit;
+
+	if(!clock.isValid())
+	{
+		//the frame times can not be converted yet
+		++framesSkipped;
+		return;
+	}
+
+	//the previous frame is replaced before it could be shown
+	if(frameCount > 0 && lastFrame.number > appliedFrame)
+		++framesSkipped;
+
+	const qint64 offset = clock.getOffset();
+	latency.add((transit + offset) / 1000.f);
+
+	prevFrame = lastFrame;
+	lastFrame.number = msg.frameNumber;
+	lastFrame.time = msg.frameTime - offset;
+	lastFrame.lead = msg.frameLead;
+	lastFrame.view = msg.viewAltAz;
+	lastFrame.fov = msg.fov;
+	frameCount = qMin(frameCount + 1, 2);
+
+	if(msg.jdAnchor != jdAnchor || msg.jdAnchorTime != jdAnchorTime || msg.timeRate != timeRate)
+	{
+		jdAnchor = msg.jdAnchor;
+		jdAnchorTime = msg.jdAnchorTime;
+		timeRate = msg.timeRate;
+		timeChanged = true;
+	}
+}
+
+void SyncClusterClient::barrierReleased(quint64 frameNumber)
+{
+	releasedFrame = qMax(releasedFrame, frameNumber);
+}
+
+void SyncClusterClient::update()
+{
+	const qint64 now = getClockTime();
+	if(lastUpdateTime)
+		frameInterval = now - lastUpdateTime;
+	lastUpdateTime = now;
+
+	if(frameCount == 0)
+		return;
+
+	applyTime(now);
+	applyView(now);
+}
+
+void SyncClusterClient::applyTime(qint64 now)
+{
+	//StelCore advances the time from its anchor itself, it only has to be set again when the anchor
+	//of the server or the clock offset estimation changes
+	const qint64 offset = clock.getOffset();
+	if(!timeChanged && qAbs(offset - appliedOffset) <= 1000)
+		return;
+	timeChanged = false;
+	appliedOffset = offset;
+
+	const double jd = jdAnchor + (now + offset - jdAnchorTime) / 1e6 * timeRate;
+	//time rate first because it causes a resetSync which we overwrite
+	if(core->getTimeRate() != timeRate)
+		core->setTimeRate(timeRate);
+	core->setJD(jd);
+}
+
+void SyncClusterClient::applyView(qint64 now)
+{
+	Vec3d view = lastFrame.view;
+	double fov = lastFrame.fov;
+
+	const qint64 span = lastFrame.time - prevFrame.time;
+	//with the swap barrier, all nodes show the last frame of the server at the same time
+	if(!swapBarrier && frameCount == 2 && span > 0 && span <= maxInterpolation)
+	{
+		//the local frame is shown after localLead, the one of the server was shown after its lead
+		qint64 target = now + localLead - lastFrame.lead;
+		target = qBound(prevFrame.time, target, lastFrame.time + maxExtrapolation);
+		extrapolation.add(qMax(Q_INT64_C(0), target - lastFrame.time) / 1000.f);
+
+		const double a = double(target - prevFrame.time) / span;
+		view = prevFrame.view + (lastFrame.view - prevFrame.view) * a;
+		view.normalize();
+
+		//StelMovementMgr applies the fov in the next frame
+		const qint64 fovTarget = qMin(target + frameInterval, lastFrame.time + maxExtrapolation);
+		const double af = double(fovTarget - prevFrame.time) / span;
+		fov = prevFrame.fov + (lastFrame.fov - prevFrame.fov) * af;
+	}
+
+	mvMgr->setViewDirectionJ2000(core->altAzToJ2000(view, StelCore::RefractionOff));
+	mvMgr->zoomTo(fov, 0.f);
+	appliedFrame = lastFrame.number;
+}
+
+void SyncClusterClient::endFrame(SyncRemotePeer &server)
+{
+	if(lastUpdateTime)
+		localLead = getClockTime() - lastUpdateTime;
+
+	//no new frame of the server was drawn
+	if(!swapBarrier || appliedFrame <= releasedFrame)
+		return;
+
+	Barrier ready;
+	ready.frameNumber = appliedFrame;
+	server.writeMessage(ready);
+
+	QElapsedTimer timer;
+	timer.start();
+	while(releasedFrame < appliedFrame)
+	{
+		const int remaining = SYNC_BARRIER_TIMEOUT - static_cast<int>(timer.elapsed());
+		if(remaining <= 0 || !server.waitForData(remaining))
+		{
+			//do not wait for this frame again
+			++barrierTimeouts;
+			releasedFrame = appliedFrame;
+			break;
+		}
+	}
+	barrierWait.add(timer.nsecsElapsed() / 1e6f);
+}
+
+QVariantMap SyncClusterClient::getStatistics() const
+{
+	QVariantMap map;
+	map["clockOffset"] = clock.getOffset() / 1000.0;
+	map["roundTrip"] = clock.getRoundTrip() / 1000.0;
+	map["clockSamples"] = clock.getSampleCount();
+	map["framesReceived"] = framesReceived;
+	map["framesSkipped"] = framesSkipped;
+	map["barrierTimeouts"] = barrierTimeouts;
+	map["jitter"] = jitter / 1000.0;
+	map["latency"] = latency.getStatistics();
+	map["extrapolation"] = extrapolation.getStatistics();
+	map["barrierWait"] = barrierWait.getStatistics();
+	return map;
+}
+
+QString SyncClusterClient::getReport() const
+{
+	QString str("clock offset %1 ms (round trip %2 ms), %3 frames received, %4 skipped, "
+		    "latency mean %5 ms p99 %6 ms, jitter %7 ms");
+	str = str.arg(clock.getOffset() / 1000.0, 0, 'f', 3)
+		 .arg(clock.getRoundTrip() / 1000.0, 0, 'f', 3)
+		 .arg(framesReceived)
+		 .arg(framesSkipped)
+		 .arg(latency.getMean(), 0, 'f', 3)
+		 .arg(latency.getPercentile(0.99f), 0, 'f', 3)
+		 .arg(jitter / 1000.0, 0, 'f', 3);
+	if(swapBarrier)
+		str += QString(", barrier wait mean %1 ms p99 %2 ms, %3 timeouts")
+				.arg(barrierWait.getMean(), 0, 'f', 3)
+				.arg(barrierWait.getPercentile(0.99f), 0, 'f', 3)
+				.arg(barrierTimeouts);
+	else
+		str += QString(", extrapolation p99 %1 ms").arg(extrapolation.getPercentile(0.99f), 0, 'f', 3);
+	return str;
+}
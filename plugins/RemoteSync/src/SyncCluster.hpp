@@ -0,0 +1,152 @@
+/*
+ * Stellarium Remote Sync plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef SYNCCLUSTER_HPP_
+#define SYNCCLUSTER_HPP_
+
+#include "StelFrameProfiler.hpp"
+#include "VecMath.hpp"
+
+#include <QVariantMap>
+#include <QVector>
+
+class SyncRemotePeer;
+class StelCore;
+class StelMovementMgr;
+
+namespace SyncProtocol
+{
+class ClockSync;
+class Frame;
+}
+
+//! Estimates the offset of the server clock to the local one (see SyncProtocol::getClockTime),
+//! from the CLOCK_SYNC round trips, like NTP does.
+//! The sample with the shortest round trip of the last ones is used, as its delays are the most symmetric.
+class ClockOffsetEstimator
+{
+public:
+	ClockOffsetEstimator();
+
+	//! Adds the answer of the server, received at the local time receiveTime
+	void addSample(const SyncProtocol::ClockSync& msg, qint64 receiveTime);
+	void clear();
+
+	bool isValid() const { return !samples.isEmpty(); }
+	//! The server clock minus the local clock [microseconds]
+	qint64 getOffset() const;
+	//! The round trip time of the sample used for the offset [microseconds]
+	qint64 getRoundTrip() const;
+	int getSampleCount() const { return samples.size(); }
+
+private:
+	struct Sample
+	{
+		qint64 offset;
+		qint64 roundTrip;
+	};
+	static const int maxSamples = 8;
+
+	QVector<Sample> samples;
+	int next;
+	int best;
+};
+
+//! The cluster side of a SyncClient: applies the time and view of the FRAME messages of the server
+//! each frame, instead of when the TIME, VIEW and FOV messages arrive, and takes part in the swap barrier.
+//! Without the barrier, the view is interpolated between the last two frames (or extrapolated a bit after the
+//! last one) for the time at which the local frame will be shown, to compensate the network and drawing delays.
+//! The statistics of the synchronization are kept for getStatistics().
+class SyncClusterClient
+{
+public:
+	SyncClusterClient(bool swapBarrier);
+
+	bool usesSwapBarrier() const { return swapBarrier; }
+
+	//! Asks the server for the FRAME messages, and starts the clock offset estimation
+	void join(SyncRemotePeer& server);
+	//! Sends a new clock offset estimation request
+	void sendClockSync(SyncRemotePeer& server);
+
+	void clockSyncReceived(const SyncProtocol::ClockSync& msg, qint64 receiveTime);
+	void frameReceived(const SyncProtocol::Frame& msg, qint64 receiveTime);
+	void barrierReleased(quint64 frameNumber);
+
+	//! Applies the state of the server to this frame. Called in the StelModule::update function.
+	void update();
+	//! Called at the end of the drawing, waits at the swap barrier if it is used
+	void endFrame(SyncRemotePeer& server);
+
+	//! The measures of the synchronization: "clockOffset", "roundTrip" [ms], "clockSamples",
+	//! "framesReceived", "framesSkipped", "barrierTimeouts", "jitter" [ms], and the
+	//! statistics (see StelFrameProfiler::History) of "latency", "extrapolation" and "barrierWait" [ms]
+	QVariantMap getStatistics() const;
+	//! The statistics as a line for the log
+	QString getReport() const;
+
+private:
+	struct FrameState
+	{
+		FrameState() : number(0), time(0), lead(0), fov(0.0) {}
+		quint64 number;
+		qint64 time; //in the local clock
+		qint64 lead;
+		Vec3d view;
+		double fov;
+	};
+
+	void applyTime(qint64 now);
+	void applyView(qint64 now);
+
+	//! Maximal time the view is extrapolated after the last frame [microseconds]
+	static const qint64 maxExtrapolation = 100000;
+	//! Frames further apart are not interpolated (e.g. the server was paused) [microseconds]
+	static const qint64 maxInterpolation = 250000;
+
+	StelCore* core;
+	StelMovementMgr* mvMgr;
+	bool swapBarrier;
+	ClockOffsetEstimator clock;
+
+	FrameState lastFrame, prevFrame;
+	int frameCount; //0, 1 or 2 frames known
+	double jdAnchor;
+	qint64 jdAnchorTime; //in the server clock
+	double timeRate;
+	bool timeChanged;
+	qint64 appliedOffset;
+
+	quint64 appliedFrame;
+	quint64 releasedFrame;
+	qint64 lastUpdateTime;
+	qint64 frameInterval;
+	qint64 localLead;
+
+	//statistics
+	qint64 lastTransit;
+	double jitter;
+	int framesReceived;
+	int framesSkipped;
+	int barrierTimeouts;
+	StelFrameProfiler::History latency;
+	StelFrameProfiler::History extrapolation;
+	StelFrameProfiler::History barrierWait;
+};
+
+#endif
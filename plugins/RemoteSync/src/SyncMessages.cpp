@@ -172,15 +172,28 @@ bool Selection::deserialize(QDataStream &stream, tPayloadSize dataSize)
 
 void StelPropertyUpdate::serialize(QDataStream &stream) const
 {
-	writeString(stream,propId);
-	stream<<value;
+	stream<<static_cast<quint16>(changes.size());
+	foreach(const tChange& change, changes)
+	{
+		writeString(stream,change.first);
+		stream<<change.second;
+	}
 }
 
 bool StelPropertyUpdate::deserialize(QDataStream &stream, tPayloadSize dataSize)
 {
 	Q_UNUSED(dataSize);
-	propId = readString(stream);
-	stream>>value;
+	quint16 count;
+	stream>>count;
+	changes.clear();
+	changes.reserve(count);
+	for(int i = 0; i<count && !stream.status(); ++i)
+	{
+		tChange change;
+		change.first = readString(stream);
+		stream>>change.second;
+		changes.append(change);
+	}
 	return !stream.status();
 }
 
@@ -213,3 +226,105 @@ bool Fov::deserialize(QDataStream &stream, tPayloadSize dataSize)
 
 	return !stream.status();
 }
+
+ClusterJoin::ClusterJoin()
+	: swapBarrier(false)
+{
+
+}
+
+void ClusterJoin::serialize(QDataStream &stream) const
+{
+	stream<<swapBarrier;
+}
+
+bool ClusterJoin::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	if(dataSize != 1)
+		return false;
+
+	stream>>swapBarrier;
+
+	return !stream.status();
+}
+
+ClockSync::ClockSync()
+	: clientSendTime(0), serverReceiveTime(0), serverSendTime(0)
+{
+
+}
+
+void ClockSync::serialize(QDataStream &stream) const
+{
+	stream<<clientSendTime;
+	stream<<serverReceiveTime;
+	stream<<serverSendTime;
+}
+
+bool ClockSync::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	if(dataSize != 3 * sizeof(qint64))
+		return false;
+
+	stream>>clientSendTime;
+	stream>>serverReceiveTime;
+	stream>>serverSendTime;
+
+	return !stream.status();
+}
+
+Frame::Frame()
+	: frameNumber(0), frameTime(0), frameLead(0), jdAnchor(0.0), jdAnchorTime(0), timeRate(0.0), fov(0.0)
+{
+
+}
+
+void Frame::serialize(QDataStream &stream) const
+{
+	stream<<frameNumber;
+	stream<<frameTime;
+	stream<<frameLead;
+	stream<<jdAnchor;
+	stream<<jdAnchorTime;
+	stream<<timeRate;
+	stream<<viewAltAz;
+	stream<<fov;
+}
+
+bool Frame::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	if(dataSize != 10 * 8)
+		return false;
+
+	stream>>frameNumber;
+	stream>>frameTime;
+	stream>>frameLead;
+	stream>>jdAnchor;
+	stream>>jdAnchorTime;
+	stream>>timeRate;
+	stream>>viewAltAz;
+	stream>>fov;
+
+	return !stream.status();
+}
+
+Barrier::Barrier()
+	: frameNumber(0)
+{
+
+}
+
+void Barrier::serialize(QDataStream &stream) const
+{
+	stream<<frameNumber;
+}
+
+bool Barrier::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	if(dataSize != sizeof(quint64))
+		return false;
+
+	stream>>frameNumber;
+
+	return !stream.status();
+}
@@ -24,6 +24,9 @@
 #include "StelLocation.hpp"
 #include "VecMath.hpp"
 
+#include <QPair>
+#include <QVector>
+
 namespace SyncProtocol
 {
 
@@ -133,6 +136,7 @@ public:
 	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE  { return SyncProtocol::ALIVE; }
 };
 
+//! The new values of one or more StelProperties. The server sends all the changes of a frame in one message.
 class StelPropertyUpdate : public SyncMessage
 {
 public:
@@ -143,11 +147,12 @@ public:
 
 	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
 	{
-		return dbg<<propId<<value;
+		return dbg<<changes;
 	}
 
-	QString propId;
-	QVariant value;
+	//! <propId, value>
+	typedef QPair<QString, QVariant> tChange;
+	QVector<tChange> changes;
 };
 
 class View : public SyncMessage
@@ -172,6 +177,90 @@ public:
 	double fov;
 };
 
+class ClusterJoin : public SyncMessage
+{
+public:
+	ClusterJoin();
+
+	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::CLUSTER_JOIN; }
+
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	bool swapBarrier; //if true, the server waits for this client at the end of each frame
+};
+
+//! The times of a clock offset estimation round trip, like in NTP.
+//! The client sends it with clientSendTime set, the server answers with the same message, adding its times.
+//! All times are from SyncProtocol::getClockTime() of the respective peer.
+class ClockSync : public SyncMessage
+{
+public:
+	ClockSync();
+
+	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::CLOCK_SYNC; }
+
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
+	{
+		return dbg<<clientSendTime<<serverReceiveTime<<serverSendTime;
+	}
+
+	qint64 clientSendTime;
+	qint64 serverReceiveTime;
+	qint64 serverSendTime;
+};
+
+//! The state of a frame of the server, sent to the cluster clients at the end of each update.
+//! The times are from SyncProtocol::getClockTime() of the server.
+class Frame : public SyncMessage
+{
+public:
+	Frame();
+
+	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::FRAME; }
+
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
+	{
+		return dbg<<frameNumber<<frameTime;
+	}
+
+	quint64 frameNumber;
+	qint64 frameTime; //when the frame was updated
+	qint64 frameLead; //time from the update to the end of the drawing, for the previous frame
+	//the simulation time is jdAnchor at jdAnchorTime, and advances with timeRate (like StelCore::getJDOfLastJDUpdate)
+	double jdAnchor;
+	qint64 jdAnchorTime;
+	double timeRate;
+	Vec3d viewAltAz;
+	double fov;
+};
+
+class Barrier : public SyncMessage
+{
+public:
+	Barrier();
+
+	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::BARRIER; }
+
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
+	{
+		return dbg<<frameNumber;
+	}
+
+	//from a client: the number of the last server frame it applied
+	//from the server: the number of the frame which is released
+	quint64 frameNumber;
+};
+
 }
 
 #endif
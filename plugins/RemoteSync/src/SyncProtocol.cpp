@@ -21,8 +21,10 @@
 #include "SyncMessages.hpp"
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QVector>
+#include <QtEndian>
 
 using namespace SyncProtocol;
 
@@ -43,9 +45,17 @@ QDataStream& operator>>(QDataStream& in, SyncHeader& header)
 	return in;
 }
 
+qint64 getClockTime()
+{
+	static QElapsedTimer timer;
+	if(!timer.isValid())
+		timer.start();
+	return timer.nsecsElapsed() / 1000;
+}
+
 }
 
-qint64 SyncMessage::createFullMessage(QByteArray &target) const
+qint64 SyncMessage::createFullMessage(QByteArray &target, bool compress) const
 {
 	//we serialize into a byte buffer first so that we can get message size easily
 	QDataStream tmpStream(&target, QIODevice::WriteOnly);
@@ -69,8 +79,23 @@ qint64 SyncMessage::createFullMessage(QByteArray &target) const
 	}
 	else
 	{
+		quint8 msgType = (quint8)getMessageType();
+		if(compress && writtenSize >= SYNC_COMPRESSION_THRESHOLD)
+		{
+			const QByteArray packed = qCompress(reinterpret_cast<const uchar*>(target.constData() + SYNC_HEADER_SIZE), writtenSize);
+			//only worth it if the payload gets smaller
+			if(packed.size() < writtenSize)
+			{
+				tmpStream.device()->seek(SYNC_HEADER_SIZE);
+				tmpStream.writeRawData(packed.constData(), packed.size());
+				writtenSize = packed.size();
+				totalSize = SYNC_HEADER_SIZE + writtenSize;
+				msgType |= SYNC_COMPRESSED_FLAG;
+			}
+		}
+
 		//write header in front
-		SyncHeader header = { (quint8)getMessageType(), static_cast<tPayloadSize>(writtenSize) };
+		SyncHeader header = { msgType, static_cast<tPayloadSize>(writtenSize) };
 		tmpStream.device()->seek(0);
 		tmpStream<<header;
 
@@ -103,7 +128,7 @@ QString SyncMessage::readString(QDataStream &stream)
 
 SyncRemotePeer::SyncRemotePeer(QAbstractSocket *socket, bool isServer, const QVector<SyncMessageHandler *> &handlerList)
 	: sock(socket), stream(sock), expectDisconnect(false), isPeerAServer(isServer), authenticated(false), authResponseSent(false), waitingForBody(false),
-	  handlerList(handlerList)
+	  compressedBody(false), compression(false), handlerList(handlerList)
 {
 	Q_ASSERT(sock);
 	sock->setParent(this); //reparent
@@ -218,18 +243,26 @@ void SyncRemotePeer::receiveMessage()
 				return;
 
 			stream>>msgHeader;
+			compressedBody = msgHeader.msgType & SYNC_COMPRESSED_FLAG;
+			msgHeader.msgType &= ~SYNC_COMPRESSED_FLAG;
 			//check if msgtype is valid
 			if(msgHeader.msgType>MSGTYPE_MAX)
 			{
 				writeError("invalid message type " + QString::number(msgHeader.msgType));
 				return;
 			}
-			if(!authenticated && msgHeader.msgType > SERVER_CHALLENGERESPONSEVALID)
+			if(!authenticated && (msgHeader.msgType > SERVER_CHALLENGERESPONSEVALID || compressedBody))
 			{
 				//if not fully authenticated, it is an error to send messages other than auth messages
 				writeError("not authenticated");
 				return;
 			}
+			if(compressedBody && !isPeerAServer)
+			{
+				//only the server compresses messages, a client has no reason to
+				writeError("compressed messages are not accepted from clients");
+				return;
+			}
 
 			peerLog()<<"received header for"<<SyncMessageType(msgHeader.msgType);
 		}
@@ -252,7 +285,32 @@ void SyncRemotePeer::receiveMessage()
 				writeError("unregistered message type " + QString::number(msgHeader.msgType));
 				return;
 			}
-			if(!handlerList[msgHeader.msgType]->handleMessage(stream, msgHeader.dataSize, *this))
+			bool ok;
+			if(compressedBody)
+			{
+				const QByteArray data = sock->read(msgHeader.dataSize);
+				//qCompress prefixes the data with the uncompressed size as 4 byte big endian,
+				//check it before qUncompress allocates anything
+				const quint32 uncompressedSize = data.size() >= 4 ? qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data.constData())) : 0;
+				if(uncompressedSize == 0 || uncompressedSize > SYNC_MAX_PAYLOAD_SIZE)
+				{
+					writeError("invalid compressed message of type " + QString::number(msgHeader.msgType));
+					return;
+				}
+				const QByteArray payload = qUncompress(data);
+				if(payload.size() != static_cast<int>(uncompressedSize))
+				{
+					writeError("invalid compressed message of type " + QString::number(msgHeader.msgType));
+					return;
+				}
+				QDataStream payloadStream(payload);
+				payloadStream.setVersion(SYNC_DATASTREAM_VERSION);
+				ok = handler->handleMessage(payloadStream, static_cast<tPayloadSize>(payload.size()), *this);
+			}
+			else
+				ok = handler->handleMessage(stream, msgHeader.dataSize, *this);
+
+			if(!ok)
 			{
 				writeError("last message of type " + QString::number(msgHeader.msgType) + " was rejected");
 			}
@@ -272,7 +330,8 @@ QDebug SyncRemotePeer::peerLog() const
 
 void SyncRemotePeer::writeMessage(const SyncMessage &msg)
 {
-	qint64 size = msg.createFullMessage(msgWriteBuffer);
+	//the peer can only know that compression is supported after the version check of the authentication
+	qint64 size = msg.createFullMessage(msgWriteBuffer, compression && authenticated);
 	peerLog()<<"Send message"<<msg;
 
 	if(!size)
@@ -302,6 +361,19 @@ void SyncRemotePeer::writeData(const QByteArray &data, int size)
 		peerLog("Can't write message, not connected");
 }
 
+void SyncRemotePeer::flush()
+{
+	if(sock->state() == QAbstractSocket::ConnectedState)
+		sock->flush();
+}
+
+bool SyncRemotePeer::waitForData(int msecs)
+{
+	flush();
+	//this emits readyRead, which processes the received messages
+	return sock->waitForReadyRead(msecs);
+}
+
 void SyncRemotePeer::writeError(const QString &err)
 {
 	qWarning()<<"[SyncPlugin] Disconnecting with error:"<<err;
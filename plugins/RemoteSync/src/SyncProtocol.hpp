@@ -32,7 +32,7 @@ namespace SyncProtocol
 //Important: All data should use the sized typedefs provided by Qt (i.e. qint32 instead of 4 byte int on x86)
 
 //! Should be changed with every breaking change
-const quint8 SYNC_PROTOCOL_VERSION = 2;
+const quint8 SYNC_PROTOCOL_VERSION = 4;
 const QDataStream::Version SYNC_DATASTREAM_VERSION = QDataStream::Qt_5_0;
 //! Magic value for protocol used during connection. Should NEVER change.
 const QByteArray SYNC_MAGIC_VALUE = "StellariumSyncPluginProtocol";
@@ -55,6 +55,20 @@ const qint64 SYNC_HEADER_SIZE = sizeof(quint8) + sizeof(tPayloadSize); //3 byte
 const qint64 SYNC_MAX_PAYLOAD_SIZE = (2<<15) - 1; // 65535
 const qint64 SYNC_MAX_MESSAGE_SIZE = SYNC_HEADER_SIZE + SYNC_MAX_PAYLOAD_SIZE;
 
+//! Set in the msgType of the header when the payload is compressed with qCompress.
+//! The dataSize is then the compressed size, the uncompressed payload is limited to SYNC_MAX_PAYLOAD_SIZE as usual.
+//! Only the server compresses, compressed messages from clients are rejected.
+const quint8 SYNC_COMPRESSED_FLAG = 0x80;
+//! Smaller payloads are never compressed, as it would not gain anything
+const qint64 SYNC_COMPRESSION_THRESHOLD = 256;
+
+//! Maximal time a cluster node waits at the swap barrier for the other nodes [ms]
+const int SYNC_BARRIER_TIMEOUT = 100;
+
+//! Returns the time of the monotonic clock used by the cluster mode [microseconds].
+//! Its origin is different in each process, the clients estimate the offset to the server clock with CLOCK_SYNC messages.
+qint64 getClockTime();
+
 //! Contains the possible message types. The enum value is used as an ID to identify the message type over the network.
 //! The classes handling these messages are defined in SyncMessages.hpp
 enum SyncMessageType
@@ -72,8 +86,12 @@ enum SyncMessageType
 	STELPROPERTY, //stelproperty updates
 	VIEW, //view change
 	FOV, //fov change
+	CLUSTER_JOIN, //sent from a client to receive the FRAME messages
+	CLOCK_SYNC, //clock offset estimation, sent from a cluster client and answered by the server
+	FRAME, //time and view of each frame of the server, only sent to cluster clients
+	BARRIER, //swap barrier: sent from a cluster client when its frame is ready, and from the server to release the frame
 
-	MSGTYPE_MAX = FOV,
+	MSGTYPE_MAX = BARRIER,
 	MSGTYPE_SIZE = MSGTYPE_MAX+1
 };
 
@@ -110,6 +128,18 @@ inline QDebug& operator<<(QDebug& deb, SyncMessageType msg)
 		case SyncProtocol::FOV:
 			deb<<"FOV";
 			break;
+		case SyncProtocol::CLUSTER_JOIN:
+			deb<<"CLUSTER_JOIN";
+			break;
+		case SyncProtocol::CLOCK_SYNC:
+			deb<<"CLOCK_SYNC";
+			break;
+		case SyncProtocol::FRAME:
+			deb<<"FRAME";
+			break;
+		case SyncProtocol::BARRIER:
+			deb<<"BARRIER";
+			break;
 		case SyncProtocol::ALIVE:
 			deb<<"ALIVE";
 			break;
@@ -130,8 +160,9 @@ public:
 	virtual SyncProtocol::SyncMessageType getMessageType() const = 0;
 
 	//! Writes a full message (with header) to the specified byte array.
+	//! If compress is true, large payloads are compressed when this makes them smaller.
 	//! Returns the total message size. If zero, the payload is too large for a SyncMessage.
-	qint64 createFullMessage(QByteArray& target) const;
+	qint64 createFullMessage(QByteArray& target, bool compress = false) const;
 
 	//! Subclasses should override this to serialize their contents to the data stream.
 	//! The default implementation writes nothing.
@@ -179,12 +210,20 @@ public:
 	void writeData(const QByteArray& data, int size=-1);
 	//! Can be used to write an error message to the peer and drop the connection
 	void writeError(const QString& err);
+	//! Sends the written data at once, instead of when the event loop is reached again
+	void flush();
+	//! Blocks until data is received from the peer (and processed by the handlers) or msecs elapsed.
+	//! Used by the swap barrier, which has to wait inside the frame.
+	//! @return false on timeout or error
+	bool waitForData(int msecs);
 
 	//! Log a message for this peer
 	void peerLog(const QString& msg) const;
 	QDebug peerLog() const;
 
 	bool isAuthenticated() const { return authenticated; }
+	//! If enabled, the large messages written to this peer are compressed (only after the authentication)
+	void setCompression(bool enable) { compression = enable; }
 	QUuid getID() const { return id; }
 
 	void checkTimeout();
@@ -211,6 +250,8 @@ private:
 	bool authenticated; // True if the peer ran through the HELLO process and can receive/send all message types
 	bool authResponseSent; //only for client use, tracks if the client has sent a resonse to the server challenge
 	bool waitingForBody; //True if waiting for full message body (after header was received)
+	bool compressedBody; //True if the body of the last message header is compressed
+	bool compression; //True if large messages to this peer should be compressed
 	SyncProtocol::SyncHeader msgHeader; //the last message header read/currently being processed
 	qint64 lastReceiveTime; // The time the last data of this peer was received
 	qint64 lastSendTime; //The time the last data was written to this peer
@@ -22,6 +22,7 @@
 #include "SyncServerHandlers.hpp"
 #include "SyncServerEventSenders.hpp"
 
+#include <QElapsedTimer>
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QTimerEvent>
@@ -32,7 +33,7 @@ Q_LOGGING_CATEGORY(syncServer,"stel.plugin.remoteSync.server")
 using namespace SyncProtocol;
 
 SyncServer::SyncServer(QObject* parent)
-	: QObject(parent), stopping(false), timeoutTimerId(-1)
+	: QObject(parent), stopping(false), frameNumber(0), frameTime(0), frameLead(0), compression(true), timeoutTimerId(-1)
 {
 	qserver = new QTcpServer(this);
 	connect(qserver,SIGNAL(newConnection()), this, SLOT(handleNewConnection()));
@@ -43,6 +44,9 @@ SyncServer::SyncServer(QObject* parent)
 	handlerList[ERROR] =  new ServerErrorHandler();
 	handlerList[CLIENT_CHALLENGE_RESPONSE] = new ServerAuthHandler(this, false);
 	handlerList[ALIVE] = new ServerAliveHandler();
+	handlerList[CLUSTER_JOIN] = new ServerClusterJoinHandler(this);
+	handlerList[CLOCK_SYNC] = new ServerClockSyncHandler();
+	handlerList[BARRIER] = new ServerBarrierHandler(this);
 }
 
 SyncServer::~SyncServer()
@@ -79,6 +83,7 @@ bool SyncServer::start(int port)
 		addSender(new StelPropertyEventSender());
 		addSender(new ViewEventSender());
 		addSender(new FovEventSender());
+		addSender(new FrameEventSender());
 	}
 	else
 		qCCritical(syncServer)<<"Error while starting:"<<qserver->errorString();
@@ -94,7 +99,8 @@ void SyncServer::addSender(SyncServerEventSender *snd)
 void SyncServer::broadcastMessage(const SyncMessage &msg)
 {
 	qCDebug(syncServer)<<"Broadcast message"<<msg;
-	qint64 size = msg.createFullMessage(broadcastBuffer);
+	//the message is serialized (and compressed) once for all clients
+	qint64 size = msg.createFullMessage(broadcastBuffer, compression);
 
 	if(!size)
 	{
@@ -117,6 +123,41 @@ void SyncServer::broadcastMessage(const SyncMessage &msg)
 	}
 }
 
+void SyncServer::broadcastClusterMessage(const SyncMessage &msg)
+{
+	qint64 size = msg.createFullMessage(broadcastBuffer);
+	Q_ASSERT(size);
+
+	for(tClusterClients::iterator it = clusterClients.begin();it!=clusterClients.end();++it)
+	{
+		SyncRemotePeer* client = it.key();
+		client->writeData(broadcastBuffer,size);
+		//the socket would be written only after the frame is drawn otherwise
+		client->flush();
+	}
+}
+
+void SyncServer::addClusterClient(SyncRemotePeer &peer, bool swapBarrier)
+{
+	peer.peerLog()<<"Joined the cluster, swap barrier:"<<swapBarrier;
+	ClusterClient& client = clusterClients[&peer];
+	client.swapBarrier = swapBarrier;
+	client.readyFrame = frameNumber;
+}
+
+void SyncServer::setBarrierReady(SyncRemotePeer &peer, quint64 frame)
+{
+	tClusterClients::iterator it = clusterClients.find(&peer);
+	if(it == clusterClients.end())
+		return;
+	it->readyFrame = qMax(it->readyFrame, frame);
+	if(it->lagging)
+	{
+		peer.peerLog("Back at the swap barrier");
+		it->lagging = false;
+	}
+}
+
 void SyncServer::stop()
 {
 	if(qserver->isListening())
@@ -149,12 +190,68 @@ void SyncServer::stop()
 
 void SyncServer::update()
 {
+	++frameNumber;
+	frameTime = getClockTime();
+
 	foreach(SyncServerEventSender* s, senderList)
 	{
 		s->update();
 	}
 }
 
+void SyncServer::endFrame()
+{
+	frameLead = getClockTime() - frameTime;
+
+	//wait until each client at the barrier has drawn this frame
+	QElapsedTimer timer;
+	timer.start();
+	bool hasBarrierClients = false;
+	for(;;)
+	{
+		SyncRemotePeer* waitFor = Q_NULLPTR;
+		for(tClusterClients::iterator it = clusterClients.begin(); it!=clusterClients.end(); ++it)
+		{
+			if(!it->swapBarrier)
+				continue;
+			hasBarrierClients = true;
+			if(!it->lagging && it->readyFrame < frameNumber)
+			{
+				waitFor = it.key();
+				break;
+			}
+		}
+		if(!waitFor)
+			break;
+
+		//the handlers run while waiting, they may also remove the client
+		const int remaining = SYNC_BARRIER_TIMEOUT - static_cast<int>(timer.elapsed());
+		if(remaining <= 0 || !waitFor->waitForData(remaining))
+		{
+			tClusterClients::iterator it = clusterClients.find(waitFor);
+			if(it != clusterClients.end() && it->readyFrame < frameNumber)
+			{
+				waitFor->peerLog("Missed the swap barrier, not waiting for it until it reports again");
+				it->lagging = true;
+			}
+		}
+	}
+
+	if(hasBarrierClients)
+	{
+		Barrier release;
+		release.frameNumber = frameNumber;
+		for(tClusterClients::iterator it = clusterClients.begin(); it!=clusterClients.end(); ++it)
+		{
+			if(it->swapBarrier)
+			{
+				it.key()->writeMessage(release);
+				it.key()->flush();
+			}
+		}
+	}
+}
+
 void SyncServer::timerEvent(QTimerEvent *evt)
 {
 	if(evt->timerId() == timeoutTimerId)
@@ -197,6 +294,7 @@ void SyncServer::handleNewConnection()
 
 	SyncRemotePeer* newClient = new SyncRemotePeer(newConn,false,handlerList);
 	newClient->peerLog("New client connection");
+	newClient->setCompression(compression);
 	//add to client list
 	clients.append(newClient);
 
@@ -229,6 +327,7 @@ void SyncServer::clientDisconnected(bool clean)
 		qCWarning(syncServer)<<"Client disconnected with error"<<peer->getError();
 	}
 	clients.removeAll(peer);
+	clusterClients.remove(peer);
 	peer->deleteLater();
 	qCDebug(syncServer)<<clients.size()<<"current connections";
 	checkStopState();
@@ -24,6 +24,7 @@
 #include <QObject>
 #include <QAbstractSocket>
 #include <QDateTime>
+#include <QHash>
 #include <QLoggingCategory>
 #include <QUuid>
 
@@ -32,7 +33,9 @@ class SyncServerEventSender;
 
 Q_DECLARE_LOGGING_CATEGORY(syncServer)
 
-//! Implements a server to which SyncClients can connect and receive state changes
+//! Implements a server to which SyncClients can connect and receive state changes.
+//! Clients in cluster mode additionally receive a FRAME message each frame, and may ask the server
+//! to wait for them at the end of each frame (swap barrier), so that all nodes present the same frame.
 class SyncServer : public QObject
 {
 	Q_OBJECT
@@ -41,11 +44,29 @@ public:
 	SyncServer(QObject* parent = Q_NULLPTR);
 	virtual ~SyncServer();
 
+	//! If enabled (the default), large messages are compressed, which saves bandwidth on slow links.
+	//! Applies to the clients which connect afterwards.
+	void setCompression(bool enable) { compression = enable; }
+	bool getCompression() const { return compression; }
+
 	//! This should be called in the StelModule::update function
 	void update();
+	//! This should be called at the end of the drawing. Waits at the swap barrier until the clients
+	//! using it have drawn the frame too (at most SyncProtocol::SYNC_BARRIER_TIMEOUT), and releases them.
+	void endFrame();
 
 	//! Broadcasts this message to all connected and authenticated clients
 	void broadcastMessage(const SyncProtocol::SyncMessage& msg);
+	//! Sends this message to the clients in cluster mode, without delay
+	void broadcastClusterMessage(const SyncProtocol::SyncMessage& msg);
+	bool hasClusterClients() const { return !clusterClients.isEmpty(); }
+
+	//! The number of the current frame, incremented by update()
+	quint64 getFrameNumber() const { return frameNumber; }
+	//! The time of the last update() (see SyncProtocol::getClockTime)
+	qint64 getFrameTime() const { return frameTime; }
+	//! The time from update() to endFrame() in the previous frame [microseconds]
+	qint64 getFrameLead() const { return frameLead; }
 public slots:
 	//! Starts the SyncServer on the specified port. If the server is already running, stops it first.
 	//! Returns true if successful (false usually means port was in use, use getErrorString)
@@ -71,6 +92,8 @@ private:
 	void addSender(SyncServerEventSender* snd);
 	void checkTimeouts();
 	void checkStopState();
+	void addClusterClient(SyncRemotePeer& peer, bool swapBarrier);
+	void setBarrierReady(SyncRemotePeer& peer, quint64 frame);
 	//use composition instead of inheritance, cleaner interfaace this way
 	//for now, we use TCP, but will test multicast UDP later if the basic setup is working
 	QTcpServer* qserver;
@@ -83,9 +106,28 @@ private:
 	typedef QVector<SyncRemotePeer*> tClientList;
 	tClientList clients;
 
+	struct ClusterClient
+	{
+		ClusterClient() : swapBarrier(false), readyFrame(0), lagging(false) {}
+		bool swapBarrier;
+		//! The last frame the client reported as drawn
+		quint64 readyFrame;
+		//! Set when the client missed the barrier, it is not waited for until it reports again
+		bool lagging;
+	};
+	typedef QHash<SyncRemotePeer*, ClusterClient> tClusterClients;
+	tClusterClients clusterClients;
+
+	quint64 frameNumber;
+	qint64 frameTime;
+	qint64 frameLead;
+
+	bool compression;
 	QByteArray broadcastBuffer;
 	int timeoutTimerId;
 	friend class ServerAuthHandler;
+	friend class ServerClusterJoinHandler;
+	friend class ServerBarrierHandler;
 };
 
 #endif
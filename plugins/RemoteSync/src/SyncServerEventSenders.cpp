@@ -27,6 +27,8 @@
 #include "StelObjectMgr.hpp"
 #include "StelPropertyMgr.hpp"
 
+#include <QDateTime>
+
 using namespace SyncProtocol;
 
 SyncServerEventSender::SyncServerEventSender()
@@ -43,6 +45,10 @@ void SyncServerEventSender::broadcastMessage(const SyncMessage &msg)
 
 TimeEventSender::TimeEventSender()
 {
+	lastSent.lastTimeSyncTime = 0;
+	lastSent.jDay = 0.0;
+	lastSent.timeRate = 0.0;
+
 	//this is the only event we need to listen to
 	connect(core,SIGNAL(timeSyncOccurred(double)),this,SLOT(reactToStellariumEvent()));
 }
@@ -56,6 +62,23 @@ Time TimeEventSender::constructMessage()
 	return msg;
 }
 
+void TimeEventSender::update()
+{
+	if(!isDirty)
+		return;
+	isDirty = false;
+
+	//StelCore also resyncs the time when nothing changed (e.g. setting the same time rate),
+	//the clients extrapolate the last time they got to the same one
+	Time msg = constructMessage();
+	const double extrapolatedJD = lastSent.jDay + (msg.lastTimeSyncTime - lastSent.lastTimeSyncTime) / 1000.0 * lastSent.timeRate;
+	if(msg.timeRate == lastSent.timeRate && qAbs(msg.jDay - extrapolatedJD) < 1e-8) //about 1 ms
+		return;
+
+	lastSent = msg;
+	broadcastMessage(msg);
+}
+
 LocationEventSender::LocationEventSender()
 {
 	connect(core,SIGNAL(targetLocationChanged(StelLocation)), this, SLOT(reactToStellariumEvent()));
@@ -110,35 +133,68 @@ Selection SelectionEventSender::constructMessage()
 StelPropertyEventSender::StelPropertyEventSender()
 {
 	propMgr = StelApp::getInstance().getStelPropertyManager();
-	connect(propMgr, SIGNAL(stelPropertyChanged(StelProperty*,QVariant)), this, SLOT(sendStelPropChange(StelProperty*,QVariant)));
+	connect(propMgr, SIGNAL(stelPropertyChanged(StelProperty*,QVariant)), this, SLOT(queueStelPropChange(StelProperty*,QVariant)));
 }
 
-void StelPropertyEventSender::sendStelPropChange(StelProperty* prop, const QVariant &val)
+void StelPropertyEventSender::queueStelPropChange(StelProperty* prop, const QVariant &val)
 {
 	//only send changes that can be applied on clients
 	if(prop->isSynchronizable())
 	{
-		StelPropertyUpdate msg;
-		msg.propId = prop->getId();
-		msg.value = val;
-		broadcastMessage(msg);
+		//e.g. a slider drag changes the same property many times per frame
+		pendingChanges.insert(prop->getId(), val);
 	}
 }
 
+void StelPropertyEventSender::update()
+{
+	if(pendingChanges.isEmpty())
+		return;
+
+	StelPropertyUpdate msg;
+	for(QMap<QString, QVariant>::const_iterator it = pendingChanges.constBegin(); it!=pendingChanges.constEnd(); ++it)
+	{
+		QHash<QString, QVariant>::iterator sent = sentValues.find(it.key());
+		if(sent != sentValues.end() && sent.value() == it.value())
+			continue;
+		sentValues.insert(it.key(), it.value());
+
+		msg.changes.append(qMakePair(it.key(), it.value()));
+		if(msg.changes.size() == maxChangesPerMessage)
+		{
+			broadcastMessage(msg);
+			msg.changes.clear();
+		}
+	}
+	if(!msg.changes.isEmpty())
+		broadcastMessage(msg);
+	pendingChanges.clear();
+}
+
 void StelPropertyEventSender::newClientConnected(SyncRemotePeer &client)
 {
+	//the new client gets the current values, which may differ from the ones sent to the others
+	//until the pending changes are sent, so these have to be sent in any case
+	for(QMap<QString, QVariant>::const_iterator it = pendingChanges.constBegin(); it!=pendingChanges.constEnd(); ++it)
+		sentValues.remove(it.key());
+
 	//send all current StelProperty values to the client
+	StelPropertyUpdate msg;
 	QList<StelProperty*> propList = propMgr->getAllProperties();
 	foreach(StelProperty* prop, propList)
 	{
 		if(!prop->isSynchronizable())
 			continue;
 
-		StelPropertyUpdate msg;
-		msg.propId = prop->getId();
-		msg.value = prop->getValue();
-		client.writeMessage(msg);
+		msg.changes.append(qMakePair(prop->getId(), prop->getValue()));
+		if(msg.changes.size() == maxChangesPerMessage)
+		{
+			client.writeMessage(msg);
+			msg.changes.clear();
+		}
 	}
+	if(!msg.changes.isEmpty())
+		client.writeMessage(msg);
 }
 
 ViewEventSender::ViewEventSender()
@@ -163,7 +219,10 @@ void ViewEventSender::update()
 
 	Vec3d viewDir = mvMgr->getViewDirectionJ2000();
 	viewDir = core->j2000ToAltAz(viewDir, StelCore::RefractionOff);
-	if(!(qFuzzyCompare(viewDir[0], lastView[0]) && qFuzzyCompare(viewDir[1], lastView[1]) && qFuzzyCompare(viewDir[2], lastView[2])))
+	//changes below a small fraction of a pixel are not sent. They are not lost,
+	//as the difference to the last sent view is sent as soon as it gets larger.
+	const double minAngle = mvMgr->getCurrentFov() * M_PI / 180.0 * 1e-5;
+	if((viewDir - lastView).length() > minAngle)
 	{
 		lastView = viewDir;
 		broadcastMessage(constructMessage());
@@ -187,9 +246,44 @@ SyncProtocol::Fov FovEventSender::constructMessage()
 void FovEventSender::update()
 {
 	double curFov = mvMgr->getCurrentFov();
-	if(curFov!=lastFov)
+	//same as for the view, very small changes are only sent with the next larger one
+	if(qAbs(curFov - lastFov) > lastFov * 1e-5)
 	{
 		lastFov = curFov;
 		broadcastMessage(constructMessage());
 	}
 }
+
+FrameEventSender::FrameEventSender()
+	: lastJdAnchor(0.0), lastJdAnchorMSecs(0), jdAnchorTime(0)
+{
+	mvMgr = core->getMovementMgr();
+}
+
+void FrameEventSender::update()
+{
+	if(!server->hasClusterClients())
+		return;
+
+	//StelCore keeps the time anchor in wall clock milliseconds, convert it once when it changes
+	const double jdAnchor = core->getJDOfLastJDUpdate();
+	const qint64 jdAnchorMSecs = core->getMilliSecondsOfLastJDUpdate();
+	if(jdAnchor != lastJdAnchor || jdAnchorMSecs != lastJdAnchorMSecs)
+	{
+		lastJdAnchor = jdAnchor;
+		lastJdAnchorMSecs = jdAnchorMSecs;
+		jdAnchorTime = getClockTime() - (QDateTime::currentMSecsSinceEpoch() - jdAnchorMSecs) * 1000;
+	}
+
+	Frame msg;
+	msg.frameNumber = server->getFrameNumber();
+	msg.frameTime = server->getFrameTime();
+	msg.frameLead = server->getFrameLead();
+	msg.jdAnchor = jdAnchor;
+	msg.jdAnchorTime = jdAnchorTime;
+	msg.timeRate = core->getTimeRate();
+	//unlike the VIEW messages, this is also sent when tracking, as the clients must not lag behind
+	msg.viewAltAz = core->j2000ToAltAz(mvMgr->getViewDirectionJ2000(), StelCore::RefractionOff);
+	msg.fov = mvMgr->getCurrentFov();
+	server->broadcastClusterMessage(msg);
+}
@@ -23,6 +23,9 @@
 #include "SyncProtocol.hpp"
 #include "SyncMessages.hpp"
 
+#include <QHash>
+#include <QMap>
+
 class SyncServer;
 class StelCore;
 class StelObjectMgr;
@@ -59,8 +62,9 @@ protected:
 	bool isDirty;
 	//! Direct access to StelCore
 	StelCore* core;
-private:
+	//! The server this sender belongs to, set by SyncServer
 	SyncServer* server;
+private:
 	friend class SyncServer;
 };
 
@@ -106,6 +110,11 @@ public:
 	TimeEventSender();
 protected:
 	SyncProtocol::Time constructMessage() Q_DECL_OVERRIDE;
+
+	//! Only broadcasts the time if it differs from the extrapolation of the last sent one
+	void update() Q_DECL_OVERRIDE;
+private:
+	SyncProtocol::Time lastSent;
 };
 
 class LocationEventSender : public TypedSyncServerEventSender<SyncProtocol::Location>
@@ -130,17 +139,28 @@ private:
 
 class StelProperty;
 class StelPropertyMgr;
+//! Collects the StelProperty changes during a frame, and broadcasts them together in update().
+//! Only the last value of each property is sent, and only if it differs from the value sent before.
 class StelPropertyEventSender : public SyncServerEventSender
 {
 	Q_OBJECT
 public:
 	StelPropertyEventSender();
+protected:
+	void update() Q_DECL_OVERRIDE;
 protected slots:
 	//! Sends all current StelProperties to the client
 	virtual void newClientConnected(SyncRemotePeer& client) Q_DECL_OVERRIDE;
-	void sendStelPropChange(StelProperty* prop, const QVariant& val);
+	void queueStelPropChange(StelProperty* prop, const QVariant& val);
 private:
+	//! Maximal number of properties in one message, to stay below SyncProtocol::SYNC_MAX_PAYLOAD_SIZE
+	static const int maxChangesPerMessage = 64;
+
 	StelPropertyMgr* propMgr;
+	//! The changes of the current frame
+	QMap<QString, QVariant> pendingChanges;
+	//! The values the clients have, changes back to them are not sent again
+	QHash<QString, QVariant> sentValues;
 };
 
 class StelMovementMgr;
@@ -172,4 +192,20 @@ private:
 	double lastFov;
 };
 
+//! Sends the time and view of each frame to the cluster clients
+class FrameEventSender : public SyncServerEventSender
+{
+	Q_OBJECT
+public:
+	FrameEventSender();
+protected:
+	void update() Q_DECL_OVERRIDE;
+private:
+	StelMovementMgr* mvMgr;
+	//the time anchor of StelCore, and its conversion to SyncProtocol::getClockTime
+	double lastJdAnchor;
+	qint64 lastJdAnchorMSecs;
+	qint64 jdAnchorTime;
+};
+
 #endif
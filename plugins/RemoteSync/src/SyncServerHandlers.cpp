@@ -105,3 +105,51 @@ bool ServerAliveHandler::handleMessage(QDataStream &stream, SyncProtocol::tPaylo
 	Alive p;
 	return p.deserialize(stream,dataSize);
 }
+
+ServerClusterJoinHandler::ServerClusterJoinHandler(SyncServer *server)
+	: ServerHandler(server)
+{
+
+}
+
+bool ServerClusterJoinHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	ClusterJoin msg;
+	if(!msg.deserialize(stream, dataSize))
+		return false;
+
+	server->addClusterClient(peer, msg.swapBarrier);
+	return true;
+}
+
+bool ServerClockSyncHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	const qint64 receiveTime = getClockTime();
+
+	ClockSync msg;
+	if(!msg.deserialize(stream, dataSize))
+		return false;
+
+	//send the request back with the server times
+	msg.serverReceiveTime = receiveTime;
+	msg.serverSendTime = getClockTime();
+	peer.writeMessage(msg);
+	peer.flush();
+	return true;
+}
+
+ServerBarrierHandler::ServerBarrierHandler(SyncServer *server)
+	: ServerHandler(server)
+{
+
+}
+
+bool ServerBarrierHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	Barrier msg;
+	if(!msg.deserialize(stream, dataSize))
+		return false;
+
+	server->setBarrierReady(peer, msg.frameNumber);
+	return true;
+}
@@ -58,4 +58,29 @@ public:
 	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
 };
 
+//! Adds the client to the cluster clients of the server
+class ServerClusterJoinHandler : public ServerHandler
+{
+	Q_OBJECT
+public:
+	ServerClusterJoinHandler(SyncServer* server);
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
+//! Answers the clock offset estimation requests at once
+class ServerClockSyncHandler : public SyncMessageHandler
+{
+public:
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
+//! Notes the frames the clients have drawn, for the swap barrier
+class ServerBarrierHandler : public ServerHandler
+{
+	Q_OBJECT
+public:
+	ServerBarrierHandler(SyncServer* server);
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
 #endif
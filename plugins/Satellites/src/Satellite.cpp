@@ -21,6 +21,7 @@
 
 
 #include "Satellite.hpp"
+#include "SatellitePredictor.hpp"
 #include "StelObject.hpp"
 #include "StelPainter.hpp"
 #include "StelApp.hpp"
@@ -38,8 +39,6 @@
 #include <QSettings>
 #include <QByteArray>
 
-#include <QVector3D>
-#include <QMatrix4x4>
 
 #include "gsatellite/gTime.hpp"
 #include "gsatellite/stdsat.h"
@@ -530,154 +529,20 @@ float Satellite::getVMagnitude(const StelCore* core) const
 				fracil = 0.000001;
 			if (pSatWrapper && name.startsWith("IRIDIUM"))
 			{
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText = "";
-#endif
-				Vec3d Sun3d = pSatWrapper->getSunECIPos();
-				QVector3D sun(Sun3d.data()[0],Sun3d.data()[1],Sun3d.data()[2]);
-				QVector3D sunN = sun; sunN.normalize();
-
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Sun3d = " + QString("[%1 %2 %3]")
-						.arg(sunN.x())
-						.arg(sunN.y())
-						.arg(sunN.z())
-						+ "<br>\n";
-#endif
-				//static double sin1 = sin(40*M_PI/180);
-				//static double cos1 = cos(40*M_PI/180);
-				//static double sin2 = sin(120*M_PI/180);
-				//static double cos2 = cos(120*M_PI/180);
-				// position, velocity are known
-				QVector3D Vx(velocity.data()[0],velocity.data()[1],velocity.data()[2]); Vx.normalize();
-
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Vx = " + QString("[%1 %2 %3]")
-						.arg(Vx.x())
-						.arg(Vx.y())
-						.arg(Vx.z())
-						+ "<br>\n";
-#endif
-				//QVector3D SatPos(position.data()[0],position.data()[1],position.data()[2]);
-				Vec3d vy = (position^velocity);
-				QVector3D Vy(vy.data()[0],vy.data()[1],vy.data()[2]); Vy.normalize();
-
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Vy = " + QString("[%1 %2 %3]")
-						.arg(Vy.x())
-						.arg(Vy.y())
-						.arg(Vy.z())
-						+ "<br>\n";
-#endif
-				QVector3D Vz = QVector3D::crossProduct(Vx,Vy); Vz.normalize();
-
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Vz = " + QString("[%1 %2 %3]")
-						.arg(Vz.x())
-						.arg(Vz.y())
-						.arg(Vz.z())
-						+ "<br>\n";
-#endif
-
-				// move this to constructor for optimizing
-				QMatrix4x4 m0;
-				m0.rotate(40, Vy);
-				QVector3D Vx0 = m0.mapVector(Vx);
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "mirror0 = " + QString("[%1 %2 %3]")
-						.arg(Vx0.x())
-						.arg(Vx0.y())
-						.arg(Vx0.z())
-						+ "<br>\n";
-#endif
-
-				QMatrix4x4 m[3];
-				//m[2] = m[1] = m[0];
-				m[0].rotate(0, Vz);
-				m[1].rotate(120, Vz);
-				m[2].rotate(-120, Vz);
-
 				StelLocation loc   = StelApp::getInstance().getCore()->getCurrentLocation();
 				const double  radLatitude    = loc.latitude * KDEG2RAD;
 				const double  theta          = pSatWrapper->getEpoch().toThetaLMST(loc.longitude * KDEG2RAD);
-				const double sinRadLatitude=sin(radLatitude);
-				const double cosRadLatitude=cos(radLatitude);
-				const double sinTheta=sin(theta);
-				const double cosTheta=cos(theta);
 
 				Vec3d observerECIPos;
 				Vec3d observerECIVel;
 				pSatWrapper->calcObserverECIPosition(observerECIPos, observerECIVel);
+				sunReflAngle = SatellitePredictor::computeSunReflectionAngle(position, velocity, pSatWrapper->getSunECIPos(),
+											     observerECIPos, elAzPosition, radLatitude, theta);
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "ObsPos = " + observerECIPos.toString() + " (" + observerECIPos.toStringLonLat() + ")<br>\n";
-				myText += "ObsVel = " + observerECIVel.toString() + " (" + observerECIVel.toStringLonLat() + ")<br>\n";
+				myText = "ObsPos = " + observerECIPos.toString() + " (" + observerECIPos.toStringLonLat() + ")<br>\n";
+				myText += QString("Angle = %1").arg(QString::number(sunReflAngle, 'f', 1)) + "<br>";
 #endif
-				sunReflAngle = 180.;
-				QVector3D mirror;
-				for (int i = 0; i<3; i++)
-				{
-					mirror = m[i].mapVector(Vx0);
-					mirror.normalize();
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += "mirror = " + QString("[%1 %2 %3]")
-							.arg(mirror.x())
-							.arg(mirror.y())
-							.arg(mirror.z())
-							+ "<br>\n";
-#endif
-					// reflection R = 2*(V dot N)*N - V
-					QVector3D rsun =  2*QVector3D::dotProduct(sun,mirror)*mirror - sun;
-					rsun = -rsun;
-					Vec3d rSun(rsun.x(),rsun.y(),rsun.z());
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += "rSun = " + rSun.toString() + "<br>\n";
-#endif
-
-					//Vec3d satECIPos  = getTEMEPos();
-					Vec3d slantRange = rSun - observerECIPos;
-					Vec3d topoRSunPos;
-					//top_s
-					topoRSunPos[0] = (sinRadLatitude * cosTheta * slantRange[0]
-							+ sinRadLatitude * sinTheta * slantRange[1]
-							- cosRadLatitude * slantRange[2]);
-					//top_e
-					topoRSunPos[1] = ((-1.0) * sinTheta * slantRange[0]
-							+ cosTheta * slantRange[1]);
-
-					//top_z
-					topoRSunPos[2] = (cosRadLatitude * cosTheta * slantRange[0]
-							+ cosRadLatitude * sinTheta * slantRange[1]
-							+ sinRadLatitude * slantRange[2]);
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += "SunRefl = " + topoRSunPos.toString() + " (" + topoRSunPos.toStringLonLat() + ")<br>\n";
-#endif
-					sunReflAngle = qMin(elAzPosition.angle(topoRSunPos) * KRAD2DEG, sunReflAngle) ;
-#ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += QString("Angle = %1").arg(QString::number(sunReflAngle, 'f', 1)) + "<br>";
-#endif
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-
-				}
-
-				// very simple flare model
-				double iridiumFlare = 100;
-				if (sunReflAngle<0.5)
-				{
-					iridiumFlare = -8.92 + sunReflAngle*6;
-				}
-				else
-				if (sunReflAngle<0.7)
-				{
-					iridiumFlare = -5.92 + (sunReflAngle-0.5)*10;
-				}
-					else
-				{
-					iridiumFlare = -3.92 + (sunReflAngle-0.7)*5;
-				}
-
-
-				 vmag = qMin(stdMag, iridiumFlare);
+				vmag = qMin(stdMag, (float)SatellitePredictor::computeIridiumFlareMagnitude(sunReflAngle));
 			}
 			else // not Iridium
 			{
@@ -770,19 +635,8 @@ void Satellite::update(double)
 		velocity                 = pSatWrapper->getTEMEVel();
 		latLongSubPointPosition  = pSatWrapper->getSubPoint();
 		height                   = latLongSubPointPosition[2]; // km
-		if (height <= 150.0)
-		{
-			// The orbit is no longer valid.  Causes include very out of date
-			// TLE, system date and time out of a reasonable range, and orbital
-			// degradation and re-entry of a satellite.  In any of these cases
-			// we might end up with a problem - usually a crash of Stellarium
-			// because of a div/0 or something.  To prevent this, we turn off
-			// the satellite when the computed height is 150km. (We can assume bogus at 250km or so...)
-			qWarning() << "Satellite has invalid orbit:" << name << id;
-			orbitValid = false;
-			displayed = false; // It shouldn't be displayed!
+		if (!checkOrbitValidity())
 			return;
-		}
 
 		elAzPosition = pSatWrapper->getAltAz();
 		elAzPosition.normalize();
@@ -796,6 +650,49 @@ void Satellite::update(double)
 	}
 }
 
+void Satellite::update(const SatellitePropagator::State& state)
+{
+	if (!pSatWrapper || !orbitValid)
+		return;
+
+	epochTime = StelApp::getInstance().getCore()->getJD();
+	position                 = state.position;
+	velocity                 = state.velocity;
+	latLongSubPointPosition  = state.subPoint;
+	height                   = latLongSubPointPosition[2]; // km
+	if (!checkOrbitValidity())
+		return;
+
+	elAzPosition = state.altAz;
+	elAzPosition.normalize();
+
+	range      = state.range;
+	rangeRate  = state.rangeRate;
+	visibility = state.visibility;
+	phaseAngle = state.phaseAngle;
+
+	// Compute orbit points to draw orbit line.
+	if (orbitDisplayed) computeOrbitPoints();
+}
+
+bool Satellite::checkOrbitValidity()
+{
+	if (height <= 150.0)
+	{
+		// The orbit is no longer valid.  Causes include very out of date
+		// TLE, system date and time out of a reasonable range, and orbital
+		// degradation and re-entry of a satellite.  In any of these cases
+		// we might end up with a problem - usually a crash of Stellarium
+		// because of a div/0 or something.  To prevent this, we turn off
+		// the satellite when the computed height is 150km. (We can assume bogus at 250km or so...)
+		qWarning() << "Satellite has invalid orbit:" << name << id;
+		orbitValid = false;
+		displayed = false; // It shouldn't be displayed!
+		return false;
+	}
+	return true;
+}
+
 double Satellite::getDoppler(double freq) const
 {
 	double result;
@@ -973,7 +870,9 @@ void Satellite::drawOrbit(StelCore *core, StelPainter& painter)
 			colorArray.append(Vec4f(drawColor[0], drawColor[1], drawColor[2], hintBrightness * calculateOrbitSegmentIntensity(i)));
 		}
 	}
+	painter.setLineSmooth(true);
 	painter.drawPath(vertexArray, colorArray); // (does client state switching as needed internally)
+	painter.setLineSmooth(false);
 }
 
 
@@ -32,6 +32,7 @@
 #include "StelTextureTypes.hpp"
 #include "StelSphereGeometry.hpp"
 #include "gSatWrapper.hpp"
+#include "SatellitePropagator.hpp"
 
 
 class StelPainter;
@@ -180,6 +181,9 @@ public:
 
 	// calculate faders, new position
 	void update(double deltaTime);
+	//! Take over the position computed by the batch propagator of the
+	//! Satellites module for the current date.
+	void update(const SatellitePropagator::State& state);
 
 	double getDoppler(double freq) const;
 	static bool showLabels;
@@ -213,6 +217,9 @@ public:
 private:
 	//draw orbits methods
 	void computeOrbitPoints();
+	//! Check the height of the last computed position. Disables the
+	//! satellite and returns false if the orbit is no longer valid.
+	bool checkOrbitValidity();
 	void drawOrbit(StelCore* core, StelPainter& painter);
 	//! returns 0 - 1.0 for the DRAWORBIT_FADE_NUMBER segments at
 	//! each end of an orbit, with 1 in the middle.
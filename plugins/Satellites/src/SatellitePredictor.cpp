@@ -0,0 +1,386 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SatellitePredictor.hpp"
+#include "SatellitePropagator.hpp"
+#include "gsatellite/gTime.hpp"
+#include "gsatellite/stdsat.h"
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QtConcurrent>
+
+#include <cmath>
+
+const float SatellitePredictor::flareMagnitudeLimit = 1.f;
+const double SatellitePredictor::flareAltitudeLimit = 5.;
+
+namespace
+{
+	const double second = 1./86400.;
+	// Precision of the event times.
+	const double crossingPrecision = 0.1*second;
+	const double extremumPrecision = 0.5*second;
+	// Grid used to look for flares during a pass.
+	const double flareStep = 2.*second;
+	// Largest reflection angle [degrees] considered as a flare candidate.
+	const double flareAngleLimit = 2.;
+	// 1/golden ratio
+	const double invPhi = 0.6180339887498949;
+}
+
+QFuture<SatellitePredictor::Result> SatellitePredictor::predict(const QList<Target>& targets, const Location& location,
+								 double startJD, double endJD, bool passes, bool flares)
+{
+	QList<Request> requests;
+	foreach (const Target& target, targets)
+	{
+		Request request;
+		request.target = target;
+		request.location = location;
+		request.startJD = startJD;
+		request.endJD = endJD;
+		request.passes = passes;
+		request.flares = flares && target.iridium;
+		requests.append(request);
+	}
+	return QtConcurrent::mapped(requests, &SatellitePredictor::predictTarget);
+}
+
+SatellitePredictor::Result SatellitePredictor::predictTarget(const Request& request)
+{
+	Context context;
+	context.elements = request.target.elements;
+	context.location = request.location;
+	context.radLatitude = request.location.latitude * KDEG2RAD;
+
+	Result result;
+	if (request.passes || request.flares)
+		findPasses(context, request, result);
+	if (!request.passes)
+		result.passes.clear();
+	return result;
+}
+
+SatellitePredictor::Sample SatellitePredictor::evaluate(Context& context, double jd)
+{
+	Sample s;
+	s.jd = jd;
+	double r[3] = {};
+	double v[3] = {};
+	sgp4(wgs72, context.elements, (jd - context.elements.jdsatepoch) * KMIN_PER_DAY, r, v);
+	s.valid = context.elements.error == 0;
+	s.position.set(r[0], r[1], r[2]);
+	s.velocity.set(v[0], v[1], v[2]);
+
+	Vec3d observerECIPos, observerECIVel;
+	SatellitePropagator::computeObserverECIPosition(jd, context.location.latitude, context.location.longitude,
+							context.location.altitude, observerECIPos, observerECIVel);
+	const double theta = gTime(jd).toThetaLMST(context.location.longitude * KDEG2RAD);
+	const double sinLat = std::sin(context.radLatitude);
+	const double cosLat = std::cos(context.radLatitude);
+	const double sinTheta = std::sin(theta);
+	const double cosTheta = std::cos(theta);
+	const Vec3d slantRange = s.position - observerECIPos;
+
+	// see gSatWrapper::getAltAz()
+	s.altAz.set(sinLat*cosTheta*slantRange[0] + sinLat*sinTheta*slantRange[1] - cosLat*slantRange[2],
+		    -sinTheta*slantRange[0] + cosTheta*slantRange[1],
+		    cosLat*cosTheta*slantRange[0] + cosLat*sinTheta*slantRange[1] + sinLat*slantRange[2]);
+	s.sinAltitude = s.altAz[2]/s.altAz.length();
+	s.azimuth = std::atan2(s.altAz[1], -s.altAz[0]);
+	if (s.azimuth < 0.)
+		s.azimuth += 2.*M_PI;
+	return s;
+}
+
+Vec3d SatellitePredictor::computeSunECIPosition(double jd)
+{
+	// Astronomical Almanac, low precision formulae for the Sun (1950-2050, 0.01 degrees)
+	const double n = jd - 2451545.0;
+	const double L = (280.460 + 0.9856474*n) * KDEG2RAD;
+	const double g = (357.528 + 0.9856003*n) * KDEG2RAD;
+	const double lambda = L + (1.915*std::sin(g) + 0.020*std::sin(2.*g)) * KDEG2RAD;
+	const double epsilon = (23.439 - 0.0000004*n) * KDEG2RAD;
+	const double R = (1.00014 - 0.01671*std::cos(g) - 0.00014*std::cos(2.*g)) * KAU;
+	return Vec3d(R*std::cos(lambda), R*std::cos(epsilon)*std::sin(lambda), R*std::sin(epsilon)*std::sin(lambda));
+}
+
+bool SatellitePredictor::isSunlit(const Vec3d& position, const Vec3d& sunECIPos)
+{
+	// Outside of the cylindrical shadow of the Earth.
+	Vec3d sunDir = sunECIPos;
+	sunDir.normalize();
+	const double along = position.dot(sunDir);
+	return along > 0. || (position - sunDir*along).length() > KEARTHRADIUS;
+}
+
+bool SatellitePredictor::isDark(const Context& context, double jd, Vec3d* sunECIPos, Vec3d* observerECIPos)
+{
+	Vec3d observerECIVel;
+	*sunECIPos = computeSunECIPosition(jd);
+	SatellitePropagator::computeObserverECIPosition(jd, context.location.latitude, context.location.longitude,
+							context.location.altitude, *observerECIPos, observerECIVel);
+	const double theta = gTime(jd).toThetaLMST(context.location.longitude * KDEG2RAD);
+	const Vec3d zenith(std::cos(context.radLatitude)*std::cos(theta), std::cos(context.radLatitude)*std::sin(theta),
+			   std::sin(context.radLatitude));
+	return (*sunECIPos - *observerECIPos).dot(zenith) < 0.;
+}
+
+double SatellitePredictor::reflectionAngle(Context& context, double jd)
+{
+	const Sample s = evaluate(context, jd);
+	Vec3d sunECIPos, observerECIPos, observerECIVel;
+	sunECIPos = computeSunECIPosition(jd);
+	SatellitePropagator::computeObserverECIPosition(jd, context.location.latitude, context.location.longitude,
+							context.location.altitude, observerECIPos, observerECIVel);
+	Vec3d altAz = s.altAz;
+	altAz.normalize();
+	const double theta = gTime(jd).toThetaLMST(context.location.longitude * KDEG2RAD);
+	return computeSunReflectionAngle(s.position, s.velocity, sunECIPos, observerECIPos, altAz, context.radLatitude, theta);
+}
+
+float SatellitePredictor::magnitude(Context& context, const Target& target, double jd)
+{
+	const Sample s = evaluate(context, jd);
+	Vec3d sunECIPos, observerECIPos;
+	if (!s.valid || s.sinAltitude <= 0. || !isDark(context, jd, &sunECIPos, &observerECIPos) || !isSunlit(s.position, sunECIPos))
+		return 99.f;
+
+	// see Satellite::getVMagnitude()
+	double fracil = (1. + std::cos(sunECIPos.angle(s.position)))*0.5;
+	if (fracil == 0.)
+		fracil = 0.000001;
+	double vmag = target.stdMag;
+	if (target.iridium)
+	{
+		Vec3d altAz = s.altAz;
+		altAz.normalize();
+		const double theta = gTime(jd).toThetaLMST(context.location.longitude * KDEG2RAD);
+		const double angle = computeSunReflectionAngle(s.position, s.velocity, sunECIPos, observerECIPos, altAz, context.radLatitude, theta);
+		vmag = qMin(vmag, computeIridiumFlareMagnitude(angle));
+	}
+	const double range = s.altAz.length();
+	return vmag - 15.75 + 2.5 * std::log10(range * range / fracil);
+}
+
+double SatellitePredictor::findHorizonCrossing(Context& context, double jd1, double jd2)
+{
+	const bool rising = evaluate(context, jd1).sinAltitude <= 0.;
+	while (jd2 - jd1 > crossingPrecision)
+	{
+		const double mid = 0.5*(jd1 + jd2);
+		if ((evaluate(context, mid).sinAltitude > 0.) == rising)
+			jd2 = mid;
+		else
+			jd1 = mid;
+	}
+	return 0.5*(jd1 + jd2);
+}
+
+void SatellitePredictor::findPasses(Context& context, const Request& request, Result& result)
+{
+	// About 100 samples per revolution, but not more than one per 10 s.
+	// Passes shorter than the step may be missed.
+	const double periodDays = 2.*M_PI/context.elements.no/KMIN_PER_DAY;
+	const double step = qBound(10.*second, periodDays/100., 120.*second);
+
+	Sample previous = evaluate(context, request.startJD);
+	if (!previous.valid)
+		return;
+	bool haveRise = false;
+	Pass pass;
+	pass.id = request.target.id;
+	pass.satellite = request.target.name;
+
+	// A pass in progress at endJD is followed until it ends, but not
+	// for ever (geostationary satellites never set).
+	for (double jd = request.startJD + step; jd <= request.endJD + 1.; jd += step)
+	{
+		const Sample current = evaluate(context, jd);
+		if (!current.valid)
+			break; // decayed
+		if (previous.sinAltitude <= 0. && current.sinAltitude > 0.)
+		{
+			pass.riseJD = findHorizonCrossing(context, previous.jd, current.jd);
+			pass.riseAzimuth = evaluate(context, pass.riseJD).azimuth;
+			haveRise = true;
+		}
+		else if (previous.sinAltitude > 0. && current.sinAltitude <= 0. && haveRise)
+		{
+			pass.setJD = findHorizonCrossing(context, previous.jd, current.jd);
+			pass.setAzimuth = evaluate(context, pass.setJD).azimuth;
+
+			// golden section search for the highest point
+			double a = pass.riseJD, b = pass.setJD;
+			double c = b - (b-a)*invPhi, d = a + (b-a)*invPhi;
+			double fc = evaluate(context, c).sinAltitude, fd = evaluate(context, d).sinAltitude;
+			while (b - a > extremumPrecision)
+			{
+				if (fc > fd)
+				{
+					b = d; d = c; fd = fc;
+					c = b - (b-a)*invPhi;
+					fc = evaluate(context, c).sinAltitude;
+				}
+				else
+				{
+					a = c; c = d; fc = fd;
+					d = a + (b-a)*invPhi;
+					fd = evaluate(context, d).sinAltitude;
+				}
+			}
+			pass.culminationJD = 0.5*(a + b);
+			const Sample top = evaluate(context, pass.culminationJD);
+			pass.culminationAltitude = std::asin(top.sinAltitude);
+			pass.culminationAzimuth = top.azimuth;
+			Vec3d sunECIPos, observerECIPos;
+			pass.visible = isDark(context, pass.culminationJD, &sunECIPos, &observerECIPos) && isSunlit(top.position, sunECIPos);
+
+			if (pass.riseJD <= request.endJD)
+			{
+				result.passes.append(pass);
+				if (request.flares)
+					findFlares(context, request, pass, result);
+			}
+			haveRise = false;
+		}
+		previous = current;
+		if (jd > request.endJD && !haveRise)
+			break;
+	}
+}
+
+void SatellitePredictor::findFlares(Context& context, const Request& request, const Pass& pass, Result& result)
+{
+	const double start = qMax(pass.riseJD, request.startJD);
+	const double end = qMin(pass.setJD, request.endJD);
+	double g0 = 180., g1 = 180.;
+	for (double jd = start; jd <= end; jd += flareStep)
+	{
+		const double g2 = reflectionAngle(context, jd);
+		// a local minimum of the reflection angle on the grid at jd-flareStep
+		if (g1 < flareAngleLimit && g1 <= g0 && g1 < g2)
+		{
+			double a = jd - 2.*flareStep, b = jd;
+			double c = b - (b-a)*invPhi, d = a + (b-a)*invPhi;
+			double fc = reflectionAngle(context, c), fd = reflectionAngle(context, d);
+			while (b - a > extremumPrecision/10.)
+			{
+				if (fc < fd)
+				{
+					b = d; d = c; fd = fc;
+					c = b - (b-a)*invPhi;
+					fc = reflectionAngle(context, c);
+				}
+				else
+				{
+					a = c; c = d; fc = fd;
+					d = a + (b-a)*invPhi;
+					fd = reflectionAngle(context, d);
+				}
+			}
+			const double peakJD = 0.5*(a + b);
+			const float mag = magnitude(context, request.target, peakJD);
+			const Sample peak = evaluate(context, peakJD);
+			const double altitude = std::asin(peak.sinAltitude);
+			if (mag < flareMagnitudeLimit && altitude > flareAltitudeLimit*M_PI/180.)
+			{
+				Flare flare;
+				flare.id = request.target.id;
+				flare.satellite = request.target.name;
+				flare.jd = peakJD;
+				flare.altitude = altitude;
+				flare.azimuth = peak.azimuth;
+				flare.magnitude = mag;
+				result.flares.append(flare);
+			}
+		}
+		g0 = g1;
+		g1 = g2;
+	}
+}
+
+double SatellitePredictor::computeIridiumFlareMagnitude(double sunReflAngle)
+{
+	// very simple flare model
+	if (sunReflAngle<0.5)
+		return -8.92 + sunReflAngle*6;
+	else if (sunReflAngle<0.7)
+		return -5.92 + (sunReflAngle-0.5)*10;
+	else
+		return -3.92 + (sunReflAngle-0.7)*5;
+}
+
+double SatellitePredictor::computeSunReflectionAngle(const Vec3d& position, const Vec3d& velocity,
+						     const Vec3d& sunECIPos, const Vec3d& observerECIPos,
+						     const Vec3d& altAz, double latitude, double thetaLMST)
+{
+	QVector3D sun(sunECIPos[0], sunECIPos[1], sunECIPos[2]);
+
+	// position, velocity are known
+	QVector3D Vx(velocity[0], velocity[1], velocity[2]); Vx.normalize();
+	Vec3d vy = (position^velocity);
+	QVector3D Vy(vy[0], vy[1], vy[2]); Vy.normalize();
+	QVector3D Vz = QVector3D::crossProduct(Vx,Vy); Vz.normalize();
+
+	QMatrix4x4 m0;
+	m0.rotate(40, Vy);
+	QVector3D Vx0 = m0.mapVector(Vx);
+
+	// the three main mission antennas
+	QMatrix4x4 m[3];
+	m[0].rotate(0, Vz);
+	m[1].rotate(120, Vz);
+	m[2].rotate(-120, Vz);
+
+	const double sinRadLatitude=std::sin(latitude);
+	const double cosRadLatitude=std::cos(latitude);
+	const double sinTheta=std::sin(thetaLMST);
+	const double cosTheta=std::cos(thetaLMST);
+
+	double sunReflAngle = 180.;
+	for (int i = 0; i<3; i++)
+	{
+		QVector3D mirror = m[i].mapVector(Vx0);
+		mirror.normalize();
+
+		// reflection R = 2*(V dot N)*N - V
+		QVector3D rsun =  2*QVector3D::dotProduct(sun,mirror)*mirror - sun;
+		rsun = -rsun;
+		Vec3d rSun(rsun.x(),rsun.y(),rsun.z());
+
+		Vec3d slantRange = rSun - observerECIPos;
+		Vec3d topoRSunPos;
+		//top_s
+		topoRSunPos[0] = (sinRadLatitude * cosTheta * slantRange[0]
+				+ sinRadLatitude * sinTheta * slantRange[1]
+				- cosRadLatitude * slantRange[2]);
+		//top_e
+		topoRSunPos[1] = ((-1.0) * sinTheta * slantRange[0]
+				+ cosTheta * slantRange[1]);
+
+		//top_z
+		topoRSunPos[2] = (cosRadLatitude * cosTheta * slantRange[0]
+				+ cosRadLatitude * sinTheta * slantRange[1]
+				+ sinRadLatitude * slantRange[2]);
+
+		sunReflAngle = qMin(altAz.angle(topoRSunPos) * KRAD2DEG, sunReflAngle);
+	}
+	return sunReflAngle;
+}
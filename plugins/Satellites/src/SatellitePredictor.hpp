@@ -0,0 +1,175 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _SATELLITEPREDICTOR_HPP_
+#define _SATELLITEPREDICTOR_HPP_
+
+#include "VecMath.hpp"
+#include "gsatellite/sgp4unit.h"
+
+#include <QFuture>
+#include <QList>
+#include <QString>
+
+//! @class SatellitePredictor
+//! Prediction of satellite passes and Iridium flares.
+//! The predictor has its own time and observer and propagates its own
+//! copies of the element sets, so it neither touches StelCore nor the
+//! Satellite objects and can run in worker threads while the program
+//! goes on. The Sun position comes from a low-precision formula
+//! (about 0.01 degrees), which is more than enough to decide about
+//! daylight and illumination.
+//!
+//! Events are found on a coarse grid first and refined by root finding:
+//! rise and set by bisection on the altitude, culminations and flare peaks
+//! by golden section search on the altitude and on the angle between the
+//! reflected sunlight and the line of sight.
+//! Altitudes are geometric, i.e. without refraction.
+//! @ingroup satellites
+class SatellitePredictor
+{
+public:
+	struct Location
+	{
+		double latitude;    //!< [degrees]
+		double longitude;   //!< [degrees]
+		double altitude;    //!< [m]
+	};
+
+	//! A satellite to predict.
+	struct Target
+	{
+		QString id;
+		QString name;
+		elsetrec elements;
+		float stdMag;       //!< standard magnitude, 99 if unknown
+		bool iridium;       //!< look for flares of the main mission antennas
+	};
+
+	//! A pass over the horizon. All dates are UTC Julian Days,
+	//! angles are in radians, azimuths counted from north over east.
+	struct Pass
+	{
+		QString id;
+		QString satellite;
+		double riseJD;
+		double riseAzimuth;
+		double culminationJD;
+		double culminationAltitude;
+		double culminationAzimuth;
+		double setJD;
+		double setAzimuth;
+		//! The satellite is sunlit and the Sun is below the horizon at culmination.
+		bool visible;
+	};
+
+	//! Peak of an Iridium flare.
+	struct Flare
+	{
+		QString id;
+		QString satellite;
+		double jd;
+		double altitude;
+		double azimuth;
+		float magnitude;
+	};
+
+	//! What to predict for one target. Used as the work item of predict().
+	struct Request
+	{
+		Target target;
+		Location location;
+		double startJD;
+		double endJD;
+		bool passes;
+		bool flares;
+	};
+
+	struct Result
+	{
+		QList<Pass> passes;
+		QList<Flare> flares;
+	};
+
+	//! Start the prediction for all targets on the global thread pool.
+	//! One result is reported per target, in the order of the targets.
+	static QFuture<Result> predict(const QList<Target>& targets, const Location& location,
+				       double startJD, double endJD, bool passes, bool flares);
+
+	//! Do the prediction of one target in the calling thread.
+	static Result predictTarget(const Request& request);
+
+	//! Flares fainter than this are not reported.
+	static const float flareMagnitudeLimit;
+	//! Flares lower than this are not reported [degrees].
+	static const double flareAltitudeLimit;
+
+	//! Smallest angle between the line of sight and the sunlight reflected
+	//! by one of the three main mission antennas of an Iridium satellite.
+	//! @param position, velocity satellite TEME position and velocity [km, km/s]
+	//! @param sunECIPos Sun ECI position [km]
+	//! @param observerECIPos observer ECI position [km]
+	//! @param altAz topocentric position of the satellite (south, east, zenith)
+	//! @param latitude geodetic latitude of the observer [rad]
+	//! @param thetaLMST local mean sidereal time [rad]
+	//! @return the angle [degrees]
+	static double computeSunReflectionAngle(const Vec3d& position, const Vec3d& velocity,
+						const Vec3d& sunECIPos, const Vec3d& observerECIPos,
+						const Vec3d& altAz, double latitude, double thetaLMST);
+	//! Standard magnitude of an Iridium flare (very simple model).
+	//! @param sunReflectionAngle [degrees]
+	static double computeIridiumFlareMagnitude(double sunReflectionAngle);
+
+	//! Low-precision geocentric equatorial position of the Sun [km].
+	static Vec3d computeSunECIPosition(double jd);
+
+private:
+	//! Everything needed at one date, computed from scratch.
+	struct Sample
+	{
+		double jd;
+		Vec3d position;
+		Vec3d velocity;
+		Vec3d altAz;           // topocentric (south, east, zenith) [km]
+		double sinAltitude;
+		double azimuth;        // from north over east [rad]
+		bool valid;
+	};
+
+	//! The state needed for the evaluation of one target.
+	struct Context
+	{
+		elsetrec elements;     // private copy, sgp4() modifies it
+		Location location;
+		double radLatitude;
+	};
+
+	static Sample evaluate(Context& context, double jd);
+	static bool isSunlit(const Vec3d& position, const Vec3d& sunECIPos);
+	static bool isDark(const Context& context, double jd, Vec3d* sunECIPos, Vec3d* observerECIPos);
+	static double reflectionAngle(Context& context, double jd);
+	//! Magnitude of the satellite at the date, 99 if it can't be seen.
+	static float magnitude(Context& context, const Target& target, double jd);
+
+	static void findPasses(Context& context, const Request& request, Result& result);
+	static void findFlares(Context& context, const Request& request, const Pass& pass, Result& result);
+	//! Refine a sign change of the altitude in [jd1, jd2] by bisection.
+	static double findHorizonCrossing(Context& context, double jd1, double jd2);
+};
+
+#endif // _SATELLITEPREDICTOR_HPP_
@@ -0,0 +1,385 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SatellitePropagator.hpp"
+#include "gsatellite/gSatTEME.hpp"
+#include "gsatellite/gTime.hpp"
+#include "gsatellite/mathUtils.hpp"
+#include "gsatellite/stdsat.h"
+
+#include <QFuture>
+#include <QList>
+#include <QtConcurrent>
+
+#include <cmath>
+
+const int SatellitePropagator::chunkSize = 512;
+
+SatellitePropagator::SatellitePropagator()
+	: capacity(0)
+{
+	// same constants as gSatTEME
+	getgravconst(wgs72, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2);
+	vkmpersec = radiusearthkm * xke/60.0;
+}
+
+void SatellitePropagator::clear()
+{
+	elements.clear();
+	capacity = 0;
+	deepSpaceSlot.clear();
+	deepSpace.clear();
+	activeFlags.clear();
+	states.clear();
+}
+
+void SatellitePropagator::reserve(int newCapacity)
+{
+	if (newCapacity <= capacity)
+		return;
+	QVector<double> newElements(ColumnCount*newCapacity, 0.);
+	const int n = count();
+	for (int c=0; c<ColumnCount; ++c)
+		std::copy(elements.constData() + c*capacity, elements.constData() + c*capacity + n, newElements.data() + c*newCapacity);
+	elements.swap(newElements);
+	capacity = newCapacity;
+}
+
+int SatellitePropagator::addSatellite(const elsetrec& satrec)
+{
+	const int index = count();
+	if (index >= capacity)
+		reserve(qMax(256, 2*capacity));
+
+	if (satrec.method == 'd')
+	{
+		deepSpaceSlot.append(deepSpace.size());
+		deepSpace.append(satrec);
+	}
+	else
+		deepSpaceSlot.append(-1);
+
+	double* e = elements.data();
+	e[JdSatEpoch*capacity + index] = satrec.jdsatepoch;
+	e[Isimp*capacity + index]   = satrec.isimp;
+	e[Mo*capacity + index]      = satrec.mo;
+	e[Mdot*capacity + index]    = satrec.mdot;
+	e[Argpo*capacity + index]   = satrec.argpo;
+	e[Argpdot*capacity + index] = satrec.argpdot;
+	e[Nodeo*capacity + index]   = satrec.nodeo;
+	e[Nodedot*capacity + index] = satrec.nodedot;
+	e[Nodecf*capacity + index]  = satrec.nodecf;
+	e[Cc1*capacity + index]     = satrec.cc1;
+	e[Cc4*capacity + index]     = satrec.cc4;
+	e[Cc5*capacity + index]     = satrec.cc5;
+	e[Bstar*capacity + index]   = satrec.bstar;
+	e[T2cof*capacity + index]   = satrec.t2cof;
+	e[T3cof*capacity + index]   = satrec.t3cof;
+	e[T4cof*capacity + index]   = satrec.t4cof;
+	e[T5cof*capacity + index]   = satrec.t5cof;
+	e[Omgcof*capacity + index]  = satrec.omgcof;
+	e[Xmcof*capacity + index]   = satrec.xmcof;
+	e[Eta*capacity + index]     = satrec.eta;
+	e[Delmo*capacity + index]   = satrec.delmo;
+	e[D2*capacity + index]      = satrec.d2;
+	e[D3*capacity + index]      = satrec.d3;
+	e[D4*capacity + index]      = satrec.d4;
+	e[Sinmao*capacity + index]  = satrec.sinmao;
+	e[No*capacity + index]      = satrec.no;
+	e[Ecco*capacity + index]    = satrec.ecco;
+	e[Inclo*capacity + index]   = satrec.inclo;
+	e[Aycof*capacity + index]   = satrec.aycof;
+	e[Xlcof*capacity + index]   = satrec.xlcof;
+	e[Con41*capacity + index]   = satrec.con41;
+	e[X1mth2*capacity + index]  = satrec.x1mth2;
+	e[X7thm1*capacity + index]  = satrec.x7thm1;
+
+	activeFlags.append(true);
+	State state;
+	state.range = state.rangeRate = state.phaseAngle = 0.;
+	state.visibility = gSatWrapper::UNKNOWN;
+	state.error = 0;
+	states.append(state);
+	return index;
+}
+
+void SatellitePropagator::computeObserverECIPosition(double jd, double latitude, double longitude, double altitude,
+						     Vec3d& position, Vec3d& velocity)
+{
+	const double radLatitude = latitude * KDEG2RAD;
+	const double theta       = gTime(jd).toThetaLMST(longitude * KDEG2RAD);
+
+	/* Reference:  Explanatory supplement to the Astronomical Almanac 1992, page 209-210. */
+	/* Elipsoid earth model*/
+	/* c = Nlat/a */
+	const double c  = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(std::sin(radLatitude)));
+	const double sq = Sqr(1 - __f)*c;
+
+	const double r = (KEARTHRADIUS*c + (altitude/1000))*std::cos(radLatitude);
+	position[0] = r * std::cos(theta);/*kilometers*/
+	position[1] = r * std::sin(theta);
+	position[2] = (KEARTHRADIUS*sq + (altitude/1000))*std::sin(radLatitude);
+	velocity[0] = -KMFACTOR*position[1];/*kilometers/second*/
+	velocity[1] =  KMFACTOR*position[0];
+	velocity[2] =  0;
+}
+
+void SatellitePropagator::propagate(const Observer& observer)
+{
+	Frame frame;
+	frame.observer = observer;
+	gTime epoch(observer.jd);
+	frame.thetaGMST = epoch.toThetaGMST();
+	const double radLatitude = observer.latitude * KDEG2RAD;
+	const double theta = epoch.toThetaLMST(observer.longitude * KDEG2RAD);
+	frame.sinLatitude = std::sin(radLatitude);
+	frame.cosLatitude = std::cos(radLatitude);
+	frame.sinTheta = std::sin(theta);
+	frame.cosTheta = std::cos(theta);
+	frame.zenith.set(frame.cosLatitude*frame.cosTheta, frame.cosLatitude*frame.sinTheta, frame.sinLatitude);
+
+	const int n = count();
+	if (n <= chunkSize)
+	{
+		propagateRange(0, n, frame);
+		return;
+	}
+
+	// Detach the containers written by the workers here, not in the workers.
+	states.data();
+	deepSpace.data();
+	QList<QFuture<void> > tasks;
+	for (int begin=0; begin<n; begin+=chunkSize)
+		tasks.append(QtConcurrent::run(this, &SatellitePropagator::propagateRange, begin, qMin(begin+chunkSize, n), frame));
+	foreach (QFuture<void> task, tasks)
+		task.waitForFinished();
+}
+
+void SatellitePropagator::propagateRange(int begin, int end, const Frame& frame)
+{
+	const double* jdSatEpoch = column(JdSatEpoch);
+	const char* active = activeFlags.constData();
+	const int* slot = deepSpaceSlot.constData();
+	State* state = states.data();
+
+	for (int i=begin; i<end; ++i)
+	{
+		if (!active[i])
+			continue;
+
+		State& s = state[i];
+		const double tsince = (frame.observer.jd - jdSatEpoch[i]) * KMIN_PER_DAY;
+		double r[3] = {};
+		double v[3] = {};
+		if (slot[i] < 0)
+			s.error = propagateNearEarth(i, tsince, r, v);
+		else
+		{
+			elsetrec& satrec = deepSpace[slot[i]];
+			sgp4(wgs72, satrec, tsince, r, v);
+			s.error = satrec.error;
+		}
+
+		// Like gSatTEME, failed propagations leave a null vector, which
+		// makes the satellite's orbit invalid.
+		s.position.set(r[0], r[1], r[2]);
+		s.velocity.set(v[0], v[1], v[2]);
+		double subPoint[3];
+		gSatTEME::computeSubPoint(r, frame.thetaGMST, subPoint);
+		s.subPoint.set(subPoint[0], subPoint[1], subPoint[2]);
+		computeTopocentric(s, frame);
+	}
+}
+
+void SatellitePropagator::computeTopocentric(State& state, const Frame& frame) const
+{
+	const Vec3d slantRange = state.position - frame.observer.eciPosition;
+	const Vec3d slantRangeVelocity = state.velocity - frame.observer.eciVelocity;
+	const double topZ = slantRange.dot(frame.zenith);
+
+	// see gSatWrapper::getAltAz()
+	state.altAz.set(frame.sinLatitude*frame.cosTheta*slantRange[0]
+			+ frame.sinLatitude*frame.sinTheta*slantRange[1]
+			- frame.cosLatitude*slantRange[2],
+			-frame.sinTheta*slantRange[0] + frame.cosTheta*slantRange[1],
+			topZ);
+	state.range = slantRange.length();
+	state.rangeRate = slantRange.dot(slantRangeVelocity)/state.range;
+	state.phaseAngle = frame.observer.sunECIPosition.angle(state.position);
+
+	// see gSatWrapper::getVisibilityPredict()
+	if (topZ <= 0.)
+		state.visibility = gSatWrapper::NOT_VISIBLE;
+	else if (frame.observer.sunAboveHorizon)
+		state.visibility = gSatWrapper::RADAR_SUN;
+	else
+	{
+		const double dist = state.position.length()*std::cos(state.phaseAngle - M_PI/2);
+		state.visibility = dist > KEARTHRADIUS ? gSatWrapper::VISIBLE : gSatWrapper::RADAR_NIGHT;
+	}
+}
+
+// The near-earth branch of sgp4() in sgp4unit.cpp, reading the constant
+// terms from the columns. Comments of the original are kept.
+int SatellitePropagator::propagateNearEarth(int i, double t, double r[3], double v[3]) const
+{
+	const double twopi = 2.0 * M_PI;
+	const double x2o3  = 2.0 / 3.0;
+	const double* e = elements.constData();
+	const int n = capacity;
+#define COL(c) e[c*n + i]
+
+	/* ------- update for secular gravity and atmospheric drag ----- */
+	const double xmdf   = COL(Mo) + COL(Mdot) * t;
+	const double argpdf = COL(Argpo) + COL(Argpdot) * t;
+	const double nodedf = COL(Nodeo) + COL(Nodedot) * t;
+	double argpm = argpdf;
+	double mm    = xmdf;
+	const double t2 = t * t;
+	double nodem = nodedf + COL(Nodecf) * t2;
+	double tempa = 1.0 - COL(Cc1) * t;
+	double tempe = COL(Bstar) * COL(Cc4) * t;
+	double templ = COL(T2cof) * t2;
+
+	if (COL(Isimp) != 1.0)
+	{
+		const double delomg = COL(Omgcof) * t;
+		const double delm   = COL(Xmcof) * (std::pow((1.0 + COL(Eta) * std::cos(xmdf)), 3) - COL(Delmo));
+		const double temp   = delomg + delm;
+		mm    = xmdf + temp;
+		argpm = argpdf - temp;
+		const double t3 = t2 * t;
+		const double t4 = t3 * t;
+		tempa = tempa - COL(D2) * t2 - COL(D3) * t3 - COL(D4) * t4;
+		tempe = tempe + COL(Bstar) * COL(Cc5) * (std::sin(mm) - COL(Sinmao));
+		templ = templ + COL(T3cof) * t3 + t4 * (COL(T4cof) + t * COL(T5cof));
+	}
+
+	double nm = COL(No);
+	double em = COL(Ecco);
+	const double inclm = COL(Inclo);
+	if (nm <= 0.0)
+		return 2;
+	const double am = std::pow((xke / nm), x2o3) * tempa * tempa;
+	nm = xke / std::pow(am, 1.5);
+	em = em - tempe;
+
+	// fix tolerance for error recognition
+	if ((em >= 1.0) || (em < -0.001))
+		return 1;
+	// sgp4fix fix tolerance to avoid a divide by zero
+	if (em < 1.0e-6)
+		em = 1.0e-6;
+	mm = mm + COL(No) * templ;
+	double xlm = mm + argpm + nodem;
+
+	nodem = std::fmod(nodem, twopi);
+	argpm = std::fmod(argpm, twopi);
+	xlm   = std::fmod(xlm, twopi);
+	mm    = std::fmod(xlm - argpm - nodem, twopi);
+
+	/* ----------------- compute extra mean quantities ------------- */
+	const double sinip = std::sin(inclm);
+	const double cosip = std::cos(inclm);
+
+	/* -------------------- long period periodics ------------------ */
+	const double axnl = em * std::cos(argpm);
+	double temp = 1.0 / (am * (1.0 - em * em));
+	const double aynl = em * std::sin(argpm) + temp * COL(Aycof);
+	const double xl   = mm + argpm + nodem + temp * COL(Xlcof) * axnl;
+
+	/* --------------------- solve kepler's equation --------------- */
+	const double u = std::fmod(xl - nodem, twopi);
+	double eo1 = u;
+	double tem5 = 9999.9;
+	double sineo1 = 0.0, coseo1 = 0.0;
+	//   sgp4fix for kepler iteration
+	//   the following iteration needs better limits on corrections
+	for (int ktr=1; std::fabs(tem5) >= 1.0e-12 && ktr <= 10; ++ktr)
+	{
+		sineo1 = std::sin(eo1);
+		coseo1 = std::cos(eo1);
+		tem5   = 1.0 - coseo1 * axnl - sineo1 * aynl;
+		tem5   = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+		if (std::fabs(tem5) >= 0.95)
+			tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+		eo1 = eo1 + tem5;
+	}
+
+	/* ------------- short period preliminary quantities ----------- */
+	const double ecose = axnl*coseo1 + aynl*sineo1;
+	const double esine = axnl*sineo1 - aynl*coseo1;
+	const double el2   = axnl*axnl + aynl*aynl;
+	const double pl    = am*(1.0-el2);
+	if (pl < 0.0)
+		return 4;
+
+	const double rl     = am * (1.0 - ecose);
+	const double rdotl  = std::sqrt(am) * esine/rl;
+	const double rvdotl = std::sqrt(pl) / rl;
+	const double betal  = std::sqrt(1.0 - el2);
+	temp = esine / (1.0 + betal);
+	const double sinu  = am / rl * (sineo1 - aynl - axnl * temp);
+	const double cosu  = am / rl * (coseo1 - axnl + aynl * temp);
+	double su          = std::atan2(sinu, cosu);
+	const double sin2u = (cosu + cosu) * sinu;
+	const double cos2u = 1.0 - 2.0 * sinu * sinu;
+	temp = 1.0 / pl;
+	const double temp1 = 0.5 * j2 * temp;
+	const double temp2 = temp1 * temp;
+
+	/* -------------- update for short period periodics ------------ */
+	const double mrt   = rl * (1.0 - 1.5 * temp2 * betal * COL(Con41)) +
+			     0.5 * temp1 * COL(X1mth2) * cos2u;
+	su                 = su - 0.25 * temp2 * COL(X7thm1) * sin2u;
+	const double xnode = nodem + 1.5 * temp2 * cosip * sin2u;
+	const double xinc  = inclm + 1.5 * temp2 * cosip * sinip * cos2u;
+	const double mvt   = rdotl - nm * temp1 * COL(X1mth2) * sin2u / xke;
+	const double rvdot = rvdotl + nm * temp1 * (COL(X1mth2) * cos2u +
+			     1.5 * COL(Con41)) / xke;
+#undef COL
+
+	/* --------------------- orientation vectors ------------------- */
+	const double sinsu =  std::sin(su);
+	const double cossu =  std::cos(su);
+	const double snod  =  std::sin(xnode);
+	const double cnod  =  std::cos(xnode);
+	const double sini  =  std::sin(xinc);
+	const double cosi  =  std::cos(xinc);
+	const double xmx   = -snod * cosi;
+	const double xmy   =  cnod * cosi;
+	const double ux    =  xmx * sinsu + cnod * cossu;
+	const double uy    =  xmy * sinsu + snod * cossu;
+	const double uz    =  sini * sinsu;
+	const double vx    =  xmx * cossu - cnod * sinsu;
+	const double vy    =  xmy * cossu - snod * sinsu;
+	const double vz    =  sini * cossu;
+
+	/* --------- position and velocity (in km and km/sec) ---------- */
+	r[0] = (mrt * ux)* radiusearthkm;
+	r[1] = (mrt * uy)* radiusearthkm;
+	r[2] = (mrt * uz)* radiusearthkm;
+	v[0] = (mvt * ux + rvdot * vx) * vkmpersec;
+	v[1] = (mvt * uy + rvdot * vy) * vkmpersec;
+	v[2] = (mvt * uz + rvdot * vz) * vkmpersec;
+
+	// sgp4fix for decaying satellites
+	if (mrt < 1.0)
+		return 6;
+	return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _SATELLITEPROPAGATOR_HPP_
+#define _SATELLITEPROPAGATOR_HPP_
+
+#include "VecMath.hpp"
+#include "gSatWrapper.hpp"
+#include "gsatellite/sgp4unit.h"
+
+#include <QVector>
+
+//! @class SatellitePropagator
+//! Propagates the SGP4 element sets of many satellites to the same date.
+//! The element sets of near-earth satellites (the vast majority of any
+//! catalog) are stored column by column (one array per SGP4 coefficient),
+//! so that the propagation loop runs over contiguous memory without calls
+//! into sgp4unit. Deep-space satellites, which need the resonance integrator
+//! of the full model, keep a private copy of their elsetrec and are
+//! propagated with sgp4().
+//!
+//! Besides the position and velocity, the per-satellite quantities used by
+//! the Satellite class (subpoint, topocentric position, range, phase angle,
+//! visibility) are computed in the same pass. The observer and Sun dependent
+//! terms are computed once per frame by the caller. The visibility
+//! prediction is skipped for satellites below the horizon, which is
+//! decided by a single dot product with the observer's zenith.
+//!
+//! The work is split in chunks which run on the global thread pool.
+//! The class does not depend on StelApp.
+//! @ingroup satellites
+class SatellitePropagator
+{
+public:
+	//! Per-frame data shared by all satellites.
+	struct Observer
+	{
+		double jd;               //!< UTC Julian Day
+		double latitude;         //!< geodetic latitude [degrees]
+		double longitude;        //!< longitude [degrees]
+		Vec3d eciPosition;       //!< observer ECI position [km]
+		Vec3d eciVelocity;       //!< observer ECI velocity [km/s]
+		Vec3d sunECIPosition;    //!< Sun ECI position [km]
+		bool sunAboveHorizon;
+	};
+
+	//! Result of the propagation of one satellite.
+	//! Units are those of gSatWrapper.
+	struct State
+	{
+		Vec3d position;          //!< TEME position [km]
+		Vec3d velocity;          //!< TEME velocity [km/s]
+		Vec3d subPoint;          //!< latitude [degrees], longitude [degrees], altitude [km]
+		Vec3d altAz;             //!< topocentric position (south, east, zenith) [km]
+		double range;            //!< slant range [km]
+		double rangeRate;        //!< slant range rate [km/s]
+		double phaseAngle;       //!< [rad]
+		gSatWrapper::Visibility visibility;
+		int error;               //!< sgp4 error code, 0 if the state is valid
+	};
+
+	SatellitePropagator();
+
+	//! Remove all satellites.
+	void clear();
+	//! Add a satellite.
+	//! @return the index used for setActive() and getState().
+	int addSatellite(const elsetrec& satrec);
+	int count() const { return deepSpaceSlot.size(); }
+
+	//! Inactive satellites are not propagated and keep their last state.
+	//! Satellites are active when added.
+	void setActive(int index, bool active) { activeFlags[index] = active; }
+	bool isActive(int index) const { return activeFlags.at(index); }
+
+	//! Propagate all active satellites to observer.jd.
+	void propagate(const Observer& observer);
+
+	const State& getState(int index) const { return states.at(index); }
+
+	//! Compute the observer position and velocity in the ECI frame.
+	//! @param latitude, longitude geodetic coordinates [degrees]
+	//! @param altitude above the ellipsoid [m]
+	//! @see gSatWrapper::calcObserverECIPosition()
+	static void computeObserverECIPosition(double jd, double latitude, double longitude, double altitude,
+					       Vec3d& position, Vec3d& velocity);
+
+	//! Number of satellites handled by one worker task.
+	static const int chunkSize;
+
+private:
+	//! Constant coefficients of the near-earth SGP4 model, one column each.
+	enum Column
+	{
+		JdSatEpoch, Isimp,
+		Mo, Mdot, Argpo, Argpdot, Nodeo, Nodedot, Nodecf,
+		Cc1, Cc4, Cc5, Bstar, T2cof, T3cof, T4cof, T5cof,
+		Omgcof, Xmcof, Eta, Delmo, D2, D3, D4, Sinmao,
+		No, Ecco, Inclo, Aycof, Xlcof, Con41, X1mth2, X7thm1,
+		ColumnCount
+	};
+
+	//! Observer dependent terms, computed once per propagate() call.
+	struct Frame
+	{
+		Observer observer;
+		double thetaGMST;
+		double sinLatitude, cosLatitude;
+		double sinTheta, cosTheta;   // local mean sidereal time
+		Vec3d zenith;                // unit vector, ECI
+	};
+
+	const double* column(Column c) const { return elements.constData() + c*capacity; }
+	void reserve(int newCapacity);
+
+	//! Propagate satellites [begin, end). Runs in a worker thread.
+	void propagateRange(int begin, int end, const Frame& frame);
+	//! Near-earth SGP4 from the columns. Same results as sgp4() for method 'n'.
+	int propagateNearEarth(int index, double tsince, double r[3], double v[3]) const;
+	//! Observer dependent quantities of one satellite.
+	void computeTopocentric(State& state, const Frame& frame) const;
+
+	// gravitational constants (WGS-72, as used by gSatTEME)
+	double tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2, vkmpersec;
+
+	QVector<double> elements;        // ColumnCount columns of capacity entries
+	int capacity;
+	QVector<int> deepSpaceSlot;      // index into deepSpace, or -1 for near-earth satellites
+	QVector<elsetrec> deepSpace;
+	QVector<char> activeFlags;
+	QVector<State> states;
+};
+
+#endif // _SATELLITEPROPAGATOR_HPP_
@@ -36,6 +36,7 @@
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
 #include "StelJsonParser.hpp"
+#include "StelPluginCatalog.hpp"
 #include "SatellitesDialog.hpp"
 #include "LabelMgr.hpp"
 #include "StelTranslator.hpp"
@@ -79,6 +80,7 @@ StelPluginInfo SatellitesStelPluginInterface::getPluginInfo() const
 
 Satellites::Satellites()
 	: satelliteListModel(Q_NULLPTR)
+	, propagatorNeedsRebuild(true)
 	, toolbarButton(Q_NULLPTR)
 	, earth(Q_NULLPTR)
 	, defaultHintColor(0.0f, 0.4f, 0.6f)
@@ -97,6 +99,8 @@ Satellites::Satellites()
 {
 	setObjectName("Satellites");
 	configDialog = new SatellitesDialog();
+	connect(&flaresWatcher, SIGNAL(finished()), this, SLOT(iridiumFlaresPredictionFinished()));
+	connect(&passesWatcher, SIGNAL(finished()), this, SLOT(passesPredictionFinished()));
 }
 
 void Satellites::deinit()
@@ -728,24 +732,18 @@ void Satellites::saveSettings()
 
 void Satellites::loadCatalog()
 {
-	setDataMap(loadDataMap());
+	StelPluginCatalog catalog(catalogPath, "satellites");
+	catalog.load();
+	setCatalog(catalog);
 }
 
 const QString Satellites::readCatalogVersion()
 {
 	QString jsonVersion("unknown");
-	QFile satelliteJsonFile(catalogPath);
-	if (!satelliteJsonFile.open(QIODevice::ReadOnly))
+	const QVariantMap header = StelPluginCatalog::readHeader(catalogPath, QStringList("creator"));
+	if (header.contains("creator"))
 	{
-		qWarning() << "[Satellites] cannot open " << QDir::toNativeSeparators(catalogPath);
-		return jsonVersion;
-	}
-
-	QVariantMap map;
-	map = StelJsonParser::parse(&satelliteJsonFile).toMap();
-	if (map.contains("creator"))
-	{
-		QString creator = map.value("creator").toString();
+		QString creator = header.value("creator").toString();
 		QRegExp vRx(".*(\\d+\\.\\d+\\.\\d+).*");
 		if (vRx.exactMatch(creator))
 		{
@@ -753,7 +751,6 @@ const QString Satellites::readCatalogVersion()
 		}
 	}
 
-	satelliteJsonFile.close();
 	//qDebug() << "[Satellites] catalog version from file:" << jsonVersion;
 	return jsonVersion;
 }
@@ -782,32 +779,15 @@ bool Satellites::saveDataMap(const QVariantMap& map, QString path)
 	}
 }
 
-QVariantMap Satellites::loadDataMap(QString path)
-{
-	if (path.isEmpty())
-		path = catalogPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Satellites] cannot open " << QDir::toNativeSeparators(path);
-	else
-	{
-		map = StelJsonParser::parse(&jsonFile).toMap();
-		jsonFile.close();
-	}
-	return map;
-}
-
-void Satellites::setDataMap(const QVariantMap& map)
+void Satellites::setCatalog(const StelPluginCatalog& catalog)
 {
 	int numReadOk = 0;
 	QVariantList defaultHintColorMap;
 	defaultHintColorMap << defaultHintColor[0] << defaultHintColor[1] << defaultHintColor[2];
 
-	if (map.contains("hintColor"))
+	if (catalog.getHeader().contains("hintColor"))
 	{
-		defaultHintColorMap = map.value("hintColor").toList();
+		defaultHintColorMap = catalog.getHeader().value("hintColor").toList();
 		defaultHintColor.set(defaultHintColorMap.at(0).toDouble(), defaultHintColorMap.at(1).toDouble(), defaultHintColorMap.at(2).toDouble());
 	}
 
@@ -816,10 +796,10 @@ void Satellites::setDataMap(const QVariantMap& map)
 	
 	satellites.clear();
 	groups.clear();
-	QVariantMap satMap = map.value("satellites").toMap();
-	foreach(const QString& satId, satMap.keys())
+	for (int i=0; i<catalog.size(); ++i)
 	{
-		QVariantMap satData = satMap.value(satId).toMap();
+		const QString satId = catalog.getName(i);
+		QVariantMap satData = catalog.getEntry(i);
 
 		if (!satData.contains("hintColor"))
 			satData["hintColor"] = defaultHintColorMap;
@@ -839,6 +819,7 @@ void Satellites::setDataMap(const QVariantMap& map)
 		}
 	}
 	qSort(satellites);
+	propagatorNeedsRebuild = true;
 	
 	if (satelliteListModel)
 		satelliteListModel->endSatellitesChange();
@@ -989,6 +970,7 @@ bool Satellites::add(const TleData& tleData)
 		qDebug() << "[Satellites] satellite added:" << tleData.id << tleData.name;
 		satellites.append(sat);
 		sat->setNew();
+		propagatorNeedsRebuild = true;
 		return true;
 	}
 	return false;
@@ -1039,6 +1021,7 @@ void Satellites::remove(const QStringList& idList)
 			satellites.removeAt(i);
 			i--; //Compensate for the change in the array's indexing
 			numRemoved++;
+			propagatorNeedsRebuild = true;
 		}
 	}
 	// As the satellite list is kept sorted, no need for re-sorting.
@@ -1475,6 +1458,7 @@ void Satellites::updateSatellites(TleDataHash& newTleSets)
 			{
 				// We have updated TLE elements for this satellite
 				sat->setNewTleElements(newTle.first, newTle.second);
+				propagatorNeedsRebuild = true;
 				
 				// Update the name if it has been changed in the source list
 				sat->name = newTle.name;
@@ -1695,11 +1679,41 @@ void Satellites::update(double deltaTime)
 
 	hintFader.update((int)(deltaTime*1000));
 
-	foreach(const SatelliteP& sat, satellites)
+	if (propagatorNeedsRebuild)
 	{
-		if (sat->initialized && sat->displayed)
-			sat->update(deltaTime);
+		propagator.clear();
+		foreach(const SatelliteP& sat, satellites)
+			propagator.addSatellite(sat->pSatWrapper->getElements());
+		propagatorNeedsRebuild = false;
 	}
+
+	// Propagate all displayed satellites at once. The observer and Sun
+	// dependent terms are the same for all of them.
+	const double jd = core->getJD(); // "true" JD (UTC), satellites don't need JDE!
+	gSatWrapper::setSharedEpoch(jd);
+	const StelLocation& loc = core->getCurrentLocation();
+	SatellitePropagator::Observer observer;
+	observer.jd = jd;
+	observer.latitude = loc.latitude;
+	observer.longitude = loc.longitude;
+	gSatWrapper::getObserverECIPosition(observer.eciPosition, observer.eciVelocity);
+	observer.sunECIPosition = gSatWrapper::getSunECIPos();
+	observer.sunAboveHorizon = GETSTELMODULE(SolarSystem)->getSun()->getAltAzPosGeometric(core)[2] > 0.;
+
+	for (int i=0; i<satellites.size(); ++i)
+	{
+		const SatelliteP& sat = satellites.at(i);
+		propagator.setActive(i, sat->initialized && sat->displayed && sat->orbitValid);
+	}
+	propagator.propagate(observer);
+
+	for (int i=0; i<satellites.size(); ++i)
+	{
+		if (propagator.isActive(i))
+			satellites.at(i)->update(propagator.getState(i));
+	}
+	// Orbit lines move the shared epoch, which is used again by draw().
+	gSatWrapper::setSharedEpoch(jd);
 }
 
 void Satellites::draw(StelCore* core)
@@ -1764,28 +1778,14 @@ void Satellites::drawPointer(StelCore* core, StelPainter& painter)
 
 bool Satellites::checkJsonFileFormat()
 {
-	QFile jsonFile(catalogPath);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Satellites] cannot open " << QDir::toNativeSeparators(catalogPath);
-		return false;
-	}
-
-	QVariantMap map;
-	try
-	{
-		map = StelJsonParser::parse(&jsonFile).toMap();
-		jsonFile.close();
-	}
-	catch (std::runtime_error& e)
+	StelPluginCatalog catalog(catalogPath, "satellites");
+	if (!catalog.load())
 	{
 		qDebug() << "[Satellites] file format is wrong!";
-		qDebug() << "[Satellites] error:" << e.what();
 		return false;
 	}
 
 	return true;
-
 }
 
 bool Satellites::isValidRangeDates(const StelCore *core) const
@@ -1803,241 +1803,137 @@ bool Satellites::isValidRangeDates(const StelCore *core) const
 		return true;
 }
 
-#ifdef _OLD_IRIDIUM_PREDICTIONS
-IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
+SatellitePredictor::Location Satellites::getPredictionLocation() const
 {
-	StelCore* pcore = StelApp::getInstance().getCore();
-	double currentJD = pcore->getJD(); // save current JD
-	bool isTimeNow = pcore->getIsTimeNow();
-	long iJD =currentJD;
-	double JDMidnight = iJD + 0.5 - pcore->getCurrentLocation().longitude / 360.f;
-	double delta = currentJD - JDMidnight;
-
-	pcore->setJD(iJD + 0.5 - pcore->getCurrentLocation().longitude / 360.f);
-	pcore->update(10); // force update to get new coordinates
+	const StelLocation& loc = StelApp::getInstance().getCore()->getCurrentLocation();
+	SatellitePredictor::Location location;
+	location.latitude = loc.latitude;
+	location.longitude = loc.longitude;
+	location.altitude = loc.altitude;
+	return location;
+}
 
-	IridiumFlaresPredictionList predictions;
-	predictions.clear();
+QList<SatellitePredictor::Target> Satellites::getPredictionTargets(bool iridiumOnly, const QStringList& ids) const
+{
+	QList<SatellitePredictor::Target> targets;
 	foreach(const SatelliteP& sat, satellites)
 	{
-		if (sat->initialized && sat.data()->getEnglishName().startsWith("IRIDIUM"))
-		{
-			double dt  = 0;
-			double angle0 = 100;
-			double lat0 = -1;
-			while (dt<1)
-			{
-				Satellite::timeShift = dt+delta;
-				sat.data()->update(0);
-
-				Vec3d pos = sat.data()->getAltAzPosApparent(pcore);
-				double lat = pos.latitude();
-				double lon = M_PI - pos.longitude();
-				double v =   sat.data()->getVMagnitude(pcore);
-				double angle =  sat.data()->sunReflAngle;
-
-				if (angle>0 && angle<2)
-				{
-					if (angle>angle0 && (v<1) && lat>5*M_PI/180)
-					{
-						IridiumFlaresPrediction flare;
-						flare.datetime = StelUtils::julianDayToISO8601String(currentJD+dt+StelApp::getInstance().getCore()->getUTCOffset(currentJD+dt)/24.f);
-						flare.satellite = sat.data()->getEnglishName();
-						flare.azimuth   = lon;
-						flare.altitude  = lat;
-						flare.magnitude = v;
-
-						predictions.append(flare);
+		if (!sat->initialized || !sat->pSatWrapper)
+			continue;
+		const bool iridium = sat->getEnglishName().startsWith("IRIDIUM");
+		if (iridiumOnly ? !iridium : (ids.isEmpty() ? !sat->displayed : !ids.contains(sat->id)))
+			continue;
 
-						dt +=0.005;
-					}
-					angle0 = angle;
-				}
-				if (angle>0)
-					dt+=0.000002*angle*angle;
-				else
-				{
-					if (lat0>0 && lat<0)
-						dt+=0.05;
-					else
-						dt+=0.0002;
-				}
-				lat0 = lat;
-			}
-		}
+		SatellitePredictor::Target target;
+		target.id = sat->id;
+		target.name = sat->getEnglishName();
+		target.elements = sat->pSatWrapper->getElements();
+		target.stdMag = sat->stdMag;
+		target.iridium = iridium;
+		targets.append(target);
 	}
-	Satellite::timeShift = 0.;
-	if (isTimeNow)
-		pcore->setTimeNow();
-	else
-		pcore->setJD(currentJD);
-
-	return predictions;
+	return targets;
 }
-#else
-
-struct SatDataStruct {
-	double nextJD;
-	double angleToSun;
-	double altitude;
-	double azimuth;
-	double v;
-};
 
-IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
+IridiumFlaresPredictionList Satellites::toIridiumFlaresPredictionList(const QList<SatellitePredictor::Result>& results) const
 {
 	StelCore* pcore = StelApp::getInstance().getCore();
-	SolarSystem* ssystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
-
-	double currentJD = pcore->getJD(); // save current JD
-	bool isTimeNow = pcore->getIsTimeNow();
-
-	double predictionJD = currentJD - 1.;  //  investigate what's seen recently// yesterday
-	double predictionEndJD = currentJD + getIridiumFlaresPredictionDepth(); // 7 days interval by default
-	pcore->setJD(predictionJD);
-
 	bool useSouthAzimuth = StelApp::getInstance().getFlagSouthAzimuthUsage();
 
 	IridiumFlaresPredictionList predictions;
-
-// create a lіst of Iridiums
-	QMap<SatelliteP,SatDataStruct> iridiums;
-	SatDataStruct sds;
-	double nextJD = predictionJD + 1./24;
-
-	foreach(const SatelliteP& sat, satellites)
+	foreach(const SatellitePredictor::Result& result, results)
 	{
-		if (sat->initialized && sat.data()->getEnglishName().startsWith("IRIDIUM"))
+		foreach(const SatellitePredictor::Flare& f, result.flares)
 		{
-			Vec3d pos = sat.data()->getAltAzPosApparent(pcore);
-			sds.angleToSun = sat.data()->sunReflAngle;
-			sds.altitude = pos.latitude();
-			sds.azimuth = pos.longitude();
-			sds.v = sat.data()->getVMagnitude(pcore);
-			double t;
-			if (sds.altitude<0)
-				t = qMax(-sds.altitude, 1.) / 2880;
-			else
-			if (sds.angleToSun>0)
-				t = qMax(sds.angleToSun, 1.) / (2*86400);
-			else
+			IridiumFlaresPrediction flare;
+			flare.datetime = StelUtils::julianDayToISO8601String(f.jd + pcore->getUTCOffset(f.jd)/24.);
+			flare.satellite = f.satellite;
+			flare.azimuth = f.azimuth;
+			if (useSouthAzimuth)
 			{
-				//qDebug() << "IRIDIUM warn: alt, angleToSun = " <<sds.altitude << sds.angleToSun;
-				t = 0.25/1440; // we should never be here, but assuming 1/4 minute to leave this
+				flare.azimuth += M_PI;
+				if (flare.azimuth > M_PI*2)
+					flare.azimuth -= M_PI*2;
 			}
-
-			sds.nextJD = predictionJD + t;
-			iridiums.insert(sat, sds);
-			//qDebug() << sat.data()->getEnglishName() << ": "
-			//		 << sds.altitude
-			//		 << sds.azimuth
-			//		 << sds.angleToSun
-			//		 << sds.v
-			//		 << StelUtils::julianDayToISO8601String(predictionJD+StelApp::getInstance().getCore()->getUTCOffset(predictionJD)/24.f)
-			//			;
-			if (nextJD>sds.nextJD)
-				nextJD = sds.nextJD;
+			flare.altitude = f.altitude;
+			flare.magnitude = f.magnitude;
+			predictions.append(flare);
 		}
 	}
-	predictionJD = nextJD;
-
-	while (predictionJD<predictionEndJD)
-	{
-		nextJD = predictionJD + 1./24;
-		pcore->setJD(predictionJD);
-
-		ssystem->getEarth().data()->computePosition(predictionJD);
-		pcore->update(0);
-
-		QMap<SatelliteP,SatDataStruct>::iterator i = iridiums.begin();
-		while (i != iridiums.end())
-		{
-			if ( i.value().nextJD<=predictionJD)
-			{
-
-				i.key().data()->update(0);
-
-				double v = i.key().data()->getVMagnitude(pcore);
-				bool flareFound = false;
-				if (v > i.value().v)
-				{
-					if (i.value().v < 1. // brighness limit
-					 && i.value().angleToSun>0.
-					 && i.value().angleToSun<2.)
-					{
-						IridiumFlaresPrediction flare;
-						flare.datetime = StelUtils::julianDayToISO8601String(predictionJD+StelApp::getInstance().getCore()->getUTCOffset(predictionJD)/24.f);
-						flare.satellite = i.key().data()->getEnglishName();
-						flare.azimuth   = i.value().azimuth;
-						if (useSouthAzimuth)
-						{
-							flare.azimuth += M_PI;
-							if (flare.azimuth > M_PI*2)
-								flare.azimuth -= M_PI*2;
-						}
-						flare.altitude  = i.value().altitude;
-						flare.magnitude = i.value().v;
-
-						predictions.append(flare);
-						flareFound = true;
-						//qDebug() << "Flare:" << flare.datetime << flare.satellite;
-
-					}
-				}
-
-/*				qDebug() << QString::asprintf("%20s  alt:%6.1f  az:%6.1f  sun:%6.1f  v:%6.1f",
-											 i.key().data()->getEnglishName().toStdString(),
-											 i.value().altitude*180/M_PI,
-											 i.value().azimuth*180/M_PI,
-											 i.value().angleToSun,
-											 v
-											 )
-						 <<  StelUtils::julianDayToISO8601String(predictionJD+StelApp::getInstance().getCore()->getUTCOffset(predictionJD)/24.f)
-							 ;
-*/
+	return predictions;
+}
 
-				Vec3d pos = i.key().data()->getAltAzPosApparent(pcore);
+IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
+{
+	double currentJD = StelApp::getInstance().getCore()->getJD();
+	// investigate what's seen recently, 7 days ahead by default
+	QFuture<SatellitePredictor::Result> future = SatellitePredictor::predict(getPredictionTargets(true), getPredictionLocation(),
+										currentJD - 1., currentJD + getIridiumFlaresPredictionDepth(),
+										false, true);
+	future.waitForFinished();
+	return toIridiumFlaresPredictionList(future.results());
+}
 
-				i.value().v = flareFound ?  17 : v; // block extra report
-				i.value().altitude = pos.latitude();
-				i.value().azimuth = M_PI - pos.longitude();
-				i.value().angleToSun = i.key().data()->sunReflAngle;
+bool Satellites::isPredictionRunning() const
+{
+	return flaresWatcher.isRunning() || passesWatcher.isRunning();
+}
 
+void Satellites::startIridiumFlaresPrediction()
+{
+	if (flaresWatcher.isRunning())
+		return;
+	double currentJD = StelApp::getInstance().getCore()->getJD();
+	flaresWatcher.setFuture(SatellitePredictor::predict(getPredictionTargets(true), getPredictionLocation(),
+							    currentJD - 1., currentJD + getIridiumFlaresPredictionDepth(),
+							    false, true));
+}
 
+void Satellites::iridiumFlaresPredictionFinished()
+{
+	emit iridiumFlaresPredicted(toIridiumFlaresPredictionList(flaresWatcher.future().results()));
+}
 
+void Satellites::startPassesPrediction(const QStringList& ids, double days)
+{
+	if (passesWatcher.isRunning())
+		return;
+	double currentJD = StelApp::getInstance().getCore()->getJD();
+	passesWatcher.setFuture(SatellitePredictor::predict(getPredictionTargets(false, ids), getPredictionLocation(),
+							    currentJD, currentJD + days, true, false));
+}
 
-				double t;
-				if (flareFound)
-					t = 1./24;
-				else
-				if (i.value().altitude<0)
-					t = qMax((-i.value().altitude)*57,1.) / 5600;
-				else
-				if (i.value().angleToSun>0)
-					t = qMax(i.value().angleToSun,1.) / (4*86400);
-				else
-				{
-					//qDebug() << "IRIDIUM warn2: alt, angleToSun = " <<i.value().altitude << i.value().angleToSun;
-					t = 0.25/1440; // we should never be here, but assuming 1/4 minute to leave this
-				}
-				i.value().nextJD = predictionJD + t;
-				if (nextJD>i.value().nextJD)
-					nextJD = i.value().nextJD;
-			}
-			++i;
-		}
-		predictionJD = nextJD;
-	}
+static bool passLessThan(const SatellitePredictor::Pass& p1, const SatellitePredictor::Pass& p2)
+{
+	return p1.riseJD < p2.riseJD;
+}
 
-	//Satellite::timeShift = 0.;
-	if (isTimeNow)
-		pcore->setTimeNow();
-	else
-		pcore->setJD(currentJD);
+void Satellites::passesPredictionFinished()
+{
+	QList<SatellitePredictor::Pass> passes;
+	foreach(const SatellitePredictor::Result& result, passesWatcher.future().results())
+		passes.append(result.passes);
+	qSort(passes.begin(), passes.end(), passLessThan);
 
-	return predictions;
+	StelCore* pcore = StelApp::getInstance().getCore();
+	predictedPasses.clear();
+	foreach(const SatellitePredictor::Pass& pass, passes)
+	{
+		QVariantMap map;
+		map.insert("id", pass.id);
+		map.insert("name", pass.satellite);
+		map.insert("rise", StelUtils::julianDayToISO8601String(pass.riseJD + pcore->getUTCOffset(pass.riseJD)/24.));
+		map.insert("rise-azimuth", pass.riseAzimuth*180./M_PI);
+		map.insert("culmination", StelUtils::julianDayToISO8601String(pass.culminationJD + pcore->getUTCOffset(pass.culminationJD)/24.));
+		map.insert("culmination-altitude", pass.culminationAltitude*180./M_PI);
+		map.insert("culmination-azimuth", pass.culminationAzimuth*180./M_PI);
+		map.insert("set", StelUtils::julianDayToISO8601String(pass.setJD + pcore->getUTCOffset(pass.setJD)/24.));
+		map.insert("set-azimuth", pass.setAzimuth*180./M_PI);
+		map.insert("visible", pass.visible);
+		predictedPasses.append(map);
+	}
+	emit passesPredicted();
 }
-#endif
 
 
 void Satellites::translations()
@@ -22,12 +22,15 @@
 
 #include "StelObjectModule.hpp"
 #include "Satellite.hpp"
+#include "SatellitePropagator.hpp"
+#include "SatellitePredictor.hpp"
 #include "StelFader.hpp"
 #include "StelGui.hpp"
 #include "StelDialog.hpp"
 #include "StelLocation.hpp"
 
 #include <QDateTime>
+#include <QFutureWatcher>
 #include <QFile>
 #include <QDir>
 #include <QUrl>
@@ -42,6 +45,7 @@ class QTimer;
 
 class SatellitesDialog;
 class SatellitesListModel;
+class StelPluginCatalog;
 
 /*! @defgroup satellites Satellites Plug-in
 @{
@@ -197,6 +201,10 @@ public:
 	virtual void draw(StelCore* core);
 	virtual void drawPointer(StelCore* core, StelPainter& painter);
 	virtual double getCallOrder(StelModuleActionName actionName) const;
+	//! The propagation of the satellites runs in a worker thread.
+	virtual bool isUpdateConcurrent() const {return true;}
+	//! The Sun position is needed to know whether satellites are lit.
+	virtual QStringList getUpdateReads() const {return QStringList("SolarSystem");}
 
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in StelObjectManager class
@@ -375,7 +383,13 @@ public:
 	//! Get depth of prediction for Iridium flares
 	int getIridiumFlaresPredictionDepth(void) const { return iridiumFlaresPredictionDepth; }
 
+	//! Predict the Iridium flares for the current location, from one day before
+	//! the current date to the prediction depth. Blocks until done.
+	//! @see startIridiumFlaresPrediction()
 	IridiumFlaresPredictionList getIridiumFlaresPrediction();
+	//! Whether a prediction started with startIridiumFlaresPrediction()
+	//! or startPassesPrediction() is still running.
+	bool isPredictionRunning() const;
 
 signals:
 	void hintsVisibleChanged(bool b);
@@ -400,6 +414,12 @@ signals:
 	//! update source(s) (and were removed, if autoRemoveEnabled is set).
 	void tleUpdateComplete(int updated, int total, int added, int missing);
 
+	//! Emitted when a prediction started with startIridiumFlaresPrediction() is done.
+	void iridiumFlaresPredicted(const IridiumFlaresPredictionList& predictions);
+	//! Emitted when a prediction started with startPassesPrediction() is done.
+	//! @see getPredictedPasses()
+	void passesPredicted();
+
 public slots:
 	// FIXME: Put back the getter functions - for scripts? --BM
 	
@@ -472,7 +492,24 @@ public slots:
 	//! @param depth in days
 	void setIridiumFlaresPredictionDepth(int depth) { iridiumFlaresPredictionDepth=depth; }
 
+	//! Start the prediction of Iridium flares in the background.
+	//! The time, location and depth are those of the moment of the call.
+	//! Emits iridiumFlaresPredicted() when done.
+	void startIridiumFlaresPrediction();
+	//! Start the prediction of the passes of some satellites in the background.
+	//! Emits passesPredicted() when done.
+	//! @param ids catalog numbers of the satellites, all displayed satellites if empty
+	//! @param days length of the prediction from the current date
+	void startPassesPrediction(const QStringList& ids = QStringList(), double days = 1.);
+	//! The passes found by the last startPassesPrediction(), sorted by date.
+	//! Each pass is a map with the keys "id", "name", "rise", "culmination", "set"
+	//! (local dates as ISO 8601 strings, like the flares), "rise-azimuth", "culmination-altitude",
+	//! "culmination-azimuth", "set-azimuth" (degrees) and "visible".
+	QVariantList getPredictedPasses() const { return predictedPasses; }
+
 private slots:
+	void iridiumFlaresPredictionFinished();
+	void passesPredictionFinished();
 
 private:
 	//! Add to the current collection the satellite described by the data.
@@ -507,11 +544,8 @@ private:
 	//! If no path is specified, catalogPath is used.
 	//! @see createDataMap()
 	bool saveDataMap(const QVariantMap& map, QString path=QString());
-	//! Load a structure representing a satellite catalog from a JSON file.
-	//! If no path is specified, catalogPath is used.
-	QVariantMap loadDataMap(QString path=QString());
-	//! Parse a satellite catalog structure into internal satellite data.
-	void setDataMap(const QVariantMap& map);
+	//! Parse a satellite catalog into internal satellite data.
+	void setCatalog(const StelPluginCatalog& catalog);
 	//! Make a satellite catalog structure from current satellite data.
 	//! @return a representation of a JSON file.
 	QVariantMap createDataMap();
@@ -542,6 +576,12 @@ private:
 	QList<SatelliteP> satellites;
 	SatellitesListModel* satelliteListModel;
 
+	//! Propagates all satellites in update(). The satellites have the same
+	//! indices as in the satellites list.
+	SatellitePropagator propagator;
+	//! Set whenever the satellites list or the TLE elements change.
+	bool propagatorNeedsRebuild;
+
 	QHash<QString, double> qsMagList;
 	
 	//! Union of the groups used by all loaded satellites - see @ref groups.
@@ -604,6 +644,17 @@ private:
 
 	int iridiumFlaresPredictionDepth;
 
+	//! @name Predictions
+	//@{
+	SatellitePredictor::Location getPredictionLocation() const;
+	//! Iridium satellites if iridiumOnly, else the displayed satellites or those of ids.
+	QList<SatellitePredictor::Target> getPredictionTargets(bool iridiumOnly, const QStringList& ids = QStringList()) const;
+	IridiumFlaresPredictionList toIridiumFlaresPredictionList(const QList<SatellitePredictor::Result>& results) const;
+	QFutureWatcher<SatellitePredictor::Result> flaresWatcher;
+	QFutureWatcher<SatellitePredictor::Result> passesWatcher;
+	QVariantList predictedPasses;
+	//@}
+
 	// GUI
 	SatellitesDialog* configDialog;
 
@@ -32,6 +32,7 @@
 #include "gsatellite/mathUtils.hpp"
 
 #include "gSatWrapper.hpp"
+#include "SatellitePropagator.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "StelUtils.hpp"
@@ -130,31 +131,18 @@ void gSatWrapper::calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_velocity
 	if (epoch != lastCalcObserverECIPosition)
 	{
 		StelLocation loc   = StelApp::getInstance().getCore()->getCurrentLocation();
-
-		double radLatitude = loc.latitude * KDEG2RAD;
-		double theta       = epoch.toThetaLMST(loc.longitude * KDEG2RAD);
-		double r;
-		double c,sq;
-
-		/* Reference:  Explanatory supplement to the Astronomical Almanac 1992, page 209-210. */
-		/* Elipsoid earth model*/
-		/* c = Nlat/a */
-		c = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(sin(radLatitude)));
-		sq = Sqr(1 - __f)*c;
-
-		r = (KEARTHRADIUS*c + (loc.altitude/1000))*cos(radLatitude);
-		ao_position[0] = r * cos(theta);/*kilometers*/
-		ao_position[1] = r * sin(theta);
-		ao_position[2] = (KEARTHRADIUS*sq + (loc.altitude/1000))*sin(radLatitude);
-		ao_velocity[0] = -KMFACTOR*ao_position[1];/*kilometers/second*/
-		ao_velocity[1] =  KMFACTOR*ao_position[0];
-		ao_velocity[2] =  0;
-
+		SatellitePropagator::computeObserverECIPosition(epoch.getGmtTm(), loc.latitude, loc.longitude, loc.altitude,
+								ao_position, ao_velocity);
 		lastCalcObserverECIPosition=epoch;
 	}
 }
 
-
+void gSatWrapper::getObserverECIPosition(Vec3d& ao_position, Vec3d& ao_vel)
+{
+	calcObserverECIPosition(observerECIPos, observerECIVel);
+	ao_position = observerECIPos;
+	ao_vel = observerECIVel;
+}
 
 Vec3d gSatWrapper::getAltAz() const
 {
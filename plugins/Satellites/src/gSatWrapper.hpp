@@ -120,6 +120,21 @@ public:
 	double getPhaseAngle() const;
 	gTime	getEpoch() const { return epoch; }
 
+	//! @brief Get the SGP4 element set of the wrapped satellite.
+	const elsetrec& getElements() const { return pSatellite->getElements(); }
+
+	// Operation setSharedEpoch
+	//! @brief Set the epoch used for the observer and Sun positions of all
+	//! wrappers, without propagating a satellite.
+	//! Used together with the batch propagator.
+	static void setSharedEpoch(double ai_julianDaysEpoch) { epoch = ai_julianDaysEpoch; }
+
+	// Operation getObserverECIPosition
+	//! @brief Get the (cached) observer ECI position and velocity for the shared epoch.
+	//! @param[out] ao_position Observer ECI position vector measured in Km
+	//! @param[out] ao_vel Observer ECI velocity vector measured in Km/s
+	static void getObserverECIPosition(Vec3d& ao_position, Vec3d& ao_vel);
+
 
 //private:
         // Operation calcObserverECIPosition
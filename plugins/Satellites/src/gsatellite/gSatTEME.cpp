@@ -127,35 +127,42 @@ void gSatTEME::setMinSinceKepEpoch(double ai_minSinceKepEpoch)
 
 gVector gSatTEME::computeSubPoint(gTime ai_Time)
 {
-
 	gVector resultVector(3); // (0) Latitude, (1) Longitude, (2) altitude
+	double position[3] = { m_Position[0], m_Position[1], m_Position[2] };
+	double subPoint[3];
+	computeSubPoint(position, ai_Time.toThetaGMST(), subPoint);
+	resultVector[ LATITUDE]  = subPoint[ LATITUDE];
+	resultVector[ LONGITUDE] = subPoint[ LONGITUDE];
+	resultVector[ ALTITUDE]  = subPoint[ ALTITUDE];
+	return resultVector;
+}
+
+void gSatTEME::computeSubPoint(const double ai_position[3], double ai_thetaGMST, double ao_subPoint[3])
+{
 	double theta, r, e2, phi, c;
 
-	theta = AcTan(m_Position[1], m_Position[0]); // radians
-	resultVector[ LONGITUDE] = fmod((theta - ai_Time.toThetaGMST()), K2PI);  //radians
+	theta = AcTan(ai_position[1], ai_position[0]); // radians
+	ao_subPoint[ LONGITUDE] = fmod((theta - ai_thetaGMST), K2PI);  //radians
 
 
-	r = std::sqrt(Sqr(m_Position[0]) + Sqr(m_Position[1]));
+	r = std::sqrt(Sqr(ai_position[0]) + Sqr(ai_position[1]));
 	e2 = __f*(2 - __f);
-	resultVector[ LATITUDE] = AcTan(m_Position[2],r); /*radians*/
+	ao_subPoint[ LATITUDE] = AcTan(ai_position[2],r); /*radians*/
 
 	do
 	{
-		phi = resultVector[ LATITUDE];
+		phi = ao_subPoint[ LATITUDE];
 		c = 1/std::sqrt(1 - e2*Sqr(sin(phi)));
-		resultVector[ LATITUDE] = AcTan(m_Position[2] + KEARTHRADIUS*c*e2*sin(phi),r);
+		ao_subPoint[ LATITUDE] = AcTan(ai_position[2] + KEARTHRADIUS*c*e2*sin(phi),r);
 	}
-	while(fabs(resultVector[ LATITUDE] - phi) >= 1E-10);
-
-	resultVector[ ALTITUDE] = r/cos(resultVector[ LATITUDE]) - KEARTHRADIUS*c;/*kilometers*/
+	while(fabs(ao_subPoint[ LATITUDE] - phi) >= 1E-10);
 
-	if(resultVector[ LATITUDE] > (KPI/2.0)) resultVector[ LATITUDE] -= K2PI;
+	ao_subPoint[ ALTITUDE] = r/cos(ao_subPoint[ LATITUDE]) - KEARTHRADIUS*c;/*kilometers*/
 
-	resultVector[LATITUDE]  = resultVector[LATITUDE]/KDEG2RAD;
-	resultVector[LONGITUDE] = resultVector[LONGITUDE]/KDEG2RAD;
-	if(resultVector[LONGITUDE] < -180.0) resultVector[LONGITUDE] +=360;
-	else if(resultVector[LONGITUDE] > 180.0) resultVector[LONGITUDE] -= 360;
+	if(ao_subPoint[ LATITUDE] > (KPI/2.0)) ao_subPoint[ LATITUDE] -= K2PI;
 
-
-	return resultVector;
+	ao_subPoint[LATITUDE]  = ao_subPoint[LATITUDE]/KDEG2RAD;
+	ao_subPoint[LONGITUDE] = ao_subPoint[LONGITUDE]/KDEG2RAD;
+	if(ao_subPoint[LONGITUDE] < -180.0) ao_subPoint[LONGITUDE] +=360;
+	else if(ao_subPoint[LONGITUDE] > 180.0) ao_subPoint[LONGITUDE] -= 360;
 }
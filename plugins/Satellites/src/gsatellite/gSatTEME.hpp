@@ -129,6 +129,21 @@ public:
 		return satrec.error;
 	}
 
+	// Operation: getElements()
+	//! @brief Get the SGP4 element set as initialized from the TLE data.
+	//! @details Used by batch propagators which keep their own copy of the elements.
+	const elsetrec& getElements() const
+	{
+		return satrec;
+	}
+
+	// Operation:  computeSubPoint
+	//! @brief Compute the Geographic subpoint of a TEME position
+	//! @param[in] ai_position TEME position measured in Km.
+	//! @param[in] ai_thetaGMST Greenwich Mean Sidereal Time of the position, in radians.
+	//! @param[out] ao_subPoint Latitude (degrees), Longitude (degrees), Altitude (Km)
+	static void computeSubPoint(const double ai_position[3], double ai_thetaGMST, double ao_subPoint[3]);
+
 private:
 	// Operation:  computeSubPoint
 	//! @brief Compute the Geographic satellite subpoint Vector
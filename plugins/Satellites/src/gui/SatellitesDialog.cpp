@@ -234,6 +234,7 @@ void SatellitesDialog::createDialogContent()
 	ui->flaresPredictionDepthSpinBox->setValue(plugin->getIridiumFlaresPredictionDepth());
 	connect(ui->flaresPredictionDepthSpinBox, SIGNAL(valueChanged(int)), plugin, SLOT(setIridiumFlaresPredictionDepth(int)));
 	connect(ui->predictIridiumFlaresPushButton, SIGNAL(clicked()), this, SLOT(predictIridiumFlares()));
+	connect(plugin, SIGNAL(iridiumFlaresPredicted(IridiumFlaresPredictionList)), this, SLOT(showIridiumFlares(IridiumFlaresPredictionList)));
 	connect(ui->predictedIridiumFlaresSaveButton, SIGNAL(clicked()), this, SLOT(savePredictedIridiumFlares()));
 	connect(ui->iridiumFlaresTreeWidget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentIridiumFlare(QModelIndex)));
 }
@@ -1015,8 +1016,13 @@ void SatellitesDialog::initListIridiumFlares()
 
 void SatellitesDialog::predictIridiumFlares()
 {
-	IridiumFlaresPredictionList predictions = GETSTELMODULE(Satellites)->getIridiumFlaresPrediction();
+	ui->predictIridiumFlaresPushButton->setEnabled(false);
+	GETSTELMODULE(Satellites)->startIridiumFlaresPrediction();
+}
 
+void SatellitesDialog::showIridiumFlares(const IridiumFlaresPredictionList& predictions)
+{
+	ui->predictIridiumFlaresPushButton->setEnabled(true);
 	ui->iridiumFlaresTreeWidget->clear();
 	foreach (const IridiumFlaresPrediction& flare, predictions)
 	{
@@ -109,7 +109,10 @@ private slots:
 	void setOrbitParams(void);
 	void updateTLEs(void);
 
+	//! Start the prediction in the background. The list is filled
+	//! by showIridiumFlares() when it is done.
 	void predictIridiumFlares();
+	void showIridiumFlares(const IridiumFlaresPredictionList& predictions);
 	void selectCurrentIridiumFlare(const QModelIndex &modelIndex);
 	void savePredictedIridiumFlares();
 
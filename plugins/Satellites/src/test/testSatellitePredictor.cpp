@@ -0,0 +1,142 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testSatellitePredictor.hpp"
+#include "SatellitePredictor.hpp"
+#include "gsatellite/gSatTEME.hpp"
+
+#include <QByteArray>
+#include <QObject>
+#include <QTest>
+
+#include <cmath>
+
+QTEST_GUILESS_MAIN(TestSatellitePredictor)
+
+namespace
+{
+	const char* iss[2] = {
+		"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+		"2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537" };
+
+	SatellitePredictor::Target makeTarget()
+	{
+		QByteArray t1(iss[0]), t2(iss[1]);
+		gSatTEME sat("ISS", t1.data(), t2.data());
+		SatellitePredictor::Target target;
+		target.id = "25544";
+		target.name = "ISS";
+		target.elements = sat.getElements();
+		target.stdMag = -0.5f;
+		target.iridium = false;
+		return target;
+	}
+
+	SatellitePredictor::Request makeRequest(double days)
+	{
+		SatellitePredictor::Request request;
+		request.target = makeTarget();
+		request.location.latitude = 48.;
+		request.location.longitude = 11.;
+		request.location.altitude = 500.;
+		request.startJD = request.target.elements.jdsatepoch;
+		request.endJD = request.startJD + days;
+		request.passes = true;
+		request.flares = false;
+		return request;
+	}
+}
+
+void TestSatellitePredictor::testSunPosition()
+{
+	// J2000.0: RA 18h45m09s, Dec -23°02' (apparent, within the precision of the formula)
+	Vec3d sun = SatellitePredictor::computeSunECIPosition(2451545.0);
+	double ra = std::atan2(sun[1], sun[0]) * 180./M_PI + 360.;
+	double dec = std::asin(sun[2]/sun.length()) * 180./M_PI;
+	QVERIFY(qAbs(ra - 281.29) < 0.05);
+	QVERIFY(qAbs(dec + 23.03) < 0.05);
+	QVERIFY(qAbs(sun.length()/1.4959787066E8 - 0.9833) < 0.001);
+}
+
+void TestSatellitePredictor::testFlareModel()
+{
+	// The piecewise model is continuous and increasing.
+	const double eps = 1e-9;
+	QVERIFY(qAbs(SatellitePredictor::computeIridiumFlareMagnitude(0.5-eps) - SatellitePredictor::computeIridiumFlareMagnitude(0.5)) < 1e-6);
+	QVERIFY(qAbs(SatellitePredictor::computeIridiumFlareMagnitude(0.7-eps) - SatellitePredictor::computeIridiumFlareMagnitude(0.7)) < 1e-6);
+	QVERIFY(SatellitePredictor::computeIridiumFlareMagnitude(0.) < SatellitePredictor::computeIridiumFlareMagnitude(1.));
+	QCOMPARE(SatellitePredictor::computeIridiumFlareMagnitude(0.), -8.92);
+}
+
+void TestSatellitePredictor::testPasses()
+{
+	const SatellitePredictor::Request request = makeRequest(3.);
+	const SatellitePredictor::Result result = SatellitePredictor::predictTarget(request);
+
+	// The ISS passes over mid-latitudes several times per day.
+	QVERIFY(result.passes.size() >= 6);
+	QVERIFY(result.flares.isEmpty());
+	double lastSet = request.startJD;
+	foreach (const SatellitePredictor::Pass& pass, result.passes)
+	{
+		QCOMPARE(pass.id, QString("25544"));
+		QVERIFY(pass.riseJD > lastSet);
+		QVERIFY(pass.riseJD <= request.endJD);
+		QVERIFY(pass.riseJD < pass.culminationJD);
+		QVERIFY(pass.culminationJD < pass.setJD);
+		// a low orbit, so a pass lasts less than a quarter of an hour
+		QVERIFY(pass.setJD - pass.riseJD < 15./1440.);
+		QVERIFY(pass.culminationAltitude > 0.);
+		QVERIFY(pass.culminationAltitude <= M_PI_2);
+		QVERIFY(pass.riseAzimuth >= 0. && pass.riseAzimuth < 2.*M_PI);
+		QVERIFY(pass.setAzimuth >= 0. && pass.setAzimuth < 2.*M_PI);
+		lastSet = pass.setJD;
+	}
+}
+
+void TestSatellitePredictor::testConcurrentPrediction()
+{
+	const SatellitePredictor::Request request = makeRequest(1.);
+	const SatellitePredictor::Result direct = SatellitePredictor::predictTarget(request);
+
+	QList<SatellitePredictor::Target> targets;
+	for (int i=0; i<8; ++i)
+		targets << request.target;
+	QFuture<SatellitePredictor::Result> future = SatellitePredictor::predict(targets, request.location,
+										request.startJD, request.endJD, true, false);
+	future.waitForFinished();
+	QCOMPARE(future.resultCount(), targets.size());
+	foreach (const SatellitePredictor::Result& result, future.results())
+	{
+		QCOMPARE(result.passes.size(), direct.passes.size());
+		for (int i=0; i<result.passes.size(); ++i)
+		{
+			QCOMPARE(result.passes.at(i).riseJD, direct.passes.at(i).riseJD);
+			QCOMPARE(result.passes.at(i).setJD, direct.passes.at(i).setJD);
+		}
+	}
+}
+
+void TestSatellitePredictor::benchmarkPasses()
+{
+	const SatellitePredictor::Request request = makeRequest(7.);
+	QBENCHMARK
+	{
+		SatellitePredictor::predictTarget(request);
+	}
+}
@@ -0,0 +1,161 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testSatellitePropagator.hpp"
+#include "SatellitePropagator.hpp"
+#include "gsatellite/gSatTEME.hpp"
+
+#include <QByteArray>
+#include <QObject>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TestSatellitePropagator)
+
+namespace
+{
+	// near-earth, simple drag model (isimp=0)
+	const char* vanguard[2] = {
+		"1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+		"2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667" };
+	// deep-space (half-day resonance)
+	const char* navstar[2] = {
+		"1 28129U 03058A   06175.57071136 -.00000104  00000-0  10000-3 0   459",
+		"2 28129  54.7298 324.8098 0048506 266.2640  93.1663  2.00562768 18918" };
+
+	gSatTEME* makeSatellite(const char* tle[2])
+	{
+		QByteArray t1(tle[0]), t2(tle[1]);
+		return new gSatTEME("test", t1.data(), t2.data());
+	}
+
+	SatellitePropagator::Observer makeObserver(double jd)
+	{
+		SatellitePropagator::Observer observer;
+		observer.jd = jd;
+		observer.latitude = 48.;
+		observer.longitude = 11.;
+		observer.eciPosition.set(0., 0., 0.);
+		observer.eciVelocity.set(0., 0., 0.);
+		observer.sunECIPosition.set(1.5e8, 0., 0.);
+		observer.sunAboveHorizon = false;
+		return observer;
+	}
+
+	// An observer on the ground, whose ECI position matches its latitude and longitude
+	SatellitePropagator::Observer makeObserverAt(double jd, double latitude, double longitude)
+	{
+		SatellitePropagator::Observer observer = makeObserver(jd);
+		observer.latitude = latitude;
+		observer.longitude = longitude;
+		SatellitePropagator::computeObserverECIPosition(jd, latitude, longitude, 0., observer.eciPosition, observer.eciVelocity);
+		return observer;
+	}
+}
+
+void TestSatellitePropagator::testAgainstScalarSgp4_data()
+{
+	QTest::addColumn<bool>("deepSpace");
+	QTest::addColumn<double>("daysFromEpoch");
+	QTest::newRow("near-earth at epoch") << false << 0.;
+	QTest::newRow("near-earth +3d") << false << 3.2;
+	QTest::newRow("near-earth -10d") << false << -10.7;
+	QTest::newRow("deep-space at epoch") << true << 0.;
+	QTest::newRow("deep-space +5d") << true << 5.5;
+}
+
+void TestSatellitePropagator::testAgainstScalarSgp4()
+{
+	QFETCH(bool, deepSpace);
+	QFETCH(double, daysFromEpoch);
+
+	QScopedPointer<gSatTEME> sat(makeSatellite(deepSpace ? navstar : vanguard));
+	SatellitePropagator propagator;
+	const int index = propagator.addSatellite(sat->getElements());
+	const double jd = sat->getElements().jdsatepoch + daysFromEpoch;
+
+	sat->setEpoch(jd);
+	propagator.propagate(makeObserver(jd));
+	const SatellitePropagator::State& state = propagator.getState(index);
+	QCOMPARE(state.error, 0);
+	gVector pos = sat->getPos();
+	gVector vel = sat->getVel();
+	gVector subPoint = sat->getSubPoint();
+	for (int i=0; i<3; ++i)
+	{
+		QVERIFY(qAbs(state.position[i]-pos[i]) < 1e-6);
+		QVERIFY(qAbs(state.velocity[i]-vel[i]) < 1e-9);
+		QVERIFY(qAbs(state.subPoint[i]-subPoint[i]) < 1e-6);
+	}
+}
+
+void TestSatellitePropagator::testInactive()
+{
+	QScopedPointer<gSatTEME> sat(makeSatellite(vanguard));
+	SatellitePropagator propagator;
+	const int index = propagator.addSatellite(sat->getElements());
+	const double jd = sat->getElements().jdsatepoch;
+	propagator.propagate(makeObserver(jd));
+	const Vec3d first = propagator.getState(index).position;
+
+	propagator.setActive(index, false);
+	propagator.propagate(makeObserver(jd+0.1));
+	QVERIFY(propagator.getState(index).position == first);
+
+	propagator.setActive(index, true);
+	propagator.propagate(makeObserver(jd+0.1));
+	QVERIFY(!(propagator.getState(index).position == first));
+}
+
+void TestSatellitePropagator::testBelowHorizon()
+{
+	QScopedPointer<gSatTEME> sat(makeSatellite(vanguard));
+	SatellitePropagator propagator;
+	const int index = propagator.addSatellite(sat->getElements());
+	const double jd = sat->getElements().jdsatepoch;
+
+	propagator.propagate(makeObserver(jd));
+	const Vec3d subPoint = propagator.getState(index).subPoint;
+
+	// Seen from its subpoint, the satellite is close to the zenith.
+	propagator.propagate(makeObserverAt(jd, subPoint[0], subPoint[1]));
+	const SatellitePropagator::State& above = propagator.getState(index);
+	QVERIFY(above.altAz[2] > 0.99*above.range);
+	QVERIFY(above.visibility != gSatWrapper::NOT_VISIBLE);
+
+	// An observer at the antipode of the subpoint never sees the satellite.
+	propagator.propagate(makeObserverAt(jd, -subPoint[0], subPoint[1] > 0. ? subPoint[1]-180. : subPoint[1]+180.));
+	const SatellitePropagator::State& below = propagator.getState(index);
+	QVERIFY(below.altAz[2] < 0.);
+	QCOMPARE(below.visibility, gSatWrapper::NOT_VISIBLE);
+}
+
+void TestSatellitePropagator::benchmarkPropagate()
+{
+	QScopedPointer<gSatTEME> nearEarth(makeSatellite(vanguard));
+	QScopedPointer<gSatTEME> deepSpace(makeSatellite(navstar));
+	SatellitePropagator propagator;
+	// About the size of the full public catalog, 10% of it in deep space.
+	for (int i=0; i<20000; ++i)
+		propagator.addSatellite(i%10 ? nearEarth->getElements() : deepSpace->getElements());
+	double jd = nearEarth->getElements().jdsatepoch;
+	QBENCHMARK
+	{
+		jd += 1./86400.;
+		propagator.propagate(makeObserver(jd));
+	}
+}
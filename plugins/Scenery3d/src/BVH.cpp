@@ -0,0 +1,209 @@
+/*
+ * Stellarium Scenery3d Plug-in
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "BVH.hpp"
+
+#include <QVarLengthArray>
+#include <algorithm>
+
+namespace
+{
+//! Orders item indices by the given coordinate of their box center
+struct CenterLess
+{
+	CenterLess(const QVector<Vec3f>& centers, int axis) : centers(centers), axis(axis) {}
+	bool operator()(int a, int b) const { return centers.at(a)[axis] < centers.at(b)[axis]; }
+	const QVector<Vec3f>& centers;
+	int axis;
+};
+
+//! Unlike AABBox::isValid, this also accepts flat boxes (e.g. of a single ground quad)
+bool isEmptyBox(const AABBox& box)
+{
+	return box.min[0] > box.max[0] || box.min[1] > box.max[1] || box.min[2] > box.max[2];
+}
+}
+
+void BVH::clear()
+{
+	nodes.clear();
+	items.clear();
+	itemBoxes.clear();
+	itemCount = 0;
+}
+
+void BVH::build(const QVector<AABBox>& boxes)
+{
+	clear();
+	itemCount = boxes.size();
+
+	QVector<Vec3f> centers(boxes.size());
+	for(int i = 0; i<boxes.size(); ++i)
+	{
+		const AABBox& box = boxes.at(i);
+		if(isEmptyBox(box))
+			continue;
+		centers[i] = (box.min + box.max) * 0.5f;
+		items.append(i);
+	}
+
+	if(items.isEmpty())
+		return;
+
+	//a balanced binary tree has less than 2 nodes per leaf
+	nodes.reserve(2 * (items.size() / maxLeafItems + 1));
+	buildNode(0, items.size(), boxes, centers);
+	nodes.squeeze();
+
+	//the leaves test the boxes of their items, in the same order as the items
+	itemBoxes.resize(items.size());
+	for(int i = 0; i<items.size(); ++i)
+		itemBoxes[i] = boxes.at(items.at(i));
+}
+
+int BVH::buildNode(int first, int count, const QVector<AABBox>& boxes, const QVector<Vec3f>& centers)
+{
+	const int index = nodes.size();
+	nodes.append(Node());
+
+	AABBox box;
+	AABBox centerBox;
+	for(int i = first; i<first+count; ++i)
+	{
+		box.expand(boxes.at(items.at(i)));
+		centerBox.expand(centers.at(items.at(i)));
+	}
+
+	int secondChild = -1;
+	if(count > maxLeafItems)
+	{
+		const Vec3f extent = centerBox.max - centerBox.min;
+		int axis = 0;
+		if(extent[1] > extent[axis])
+			axis = 1;
+		if(extent[2] > extent[axis])
+			axis = 2;
+
+		const int half = count / 2;
+		std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count, CenterLess(centers, axis));
+
+		//the first child is the next node
+		buildNode(first, half, boxes, centers);
+		secondChild = buildNode(first + half, count - half, boxes, centers);
+	}
+
+	//the vector may have been reallocated by the children
+	Node& node = nodes[index];
+	node.box = box;
+	node.secondChild = secondChild;
+	node.firstItem = first;
+	node.count = count;
+	return index;
+}
+
+int BVH::cull(const QMatrix4x4 &mvp, QVector<bool> &visible) const
+{
+	visible.fill(false, itemCount);
+	if(nodes.isEmpty())
+		return itemCount;
+
+	//the clip volume planes (-w <= x,y,z <= w), pointing inwards
+	QVector4D planes[6];
+	const QVector4D rowW = mvp.row(3);
+	for(int i = 0; i<3; ++i)
+	{
+		const QVector4D row = mvp.row(i);
+		planes[2*i] = rowW + row;
+		planes[2*i+1] = rowW - row;
+	}
+
+	//the stack holds node indices and the mask of the planes the node may still intersect
+	QVarLengthArray<QPair<int,int>, 64> stack;
+	stack.append(qMakePair(0, (1<<6) - 1));
+	int visibleCount = 0;
+
+	while(!stack.isEmpty())
+	{
+		const QPair<int,int> entry = stack.last();
+		stack.removeLast();
+		const Node& node = nodes.at(entry.first);
+		const int mask = clipMask(node.box, planes, entry.second);
+
+		if(mask < 0)
+			continue;
+
+		if(mask == 0)
+		{
+			//completely inside, no need to test the items
+			for(int i = node.firstItem; i<node.firstItem+node.count; ++i)
+				visible[items.at(i)] = true;
+			visibleCount += node.count;
+		}
+		else if(node.secondChild < 0)
+		{
+			for(int i = node.firstItem; i<node.firstItem+node.count; ++i)
+			{
+				if(clipMask(itemBoxes.at(i), planes, mask) >= 0)
+				{
+					visible[items.at(i)] = true;
+					++visibleCount;
+				}
+			}
+		}
+		else
+		{
+			stack.append(qMakePair(node.secondChild, mask));
+			stack.append(qMakePair(entry.first + 1, mask));
+		}
+	}
+
+	return itemCount - visibleCount;
+}
+
+int BVH::clipMask(const AABBox &box, const QVector4D* planes, int mask)
+{
+	for(int p = 0; p<6; ++p)
+	{
+		if(!(mask & (1<<p)))
+			continue;
+
+		//the distances of the corners farthest along the plane normal and opposite to it
+		const QVector4D& plane = planes[p];
+		float maxDist = plane.w(), minDist = plane.w();
+		for(int k = 0; k<3; ++k)
+		{
+			const float n = plane[k];
+			if(n >= 0.0f)
+			{
+				maxDist += n * box.max[k];
+				minDist += n * box.min[k];
+			}
+			else
+			{
+				maxDist += n * box.min[k];
+				minDist += n * box.max[k];
+			}
+		}
+
+		if(maxDist < 0.0f)
+			return -1;
+		if(minDist >= 0.0f)
+			mask &= ~(1<<p);
+	}
+	return mask;
+}
@@ -0,0 +1,75 @@
+/*
+ * Stellarium Scenery3d Plug-in
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _BVH_HPP_
+#define _BVH_HPP_
+
+#include "GeomMath.hpp"
+
+#include <QMatrix4x4>
+#include <QVector>
+
+//! A bounding volume hierarchy over a list of axis-aligned boxes, used to find the
+//! parts of a scene inside a view volume without testing each of them.
+//! The hierarchy is built once (the boxes do not move), by splitting the boxes at
+//! the median of their centers along the longest axis.
+class BVH
+{
+public:
+	BVH() : itemCount(0) {}
+
+	//! Builds the hierarchy. The items are identified by their index in @p boxes.
+	//! Items with an empty box are never reported as visible.
+	void build(const QVector<AABBox>& boxes);
+	void clear();
+
+	//! The number of items given to build()
+	int getItemCount() const { return itemCount; }
+
+	//! Finds the items whose box intersects the clip volume of the given model-view-projection matrix.
+	//! Subtrees which are completely inside or outside of the volume are not descended into.
+	//! @param visible resized to the item count, and set to true for the items which may be visible
+	//! @return the number of items which are not visible
+	int cull(const QMatrix4x4& mvp, QVector<bool>& visible) const;
+
+private:
+	struct Node
+	{
+		AABBox box;
+		//! The first child directly follows its parent, this is the index of the second one (-1 for leaves)
+		int secondChild;
+		//! The range in the items array covered by this subtree
+		int firstItem;
+		int count;
+	};
+
+	int buildNode(int first, int count, const QVector<AABBox>& boxes, const QVector<Vec3f>& centers);
+	//! Tests the box against the planes selected by @p mask.
+	//! Returns -1 if the box is outside of one of them, else the mask of the planes the box intersects.
+	static int clipMask(const AABBox& box, const QVector4D* planes, int mask);
+
+	//! Leaves are not split further below this number of items
+	static const int maxLeafItems = 4;
+
+	QVector<Node> nodes;
+	QVector<int> items;
+	QVector<AABBox> itemBoxes;
+	int itemCount;
+};
+
+#endif // _BVH_HPP_
@@ -33,10 +33,21 @@ class GLExtFuncs : public QOpenGLFunctions_1_0
 public:
 	//! Since 3.2
 	PFNGLFRAMEBUFFERTEXTUREPROC glFramebufferTexture;
+	//! Occlusion queries, since 1.5
+	PFNGLGENQUERIESPROC glGenQueries;
+	PFNGLDELETEQUERIESPROC glDeleteQueries;
+	PFNGLBEGINQUERYPROC glBeginQuery;
+	PFNGLENDQUERYPROC glEndQuery;
+	PFNGLGETQUERYOBJECTUIVPROC glGetQueryObjectuiv;
 
 	void init(QOpenGLContext* ctx)
 	{
 		glFramebufferTexture = (PFNGLFRAMEBUFFERTEXTUREPROC)ctx->getProcAddress("glFramebufferTexture");
+		glGenQueries = (PFNGLGENQUERIESPROC)ctx->getProcAddress("glGenQueries");
+		glDeleteQueries = (PFNGLDELETEQUERIESPROC)ctx->getProcAddress("glDeleteQueries");
+		glBeginQuery = (PFNGLBEGINQUERYPROC)ctx->getProcAddress("glBeginQuery");
+		glEndQuery = (PFNGLENDQUERYPROC)ctx->getProcAddress("glEndQuery");
+		glGetQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVPROC)ctx->getProcAddress("glGetQueryObjectuiv");
 
 		if(!ctx->isOpenGLES())
 			initializeOpenGLFunctions();
@@ -24,6 +24,7 @@
 #include "VecMath.hpp"
 #include "GeomMath.hpp"
 
+#include <QDataStream>
 #include <QElapsedTimer>
 
 #define INF (std::numeric_limits<float>::max())
@@ -39,7 +40,7 @@ Heightmap::~Heightmap()
 	delete[] grid;
 }
 
-void Heightmap::setMeshData(const IdxList &indexList, const PosList &posList, const AABBox* bbox)
+void Heightmap::setMeshData(const IdxList &indexList, const PosList &posList, const AABBox* bbox, const QByteArray& gridData)
 {
 	this->indexList = indexList;
 	this->posList = posList;
@@ -70,10 +71,73 @@ void Heightmap::setMeshData(const IdxList &indexList, const PosList &posList, co
 	this->initQuadtree();
 	qDebug()<<"initQuadtree\t"<<qSetFieldWidth(12)<<right<<timer.nsecsElapsed();*/
 	timer.start();
+	if(!gridData.isEmpty() && this->restoreGrid(gridData))
+	{
+		qDebug()<<"restoreGrid\t\t"<<qSetFieldWidth(12)<<right<<timer.nsecsElapsed();
+		return;
+	}
 	this->initGrid();
 	qDebug()<<"initGrid\t\t"<<qSetFieldWidth(12)<<right<<timer.nsecsElapsed();
 }
 
+QByteArray Heightmap::getGridData() const
+{
+	QByteArray data;
+	if(!grid)
+		return data;
+
+	//the faces are stored as their number in the index list
+	QDataStream stream(&data, QIODevice::WriteOnly);
+	stream << qint32(GRID_LENGTH) << qint32(indexList.size());
+	for(int i = 0;i<GRID_LENGTH*GRID_LENGTH;++i)
+	{
+		const FaceVector& faces = grid[i].faces;
+		stream << qint32(faces.size());
+		for(int j = 0;j<faces.size();++j)
+		{
+			stream << qint32((faces.at(j) - indexList.constData()) / 3);
+		}
+	}
+	return data;
+}
+
+bool Heightmap::restoreGrid(const QByteArray &gridData)
+{
+	QDataStream stream(gridData);
+	qint32 length, indexCount;
+	stream >> length >> indexCount;
+	if(length!=GRID_LENGTH || indexCount!=indexList.size())
+		return false;
+
+	delete[] grid;
+	grid = new GridSpace[GRID_LENGTH*GRID_LENGTH];
+	const int faceCount = indexList.size() / 3;
+	bool ok = true;
+	for(int i = 0;ok && i<GRID_LENGTH*GRID_LENGTH;++i)
+	{
+		qint32 count;
+		stream >> count;
+		ok = stream.status()==QDataStream::Ok && count>=0 && count<=faceCount;
+		FaceVector& faces = grid[i].faces;
+		for(int j = 0;ok && j<count;++j)
+		{
+			qint32 face;
+			stream >> face;
+			ok = face>=0 && face<faceCount;
+			if(ok)
+				faces.push_back(&indexList.at(face*3));
+		}
+	}
+
+	if(!ok || stream.status()!=QDataStream::Ok)
+	{
+		delete[] grid;
+		grid = Q_NULLPTR;
+		return false;
+	}
+	return true;
+}
+
 /**
  * Returns the height of the ground model for any observer x/y coords.
  * The height is the highest z value of the ground model at these
@@ -38,7 +38,12 @@ public:
         virtual ~Heightmap();
 
 	//! Sets the mesh data to use. If the bbox is given, min/max calculation is skipped and its values are taken.
-	void setMeshData(const IdxList& indexList, const PosList& posList, const AABBox *bbox = Q_NULLPTR);
+	//! If gridData is given, the grid is restored from it instead of being calculated.
+	//! It must have been returned by getGridData() for the same mesh data.
+	void setMeshData(const IdxList& indexList, const PosList& posList, const AABBox *bbox = Q_NULLPTR, const QByteArray& gridData = QByteArray());
+
+	//! Returns the faces of each grid space in a compact form, for caching.
+	QByteArray getGridData() const;
 
         //! Get z Value at (x,y) coordinates.
         //! In case of ambiguities always returns the maximum height.
@@ -116,6 +121,8 @@ private:
 
 	void initQuadtree();
         void initGrid();
+	//! Restores the grid from getGridData(), returns false if gridData does not match the mesh data
+	bool restoreGrid(const QByteArray& gridData);
         GridSpace* getSpace(const float x, const float y) const ;
 	static bool triangle_intersects_bbox(const Vec2f &t1, const Vec2f &t2, const Vec2f &t3, const Vec2f &rMin, const Vec2f &rMax);
 	//! Check whether points p and q lie on the same side of line ab, helper for line_intersects_triangle
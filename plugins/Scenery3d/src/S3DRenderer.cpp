@@ -69,7 +69,7 @@ S3DRenderer::S3DRenderer(QObject *parent)
       QObject(parent),
       sun(Q_NULLPTR), moon(Q_NULLPTR), venus(Q_NULLPTR),
       currentScene(Q_NULLPTR),
-      supportsGSCubemapping(false), supportsShadows(false), supportsShadowFiltering(false), isANGLE(false), maximumFramebufferSize(0),
+      supportsGSCubemapping(false), supportsShadows(false), supportsShadowFiltering(false), supportsOcclusionQueries(false), isANGLE(false), maximumFramebufferSize(0),
       defaultFBO(-1),
       torchBrightness(0.5f), torchRange(5.0f), textEnabled(false), debugEnabled(false), fixShadowData(false),
       simpleShadows(false), fullCubemapShadows(false), cubemappingMode(S3DEnum::CM_TEXTURES), //set it to 6 textures as a safe default (Cubemap should work on ANGLE, but does not...)
@@ -77,13 +77,16 @@ S3DRenderer::S3DRenderer(QObject *parent)
       cubemapSize(1024),shadowmapSize(1024),wasMovedInLastDrawCall(false),
       core(Q_NULLPTR), landscapeMgr(Q_NULLPTR),
       backfaceCullState(true), blendEnabled(false), lastMaterial(Q_NULLPTR), curShader(Q_NULLPTR),
-      drawnTriangles(0), drawnModels(0), materialSwitches(0), shaderSwitches(0),
+      occlusionQueries(false), occlusionScene(Q_NULLPTR),
+      drawnTriangles(0), drawnModels(0), culledModels(0), occludedModels(0), materialSwitches(0), shaderSwitches(0),
       requiresCubemap(false), cubemappingUsedLastFrame(false),
       lazyDrawing(false), updateOnlyDominantOnMoving(true), updateSecondDominantOnMoving(true), needsMovementEndUpdate(false),
       needsCubemapUpdate(true), needsMovementUpdate(false), lazyInterval(2.0), lastCubemapUpdate(0.0), lastCubemapUpdateRealTime(0), lastMovementEndRealTime(0),
-      cubeMapCubeTex(0), cubeMapCubeDepth(0), cubeMapTex(), cubeRB(0), dominantFace(0), secondDominantFace(1), cubeFBO(0), cubeSideFBO(), cubeMappingCreated(false),
+      cubeMapCubeTex(0), cubeMapCubeDepth(0), cubeMapTex(), cubeRB(0), dominantFace(0), secondDominantFace(1), cubeFaceState(), cubeFaceVisible(), spreadCubemapUpdate(false), cubeFBO(0), cubeSideFBO(), cubeMappingCreated(false),
       cubeVertexBuffer(QOpenGLBuffer::VertexBuffer), transformedCubeVertexBuffer(QOpenGLBuffer::VertexBuffer), cubeIndexBuffer(QOpenGLBuffer::IndexBuffer), cubeIndexCount(0),
-      lightOrthoNear(0.1f), lightOrthoFar(1000.0f), parallaxScale(0.015f)
+      lightOrthoNear(0.1f), lightOrthoFar(1000.0f),
+      shadowMapsValid(false), lastShadowCaster(LightParameters::SC_None), lastShadowFov(0.0f), lastShadowAspect(0.0f), lastShadowScene(Q_NULLPTR),
+      parallaxScale(0.015f)
 {
 	#ifndef NDEBUG
 	qCDebug(s3drenderer)<<"Scenery3d constructor...";
@@ -91,6 +94,8 @@ S3DRenderer::S3DRenderer(QObject *parent)
 	//the arrays should all contain only zeroes
 	Q_ASSERT(cubeMapTex[0]==0);
 	Q_ASSERT(cubeSideFBO[0]==0);
+	//nothing has been rendered into the cube faces yet
+	std::fill(cubeFaceState, cubeFaceState + 6, CF_Invalid);
 
 	shaderParameters.openglES = false;
 	shaderParameters.shadowTransform = false;
@@ -121,6 +126,7 @@ S3DRenderer::~S3DRenderer()
 
 	deleteShadowmapping();
 	deleteCubemapping();
+	deleteOcclusionQueries();
 
 #ifndef QT_OPENGL_ES_2
 	//delete extension functions
@@ -283,7 +289,7 @@ bool zSortFunction(const StelOBJ::MaterialGroup* const & mLeft, const StelOBJ::M
 	return dist1>dist2;
 }
 
-bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive)
+bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive, bool occlusionCulling)
 {
 	//override some shader Params
 	renderShaderParameters = shaderParameters;
@@ -301,6 +307,22 @@ bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive)
 			break;
 	}
 
+	//skip the groups outside of the view volume
+	//the geometry shader renders all cube faces at once, so nothing can be culled there
+	if(shaderParameters.geometryShader)
+		visibleGroups.fill(true, currentScene->getMaterialGroupCount());
+	else
+		culledModels += currentScene->cullMaterialGroups(projectionMatrix * modelViewMatrix, visibleGroups);
+
+#ifndef QT_OPENGL_ES_2
+	occlusionCulling = occlusionCulling && shading && supportsOcclusionQueries;
+	if(occlusionCulling)
+		updateOcclusionQueries();
+#else
+	occlusionCulling = false;
+#endif
+	occlusionTests.clear();
+
 	//bind VAO
 	currentScene->glBind();
 
@@ -316,13 +338,22 @@ bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive)
 	//TODO optimize: clump models with same material together when first loading to minimize state changes
 
 	const S3DScene::ObjectList& objectList = currentScene->getObjects();
-	for(int i=0; i<objectList.size(); ++i)
+	int groupIndex = -1; //index of the group in the whole scene
+	for(int i=0; i<objectList.size() && success; ++i)
 	{
 		const StelOBJ::Object& obj = objectList.at(i);
 		const StelOBJ::MaterialGroupList& matGroups = obj.groups;
 
 		for(int j = 0; j < matGroups.size();++j)
 		{
+			++groupIndex;
+			if(!visibleGroups.at(groupIndex))
+			{
+				if(occlusionCulling)
+					occludedGroups[groupIndex] = false; //test it again when it comes back into view
+				continue;
+			}
+
 			const StelOBJ::MaterialGroup& matGroup = matGroups.at(j);
 			const S3DScene::Material* pMaterial = &currentScene->getMaterial(matGroup.materialIndex);
 			Q_ASSERT(pMaterial);
@@ -346,12 +377,54 @@ bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive)
 					continue;
 			}
 
+#ifndef QT_OPENGL_ES_2
+			if(occlusionCulling)
+			{
+				if(occludedGroups.at(groupIndex))
+				{
+					//hidden in the last frame, only its bounding box is tested after the other opaque groups
+					if(!pendingQueries.at(groupIndex))
+						occlusionTests.append(qMakePair(groupIndex, &matGroup));
+					++occludedModels;
+					continue;
+				}
+				if(!pendingQueries.at(groupIndex))
+				{
+					//find out if the group is still visible when drawn
+					glExtFuncs->glBeginQuery(GL_SAMPLES_PASSED, occlusionQueryIds.at(groupIndex));
+					success = drawMaterialGroup(matGroup,shading,blendAlphaAdditive);
+					glExtFuncs->glEndQuery(GL_SAMPLES_PASSED);
+					pendingQueries[groupIndex] = true;
+					if(!success)
+						break;
+					continue;
+				}
+			}
+#endif
+
 			success = drawMaterialGroup(matGroup,shading,blendAlphaAdditive);
 			if(!success)
 				break;
 		}
 	}
 
+#ifndef QT_OPENGL_ES_2
+	if(success && !occlusionTests.isEmpty())
+	{
+		//the depth buffer now contains all opaque groups
+		if(curShader)
+			curShader->release();
+		currentScene->glRelease();
+
+		testOccludedGroups();
+
+		//the next material group has to re-bind its shader
+		currentScene->glBind();
+		lastMaterial = Q_NULLPTR;
+		curShader = Q_NULLPTR;
+	}
+#endif
+
 	//sort and render transparent objects
 	if(transparentGroups.size()>0)
 	{
@@ -476,6 +549,138 @@ bool S3DRenderer::drawMaterialGroup(const StelOBJ::MaterialGroup &matGroup, bool
 	return true;
 }
 
+void S3DRenderer::updateOcclusionQueries()
+{
+#ifndef QT_OPENGL_ES_2
+	const int groupCount = currentScene->getMaterialGroupCount();
+	if(occlusionScene != currentScene || occlusionQueryIds.size() != groupCount)
+	{
+		//new scene, start with all groups visible
+		deleteOcclusionQueries();
+		occlusionScene = currentScene;
+		occlusionQueryIds.resize(groupCount);
+		if(groupCount>0)
+			glExtFuncs->glGenQueries(groupCount, occlusionQueryIds.data());
+		occludedGroups.fill(false, groupCount);
+		pendingQueries.fill(false, groupCount);
+		return;
+	}
+
+	//collect the results which are ready, without waiting for the GPU
+	for(int i = 0; i<groupCount; ++i)
+	{
+		if(!pendingQueries.at(i))
+			continue;
+
+		GLuint available = 0;
+		glExtFuncs->glGetQueryObjectuiv(occlusionQueryIds.at(i), GL_QUERY_RESULT_AVAILABLE, &available);
+		if(!available)
+			continue;
+
+		GLuint samples = 0;
+		glExtFuncs->glGetQueryObjectuiv(occlusionQueryIds.at(i), GL_QUERY_RESULT, &samples);
+		occludedGroups[i] = (samples == 0);
+		pendingQueries[i] = false;
+	}
+#endif
+}
+
+#ifndef QT_OPENGL_ES_2
+//! Draws the faces of the box in immediate mode
+static void drawBoxFaces(const AABBox& box)
+{
+	static const int faces[6][4] = {
+		{ AABBox::MinMinMin, AABBox::MinMaxMin, AABBox::MaxMaxMin, AABBox::MaxMinMin },
+		{ AABBox::MinMinMax, AABBox::MaxMinMax, AABBox::MaxMaxMax, AABBox::MinMaxMax },
+		{ AABBox::MinMinMin, AABBox::MaxMinMin, AABBox::MaxMinMax, AABBox::MinMinMax },
+		{ AABBox::MinMaxMin, AABBox::MinMaxMax, AABBox::MaxMaxMax, AABBox::MaxMaxMin },
+		{ AABBox::MinMinMin, AABBox::MinMinMax, AABBox::MinMaxMax, AABBox::MinMaxMin },
+		{ AABBox::MaxMinMin, AABBox::MaxMaxMin, AABBox::MaxMaxMax, AABBox::MaxMinMax }
+	};
+
+	glExtFuncs->glBegin(GL_QUADS);
+	for(int f = 0; f<6; ++f)
+	{
+		for(int c = 0; c<4; ++c)
+		{
+			const Vec3f v = box.getCorner(static_cast<AABBox::Corner>(faces[f][c]));
+			glExtFuncs->glVertex3f(v.v[0],v.v[1],v.v[2]);
+		}
+	}
+	glExtFuncs->glEnd();
+}
+#endif
+
+void S3DRenderer::testOccludedGroups()
+{
+#ifndef QT_OPENGL_ES_2
+	//the boxes are drawn like the debug geometry, see drawDebug
+	QOpenGLShaderProgram* boxShader = shaderManager.getDebugShader();
+	if(!boxShader)
+	{
+		//the groups can not be tested, draw them again in the next frame
+		for(int i = 0; i<occlusionTests.size(); ++i)
+			occludedGroups[occlusionTests.at(i).first] = false;
+		return;
+	}
+
+	boxShader->bind();
+	glExtFuncs->glMatrixMode(GL_MODELVIEW);
+	glExtFuncs->glLoadIdentity();
+	glExtFuncs->glMatrixMode(GL_PROJECTION);
+	glExtFuncs->glLoadIdentity();
+	SET_UNIFORM(boxShader,ShaderMgr::UNIFORM_MAT_MVP,projectionMatrix * modelViewMatrix);
+
+	//the boxes must neither be visible nor hide anything, only the depth test is required
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDisable(GL_CULL_FACE);
+
+	const Vec3f eyePos = currentScene->getEyePosition().toVec3f();
+	const float nearZ = currentScene->getSceneInfo().camNearZ;
+
+	for(int i = 0; i<occlusionTests.size(); ++i)
+	{
+		const int groupIndex = occlusionTests.at(i).first;
+		const AABBox& box = occlusionTests.at(i).second->boundingbox;
+
+		//when the viewer is inside of the box, its faces may be clipped by the near plane
+		bool inside = true;
+		for(int k = 0; k<3; ++k)
+			inside = inside && eyePos[k] > box.min[k] - nearZ && eyePos[k] < box.max[k] + nearZ;
+		if(inside)
+		{
+			occludedGroups[groupIndex] = false;
+			continue;
+		}
+
+		glExtFuncs->glBeginQuery(GL_SAMPLES_PASSED, occlusionQueryIds.at(groupIndex));
+		drawBoxFaces(box);
+		glExtFuncs->glEndQuery(GL_SAMPLES_PASSED);
+		pendingQueries[groupIndex] = true;
+	}
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	if(backfaceCullState)
+		glEnable(GL_CULL_FACE);
+
+	boxShader->release();
+#endif
+}
+
+void S3DRenderer::deleteOcclusionQueries()
+{
+#ifndef QT_OPENGL_ES_2
+	if(!occlusionQueryIds.isEmpty())
+		glExtFuncs->glDeleteQueries(occlusionQueryIds.size(), occlusionQueryIds.constData());
+#endif
+	occlusionQueryIds.clear();
+	occludedGroups.clear();
+	pendingQueries.clear();
+	occlusionScene = Q_NULLPTR;
+}
+
 void S3DRenderer::computeFrustumSplits(const Vec3d& viewPos, const Vec3d& viewDir, const Vec3d& viewUp)
 {
 	//the frustum arrays all already contain the same adjusted frustum from adjustFrustum
@@ -1072,6 +1277,8 @@ void S3DRenderer::renderShadowMapsForFace(int face)
 	//the problem seems to occur during final rendering because shadowmap textures look alright and the scaling values seem valid
 	//for now, fix this by adding a tiny value to X in these cases
 	adjustShadowFrustum(currentScene->getEyePosition(),Vec3d(face>3?viewDir[0]+0.000001:viewDir[0],viewDir[1],viewDir[2]),Vec3d(0,0,1),90.0f,1.0f);
+	//the shadow maps now only fit this face
+	shadowMapsValid = false;
 	//render shadowmap
 	if(!renderShadowMaps())
 		return;
@@ -1083,72 +1290,75 @@ void S3DRenderer::renderShadowMapsForFace(int face)
 	glViewport(0, 0, cubemapSize, cubemapSize);
 }
 
-void S3DRenderer::renderIntoCubemapSixPasses()
+void S3DRenderer::renderCubeFace(int face, const QMatrix4x4& squareProjection)
 {
-	//store current projection (= 90° cube projection)
-	QMatrix4x4 squareProjection = projectionMatrix;
+	if(shaderParameters.shadows && fullCubemapShadows)
+	{
+		//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
+		renderShadowMapsForFace(face);
+		//projection needs to be reset
+		projectionMatrix = squareProjection;
+	}
 
 	const Vec3d& eyePos = currentScene->getEyePosition();
 
-	if(needsMovementUpdate && updateOnlyDominantOnMoving)
-	{
-		if(shaderParameters.shadows && fullCubemapShadows)
-		{
-			//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
-			renderShadowMapsForFace(dominantFace);
-			//projection needs to be reset
-			projectionMatrix = squareProjection;
-		}
-
-		//update only the dominant face
-		glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[dominantFace]);
-		modelViewMatrix = cubeRotation[dominantFace];
-		modelViewMatrix.translate(-eyePos.v[0], -eyePos.v[1], -eyePos.v[2]);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	//bind a single side of the cube
+	glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[face]);
 
-		drawArrays(true,true);
+	modelViewMatrix = cubeRotation[face];
+	modelViewMatrix.translate(-eyePos.v[0], -eyePos.v[1], -eyePos.v[2]);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		if(updateSecondDominantOnMoving)
-		{
-			if(shaderParameters.shadows && fullCubemapShadows)
-			{
-				//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
-				renderShadowMapsForFace(secondDominantFace);
-				//projection needs to be reset
-				projectionMatrix = squareProjection;
-			}
+	drawArrays(true,true);
+	cubeFaceState[face] = CF_UpToDate;
+}
 
-			//update also the second-most dominant face
-			glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[secondDominantFace]);
+void S3DRenderer::renderIntoCubemapSixPasses()
+{
+	//store current projection (= 90° cube projection)
+	QMatrix4x4 squareProjection = projectionMatrix;
 
-			modelViewMatrix = cubeRotation[secondDominantFace];
-			modelViewMatrix.translate(-eyePos.v[0], -eyePos.v[1], -eyePos.v[2]);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	if(needsMovementUpdate && updateOnlyDominantOnMoving)
+	{
+		//update only the dominant face
+		if(cubeFaceVisible[dominantFace])
+			renderCubeFace(dominantFace, squareProjection);
 
-			drawArrays(true,true);
-		}
+		//update also the second-most dominant face
+		if(updateSecondDominantOnMoving && cubeFaceVisible[secondDominantFace])
+			renderCubeFace(secondDominantFace, squareProjection);
 	}
 	else
 	{
-		//traditional 6-pass version
+		//render the visible faces which must be updated now, the others are rendered when they come into view
+		bool rendered = false;
 		for(int i=0;i<6;++i)
 		{
-			if(shaderParameters.shadows && fullCubemapShadows)
+			if(cubeFaceVisible[i] && cubeFaceState[i] == CF_Invalid)
 			{
-				//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
-				renderShadowMapsForFace(i);
-				//projection needs to be reset
-				projectionMatrix = squareProjection;
+				renderCubeFace(i, squareProjection);
+				rendered = true;
 			}
+		}
 
-			//bind a single side of the cube
-			glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[i]);
-
-			modelViewMatrix = cubeRotation[i];
-			modelViewMatrix.translate(-eyePos.v[0], -eyePos.v[1], -eyePos.v[2]);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-			drawArrays(true,true);
+		if(!rendered)
+		{
+			//of the outdated faces, only a single one is rendered in each frame, the dominant faces first
+			int order[6] = { dominantFace, secondDominantFace, 0, 0, 0, 0 };
+			for(int i=0, n=2;i<6;++i)
+			{
+				if(i != dominantFace && i != secondDominantFace)
+					order[n++] = i;
+			}
+			for(int i=0;i<6;++i)
+			{
+				const int face = order[i];
+				if(cubeFaceVisible[face] && cubeFaceState[face] == CF_Outdated)
+				{
+					renderCubeFace(face, squareProjection);
+					break;
+				}
+			}
 		}
 	}
 }
@@ -1172,12 +1382,26 @@ void S3DRenderer::generateCubeMap()
 			float fov = altAzProjector->getFov();
 			float aspect = (float)altAzProjector->getViewportWidth() / (float)altAzProjector->getViewportHeight();
 
-			adjustShadowFrustum(currentScene->getEyePosition(),currentScene->getViewDirection(),Vec3d(0.,0.,1.),fov,aspect);
-			if(!renderShadowMaps())
-				return; //shadow map rendering failed, do an early abort
+			//the shadow maps can be kept while the view stays and the light moves only a little
+			if(shadowMapsOutdated(currentScene->getViewDirection(),fov,aspect))
+			{
+				adjustShadowFrustum(currentScene->getEyePosition(),currentScene->getViewDirection(),Vec3d(0.,0.,1.),fov,aspect);
+				if(!renderShadowMaps())
+				{
+					shadowMapsValid = false;
+					return; //shadow map rendering failed, do an early abort
+				}
+			}
 		}
 	}
 
+	if(needsCubemapUpdate)
+	{
+		//when spreading, faces left over from the last refresh are updated first
+		for(int i = 0; i<6; ++i)
+			cubeFaceState[i] = (spreadCubemapUpdate && cubeFaceState[i] == CF_UpToDate) ? CF_Outdated : CF_Invalid;
+	}
+
 	const SceneInfo& info = currentScene->getSceneInfo();
 
 	//setup projection matrix - this is a 90-degree perspective with aspect 1.0
@@ -1197,6 +1421,7 @@ void S3DRenderer::generateCubeMap()
 	{
 		//In this mode, only the "perspective" shadow mode can be used (otherwise it would need up to 6*4 shadowmaps at once)
 		renderIntoCubemapGeometryShader();
+		std::fill(cubeFaceState, cubeFaceState + 6, CF_UpToDate);
 	}
 	else
 	{
@@ -1327,12 +1552,19 @@ void S3DRenderer::drawDirect() // for Perspective Projection only!
     {
 	    calculateShadowCaster();
 
-	    //no need to extract view information, use the direction from stellarium
-	    adjustShadowFrustum(eyePos,currentScene->getViewDirection(),Vec3d(0.0,0.0,1.0),fov,aspect);
+	    //the shadow maps can be kept while the view stays and the light moves only a little
+	    if(shadowMapsOutdated(currentScene->getViewDirection(),fov,aspect))
+	    {
+		    //no need to extract view information, use the direction from stellarium
+		    adjustShadowFrustum(eyePos,currentScene->getViewDirection(),Vec3d(0.0,0.0,1.0),fov,aspect);
 
-	    //this call modifies projection + mv matrices, so we have to set them afterwards
-	    if(!renderShadowMaps())
-		    return; //shadow map rendering failed, do an early abort
+		    //this call modifies projection + mv matrices, so we have to set them afterwards
+		    if(!renderShadowMaps())
+		    {
+			    shadowMapsValid = false;
+			    return; //shadow map rendering failed, do an early abort
+		    }
+	    }
     }
 
     mvMatrix.translate(-eyePos.v[0],-eyePos.v[1],-eyePos.v[2]);
@@ -1367,7 +1599,7 @@ void S3DRenderer::drawDirect() // for Perspective Projection only!
     glEnable(GL_CULL_FACE);
 
     //only 1 call needed here
-    drawArrays(true);
+    drawArrays(true, false, occlusionQueries);
 
     glDepthMask(GL_FALSE);
     glDisable(GL_DEPTH_TEST);
@@ -1377,7 +1609,7 @@ void S3DRenderer::drawDirect() // for Perspective Projection only!
 
 void S3DRenderer::drawWithCubeMap()
 {
-	if(needsCubemapUpdate || needsMovementUpdate)
+	if(needsCubemapUpdate || needsMovementUpdate || hasPendingCubeFaces())
 	{
 		//lazy redrawing: update cubemap in slower intervals
 		generateCubeMap();
@@ -1385,6 +1617,58 @@ void S3DRenderer::drawWithCubeMap()
 	drawFromCubeMap();
 }
 
+void S3DRenderer::updateCubeFaceVisibility()
+{
+	//the faces are tested with their bounding cap against the cap of the whole viewport,
+	//which is also valid for the wide angle projections the cubemap is used for
+	const SphericalCap& viewportCap = altAzProjector->getBoundingCap();
+	//the corners of a face are at 54.7° from its center, add a small margin for the texture filtering at the edges
+	static const double faceCapD = std::cos(56.0 * M_PI / 180.0);
+
+	const int vtxCount = cubeVertices.size() / 6;
+	for(int i = 0; i<6; ++i)
+	{
+		//the middle vertex of the face grid is its center
+		Vec3d center = cubeVertices.at(i * vtxCount + vtxCount / 2).toVec3d();
+		center.normalize();
+		cubeFaceVisible[i] = viewportCap.intersects(SphericalCap(center, faceCapD));
+	}
+}
+
+bool S3DRenderer::hasPendingCubeFaces() const
+{
+	for(int i = 0; i<6; ++i)
+	{
+		if(cubeFaceVisible[i] && cubeFaceState[i] != CF_UpToDate)
+			return true;
+	}
+	return false;
+}
+
+bool S3DRenderer::shadowMapsOutdated(const Vec3d &viewDir, float fov, float aspect)
+{
+	//the sun moves this angle in one minute, which is not visible in the shadows
+	static const float lightThresholdCos = std::cos(0.25f * M_PI / 180.0f);
+
+	Vec3f lightDir = lightInfo.lightDirectionV3f;
+	lightDir.normalize();
+
+	if(shadowMapsValid && !fixShadowData && lastShadowScene == currentScene && lastShadowCaster == lightInfo.shadowCaster &&
+	   lastShadowEyePos == currentScene->getEyePosition() && lastShadowViewDir == viewDir &&
+	   lastShadowFov == fov && lastShadowAspect == aspect && lightDir.dot(lastShadowLightDir) > lightThresholdCos)
+		return false;
+
+	shadowMapsValid = true;
+	lastShadowScene = currentScene;
+	lastShadowCaster = lightInfo.shadowCaster;
+	lastShadowEyePos = currentScene->getEyePosition();
+	lastShadowViewDir = viewDir;
+	lastShadowFov = fov;
+	lastShadowAspect = aspect;
+	lastShadowLightDir = lightDir;
+	return true;
+}
+
 void S3DRenderer::drawCoordinatesText()
 {
     StelPainter painter(altAzProjector);
@@ -1577,6 +1861,9 @@ void S3DRenderer::drawDebug()
 	str = QString("%1 tris, %2 mdls").arg(drawnTriangles).arg(drawnModels);
 	painter.drawText(screen_x, screen_y, str);
 	screen_y -= 15.0f;
+	str = QString("%1 culled, %2 occluded").arg(culledModels).arg(occludedModels);
+	painter.drawText(screen_x, screen_y, str);
+	screen_y -= 15.0f;
 	str = QString("%1 mats, %2 shaders").arg(materialSwitches).arg(shaderSwitches);
 	painter.drawText(screen_x, screen_y, str);
 	screen_y -= 15.0f;
@@ -1691,6 +1978,13 @@ void S3DRenderer::determineFeatureSupport()
 		supportsShadows = true;
 		supportsShadowFiltering = true;
 	}
+
+#ifndef QT_OPENGL_ES_2
+	//occlusion queries are core since GL 1.5, but the box tests use the fixed-function debug shader
+	supportsOcclusionQueries = !shaderParameters.openglES && glExtFuncs->glGenQueries && glExtFuncs->glDeleteQueries &&
+			glExtFuncs->glBeginQuery && glExtFuncs->glEndQuery && glExtFuncs->glGetQueryObjectuiv;
+#endif
+	qCDebug(s3drenderer)<<"Occlusion queries supported:"<<supportsOcclusionQueries;
 }
 
 void S3DRenderer::init()
@@ -1743,6 +2037,7 @@ void S3DRenderer::init()
 
 void S3DRenderer::deleteCubemapping()
 {
+	std::fill(cubeFaceState, cubeFaceState + 6, CF_Invalid);
 	if(cubeMappingCreated)
 	{
 		//delete cube map - we have to check each possible variable because we dont know which ones are active
@@ -2194,6 +2489,7 @@ bool S3DRenderer::initCubemapping()
 
 void S3DRenderer::deleteShadowmapping()
 {
+	shadowMapsValid = false;
 	if(shadowFBOs.size()>0) //kinda hack that finds out if shadowmap related objects have been created
 	{
 		//we can delete them all at once then
@@ -2367,7 +2663,7 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 	currentScene = &scene;
 
 	//reset render statistic
-	drawnTriangles = drawnModels = materialSwitches = shaderSwitches = 0;
+	drawnTriangles = drawnModels = culledModels = occludedModels = materialSwitches = shaderSwitches = 0;
 
 	requiresCubemap = core->getCurrentProjectionType() != StelCore::ProjectionPerspective;
 	//update projector from core
@@ -2399,6 +2695,8 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 			{
 				needsCubemapUpdate = true;
 				needsMovementEndUpdate = false;
+				//a regular refresh may be spread over some frames, but not the first draw after invalidateCubemap()
+				spreadCubemapUpdate = lastCubemapUpdate != 0.0 && !reinitCubemapping;
 			}
 			else if (wasMoved) //we have been moved currently
 			{
@@ -2412,6 +2710,7 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 				{
 					needsCubemapUpdate = true;
 					needsMovementEndUpdate = false;
+					spreadCubemapUpdate = false;
 				}
 			}
 			else
@@ -2424,6 +2723,7 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 					//if the last movement was some time ago, update the whole cubemap
 					needsCubemapUpdate = true;
 					needsMovementEndUpdate = false;
+					spreadCubemapUpdate = false;
 				}
 				else
 					needsCubemapUpdate = false;
@@ -2434,6 +2734,7 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 		else
 		{
 			needsCubemapUpdate = true;
+			spreadCubemapUpdate = false;
 		}
 
 
@@ -2460,6 +2761,8 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 		//check sign
 		dominantFace = dominantFace*2 + (mainViewDir.v[dominantFace]<0.0);
 		secondDominantFace = secondDominantFace*2 + (mainViewDir.v[secondDominantFace]<0.0);
+
+		updateCubeFaceVisibility();
 	}
 	else
 	{
@@ -82,6 +82,11 @@ public:
 	double getLazyCubemapInterval() const { return lazyInterval; }
 	void setLazyCubemapInterval(double val) { lazyInterval = val; }
 
+	//! When enabled, groups hidden behind others in the last frame are skipped in the perspective view.
+	//! Only used when areOcclusionQueriesSupported() is true.
+	bool getOcclusionQueriesEnabled() const { return occlusionQueries; }
+	void setOcclusionQueriesEnabled(bool val) { occlusionQueries = val; }
+
 	//This has the be the most crazy method name in the plugin
 	void getLazyCubemapUpdateOnlyDominantFaceOnMoving(bool &val, bool &alsoSecondDominantFace) const { val = updateOnlyDominantOnMoving; alsoSecondDominantFace = updateSecondDominantOnMoving; }
 	void setLazyCubemapUpdateOnlyDominantFaceOnMoving(bool val, bool alsoSecondDominantFace) { updateOnlyDominantOnMoving = val; updateSecondDominantOnMoving = alsoSecondDominantFace; }
@@ -132,6 +137,7 @@ public:
 	bool isGeometryShaderCubemapSupported() const { return supportsGSCubemapping; }
 	bool areShadowsSupported() const { return supportsShadows; }
 	bool isShadowFilteringSupported() const { return supportsShadowFiltering; }
+	bool areOcclusionQueriesSupported() const { return supportsOcclusionQueries; }
 	bool isANGLEContext() const { return isANGLE; }
 	unsigned int getMaximumFramebufferSize() const { return maximumFramebufferSize; }
 signals:
@@ -146,6 +152,7 @@ private:
 	bool supportsGSCubemapping; //if the GL context supports geometry shader cubemapping
 	bool supportsShadows; //if shadows are supported
 	bool supportsShadowFiltering; //if shadow filtering is supported
+	bool supportsOcclusionQueries; //if occlusion queries are supported (desktop GL only)
 	bool isANGLE; //true if running on ANGLE
 	unsigned int maximumFramebufferSize;
 	GLuint defaultFBO; //the default background FBO handle
@@ -179,9 +186,19 @@ private:
 	QOpenGLShaderProgram* curShader;
 	QSet<QOpenGLShaderProgram*> initializedShaders;
 	QVector<const StelOBJ::MaterialGroup*> transparentGroups;
+	QVector<bool> visibleGroups; //result of the frustum culling for the current pass
+
+	// occlusion culling, per material group (indexed like the visibleGroups)
+	bool occlusionQueries; //if occlusion culling is enabled
+	const S3DScene* occlusionScene; //the scene the queries were created for
+	QVector<GLuint> occlusionQueryIds;
+	QVector<bool> occludedGroups; //groups which had no visible samples in their last query
+	QVector<bool> pendingQueries; //queries whose result is not yet available
+	QVector<QPair<int,const StelOBJ::MaterialGroup*> > occlusionTests; //occluded groups to test with their bounding box in the current pass
 
 	// debug info
 	int drawnTriangles,drawnModels;
+	int culledModels,occludedModels;
 	int materialSwitches, shaderSwitches;
 
 	/// ---- Cubemapping variables ----
@@ -203,6 +220,17 @@ private:
 	GLuint cubeRB; //renderbuffer for depth of a single face in TEXTURES and CUBEMAP modes (attached to multiple FBOs)
 	int dominantFace,secondDominantFace;
 
+	//! The state of the content of a cube face, used to update only the visible faces
+	enum CubeFaceState
+	{
+		CF_UpToDate, //rendered in the last update
+		CF_Outdated, //an update is due, but may be delayed to spread the work over some frames
+		CF_Invalid //has to be rendered as soon as it is visible
+	};
+	CubeFaceState cubeFaceState[6];
+	bool cubeFaceVisible[6]; //true for the faces which intersect the viewport in the current frame
+	bool spreadCubemapUpdate; //if true, the outdated faces are rendered one per frame
+
 	//because of use that deviates very much from QOpenGLFramebufferObject typical usage, we manage the FBOs ourselves
 	GLuint cubeFBO; //used in CUBEMAP_GSACCEL mode - only a single FBO exists, with a cubemap for color and one for depth
 	GLuint cubeSideFBO[6]; //used in TEXTURES and CUBEMAP mode, 6 textures/cube faces for color and a shared depth renderbuffer (we don't require the depth after rendering)
@@ -269,6 +297,15 @@ private:
 	//near/far planes for the orthographic light that fits the whole scene
 	float lightOrthoNear;
 	float lightOrthoFar;
+
+	//the shadow maps are only rendered again when the view or the light changed, see shadowMapsOutdated()
+	bool shadowMapsValid;
+	LightParameters::ShadowCaster lastShadowCaster;
+	Vec3f lastShadowLightDir;
+	Vec3d lastShadowEyePos;
+	Vec3d lastShadowViewDir;
+	float lastShadowFov, lastShadowAspect;
+	const S3DScene* lastShadowScene;
 	//Array holding the split frustums
 	QVector<Frustum> frustumArray;
 	//Vector holding the convex split bodies for focused shadow mapping
@@ -298,8 +335,18 @@ private:
 	void drawDirect();
 	//! When another projection than perspective is selected, rendering is performed using a cubemap.
 	void drawWithCubeMap();
+	//! Finds the cube faces which intersect the viewport
+	void updateCubeFaceVisibility();
+	//! Returns true if a visible cube face has to be rendered, even if the cubemap itself does not need an update
+	bool hasPendingCubeFaces() const;
+	//! Renders a single face in the six passes modes
+	void renderCubeFace(int face, const QMatrix4x4& squareProjection);
 	//! Performs the actual rendering of the shadow map
 	bool renderShadowMaps();
+	//! Returns true if the shadow maps have to be rendered for the given view.
+	//! This is the case when the view, the scene or the shadow caster changed since they were last rendered,
+	//! or when the light moved more than a small angle. The current state is remembered when true is returned.
+	bool shadowMapsOutdated(const Vec3d& viewDir, float fov, float aspect);
 	//! Creates shadowmaps for the specified cubemap face
 	void renderShadowMapsForFace(int face);
 	//! Generates a 6-sided cube map by drawing a view in each direction
@@ -313,10 +360,20 @@ private:
 	//! This is the method that performs the actual drawing.
 	//! If shading is true, a suitable shader for each material is selected and initialized. Submits 1 draw call for each StelModel.
 	//! @return false on shader errors
-	bool drawArrays(bool shading=true, bool blendAlphaAdditive=false);
+	//! Material groups outside of the view volume of the current projection and modelview matrices are skipped.
+	//! @param occlusionCulling if true, occlusion queries are used to skip groups hidden behind others (for the direct perspective view)
+	bool drawArrays(bool shading=true, bool blendAlphaAdditive=false, bool occlusionCulling=false);
 	//! Draws a single material group, to be use from within drawArrays
 	bool drawMaterialGroup(const StelOBJ::MaterialGroup& matGroup, bool shading, bool blendAlphaAdditive);
 
+	// --- occlusion culling ---
+	//! Makes sure that there is a query for each group of the current scene, and collects the results that are available without waiting.
+	void updateOcclusionQueries();
+	//! Draws the bounding boxes of the groups in occlusionTests inside of queries, without writing color or depth
+	void testOccludedGroups();
+	//! Deletes all queries
+	void deleteOcclusionQueries();
+
 	//! Draw observer grid coordinates as text.
 	void drawCoordinatesText();
 	//! Draw some text output. This can be filled as needed by development.
@@ -21,6 +21,7 @@
 #include "S3DScene.hpp"
 
 #include "StelApp.hpp"
+#include "StelBinaryCache.hpp"
 #include "StelCore.hpp"
 #include "StelTexture.hpp"
 #include "StelTextureMgr.hpp"
@@ -226,6 +227,17 @@ void S3DScene::setModel(const StelOBJ &model)
 	//copy objects
 	objects = modelData.getObjectList();
 
+	//the group boxes are already transformed to the scene coordinates
+	QVector<AABBox> groupBoxes;
+	for(int i=0;i<objects.size();++i)
+	{
+		const StelOBJ::MaterialGroupList& groups = objects.at(i).groups;
+		for(int j=0;j<groups.size();++j)
+			groupBoxes.append(groups.at(j).boundingbox);
+	}
+	groupHierarchy.build(groupBoxes);
+	qCDebug(s3dscene)<<"Built bounding volume hierarchy over"<<groupBoxes.size()<<"material groups";
+
 	if(info.hasLocation())
 	{
 		if(info.altitudeFromModel)
@@ -279,7 +291,27 @@ void S3DScene::setGround(const StelOBJ &ground)
 	StelOBJ::V3Vec groundPositionList;
 	groundTmp.splitVertexData(&groundPositionList);
 
-	heightmap.setMeshData(groundTmp.getIndexList(), groundPositionList, &groundTmp.getAABBox());
+	//the grid of the heightmap only depends on the ground mesh and its rotation, and is cached as long as they are unchanged
+	QString cacheKey;
+	QByteArray sourceHash;
+	QByteArray gridData;
+	if(!ground.getSourceHash().isEmpty())
+	{
+		cacheKey = "Scenery3d heightmap:" + info.id;
+		sourceHash = StelBinaryCache::hash(ground.getSourceHash() + QByteArray(reinterpret_cast<const char*>(zRot2Grid.constData()), 16*sizeof(float)));
+		QVariant cached;
+		if(StelBinaryCache::load(cacheKey, sourceHash, cached))
+			gridData = cached.toByteArray();
+	}
+
+	heightmap.setMeshData(groundTmp.getIndexList(), groundPositionList, &groundTmp.getAABBox(), gridData);
+
+	if(!cacheKey.isEmpty())
+	{
+		const QByteArray newGridData = heightmap.getGridData();
+		if(newGridData!=gridData)
+			StelBinaryCache::save(cacheKey, sourceHash, newGridData);
+	}
 	if(info.groundNullHeightFromModel)
 	{
 		info.groundNullHeight = ground.getAABBox().min[2];
@@ -26,6 +26,7 @@
 #include "StelOpenGLArray.hpp"
 #include "SceneInfo.hpp"
 #include "Heightmap.hpp"
+#include "BVH.hpp"
 
 Q_DECLARE_LOGGING_CATEGORY(s3dscene)
 
@@ -116,6 +117,13 @@ public:
 	MaterialList& getMaterialList() { return materials; }
 	const Material& getMaterial(int index) const { return materials.at(index); }
 	const ObjectList& getObjects() const { return objects; }
+	//! The number of material groups of all objects together.
+	//! The groups are numbered in the order of getObjects() and their group lists.
+	int getMaterialGroupCount() const { return groupHierarchy.getItemCount(); }
+	//! Finds the material groups whose bounding box intersects the view volume of the given matrix
+	//! @param visible set to true for each group which may be visible, indexed like for getMaterialGroupCount()
+	//! @return the number of invisible groups
+	int cullMaterialGroups(const QMatrix4x4& mvp, QVector<bool>& visible) const { return groupHierarchy.cull(mvp, visible); }
 
 	//! Moves the viewer according to the given move vector
 	//!  (which is specified relative to the view direction and current position)
@@ -156,7 +164,8 @@ private:
 	inline void recalcEyePos() { eyePosition = position; eyePosition[2]+=eye_height; }
 	MaterialList materials;
 	ObjectList objects;
-
+	//! Bounding volume hierarchy over the material groups of all objects, for view frustum culling
+	BVH groupHierarchy;
 
 	bool glReady;
 
@@ -304,6 +304,7 @@ void Scenery3d::loadConfig()
 	renderer->setUseFullCubemapShadows(conf->value("flag_cubemap_fullshadows", false).toBool());
 	renderer->setLazyCubemapEnabled(conf->value("flag_lazy_cubemap", true).toBool());
 	renderer->setLazyCubemapInterval(conf->value("cubemap_lazy_interval",1.0).toDouble());
+	renderer->setOcclusionQueriesEnabled(conf->value("flag_occlusion_queries", false).toBool());
 	renderer->setPixelLightingEnabled(conf->value("flag_pixel_lighting", false).toBool());
 	renderer->setLocationInfoEnabled(conf->value("flag_location_info", false).toBool());
 
@@ -909,6 +910,20 @@ void Scenery3d::setLazyDrawingInterval(const double val)
 	emit lazyDrawingIntervalChanged(val);
 }
 
+bool Scenery3d::getEnableOcclusionQueries() const
+{
+	return renderer->getOcclusionQueriesEnabled();
+}
+
+void Scenery3d::setEnableOcclusionQueries(const bool val)
+{
+	showMessage(QString(q_("Occlusion culling: %1")).arg(val?q_("enabled"):q_("disabled")));
+	renderer->setOcclusionQueriesEnabled(val);
+
+	conf->setValue(S3D_CONFIG_PREFIX + "/flag_occlusion_queries",val);
+	emit enableOcclusionQueriesChanged(val);
+}
+
 bool Scenery3d::getOnlyDominantFaceWhenMoving() const
 {
 	bool v1,v2;
@@ -69,6 +69,7 @@ class Scenery3d : public StelModule
 	Q_PROPERTY(float torchRange READ getTorchRange WRITE setTorchRange NOTIFY torchRangeChanged)
 	Q_PROPERTY(bool enableLazyDrawing READ getEnableLazyDrawing WRITE setEnableLazyDrawing NOTIFY enableLazyDrawingChanged)
 	Q_PROPERTY(double lazyDrawingInterval READ getLazyDrawingInterval WRITE setLazyDrawingInterval NOTIFY lazyDrawingIntervalChanged)
+	Q_PROPERTY(bool enableOcclusionQueries READ getEnableOcclusionQueries WRITE setEnableOcclusionQueries NOTIFY enableOcclusionQueriesChanged)
 	Q_PROPERTY(bool onlyDominantFaceWhenMoving READ getOnlyDominantFaceWhenMoving WRITE setOnlyDominantFaceWhenMoving NOTIFY onlyDominantFaceWhenMovingChanged)
 	Q_PROPERTY(bool secondDominantFaceWhenMoving READ getSecondDominantFaceWhenMoving WRITE setSecondDominantFaceWhenMoving NOTIFY secondDominantFaceWhenMovingChanged)
 	Q_PROPERTY(uint cubemapSize READ getCubemapSize WRITE setCubemapSize NOTIFY cubemapSizeChanged)
@@ -119,6 +120,7 @@ signals:
     void torchRangeChanged(const float val);
     void enableLazyDrawingChanged(const bool val);
     void lazyDrawingIntervalChanged(const double val);
+    void enableOcclusionQueriesChanged(const bool val);
     void onlyDominantFaceWhenMovingChanged(const bool val);
     void secondDominantFaceWhenMovingChanged(const bool val);
     void cubemapSizeChanged(const uint val);
@@ -226,6 +228,11 @@ public slots:
     void setLazyDrawingInterval(const double val);
     double getLazyDrawingInterval() const;
 
+    //! When enabled, hardware occlusion queries are used to skip the parts of the scene
+    //! hidden behind others in the perspective view. This helps in dense scenes like towns.
+    void setEnableOcclusionQueries(const bool val);
+    bool getEnableOcclusionQueries() const;
+
     //! Sets the size used for cubemap rendering.
     //! For best compatibility and performance, this should be a power of 2.
     void setCubemapSize(const uint val);
@@ -0,0 +1,152 @@
+/*
+ * Solar System editor plug-in for Stellarium
+ *
+ * Copyright (C) 2010 Bogdan Marinov
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _MPC_ELEMENTS_READER_HPP_
+#define _MPC_ELEMENTS_READER_HPP_
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+class QIODevice;
+
+//! Convenience type for storage of SSO properties in ssystem_minor.ini format.
+//! This is an easy way of storing data in the format used in Stellarium's
+//! solar system configuration file.
+//! What would be key/value pairs in a section in the ssystem_minor.ini file
+//! are key/value pairs in the hash. The section name is stored with key
+//! "section_name".
+//! As it is a hash, key names are not stored alphabetically. This allows
+//! for rapid addition and look-up of values, unlike a real QSettings
+//! object in StelIniFormat.
+//! Also, using this way may allow scripts to define SSOs.
+//! \todo Better name.
+typedef QHash<QString, QVariant> SsoElements;
+
+/*!
+ \class MpcElementsReader
+ \brief Streaming reader for orbital elements in the MPC one-line formats.
+
+ The source is read in chunks of lines. Each chunk is handed over to the
+ global QThreadPool and converted to SsoElements there, while the next chunk
+ is being read, so that neither the whole file nor the whole list of
+ unparsed lines has to be kept in memory. Results are collected in the order
+ of the source lines. Objects which appear more than once in the source
+ (identified by their "section_name") are collapsed into one entry holding
+ the elements of the last occurrence.
+
+ The class does not depend on StelApp, so that it can be used (and
+ benchmarked) outside of a running program.
+*/
+class MpcElementsReader
+{
+public:
+	//! Line formats understood by the reader.
+	enum Format {
+		CometFormat,		//!< http://www.minorplanetcenter.org/iau/info/CometOrbitFormat.html
+		MinorPlanetFormat	//!< http://www.minorplanetcenter.org/iau/info/MPOrbitFormat.html
+	};
+
+	MpcElementsReader(Format format);
+
+	//! Set the number of lines parsed together by one worker task.
+	void setChunkSize(int lines) { chunkSize = qMax(1, lines); }
+	int getChunkSize() const { return chunkSize; }
+
+	//! Read and parse all lines of a file.
+	//! \returns an empty list if the file can't be opened.
+	QList<SsoElements> readFile(const QString& filePath);
+	//! Read and parse all lines from an already opened device.
+	QList<SsoElements> readDevice(QIODevice& device);
+
+	//! Number of non-empty lines seen during the last read.
+	int getLineCount() const { return lineCount; }
+	//! Number of distinct objects recognized during the last read.
+	int getCandidatesCount() const { return candidatesCount; }
+	//! Duration of the last read in milliseconds.
+	qint64 getElapsedTime() const { return elapsedTime; }
+
+	//! Reads a single comet's orbital elements from a string.
+	//! This function converts a line of comet orbital elements in MPC format
+	//! to a hash in Stellarium's ssystem.ini format.
+	//! The MPC's one-line orbital elements format for comets
+	//! is described on their website:
+	//! http://www.minorplanetcenter.org/iau/info/CometOrbitFormat.html
+	//! \returns an empty hash if there is an error or the source string is not
+	//! a valid line in MPC format.
+	//! \note Thread-safe: it is called from the worker threads.
+	static SsoElements readCometLine(QString oneLineElements);
+
+	//! Reads a single minor planet's orbital elements from a string.
+	//! This function converts a line of minor planet orbital elements in
+	//! MPC format to a hash in Stellarium's ssystem.ini format.
+	//! The MPC's one-line orbital elements format for minor planets
+	//! is described on their website:
+	//! http://www.minorplanetcenter.org/iau/info/MPOrbitFormat.html
+	//! \returns an empty hash if there is an error or the source string is not
+	//! a valid line in MPC format.
+	//! \note Thread-safe: it is called from the worker threads.
+	static SsoElements readMinorPlanetLine(QString oneLineElements);
+
+	//! Converts an object name to a key (group) name in a configuration file.
+	static QString convertToGroupName(QString& name, int minorPlanetNumber = 0);
+
+	//! Unpacks an MPC packed minor planet provisional designation.
+	//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
+	//! \returns an empty string if the argument is not a valid packed
+	//! provisional designation.
+	static QString unpackMinorPlanetProvisionalDesignation(QString packedDesignation);
+
+private:
+	typedef SsoElements (*LineParser)(QString);
+
+	//! Parses one chunk of lines. Runs in a worker thread.
+	static QList<SsoElements> readChunk(LineParser parser, QStringList lines);
+
+	//! Converts an alphanumeric digit as used in MPC packed dates to an integer.
+	//! See http://www.minorplanetcenter.org/iau/info/PackedDates.html
+	//! Interprets the digits from 0 to 9 normally, and the capital letters
+	//! from A to V as numbers between 10 and 31.
+	//! \returns -1 if the digit is invalid (0 is also an invalid ordinal number
+	//! for a day or month, so this is not a problem)
+	static int unpackDayOrMonthNumber (QChar digit);
+	//! Converts an alphanumeric year number as used in MPC packed dates to an integer.
+	//! See http://www.minorplanetcenter.org/iau/info/PackedDates.html
+	//! Also used in packed provisional designations, see
+	//! http://www.minorplanetcenter.org/iau/info/PackedDes.html
+	static int unpackYearNumber (QChar prefix, int lastTwoDigits);
+	//! Converts a two-character number used in MPC packed provisional designations.
+	//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
+	//! This function is used for both asteroid and comet designations.
+	static int unpackAlphanumericNumber (QChar prefix, int lastDigit);
+
+	Format format;
+	LineParser parser;
+	int maxLineLength;
+	int chunkSize;
+
+	int lineCount;
+	int candidatesCount;
+	qint64 elapsedTime;
+};
+
+#endif // _MPC_ELEMENTS_READER_HPP_
@@ -36,6 +36,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QSet>
 #include <QSettings>
 #include <QString>
 
@@ -403,7 +404,7 @@ QHash<QString,QString> SolarSystemEditor::listAllLoadedObjectsInFile(QString fil
 		return QHash<QString,QString>();
 
 	QStringList groups = solarSystemIni.childGroups();
-	QStringList planetNames = solarSystem->getAllMinorPlanetCommonEnglishNames();
+	QSet<QString> planetNames = solarSystem->getAllMinorPlanetCommonEnglishNames().toSet();
 	QHash<QString,QString> loadedObjects;
 	foreach (QString group, groups)
 	{
@@ -481,387 +482,16 @@ bool SolarSystemEditor::removeSsoWithName(QString name)
 	return true;
 }
 
-//TODO: Strings that have failed to be parsed. The usual source of discrepancies is
-//http://www.minorplanetcenter.org/iau/Ephemerides/Comets/Soft00Cmt.txt
-//It seems that some entries in the list don't match the described format.
-/*
-  "    CJ95O010  1997 03 31.4141  0.906507  0.994945  130.5321  282.6820   89.3193  20100723  -2.0  4.0  C/1995 O1 (Hale-Bopp)                                    MPC 61436" -> minus sign, fixed
-  "    CK09K030  2011 01  9.266   3.90156   1.00000   251.413     0.032   146.680              8.5  4.0  C/2009 K3 (Beshore)                                      MPC 66205" -> lower precision than the spec, fixed
-  "    CK10F040  2010 04  6.109   0.61383   1.00000   120.718   237.294    89.143             13.5  4.0  C/2010 F4 (Machholz)                                     MPC 69906" -> lower precision than the spec, fixed
-  "    CK10M010  2012 02  7.840   2.29869   1.00000   265.318    82.150    78.373              9.0  4.0  C/2010 M1 (Gibbs)                                        MPC 70817" -> lower precision than the spec, fixed
-  "    CK10R010  2011 11 28.457   6.66247   1.00000    96.009   345.949   157.437              6.0  4.0  C/2010 R1 (LINEAR)                                       MPEC 2010-R99" -> lower precision than the spec, fixed
-  "0128P      b  2007 06 13.8064  3.062504  0.320891  210.3319  214.3583    4.3606  20100723   8.5  4.0  128P/Shoemaker-Holt                                      MPC 51822" -> fragment, fixed
-  "0141P      d  2010 05 29.7106  0.757809  0.749215  149.3298  246.0849   12.8032  20100723  12.0 12.0  141P/Machholz                                            MPC 59599" -> fragment, fixed
-*/
 SsoElements SolarSystemEditor::readMpcOneLineCometElements(QString oneLineElements) const
 {
-	SsoElements result;
-	//qDebug() << "readMpcOneLineCometElements started...";
-
-	QRegExp mpcParser("^\\s*(\\d{4})?([A-Z])((?:\\w{6}|\\s{6})?[0a-zA-Z])?\\s+(\\d{4})\\s+(\\d{2})\\s+(\\d{1,2}\\.\\d{3,4})\\s+(\\d{1,2}\\.\\d{5,6})\\s+(\\d\\.\\d{5,6})\\s+(\\d{1,3}\\.\\d{3,4})\\s+(\\d{1,3}\\.\\d{3,4})\\s+(\\d{1,3}\\.\\d{3,4})\\s+(?:(\\d{4})(\\d\\d)(\\d\\d))?\\s+(\\-?\\d{1,2}\\.\\d)\\s+(\\d{1,2}\\.\\d)\\s+(\\S.{1,54}\\S)(?:\\s+(\\S.*))?$");//
-
-	int match = mpcParser.indexIn(oneLineElements);
-	//qDebug() << "RegExp captured:" << match << mpcParser.capturedTexts();
-
-	if (match < 0)
-	{
-		qWarning() << "No match for" << oneLineElements;
-		return result;
-	}
-
-	QString numberString = mpcParser.cap(1).trimmed();
-	//QChar cometType = mpcParser.cap(2).at(0);
-	QString provisionalDesignation = mpcParser.cap(3).trimmed();
-
-	if (numberString.isEmpty() && provisionalDesignation.isEmpty())
-	{
-		qWarning() << "Comet is missing both comet number AND provisional designation.";
-		return result;
-	}
-
-	QString name = mpcParser.cap(17).trimmed();
-
-	//Fragment suffix
-	if (provisionalDesignation.length() == 1)
-	{
-		QChar fragmentIndex = provisionalDesignation.at(0);
-		name.append(' ');
-		name.append(fragmentIndex.toUpper());
-	}
-
-	if (name.isEmpty())
-	{
-		return SsoElements();
-	}
-	result.insert("name", name);
-
-	QString sectionName = convertToGroupName(name);
-	if (sectionName.isEmpty())
-	{
-		return SsoElements();
-	}
-	result.insert("section_name", sectionName);
-
-	//After a name has been determined, insert the essential keys
-	//result.insert("parent", "Sun"); // 0.16: omit obvious default.
-	result.insert("type", "comet");
-	//"comet_orbit" is used for all cases:
-	//"ell_orbit" interprets distances as kilometers, not AUs
-	result.insert("coord_func", "comet_orbit");
-	// GZ: moved next line below!
-	//result.insert("orbit_good", 1000); // default validity for osculating elements, days
-
-	//result.insert("color", "1.0, 1.0, 1.0");  // 0.16: omit obvious default.
-	//result.insert("tex_map", "nomap.png");    // 0.16: omit obvious default.
-
-	bool ok = false;
-	//TODO: Use this for VALIDATION!
-
-	int year	= mpcParser.cap(4).toInt();
-	int month	= mpcParser.cap(5).toInt();
-	double dayFraction	= mpcParser.cap(6).toDouble(&ok);
-	int day = (int) dayFraction;
-	QDate datePerihelionPassage(year, month, day);
-	int fraction = (int) ((dayFraction - day) * 24 * 60 * 60);
-	int seconds = fraction % 60; fraction /= 60;
-	int minutes = fraction % 60; fraction /= 60;
-	int hours = fraction % 24;
-	//qDebug() << hours << minutes << seconds << fraction;
-	QTime timePerihelionPassage(hours, minutes, seconds, 0);
-	QDateTime dtPerihelionPassage(datePerihelionPassage, timePerihelionPassage, Qt::UTC);
-	double jdPerihelionPassage = StelUtils::qDateTimeToJd(dtPerihelionPassage);
-	result.insert("orbit_TimeAtPericenter", jdPerihelionPassage);
-
-	double perihelionDistance = mpcParser.cap(7).toDouble(&ok);//AU
-	result.insert("orbit_PericenterDistance", perihelionDistance);
-
-	double eccentricity = mpcParser.cap(8).toDouble(&ok);//degrees
-	result.insert("orbit_Eccentricity", eccentricity);
-
-	double argumentOfPerihelion = mpcParser.cap(9).toDouble(&ok);//J2000.0, degrees
-	result.insert("orbit_ArgOfPericenter", argumentOfPerihelion);
-
-	double longitudeOfTheAscendingNode = mpcParser.cap(10).toDouble(&ok);//J2000.0, degrees
-	result.insert("orbit_AscendingNode", longitudeOfTheAscendingNode);
-
-	double inclination = mpcParser.cap(11).toDouble(&ok);
-	result.insert("orbit_Inclination", inclination);
-
-	// GZ: We should reduce orbit_good for elliptical orbits to one half period before/after perihel!
-	if (eccentricity < 1.0)
-	{
-		// Heafner, Fundamental Ephemeris Computations, p.71
-		const double a=perihelionDistance/(1.-eccentricity); // semimajor axis.
-		const double meanMotion=0.01720209895/std::sqrt(a*a*a); // radians/day (0.01720209895 is Gaussian gravitational constant (symbol k))
-		double period=M_PI*2.0 / meanMotion; // period, days
-		result.insert("orbit_good", qMin(1000, (int) floor(0.5*period))); // validity for elliptical osculating elements, days. Goes from aphel to next aphel or max 1000 days.
-		result.insert("orbit_visualization_period", period); // add period for visualization of orbit
-	}
-	else
-		result.insert("orbit_good", 1000); // default validity for osculating elements, days
-
-	double absoluteMagnitude = mpcParser.cap(15).toDouble(&ok);
-	result.insert("absolute_magnitude", absoluteMagnitude);
-
-	//This is not the same "slope parameter" as used in asteroids. Better name?
-	double slopeParameter = mpcParser.cap(16).toDouble(&ok);
-	result.insert("slope_parameter", slopeParameter);
-
-	double radius = 5; //Fictitious default assumption
-	result.insert("radius", radius);
-	result.insert("albedo", 0.1); // GZ 2014-01-10: Comets are very dark, should even be 0.03!
-	result.insert("dust_lengthfactor", 0.4); // dust tail length w.r.t. gas tail length
-	result.insert("dust_brightnessfactor", 1.5); // dust tail brightness w.r.t. gas tail.
-	result.insert("dust_widthfactor", 1.5); // opening w.r.t. gas tail opening width.
-	//qDebug() << "readMpcOneLineCometElements done\n";
-	return result;
+	return MpcElementsReader::readCometLine(oneLineElements);
 }
 
 SsoElements SolarSystemEditor::readMpcOneLineMinorPlanetElements(QString oneLineElements) const
 {
-	SsoElements result;
-
-	//This time I'll try splitting the line to columns, instead of
-	//using a regular expression.
-	//Using QString::mid() allows parsing it in a random sequence.
-
-	//Length validation
-	if (oneLineElements.isEmpty() ||
-	    oneLineElements.length() > 202 ||
-	    oneLineElements.length() < 152) //The column ends at 160, but is left-aligned
-	{
-		return result;
-	}
-
-	QString column;
-	QString objectType = "asteroid";
-	bool ok = false;
-	//bool isLongForm = (oneLineElements.length() > 160) ? true : false;
-
-	//Minor planet number or provisional designation
-	column = oneLineElements.mid(0, 7).trimmed();
-	if (column.isEmpty())
-	{
-		return result;
-	}
-	int minorPlanetNumber = 0;
-	QString provisionalDesignation;
-	QString name;
-	if (column.toInt(&ok) || ok)
-	{
-		minorPlanetNumber = column.toInt();
-	}
-	else
-	{
-		//See if it is a number, but packed
-		//I hope the format is right (I've seen prefixes only between A and P)
-		QRegExp packedMinorPlanetNumber("^([A-Za-z])(\\d+)$");
-		if (packedMinorPlanetNumber.indexIn(column) == 0)
-		{
-			minorPlanetNumber = packedMinorPlanetNumber.cap(2).toInt(&ok);
-			//TODO: Validation
-			QChar prefix = packedMinorPlanetNumber.cap(1).at(0);
-			if (prefix.isUpper())
-			{
-				minorPlanetNumber += ((10 + prefix.toLatin1() - 'A') * 10000);
-			}
-			else
-			{
-				minorPlanetNumber += ((10 + prefix.toLatin1() - 'a' + 26) * 10000);
-			}
-		}
-		else
-		{
-			provisionalDesignation = unpackMinorPlanetProvisionalDesignation(column);
-		}
-	}
-
-	if (minorPlanetNumber)
-	{
-		name = QString::number(minorPlanetNumber);
-	}
-	else if(provisionalDesignation.isEmpty())
-	{
-		qDebug() << "readMpcOneLineMinorPlanetElements():"
-		         << column
-		         << "is not a valid number or packed provisional designation";
-		return SsoElements();
-	}
-	else
-	{
-		name = provisionalDesignation;
-	}
-
-	//In case the longer format is used, extract the human-readable name
-	column = oneLineElements.mid(166, 28).trimmed();
-	if (!column.isEmpty())
-	{
-		if (minorPlanetNumber)
-		{
-			QRegExp asteroidName("^\\((\\d+)\\)\\s+(\\S.+)$");
-			if (asteroidName.indexIn(column) == 0)
-			{
-				name = asteroidName.cap(2);
-				result.insert("minor_planet_number", minorPlanetNumber);
-			}
-			else
-			{
-				//Use the whole string, just in case
-				name = column;
-			}
-		}
-		//In the other case, the name is already the provisional designation
-	}
-	if (name.isEmpty())
-	{
-		return SsoElements();
-	}
-	result.insert("name", name);
-
-	//Section name
-	QString sectionName = convertToGroupName(name, minorPlanetNumber);
-	if (sectionName.isEmpty())
-	{
-		return SsoElements();
-	}
-	result.insert("section_name", sectionName);
-
-	//After a name has been determined, insert the essential keys
-	//result.insert("parent", "Sun");	 // 0.16: omit obvious default.
-	//"comet_orbit" is used for all cases:
-	//"ell_orbit" interprets distances as kilometers, not AUs
-	result.insert("coord_func","comet_orbit");
-
-	//result.insert("color", "1.0, 1.0, 1.0"); // 0.16: omit obvious default.
-	//result.insert("tex_map", "nomap.png");   // 0.16: omit obvious default.
-
-	//Magnitude and slope parameter
-	column = oneLineElements.mid(8,5).trimmed();
-	double absoluteMagnitude = column.toDouble(&ok);
-	if (!ok)
-		return SsoElements();
-	column = oneLineElements.mid(14,5).trimmed();
-	double slopeParameter = column.toDouble(&ok);
-	if (!ok)
-		return SsoElements();
-	result.insert("absolute_magnitude", absoluteMagnitude);
-	result.insert("slope_parameter", slopeParameter);
-
-	//Orbital parameters
-	column = oneLineElements.mid(37, 9).trimmed();
-	double argumentOfPerihelion = column.toDouble(&ok);//J2000.0, degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_ArgOfPericenter", argumentOfPerihelion);
-
-	column = oneLineElements.mid(48, 9).trimmed();
-	double longitudeOfTheAscendingNode = column.toDouble(&ok);//J2000.0, degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_AscendingNode", longitudeOfTheAscendingNode);
-
-	column = oneLineElements.mid(59, 9).trimmed();
-	double inclination = column.toDouble(&ok);//J2000.0, degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_Inclination", inclination);
-
-	column = oneLineElements.mid(70, 9).trimmed();
-	double eccentricity = column.toDouble(&ok);//degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_Eccentricity", eccentricity);
-
-	column = oneLineElements.mid(80, 11).trimmed();
-	double meanDailyMotion = column.toDouble(&ok);//degrees per day
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_MeanMotion", meanDailyMotion);
-
-	column = oneLineElements.mid(92, 11).trimmed();
-	double semiMajorAxis = column.toDouble(&ok);
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_SemiMajorAxis", semiMajorAxis);
-
-	column = oneLineElements.mid(20, 5).trimmed();//Epoch, in packed form
-	QRegExp packedDateFormat("^([IJK])(\\d\\d)([1-9A-C])([1-9A-V])$");
-	if (packedDateFormat.indexIn(column) != 0)
-	{
-		qWarning() << "readMpcOneLineMinorPlanetElements():"
-		         << column << "is not a date in packed format";
-		return SsoElements();
-	}
-	int year = packedDateFormat.cap(2).toInt();
-	switch (packedDateFormat.cap(1).at(0).toLatin1())
-	{
-		case 'I':
-			year += 1800;
-			break;
-		case 'J':
-			year += 1900;
-			break;
-		case 'K':
-		default:
-			year += 2000;
-	}
-	int month = unpackDayOrMonthNumber(packedDateFormat.cap(3).at(0));
-	int day   = unpackDayOrMonthNumber(packedDateFormat.cap(4).at(0));
-	//qDebug() << column << year << month << day;
-	QDate epochDate(year, month, day);
-	if (!epochDate.isValid())
-	{
-		qWarning() << "readMpcOneLineMinorPlanetElements():"
-		         << column << "unpacks to"
-		         << QString("%1-%2-%3").arg(year).arg(month).arg(day)
-				 << "This is not a valid date for an Epoch.";
-		return SsoElements();
-	}
-	//Epoch is at .0 TT, i.e. midnight
-	double epochJD;
-	StelUtils::getJDFromDate(&epochJD, year, month, day, 0, 0, 0);
-	result.insert("orbit_Epoch", epochJD);
-
-	column = oneLineElements.mid(26, 9).trimmed();
-	double meanAnomalyAtEpoch = column.toDouble(&ok);//degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_MeanAnomaly", meanAnomalyAtEpoch);
-
-	// add period for visualization of orbit
-	if (semiMajorAxis>0)
-		result.insert("orbit_visualization_period", StelUtils::calculateSiderealPeriod(semiMajorAxis));
-
-	// 2:3 resonance to Neptune [https://en.wikipedia.org/wiki/Plutino]
-	if ((int)semiMajorAxis == 39)
-		objectType = "plutino";
-
-	// Classical Kuiper belt objects [https://en.wikipedia.org/wiki/Classical_Kuiper_belt_object]
-	if (semiMajorAxis>=40 && semiMajorAxis<=50)
-		objectType = "cubewano";
-
-	// Calculate perihelion
-	float r = (1 - eccentricity)*semiMajorAxis;
-
-	// Scattered disc objects
-	if (r > 35)
-		objectType = "scattered disc object";
-
-	// Sednoids [https://en.wikipedia.org/wiki/Planet_Nine]
-	if (r > 30 && semiMajorAxis > 250)
-		objectType = "sednoid";
-
-	//Radius and albedo
-	//Assume albedo of 0.15 and calculate a radius based on the absolute magnitude
-	//as described here: http://www.physics.sfasu.edu/astro/asteroids/sizemagnitude.html
-	double albedo = 0.15; //Assumed
-	double radius = std::ceil((1329 / std::sqrt(albedo)) * std::pow(10, -0.2 * absoluteMagnitude));
-	result.insert("albedo", albedo);
-	result.insert("radius", radius);
-	result.insert("type", objectType);
-
-	return result;
+	return MpcElementsReader::readMinorPlanetLine(oneLineElements);
 }
+
 /* DEAD CODE. MAYBE REACTIVATE FOR SCRIPTING ACCESS
 SsoElements SolarSystemEditor::readXEphemOneLineElements(QString oneLineElements)
 {
@@ -1122,110 +752,14 @@ SsoElements SolarSystemEditor::readXEphemOneLineElements(QString oneLineElements
 
 QList<SsoElements> SolarSystemEditor::readMpcOneLineCometElementsFromFile(QString filePath) const
 {
-	QList<SsoElements> objectList;
-
-	if (!QFile::exists(filePath))
-	{
-		qDebug() << "Can't find" << QDir::toNativeSeparators(filePath);
-		return objectList;
-	}
-
-	QFile mpcElementsFile(filePath);
-	if (mpcElementsFile.open(QFile::ReadOnly | QFile::Text ))//| QFile::Unbuffered
-	{
-		int candidatesCount = 0;
-		int lineCount = 0;
-
-		while(!mpcElementsFile.atEnd())
-		{
-			QString oneLineElements = QString(mpcElementsFile.readLine(200));
-			if(oneLineElements.endsWith('\n'))
-			{
-				oneLineElements.chop(1);
-			}
-			if (oneLineElements.isEmpty())
-			{
-				qDebug() << "Empty line skipped.";
-				continue;
-			}
-			lineCount++;
-
-			SsoElements ssObject = readMpcOneLineCometElements(oneLineElements);
-			if(!ssObject.isEmpty() && !ssObject.value("section_name").toString().isEmpty())
-			{
-				objectList << ssObject;
-				candidatesCount++;
-			}
-		}
-		mpcElementsFile.close();
-		qDebug() << "Done reading comet orbital elements."
-		         << "Recognized" << candidatesCount << "candidate objects"
-		         << "out of" << lineCount << "lines.";
-
-		return objectList;
-	}
-	else
-	{
-		qDebug() << "Unable to open for reading" << QDir::toNativeSeparators(filePath);
-		qDebug() << "File error:" << mpcElementsFile.errorString();
-		return objectList;
-	}
-
-	return objectList;
+	MpcElementsReader reader(MpcElementsReader::CometFormat);
+	return reader.readFile(filePath);
 }
 
 QList<SsoElements> SolarSystemEditor::readMpcOneLineMinorPlanetElementsFromFile(QString filePath) const
 {
-	QList<SsoElements> objectList;
-
-	if (!QFile::exists(filePath))
-	{
-		qDebug() << "Can't find" << QDir::toNativeSeparators(filePath);
-		return objectList;
-	}
-
-	QFile mpcElementsFile(filePath);
-	if (mpcElementsFile.open(QFile::ReadOnly | QFile::Text ))//| QFile::Unbuffered
-	{
-		int candidatesCount = 0;
-		int lineCount = 0;
-
-		while(!mpcElementsFile.atEnd())
-		{
-			QString oneLineElements = QString(mpcElementsFile.readLine(202 + 2));//Allow for end-of-line characters
-			if(oneLineElements.endsWith('\n'))
-			{
-				oneLineElements.chop(1);
-			}
-			if (oneLineElements.isEmpty())
-			{
-				qDebug() << "Empty line skipped.";
-				continue;
-			}
-			lineCount++;
-
-			SsoElements ssObject = readMpcOneLineMinorPlanetElements(oneLineElements);
-			if(!ssObject.isEmpty() && !ssObject.value("section_name").toString().isEmpty())
-			{
-				objectList << ssObject;
-				candidatesCount++;
-			}
-		}
-		mpcElementsFile.close();
-		qDebug() << "Done reading minor planet orbital elements."
-		         << "Recognized" << candidatesCount << "candidate objects"
-		         << "out of" << lineCount << "lines.";
-
-		return objectList;
-	}
-	else
-	{
-		qDebug() << "Unable to open for reading" << QDir::toNativeSeparators(filePath);
-		qDebug() << "File error:" << mpcElementsFile.errorString();
-		return objectList;
-	}
-
-	return objectList;
+	MpcElementsReader reader(MpcElementsReader::MinorPlanetFormat);
+	return reader.readFile(filePath);
 }
 
 /*
@@ -1311,9 +845,14 @@ bool SolarSystemEditor::appendToSolarSystemConfigurationFile(QList<SsoElements>
 	if (solarSystemSettings->status() != QSettings::NoError)
 	{
 		qDebug() << "Error opening ssystem_minor.ini:" << QDir::toNativeSeparators(customSolarSystemFilePath);
+		delete solarSystemSettings;
 		return false;
 	}
-	foreach (SsoElements object, objectList)
+	//Index the existing sections once instead of asking QSettings for
+	//the full group list for every new object.
+	QSet<QString> existingGroups = solarSystemSettings->childGroups().toSet();
+	bool removedAtLeastOne = false;
+	foreach (const SsoElements& object, objectList)
 	{
 		QString name = object.value("name").toString();
 		if (name.isEmpty())
@@ -1325,56 +864,60 @@ bool SolarSystemEditor::appendToSolarSystemConfigurationFile(QList<SsoElements>
 
 		if (loadedObjects.contains(name))
 		{
-			solarSystemSettings->remove(loadedObjects.value(name));
-			loadedObjects.remove(name);
+			QString loadedGroup = loadedObjects.take(name);
+			solarSystemSettings->remove(loadedGroup);
+			existingGroups.remove(loadedGroup);
+			removedAtLeastOne = true;
 		}
-		else if (solarSystemSettings->childGroups().contains(group))
+		else if (existingGroups.contains(group))
 		{
 			loadedObjects.remove(solarSystemSettings->value(group + "/name").toString());
 			solarSystemSettings->remove(group);
+			existingGroups.remove(group);
+			removedAtLeastOne = true;
 		}
 	}
-	solarSystemSettings->sync();
+	if (removedAtLeastOne)
+		solarSystemSettings->sync();
 	delete solarSystemSettings;
 	solarSystemSettings = Q_NULLPTR;
 
 	//Write to file. (Handle as regular text file, not QSettings.)
+	//All entries are formatted into one buffer first and written in one pass.
 	//TODO: The usual validation
-	qDebug() << "Appending to file...";
-	QFile solarSystemConfigurationFile(customSolarSystemFilePath);
-	if(solarSystemConfigurationFile.open(QFile::WriteOnly | QFile::Append | QFile::Text))
+	QString buffer;
+	int appendedCount = 0;
+	foreach (SsoElements object, objectList)
 	{
-		QTextStream output (&solarSystemConfigurationFile);
-		bool appendedAtLeastOne = false;
-
-		foreach (SsoElements object, objectList)
-		{
-			if (!object.contains("section_name"))
-				continue;
-
-			QString sectionName = object.value("section_name").toString();
-			if (sectionName.isEmpty())
-				continue;
-			object.remove("section_name");
+		QString sectionName = object.take("section_name").toString();
+		if (sectionName.isEmpty())
+			continue;
 
-			QString name = object.value("name").toString();
-			if (name.isEmpty())
-				continue;
+		QString name = object.value("name").toString();
+		if (name.isEmpty())
+			continue;
 
-			output << endl << QString("[%1]").arg(sectionName) << endl;
-			foreach(QString key, object.keys())
-			{
-				output << QString("%1 = %2").arg(key).arg(object.value(key).toString()) << endl;
-			}
-			output.flush();
-			qDebug() << "Appended successfully" << sectionName;
-			appendedAtLeastOne = true;
+		buffer.append(QString("\n[%1]\n").arg(sectionName));
+		for (SsoElements::const_iterator it = object.constBegin(); it != object.constEnd(); ++it)
+		{
+			buffer.append(QString("%1 = %2\n").arg(it.key()).arg(it.value().toString()));
 		}
+		appendedCount++;
+	}
+	if (appendedCount == 0)
+		return false;
 
+	qDebug() << "Appending" << appendedCount << "objects to file...";
+	QFile solarSystemConfigurationFile(customSolarSystemFilePath);
+	if(solarSystemConfigurationFile.open(QFile::WriteOnly | QFile::Append | QFile::Text))
+	{
+		QTextStream output (&solarSystemConfigurationFile);
+		output << buffer;
+		output.flush();
 		solarSystemConfigurationFile.close();
-		qDebug() << "appendToSolarSystemConfigurationFile appended: " << appendedAtLeastOne;
+		qDebug() << "appendToSolarSystemConfigurationFile appended: " << appendedCount;
 
-		return appendedAtLeastOne;
+		return true;
 	}
 	else
 	{
@@ -1418,7 +961,7 @@ bool SolarSystemEditor::updateSolarSystemConfigurationFile(QList<SsoElements> ob
 		qDebug() << "Error opening ssystem.ini:" << QDir::toNativeSeparators(customSolarSystemFilePath);
 		return false;
 	}
-	QStringList existingSections = solarSystem.childGroups();
+	QSet<QString> existingSections = solarSystem.childGroups().toSet();
 	QHash<QString,QString> loadedObjects = listAllLoadedSsoIdentifiers();
 	//TODO: Move to constructor?
 	// This list of elements gets temporarily deleted.
@@ -1553,28 +1096,6 @@ void SolarSystemEditor::updateSsoProperty(QSettings & settings, SsoElements & pr
 	}
 }
 
-QString SolarSystemEditor::convertToGroupName(QString &name, int minorPlanetNumber)
-{
-	//TODO: Should I remove all non-alphanumeric, or only the obviously problematic?
-	QString groupName(name);
-	groupName.remove('\\');
-	groupName.remove('/');
-	groupName.remove('#');
-	groupName.remove(' ');
-	groupName.remove('-');
-	groupName = groupName.toLower();
-
-	//To prevent mix-up between asteroids and satellites:
-	//insert the minor planet number in the section name
-	//(if an asteroid is named, it must be numbered)
-	if (minorPlanetNumber)
-	{
-		groupName.prepend(QString::number(minorPlanetNumber));
-	}
-
-	return groupName;
-}
-
 QString SolarSystemEditor::fixGroupName(QString &name)
 {
 	QString groupName(name);
@@ -1584,112 +1105,3 @@ QString SolarSystemEditor::fixGroupName(QString &name)
 	return groupName;
 }
 
-int SolarSystemEditor::unpackDayOrMonthNumber(QChar digit)
-{
-	//0-9, 0 is an invalid value in the designed use of this function.
-	if (digit.isDigit())
-	{
-		return digit.digitValue();
-	}
-
-	if (digit.isUpper())
-	{
-		char letter = digit.toLatin1();
-		if (letter < 'A' || letter > 'V')
-			return 0;
-		return (10 + (letter - 'A'));
-	}
-	else
-	{
-		return -1;
-	}
-}
-
-int SolarSystemEditor::unpackYearNumber (QChar prefix, int lastTwoDigits)
-{
-	int year = lastTwoDigits;
-	if (prefix == 'I')
-		year += 1800;
-	else if (prefix == 'J')
-		year += 1900;
-	else if (prefix == 'K')
-		year += 2000;
-	else
-		year = 0; //Error
-
-	return year;
-}
-
-//Can be used both for minor planets and comets with no additional modification,
-//as the regular expression for comets will match only capital letters.
-int SolarSystemEditor::unpackAlphanumericNumber (QChar prefix, int lastDigit)
-{
-	int cycleCount = lastDigit;
-	if (prefix.isDigit())
-		cycleCount += prefix.digitValue() * 10;
-	else if (prefix.isLetter() && prefix.isUpper())
-		cycleCount += (10 + prefix.toLatin1() - QChar('A').toLatin1()) * 10;
-	else if (prefix.isLetter() && prefix.isLower())
-		cycleCount += (10 + prefix.toLatin1() - QChar('a').toLatin1()) * 10 + 26*10;
-	else
-		cycleCount = 0; //Error
-
-	return cycleCount;
-}
-
-QString SolarSystemEditor::unpackMinorPlanetProvisionalDesignation (QString packedDesignation)
-{
-	QRegExp packedFormat("^([IJK])(\\d\\d)([A-Z])([\\dA-Za-z])(\\d)([A-Z])$");
-	if (packedFormat.indexIn(packedDesignation) != 0)
-	{
-		QRegExp packedSurveyDesignation("^(PL|T1|T2|T3)S(\\d+)$");
-		if (packedSurveyDesignation.indexIn(packedDesignation) == 0)
-		{
-			int number = packedSurveyDesignation.cap(2).toInt();
-			if (packedSurveyDesignation.cap(1) == "PL")
-			{
-				return QString("%1 P-L").arg(number);
-			}
-			else if (packedSurveyDesignation.cap(1) == "T1")
-			{
-				return QString("%1 T-1").arg(number);
-			}
-			else if (packedSurveyDesignation.cap(1) == "T2")
-			{
-				return QString("%1 T-2").arg(number);
-			}
-			else
-			{
-				return QString("%1 T-3").arg(number);
-			}
-			//TODO: Are there any other surveys?
-		}
-		else
-		{
-			return QString();
-		}
-	}
-
-	//Year
-	QChar yearPrefix = packedFormat.cap(1).at(0);
-	int yearLastTwoDigits = packedFormat.cap(2).toInt();
-	int year = unpackYearNumber(yearPrefix, yearLastTwoDigits);
-
-	//Letters
-	QString halfMonthLetter = packedFormat.cap(3);
-	QString secondLetter = packedFormat.cap(6);
-
-	//Second letter cycle count
-	QChar cycleCountPrefix = packedFormat.cap(4).at(0);
-	int cycleCountLastDigit = packedFormat.cap(5).toInt();
-	int cycleCount = unpackAlphanumericNumber(cycleCountPrefix, cycleCountLastDigit);
-
-	//Assemble the unpacked provisional designation
-	QString result = QString("%1 %2%3").arg(year).arg(halfMonthLetter).arg(secondLetter);
-	if (cycleCount != 0)
-	{
-		result.append(QString::number(cycleCount));
-	}
-
-	return result;
-}
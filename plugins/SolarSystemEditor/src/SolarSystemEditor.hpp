@@ -24,6 +24,7 @@
 
 #include "StelGui.hpp"
 #include "StelModule.hpp"
+#include "MpcElementsReader.hpp"
 //#include "CAIMainWindow.hpp"
 
 #include <QHash>
@@ -35,18 +36,6 @@ class SolarSystemManagerWindow;
 class SolarSystem;
 class QSettings;
 
-//! Convenience type for storage of SSO properties in ssystem_minor.ini format.
-//! This is an easy way of storing data in the format used in Stellarium's
-//! solar system configuration file.
-//! What would be key/value pairs in a section in the ssystem_minor.ini file
-//! are key/value pairs in the hash. The section name is stored with key
-//! "section_name".
-//! As it is a hash, key names are not stored alphabetically. This allows
-//! for rapid addition and look-up of values, unlike a real QSettings
-//! object in StelIniFormat.
-//! Also, using this way may allow scripts to define SSOs.
-//! \todo Better name.
-typedef QHash<QString, QVariant> SsoElements;
 
 /*!
  \class SolarSystemEditor
@@ -93,6 +82,7 @@ public:
 	//! \todo Recognise the long form packed designations (to handle fragments)
 	//! \todo Handle better any unusual symbols in section names (URL encoding?)
 	//! \todo Use column cuts intead of a regular expression?
+	//! \sa MpcElementsReader::readCometLine()
 	SsoElements readMpcOneLineCometElements(QString oneLineElements) const;
 
 	//! Reads a single minor planet's orbital elements from a string.
@@ -104,6 +94,7 @@ public:
 	//! \returns an empty hash if there is an error or the source string is not
 	//! a valid line in MPC format.
 	//! \todo Handle better any unusual symbols in section names (URL encoding?)
+	//! \sa MpcElementsReader::readMinorPlanetLine()
 	SsoElements readMpcOneLineMinorPlanetElements(QString oneLineElements) const;
 /* DEAD CODE. MAYBE REACTIVATE as scripting function (public slot)?
 	//! Reads a single object's orbital elements from a string.
@@ -124,7 +115,8 @@ public:
 	//! hashes in Stellarium's ssystem.ini format.
 	//! Example source file is the list of observable comets on the MPC's site:
 	//! http://www.minorplanetcenter.org/iau/Ephemerides/Comets/Soft00Cmt.txt
-	//! readMpcOneLineCometElements() is used internally to parse each line.
+	//! The file is streamed through MpcElementsReader, which parses it
+	//! in chunks on worker threads.
 	QList<SsoElements> readMpcOneLineCometElementsFromFile(QString filePath) const;
 
 	//! Reads a list of minor planet orbital elements from a file.
@@ -133,7 +125,8 @@ public:
 	//! a list of hashes in Stellarium's ssystem.ini format.
 	//! Example source file is the list of bright asteroids on the MPC's site:
 	//! http://www.minorplanetcenter.org/iau/Ephemerides/Bright/2010/Soft00Bright.txt
-	//! readMpcOneLineMinorPlanetElements() is used internally to parse each line.
+	//! The file is streamed through MpcElementsReader, which parses it
+	//! in chunks on worker threads.
 	QList<SsoElements> readMpcOneLineMinorPlanetElementsFromFile(QString filePath) const;
 
 	/*
@@ -278,35 +271,9 @@ private:
 	//! \returns true if the replacement has been successfull.
 	bool resetSolarSystemConfigurationFile() const;
 
-	//! Converts an alphanumeric digit as used in MPC packed dates to an integer.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDates.html
-	//! Interprets the digits from 0 to 9 normally, and the capital letters
-	//! from A to V as numbers between 10 and 31.
-	//! \returns -1 if the digit is invalid (0 is also an invalid ordinal number
-	//! for a day or month, so this is not a problem)
-	static int unpackDayOrMonthNumber (QChar digit);
-	//! Converts an alphanumeric year number as used in MPC packed dates to an integer.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDates.html
-	//! Also used in packed provisional designations, see
-	//! http://www.minorplanetcenter.org/iau/info/PackedDes.html
-	static int unpackYearNumber (QChar prefix, int lastTwoDigits);
-	//! Converts a two-character number used in MPC packed provisional designations.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
-	//! This function is used for both asteroid and comet designations.
-	static int unpackAlphanumericNumber (QChar prefix, int lastDigit);
-
-	//TODO: This should be public, perhaps?
-	//! Unpacks an MPC packed minor planet provisional designation.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
-	//! \returns an empty string if the argument is not a valid packed
-	//! provisional designation.
-	static QString unpackMinorPlanetProvisionalDesignation(QString packedDesignation);
-
 	//! Updates a value in a configuration file with a value with the same key in a SsoElements hash.
 	static void updateSsoProperty(QSettings& configuration, SsoElements& properties, QString key);
 
-	//! Converts an object name to a key (group) name in a configuration file.
-	static QString convertToGroupName(QString& name, int minorPlanetNumber = 0);
 	//! replaces "%25" by "%", then replaces "%28" by "(" and "%29" by ")".
 	static QString fixGroupName(QString &name);
 };
@@ -0,0 +1,121 @@
+/*
+ * Solar System editor plug-in for Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testMpcElementsReader.hpp"
+#include "MpcElementsReader.hpp"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QFile>
+#include <QObject>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TestMpcElementsReader)
+
+namespace
+{
+	const QString ceresLine("00001    3.34  0.12 K183N 357.92283   73.59764   80.30553   10.59286  0.0760091  0.21411010   2.7660431  0 MPO440365  6917 114 1801-2018 0.60 M-v 30h MPCLINUX   0000      (1) Ceres              20180322");
+	const QString haleBoppLine("    CJ95O010  1997 03 31.4141  0.906507  0.994945  130.5321  282.6820   89.3193  20100723  -2.0  4.0  C/1995 O1 (Hale-Bopp)                                    MPC 61436");
+}
+
+void TestMpcElementsReader::initTestCase()
+{
+	// A synthetic MPCORB.DAT-like list: the Ceres line with running
+	// numbers and without the readable name column.
+	const int count = 20000;
+	const QString body = ceresLine.mid(7, 160 - 7);
+	minorPlanetBuff.reserve(count * 162);
+	for (int i = 1; i <= count; ++i)
+	{
+		minorPlanetBuff.append(QString("%1").arg(i, 7, 10, QChar('0')).toLatin1());
+		minorPlanetBuff.append(body.toLatin1());
+		minorPlanetBuff.append('\n');
+	}
+}
+
+void TestMpcElementsReader::testMinorPlanetLine()
+{
+	SsoElements ceres = MpcElementsReader::readMinorPlanetLine(ceresLine);
+	QCOMPARE(ceres.value("name").toString(), QString("Ceres"));
+	QCOMPARE(ceres.value("section_name").toString(), QString("1ceres"));
+	QCOMPARE(ceres.value("minor_planet_number").toInt(), 1);
+	QCOMPARE(ceres.value("type").toString(), QString("asteroid"));
+	QVERIFY(qAbs(ceres.value("orbit_SemiMajorAxis").toDouble() - 2.7660431) < 1e-9);
+	QVERIFY(qAbs(ceres.value("orbit_Eccentricity").toDouble() - 0.0760091) < 1e-9);
+	QVERIFY(qAbs(ceres.value("absolute_magnitude").toDouble() - 3.34) < 1e-9);
+
+	QVERIFY(MpcElementsReader::readMinorPlanetLine(ceresLine.left(100)).isEmpty());
+}
+
+void TestMpcElementsReader::testCometLine()
+{
+	SsoElements haleBopp = MpcElementsReader::readCometLine(haleBoppLine);
+	QCOMPARE(haleBopp.value("name").toString(), QString("C/1995 O1 (Hale-Bopp)"));
+	QCOMPARE(haleBopp.value("type").toString(), QString("comet"));
+	QVERIFY(qAbs(haleBopp.value("orbit_PericenterDistance").toDouble() - 0.906507) < 1e-9);
+	QVERIFY(qAbs(haleBopp.value("absolute_magnitude").toDouble() + 2.0) < 1e-9);
+}
+
+void TestMpcElementsReader::testDuplicates()
+{
+	QByteArray data = minorPlanetBuff.left(3 * 161);
+	data.append(minorPlanetBuff.left(161));
+	QBuffer buf(&data);
+	buf.open(QIODevice::ReadOnly);
+
+	MpcElementsReader reader(MpcElementsReader::MinorPlanetFormat);
+	reader.setChunkSize(2);
+	QList<SsoElements> objects = reader.readDevice(buf);
+	QCOMPARE(reader.getLineCount(), 4);
+	QCOMPARE(objects.size(), 3);
+	QCOMPARE(reader.getCandidatesCount(), 3);
+	// Source order is kept
+	QCOMPARE(objects.at(0).value("name").toString(), QString("1"));
+	QCOMPARE(objects.at(2).value("name").toString(), QString("3"));
+}
+
+void TestMpcElementsReader::benchmarkReadDevice()
+{
+	QBuffer buf(&minorPlanetBuff);
+	buf.open(QIODevice::ReadOnly);
+	MpcElementsReader reader(MpcElementsReader::MinorPlanetFormat);
+	QList<SsoElements> objects;
+	QBENCHMARK {
+		buf.seek(0);
+		objects = reader.readDevice(buf);
+	}
+	QCOMPARE(objects.size(), 20000);
+}
+
+//! Set MPC_SAMPLE_FILE to a local copy of MPCORB.DAT (or any other file in
+//! the MPC one-line minor planet format) to measure the real throughput.
+void TestMpcElementsReader::benchmarkReadSampleFile()
+{
+	const QString filePath = QString::fromLocal8Bit(qgetenv("MPC_SAMPLE_FILE"));
+	if (filePath.isEmpty() || !QFile::exists(filePath))
+		QSKIP("MPC_SAMPLE_FILE is not set");
+
+	MpcElementsReader reader(MpcElementsReader::MinorPlanetFormat);
+	QList<SsoElements> objects;
+	QBENCHMARK_ONCE {
+		objects = reader.readFile(filePath);
+	}
+	QVERIFY(!objects.isEmpty());
+	qDebug() << reader.getLineCount() << "lines," << reader.getCandidatesCount() << "objects,"
+		 << (reader.getElapsedTime() > 0 ? reader.getLineCount() * 1000 / reader.getElapsedTime() : 0) << "lines/s";
+}
@@ -26,7 +26,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelPluginCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -370,41 +370,23 @@ bool Supernovae::backupJsonFile(bool deleteOriginal)
 */
 void Supernovae::readJsonFile(void)
 {
-	setSNeMap(loadSNeMap());
+	StelPluginCatalog catalog(sneJsonPath, "supernova");
+	catalog.load();
+	setSNeCatalog(catalog);
 }
 
 /*
-  Parse JSON file and load supernovaes to map
+  Set items for list of struct from the catalog
 */
-QVariantMap Supernovae::loadSNeMap(QString path)
-{
-	if (path.isEmpty())
-	    path = sneJsonPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Supernovae] cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-		jsonFile.close();
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Supernovae::setSNeMap(const QVariantMap& map)
+void Supernovae::setSNeCatalog(const StelPluginCatalog& catalog)
 {
 	snstar.clear();
 	snlist.clear();
 	SNCount = 0;
-	QVariantMap sneMap = map.value("supernova").toMap();
-	foreach(QString sneKey, sneMap.keys())
+	for (int i=0; i<catalog.size(); ++i)
 	{
-		QVariantMap sneData = sneMap.value(sneKey).toMap();
+		const QString sneKey = catalog.getName(i);
+		QVariantMap sneData = catalog.getEntry(i);
 		sneData["designation"] = QString("SN %1").arg(sneKey);
 
 		snlist.insert(sneData.value("designation").toString(), sneData.value("peakJD").toDouble());
@@ -418,45 +400,24 @@ void Supernovae::setSNeMap(const QVariantMap& map)
 }
 
 int Supernovae::getJsonFileVersion(void) const
-{	
+{
 	int jsonVersion = -1;
-	QFile sneJsonFile(sneJsonPath);
-	if (!sneJsonFile.open(QIODevice::ReadOnly))
+	const QVariantMap header = StelPluginCatalog::readHeader(sneJsonPath, QStringList("version"));
+	if (header.contains("version"))
 	{
-		qWarning() << "[Supernovae] cannot open" << QDir::toNativeSeparators(sneJsonPath);
-		return jsonVersion;
+		jsonVersion = header.value("version").toInt();
 	}
 
-	QVariantMap map;
-	map = StelJsonParser::parse(&sneJsonFile).toMap();
-	if (map.contains("version"))
-	{
-		jsonVersion = map.value("version").toInt();
-	}
-
-	sneJsonFile.close();
 	qDebug() << "[Supernovae] version of the catalog:" << jsonVersion;
 	return jsonVersion;
 }
 
 bool Supernovae::checkJsonFileFormat() const
 {
-	QFile sneJsonFile(sneJsonPath);
-	if (!sneJsonFile.open(QIODevice::ReadOnly))
+	StelPluginCatalog catalog(sneJsonPath, "supernova");
+	if (!catalog.load())
 	{
-		qWarning() << "[Supernovae] cannot open " << QDir::toNativeSeparators(sneJsonPath);
-		return false;
-	}
-
-	QVariantMap map;
-	try
-	{
-		map = StelJsonParser::parse(&sneJsonFile).toMap();
-		sneJsonFile.close();
-	}
-	catch (std::runtime_error& e)
-	{
-		qDebug() << "[Supernovae] file format is wrong! Error:" << e.what();
+		qDebug() << "[Supernovae] file format is wrong!";
 		return false;
 	}
 
@@ -466,21 +427,12 @@ bool Supernovae::checkJsonFileFormat() const
 float Supernovae::getLowerLimitBrightness() const
 {
 	float lowerLimit = 10.f;
-	QFile sneJsonFile(sneJsonPath);
-	if (!sneJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Supernovae] cannot open" << QDir::toNativeSeparators(sneJsonPath);
-		return lowerLimit;
-	}
-
-	QVariantMap map;
-	map = StelJsonParser::parse(&sneJsonFile).toMap();
-	if (map.contains("limit"))
+	const QVariantMap header = StelPluginCatalog::readHeader(sneJsonPath, QStringList("limit"));
+	if (header.contains("limit"))
 	{
-		lowerLimit = map.value("limit").toFloat();
+		lowerLimit = header.value("limit").toFloat();
 	}
 
-	sneJsonFile.close();
 	return lowerLimit;
 }
 
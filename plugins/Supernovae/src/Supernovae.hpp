@@ -38,6 +38,7 @@ class QTimer;
 class SupernovaeDialog;
 
 class StelPainter;
+class StelPluginCatalog;
 
 /*! @defgroup historicalSupernovae Historical Supernovae Plug-in
 @{
@@ -212,11 +213,8 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void) const;
 
-	//! Parse JSON file and load supernovaes to map
-	QVariantMap loadSNeMap(QString path=QString());
-
-	//! Set items for list of struct from data map
-	void setSNeMap(const QVariantMap& map);
+	//! Set items for list of struct from the catalog
+	void setSNeCatalog(const StelPluginCatalog& catalog);
 
 	QString sneJsonPath;
 
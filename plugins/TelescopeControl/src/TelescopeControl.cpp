@@ -28,6 +28,7 @@
 #include "StelUtils.hpp"
 #include "TelescopeControl.hpp"
 #include "TelescopeClient.hpp"
+#include "TelescopeIOThread.hpp"
 #include "TelescopeDialog.hpp"
 #include "SlewDialog.hpp"
 #include "LogFile.hpp"
@@ -63,6 +64,22 @@
 
 #define DEFAULT_RTS2_REFRESH    500000
 
+namespace
+{
+//! A client living in the I/O thread must be destroyed by that thread
+//! (or when it finishes), the other ones are destroyed at once.
+struct TelescopeClientDeleter
+{
+	void operator()(TelescopeClient* telescope) const
+	{
+		if (telescope->usesIOThread())
+			telescope->deleteLater();
+		else
+			delete telescope;
+	}
+};
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 StelModule* TelescopeControlStelPluginInterface::getStelModule() const
@@ -90,6 +107,7 @@ StelPluginInfo TelescopeControlStelPluginInterface::getPluginInfo() const
 // Constructor and destructor
 TelescopeControl::TelescopeControl()
 	: toolbarButton(Q_NULLPTR)
+	, ioThread(new TelescopeIOThread(this))
 	, useTelescopeServerLogs(false)
 	, useServerExecutables(false)
 	, telescopeDialog(Q_NULLPTR)
@@ -148,6 +166,7 @@ void TelescopeControl::init()
 			existence to return a value.*/
 		
 		//Load and start all telescope clients
+		ioThread->start();
 		loadTelescopes();
 		
 		//Load OpenGL textures
@@ -234,6 +253,9 @@ void TelescopeControl::deinit()
 {
 	//Destroy all clients first in order to avoid displaying a TCP error
 	deleteAllTelescopes();
+	//The clients of the thread are destroyed when it finishes
+	ioThread->quit();
+	ioThread->wait();
 
 	QHash<int, QProcess*>::const_iterator iterator = telescopeServerProcess.constBegin();
 	while(iterator != telescopeServerProcess.constEnd())
@@ -437,7 +459,14 @@ void TelescopeControl::telescopeGoto(int slotNumber, const Vec3d &j2000Pos, Stel
 {
 	//TODO: See the original code. I think that something is wrong here...
 	if(telescopeClients.contains(slotNumber))
-		telescopeClients.value(slotNumber)->telescopeGoto(j2000Pos, selectObject);
+	{
+		const TelescopeClientP& telescope = telescopeClients[slotNumber];
+		if (telescope->usesIOThread())
+			QMetaObject::invokeMethod(telescope.data(), "telescopeGoto", Qt::QueuedConnection,
+						  Q_ARG(Vec3d, j2000Pos), Q_ARG(StelObjectP, selectObject));
+		else
+			telescope->telescopeGoto(j2000Pos, selectObject);
+	}
 }
 
 void TelescopeControl::communicate(void)
@@ -447,6 +476,11 @@ void TelescopeControl::communicate(void)
 		QMap<int, TelescopeClientP>::const_iterator telescope = telescopeClients.constBegin();
 		while (telescope != telescopeClients.end())
 		{
+			if (telescope.value()->usesIOThread())
+			{
+				telescope++;
+				continue;
+			}
 			logAtSlot(telescope.key());//If there's no log, it will be ignored
 			if(telescope.value()->prepareCommunication())
 			{
@@ -463,9 +497,11 @@ void TelescopeControl::communicate(void)
 //
 void TelescopeControl::deleteAllTelescopes()
 {
-	//TODO: I really hope that this won't cause a memory leak...
-	//foreach (TelescopeClient* telescope, telescopeClients)
-	//	delete telescope;
+	foreach (const TelescopeClientP& telescope, telescopeClients)
+	{
+		if (telescope->usesIOThread())
+			ioThread->removeClient(telescope.data());
+	}
 	telescopeClients.clear();
 }
 
@@ -1306,7 +1342,9 @@ bool TelescopeControl::startClientAtSlot(int slotNumber, ConnectionType connecti
 			for (int i = 0; i < circles.size(); ++i)
 				newTelescope->addOcular(circles[i]);
 
-		telescopeClients.insert(slotNumber, TelescopeClientP(newTelescope));
+		telescopeClients.insert(slotNumber, TelescopeClientP(newTelescope, TelescopeClientDeleter()));
+		if (newTelescope->usesIOThread())
+			ioThread->addClient(newTelescope, telescopeServerLogStreams.value(slotNumber, Q_NULLPTR));
 		return true;
 	}
 
@@ -1331,7 +1369,9 @@ bool TelescopeControl::stopClientAtSlot(int slotNumber)
 	{
 		GETSTELMODULE(StelObjectMgr)->unSelect();
 	}
-	telescopeClients.remove(slotNumber);
+	const TelescopeClientP telescope = telescopeClients.take(slotNumber);
+	if (telescope->usesIOThread())
+		ioThread->removeClient(telescope.data());
 
 	//This is not needed by every client
 	removeLogAtSlot(slotNumber);
@@ -53,6 +53,7 @@ class StelPainter;
 class StelProjector;
 class TelescopeClient;
 class TelescopeDialog;
+class TelescopeIOThread;
 class SlewDialog;
 
 
@@ -289,6 +290,7 @@ private:
 	void drawPointer(const StelProjectorP& prj, const StelCore* core, StelPainter& sPainter);
 
 	//! Perform the communication with the telescope servers
+	//! which do not communicate from ioThread
 	void communicate(void);
 	
 	LinearFader labelFader;
@@ -314,6 +316,8 @@ private:
 	
 	//! Contains the initialized telescope client objects representing the telescopes that Stellarium is connected to or attempting to connect to.
 	QMap<int, TelescopeClientP> telescopeClients;
+	//! The thread in which the clients which support it communicate
+	TelescopeIOThread* ioThread;
 	//! Contains QProcess objects of the currently running telescope server processes that have been launched by Stellarium.
 	QHash<int, QProcess*> telescopeServerProcess;
 	QStringList telescopeServers;
@@ -25,8 +25,9 @@
 
 #include "InterpolatedPosition.hpp"
 
-InterpolatedPosition::InterpolatedPosition() :
-		end_position(positions+(sizeof(positions)/sizeof(positions[0])))
+#include <cstring>
+
+InterpolatedPosition::InterpolatedPosition() : current(0), sequence(0)
 {
 	reset();
 }
@@ -38,51 +39,74 @@ InterpolatedPosition::~InterpolatedPosition()
 
 void InterpolatedPosition::reset()
 {
-	for (position_pointer = positions; position_pointer < end_position; position_pointer++)
+	sequence.fetchAndAddOrdered(1);
+	for (int i = 0; i < size; i++)
 	{
-		position_pointer->server_micros = INT64_MAX;
-		position_pointer->client_micros = INT64_MAX;
-		position_pointer->pos[0] = 0.0;
-		position_pointer->pos[1] = 0.0;
-		position_pointer->pos[2] = 0.0;
-		position_pointer->status = 0;
+		positions[i].server_micros = INT64_MAX;
+		positions[i].client_micros = INT64_MAX;
+		positions[i].pos[0] = 0.0;
+		positions[i].pos[1] = 0.0;
+		positions[i].pos[2] = 0.0;
+		positions[i].status = 0;
 	}
-	position_pointer = positions;
+	current = 0;
+	sequence.fetchAndAddOrdered(1);
 }
 
 void InterpolatedPosition::add(Vec3d &position, qint64 clientTime, qint64 serverTime, int status)
 {
 	// remember the time and received position so that later we
 	// will know where the telescope is pointing to:
-	position_pointer++;
-	if (position_pointer >= end_position)
-		position_pointer = positions;
+	sequence.fetchAndAddOrdered(1);
+	current = (current + 1) % size;
+	positions[current].pos = position;
+	positions[current].server_micros = serverTime;
+	positions[current].client_micros = clientTime;
+	positions[current].status = status;
+	sequence.fetchAndAddOrdered(1);
+}
+
+int InterpolatedPosition::snapshot(Position* copy) const
+{
+	for (;;)
+	{
+		const int before = sequence.loadAcquire();
+		if (before & 1)
+			continue; // being written
+		std::memcpy(copy, positions, sizeof(positions));
+		const int last = current;
+		// the ordered operation keeps the copy before the second read of the sequence
+		if (sequence.fetchAndAddOrdered(0) == before)
+			return last;
+	}
+}
 
-	position_pointer->pos = position;
-	position_pointer->server_micros = serverTime;
-	position_pointer->client_micros = clientTime;
-	position_pointer->status = status;
+bool InterpolatedPosition::isKnown() const
+{
+	Position copy[size];
+	const int last = snapshot(copy);
+	return (copy[last].client_micros != INT64_MAX);
 }
 
 Vec3d InterpolatedPosition::get(qint64 now) const
 {
-	if (position_pointer->client_micros == INT64_MAX)
+	Position copy[size];
+	const int last = snapshot(copy);
+	if (copy[last].client_micros == INT64_MAX)
 	{
 		return Vec3d(0,0,0);
 	}
 
-	const Position *p = position_pointer;
+	int p = last;
 	do
 	{
-		const Position *pp = p;
-		if (pp == positions) pp = end_position;
-		pp--;
-		if (pp->client_micros == INT64_MAX) break;
-		if (pp->client_micros <= now && now <= p->client_micros)
+		const int pp = (p + size - 1) % size;
+		if (copy[pp].client_micros == INT64_MAX) break;
+		if (copy[pp].client_micros <= now && now <= copy[p].client_micros)
 		{
-			if (pp->client_micros != p->client_micros)
+			if (copy[pp].client_micros != copy[p].client_micros)
 			{
-				Vec3d rval = p->pos * (now - pp->client_micros) + pp->pos * (p->client_micros - now);
+				Vec3d rval = copy[p].pos * (now - copy[pp].client_micros) + copy[pp].pos * (copy[p].client_micros - now);
 				double f = rval.lengthSquared();
 				if (f > 0.0)
 				{
@@ -93,7 +117,7 @@ Vec3d InterpolatedPosition::get(qint64 now) const
 		}
 		p = pp;
 	}
-	while (p != position_pointer);
+	while (p != last);
 
-	return Vec3d(p->pos);
+	return Vec3d(copy[p].pos);
 }
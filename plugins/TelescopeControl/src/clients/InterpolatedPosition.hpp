@@ -33,6 +33,8 @@
 
 #include "VecMath.hpp"
 
+#include <QAtomicInt>
+
 //! A telescope's position at a given time.
 //! This structure used to be defined inline in TelescopeTCP.
 struct Position
@@ -43,6 +45,11 @@ struct Position
 	int status;
 };
 
+//! The last positions received from a telescope.
+//! The positions are written by the thread communicating with the telescope and read
+//! by the thread drawing it, without locking: the writer increments a sequence number
+//! before and after each change, and the readers copy the positions again until the
+//! number is even and did not change during the copy.
 class InterpolatedPosition {
 public:
 	InterpolatedPosition();
@@ -53,12 +60,19 @@ public:
 	Vec3d get(qint64 time) const;
 	//! resets/initializes the array of positions kept for position interpolation
 	void reset();
-	bool isKnown() const {return (position_pointer->client_micros != INT64_MAX);}
+	bool isKnown() const;
 	
 private:
-	Position positions[16];
-	Position *position_pointer;
-	Position *const end_position;
+	static const int size = 16;
+	//! Copy the positions into copy.
+	//! @return the index of the last position in copy.
+	int snapshot(Position* copy) const;
+
+	Position positions[size];
+	//! Index of the last added position
+	int current;
+	//! Odd while the positions are being changed
+	mutable QAtomicInt sequence;
 };
  
  #endif //_INTEPOLATED_POSITION_HPP_
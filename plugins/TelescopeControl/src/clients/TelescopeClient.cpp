@@ -170,9 +170,10 @@ qint64 getNow(void)
 TelescopeTCP::TelescopeTCP(const QString &name, const QString &params, Equinox eq)
 	: TelescopeClient(name)
 	, port(0)
-	, tcpSocket(new QTcpSocket())
+	, tcpSocket(new QTcpSocket(this))
 	, end_of_timeout(0)
 	, time_delay(0)
+	, connected(0)
 	, equinox(eq)
 {
 	hangup();
@@ -244,6 +245,7 @@ TelescopeTCP::TelescopeTCP(const QString &name, const QString &params, Equinox e
 	interpolatedPosition.reset();
 	
 	connect(tcpSocket, SIGNAL(connected()), this, SLOT(socketConnected()));
+	connect(tcpSocket, SIGNAL(readyRead()), this, SLOT(socketReadyRead()));
 	connect(tcpSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(socketFailed(QAbstractSocket::SocketError)));
 }
 
@@ -257,6 +259,7 @@ void TelescopeTCP::hangup(void)
 	readBufferEnd = readBuffer;
 	writeBufferEnd = writeBuffer;
 	wait_for_connection_establishment = false;
+	connected.storeRelease(0);
 	
 	interpolatedPosition.reset();
 }
@@ -479,7 +482,8 @@ Vec3d TelescopeTCP::getJ2000EquatorialPos(const StelCore*) const
 //@return true if the socket is connected
 bool TelescopeTCP::prepareCommunication()
 {
-	if(tcpSocket->state() == QAbstractSocket::ConnectedState)
+	connected.storeRelease(tcpSocket->state() == QAbstractSocket::ConnectedState);
+	if(connected.loadAcquire())
 	{
 		if(wait_for_connection_establishment)
 		{
@@ -513,16 +517,10 @@ bool TelescopeTCP::prepareCommunication()
 
 void TelescopeTCP::performCommunication()
 {
-	if (tcpSocket->state() == QAbstractSocket::ConnectedState)
+	// the positions are read as soon as they arrive, in socketReadyRead()
+	if (tcpSocket->state() == QAbstractSocket::ConnectedState && writeBufferEnd > writeBuffer)
 	{
 		performWriting();
-		
-		if (tcpSocket->bytesAvailable() > 0)
-		{
-			//If performReading() is called when there are no bytes to read,
-			//it closes the connection
-			performReading();
-		}
 	}
 }
 
@@ -532,6 +530,16 @@ void TelescopeTCP::socketConnected(void)
 	tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
 }
 
+void TelescopeTCP::socketReadyRead(void)
+{
+	//If performReading() is called when there are no bytes to read,
+	//it closes the connection
+	if (tcpSocket->bytesAvailable() > 0)
+	{
+		performReading();
+	}
+}
+
 //TODO: More informative error messages?
 void TelescopeTCP::socketFailed(QAbstractSocket::SocketError)
 {
@@ -26,6 +26,7 @@
 #ifndef _TELESCOPE_HPP_
 #define _TELESCOPE_HPP_
 
+#include <QAtomicInt>
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QList>
@@ -79,7 +80,8 @@ public:
 	virtual double getAngularSize(const StelCore*) const {Q_ASSERT(0); return 0;}	// TODO
 		
 	// Methods specific to telescope
-	virtual void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject) = 0;
+	//! Invokable, so that it can be queued to the thread of the client.
+	Q_INVOKABLE virtual void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject) = 0;
 	virtual bool isConnected(void) const = 0;
 	virtual bool hasKnownPosition(void) const = 0;
 	void addOcular(double fov) {if (fov>=0.0) oculars.push_back(fov);}
@@ -87,6 +89,10 @@ public:
 	
 	virtual bool prepareCommunication() {return false;}
 	virtual void performCommunication() {}
+	//! Whether the client communicates from the I/O thread of the plug-in (see TelescopeIOThread).
+	//! Such a client must be thread-safe in isConnected(), hasKnownPosition() and getJ2000EquatorialPos(),
+	//! which are called while drawing.
+	virtual bool usesIOThread() const {return false;}
 
 protected:
 	TelescopeClient(const QString &name);
@@ -171,9 +177,9 @@ public:
 	}
 	bool isConnected(void) const
 	{
-		//return (tcpSocket->isValid() && !wait_for_connection_establishment);
-		return (tcpSocket->state() == QAbstractSocket::ConnectedState);
+		return connected.loadAcquire();
 	}
+	bool usesIOThread() const {return true;}
 	
 private:
 	Vec3d getJ2000EquatorialPos(const StelCore* core=Q_NULLPTR) const;
@@ -199,6 +205,8 @@ private:
 	char writeBuffer[120];
 	char *writeBufferEnd;
 	int time_delay;
+	//! Whether the socket is connected, as last seen by the communicating thread
+	QAtomicInt connected;
 
 	InterpolatedPosition interpolatedPosition;
 	virtual bool hasKnownPosition(void) const
@@ -210,6 +218,7 @@ private:
 	
 private slots:
 	void socketConnected(void);
+	void socketReadyRead(void);
 	void socketFailed(QAbstractSocket::SocketError socketError);
 };
 
@@ -44,6 +44,7 @@ TelescopeClientDirectLx200::TelescopeClientDirectLx200 (const QString &name, con
 	, last_ra(0)
 	, queue_get_position(true)
 	, next_pos_time(0)
+	, connected(0)
 {
 	interpolatedPosition.reset();
 	
@@ -89,6 +90,7 @@ TelescopeClientDirectLx200::TelescopeClientDirectLx200 (const QString &name, con
 	
 	// lx200 will be deleted in the destructor of Server
 	addConnection(lx200);
+	connected.storeRelease(1);
 	
 	long_format_used = false; // unknown
 	last_ra = 0;
@@ -153,7 +155,8 @@ bool TelescopeClientDirectLx200::prepareCommunication()
 
 void TelescopeClientDirectLx200::performCommunication()
 {
-	step(10000);
+	// the I/O thread calls this regularly, there is no need to wait for the serial port
+	step(0);
 }
 
 void TelescopeClientDirectLx200::communicationResetReceived(void)
@@ -218,11 +221,12 @@ void TelescopeClientDirectLx200::step(long long int timeout_micros)
 		next_pos_time = now + 500000;// 500000;
 	}
 	Server::step(timeout_micros);
+	connected.storeRelease(!lx200->isClosed());
 }
 
 bool TelescopeClientDirectLx200::isConnected(void) const
 {
-	return (!lx200->isClosed());//TODO
+	return connected.loadAcquire();
 }
 
 bool TelescopeClientDirectLx200::isInitialized(void) const
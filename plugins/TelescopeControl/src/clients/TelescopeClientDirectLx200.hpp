@@ -53,6 +53,7 @@ public:
 	//======================================================================
 	// Methods inherited from TelescopeClient
 	bool isConnected(void) const;
+	bool usesIOThread() const {return true;}
 	
 	//======================================================================
 	// Methods inherited from Server
@@ -98,6 +99,8 @@ private:
 	unsigned int last_ra;
 	bool queue_get_position;
 	long long int next_pos_time;
+	//! Whether the serial connection is open, as last seen by the communicating thread
+	QAtomicInt connected;
 };
 
 #endif //_TELESCOPE_CLIENT_DIRECT_LX200_
@@ -42,6 +42,7 @@ TelescopeClientDirectNexStar::TelescopeClientDirectNexStar(const QString &name,
 	, last_ra(0)
 	, queue_get_position(true)
 	, next_pos_time(0)
+	, connected(0)
 {
 	interpolatedPosition.reset();
 	
@@ -87,6 +88,7 @@ TelescopeClientDirectNexStar::TelescopeClientDirectNexStar(const QString &name,
 	
 	//This connection will be deleted in the destructor of Server
 	addConnection(nexstar);
+	connected.storeRelease(1);
 	
 	last_ra = 0;
 	queue_get_position = true;
@@ -149,7 +151,8 @@ bool TelescopeClientDirectNexStar::prepareCommunication()
 
 void TelescopeClientDirectNexStar::performCommunication()
 {
-	step(10000);
+	// the I/O thread calls this regularly, there is no need to wait for the serial port
+	step(0);
 }
 
 void TelescopeClientDirectNexStar::communicationResetReceived(void)
@@ -193,11 +196,12 @@ void TelescopeClientDirectNexStar::step(long long int timeout_micros)
 		next_pos_time = now + 500000;
 	}
 	Server::step(timeout_micros);
+	connected.storeRelease(!nexstar->isClosed());
 }
 
 bool TelescopeClientDirectNexStar::isConnected(void) const
 {
-	return (!nexstar->isClosed());//TODO
+	return connected.loadAcquire();
 }
 
 bool TelescopeClientDirectNexStar::isInitialized(void) const
@@ -0,0 +1,82 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "TelescopeIOThread.hpp"
+#include "TelescopeClient.hpp"
+#include "LogFile.hpp"
+
+#include <QMutexLocker>
+#include <QTimer>
+
+TelescopeIOThread::TelescopeIOThread(QObject* parent) : QThread(parent)
+{
+	setObjectName("TelescopeIOThread");
+}
+
+TelescopeIOThread::~TelescopeIOThread()
+{
+	quit();
+	wait();
+}
+
+void TelescopeIOThread::addClient(TelescopeClient* client, QTextStream* log)
+{
+	client->moveToThread(this);
+	QMutexLocker locker(&mutex);
+	Client entry;
+	entry.client = client;
+	entry.log = log;
+	clients.append(entry);
+}
+
+void TelescopeIOThread::removeClient(TelescopeClient* client)
+{
+	// waits for the end of the current communication
+	QMutexLocker locker(&mutex);
+	for (int i = 0; i < clients.size(); ++i)
+	{
+		if (clients.at(i).client == client)
+		{
+			clients.removeAt(i);
+			break;
+		}
+	}
+}
+
+void TelescopeIOThread::run()
+{
+	QTimer timer;
+	timer.setTimerType(Qt::PreciseTimer);
+	// this object lives in the thread which created it, the slot must be called directly
+	connect(&timer, SIGNAL(timeout()), this, SLOT(communicate()), Qt::DirectConnection);
+	timer.start(pollInterval);
+	exec();
+}
+
+void TelescopeIOThread::communicate()
+{
+	QMutexLocker locker(&mutex);
+	foreach (const Client& entry, clients)
+	{
+		// log_file is thread local, the main thread keeps its own
+		if (entry.log)
+			log_file = entry.log;
+		if (entry.client->prepareCommunication())
+			entry.client->performCommunication();
+	}
+}
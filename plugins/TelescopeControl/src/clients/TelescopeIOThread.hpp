@@ -0,0 +1,70 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TELESCOPE_IO_THREAD_HPP_
+#define _TELESCOPE_IO_THREAD_HPP_
+
+#include <QList>
+#include <QMutex>
+#include <QThread>
+
+class QTextStream;
+class TelescopeClient;
+
+//! The thread in which the telescope clients which poll their connection communicate,
+//! so that waiting for a telescope never delays the drawing of a frame.
+//! The clients are moved to the thread, whose event loop delivers their socket
+//! notifications and calls their prepareCommunication() and performCommunication()
+//! methods every pollInterval milliseconds.
+class TelescopeIOThread : public QThread
+{
+	Q_OBJECT
+public:
+	//! Interval between two calls to the communication methods of the clients [ms]
+	static const int pollInterval = 10;
+
+	TelescopeIOThread(QObject* parent = Q_NULLPTR);
+	~TelescopeIOThread();
+
+	//! Move the client to the thread, which communicates with it from now on.
+	//! Its methods may then only be called from the thread, except the ones
+	//! reading its state, and it must be destroyed with deleteLater().
+	//! @param log the log of the telescope server of the client, or Q_NULLPTR.
+	void addClient(TelescopeClient* client, QTextStream* log);
+	//! Stop communicating with the client. When this returns, the thread does not use
+	//! the client nor its log anymore.
+	void removeClient(TelescopeClient* client);
+
+protected:
+	void run();
+
+private slots:
+	void communicate();
+
+private:
+	struct Client
+	{
+		TelescopeClient* client;
+		QTextStream* log;
+	};
+	//! Held while the clients communicate
+	QMutex mutex;
+	QList<Client> clients;
+};
+
+#endif // _TELESCOPE_IO_THREAD_HPP_
@@ -38,6 +38,9 @@ public:
 
 QTextStream &operator<<(QTextStream &o, const Now &now);
 
-extern QTextStream *log_file;
+//! The log of the telescope being served. It is selected by each thread for itself
+//! (TelescopeControl in the main thread, TelescopeIOThread for its clients), so that
+//! a thread never writes to the log of a telescope served by another one.
+extern thread_local QTextStream *log_file;
 
 #endif
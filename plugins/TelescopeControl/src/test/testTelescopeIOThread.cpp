@@ -0,0 +1,99 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testTelescopeIOThread.hpp"
+
+#include "TelescopeClient.hpp"
+#include "TelescopeIOThread.hpp"
+
+#include <QDataStream>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+QTEST_GUILESS_MAIN(TestTelescopeIOThread)
+
+void TestTelescopeIOThread::init()
+{
+	qRegisterMetaType<Vec3d>();
+
+	server = new QTcpServer(this);
+	QVERIFY(server->listen(QHostAddress::LocalHost));
+	connection = Q_NULLPTR;
+
+	ioThread = new TelescopeIOThread();
+	ioThread->start();
+	client = new TelescopeTCP("test", QString("127.0.0.1:%1:500000").arg(server->serverPort()));
+	ioThread->addClient(client, Q_NULLPTR);
+	QCOMPARE(client->thread(), static_cast<QThread*>(ioThread));
+
+	// the I/O thread connects by itself
+	QTRY_VERIFY_WITH_TIMEOUT(server->hasPendingConnections(), 10000);
+	connection = server->nextPendingConnection();
+	QTRY_VERIFY(client->isConnected());
+}
+
+void TestTelescopeIOThread::cleanup()
+{
+	ioThread->removeClient(client);
+	client->deleteLater();
+	// the client is deleted when the thread finishes
+	delete ioThread;
+	delete server;
+}
+
+void TestTelescopeIOThread::sendPosition(unsigned int ra, int dec)
+{
+	QByteArray msg;
+	QDataStream stream(&msg, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream << quint16(24) << quint16(0) << qint64(getNow()) << quint32(ra) << qint32(dec) << qint32(0);
+	connection->write(msg);
+	connection->flush();
+}
+
+void TestTelescopeIOThread::testPosition()
+{
+	QVERIFY(!client->hasKnownPosition());
+	// RA 6h, Dec 0
+	sendPosition(0x40000000u, 0);
+	// nothing but the I/O thread reads the socket of the client
+	QTRY_VERIFY(client->hasKnownPosition());
+	const Vec3d pos = client->getJ2000EquatorialPos(Q_NULLPTR);
+	QVERIFY((pos - Vec3d(0., 1., 0.)).length() < 1e-6);
+}
+
+void TestTelescopeIOThread::testGoto()
+{
+	// queued to the I/O thread, like TelescopeControl does
+	QVERIFY(QMetaObject::invokeMethod(client, "telescopeGoto", Qt::QueuedConnection,
+					  Q_ARG(Vec3d, Vec3d(0., 0., 1.)), Q_ARG(StelObjectP, StelObjectP())));
+
+	// the command is written by the next communication of the thread
+	QTRY_VERIFY(connection->bytesAvailable() >= 20);
+	QDataStream stream(connection);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	quint16 size, type;
+	qint64 clientMicros;
+	quint32 ra;
+	qint32 dec;
+	stream >> size >> type >> clientMicros >> ra >> dec;
+	QCOMPARE(size, quint16(20));
+	QCOMPARE(type, quint16(0));
+	// Dec +90
+	QCOMPARE(dec, qint32(0x40000000));
+}
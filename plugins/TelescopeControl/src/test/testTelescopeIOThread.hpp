@@ -0,0 +1,51 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTTELESCOPEIOTHREAD_HPP_
+#define _TESTTELESCOPEIOTHREAD_HPP_
+
+#include <QObject>
+#include <QTest>
+
+class QTcpServer;
+class QTcpSocket;
+class TelescopeClient;
+class TelescopeIOThread;
+
+//! Connects a TelescopeTCP client communicating from a TelescopeIOThread
+//! to a simulated telescope server speaking the Stellarium telescope protocol.
+class TestTelescopeIOThread : public QObject
+{
+Q_OBJECT
+private slots:
+	void init();
+	void cleanup();
+	void testPosition();
+	void testGoto();
+
+private:
+	//! Send a position message (type 0) to the client
+	void sendPosition(unsigned int ra, int dec);
+
+	QTcpServer* server;
+	QTcpSocket* connection;
+	TelescopeIOThread* ioThread;
+	TelescopeClient* client;
+};
+
+#endif // _TESTTELESCOPEIOTHREAD_HPP_
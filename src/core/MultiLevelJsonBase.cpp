@@ -17,6 +17,7 @@
  */
 
 #include "MultiLevelJsonBase.hpp"
+#include "StelBinaryCache.hpp"
 #include "StelJsonParser.hpp"
 #include "StelApp.hpp"
 #include "StelFileMgr.hpp"
@@ -64,11 +65,12 @@ QNetworkAccessManager& MultiLevelJsonBase::getNetworkAccessManager()
 class JsonLoadThread : public QThread
 {
 	public:
-		JsonLoadThread(MultiLevelJsonBase* atile, QByteArray content, bool aqZcompressed=false, bool agzCompressed=false) : QThread((QObject*)atile),
-			tile(atile), data(content), qZcompressed(aqZcompressed), gzCompressed(agzCompressed){;}
+		JsonLoadThread(MultiLevelJsonBase* atile, const QString& aurl, QByteArray content, bool aqZcompressed=false, bool agzCompressed=false) : QThread((QObject*)atile),
+			tile(atile), url(aurl), data(content), qZcompressed(aqZcompressed), gzCompressed(agzCompressed){;}
 		virtual void run();
 	private:
 		MultiLevelJsonBase* tile;
+		QString url;
 		QByteArray data;
 		const bool qZcompressed;
 		const bool gzCompressed;
@@ -78,9 +80,7 @@ void JsonLoadThread::run()
 {
 	try
 	{
-		QBuffer buf(&data);
-		buf.open(QIODevice::ReadOnly);
-		tile->temporaryResultMap = MultiLevelJsonBase::loadFromJSON(buf, qZcompressed, gzCompressed);
+		tile->temporaryResultMap = MultiLevelJsonBase::loadFromJSONCached(url, data, qZcompressed, gzCompressed);
 	}
 	catch (std::runtime_error e)
 	{
@@ -138,7 +138,7 @@ void MultiLevelJsonBase::initFromUrl(const QString& url)
 			const bool gzCompressed = fileName.endsWith(".gz");
 			try
 			{
-				loadFromQVariantMap(loadFromJSON(f, compressed, gzCompressed));
+				loadFromQVariantMap(loadFromJSONCached(fileName, f.readAll(), compressed, gzCompressed));
 			}
 			catch (std::runtime_error e)
 			{
@@ -285,6 +285,116 @@ QVariantMap MultiLevelJsonBase::loadFromJSON(QIODevice& input, bool qZcompressed
 }
 
 
+QVariantMap MultiLevelJsonBase::loadFromJSONCached(const QString& key, const QByteArray& content, bool qZcompressed, bool gzCompressed)
+{
+	const QByteArray sourceHash = StelBinaryCache::hash(content);
+	QVariant cached;
+	if (StelBinaryCache::load(key, sourceHash, cached))
+		return cached.toMap();
+
+	QByteArray data(content);
+	QBuffer buf(&data);
+	buf.open(QIODevice::ReadOnly);
+	QVariantMap map = loadFromJSON(buf, qZcompressed, gzCompressed);
+	compileWorldRegions(map);
+	StelBinaryCache::save(key, sourceHash, map);
+	return map;
+}
+
+QList<SphericalRegionP> MultiLevelJsonBase::loadWorldRegions(const QVariantMap& map)
+{
+	QList<SphericalRegionP> regions;
+	if (map.contains("worldRegions"))
+	{
+		foreach (const QVariant& reg, map.value("worldRegions").toList())
+			regions.append(reg.value<SphericalRegionP>());
+		return regions;
+	}
+
+	// Load the convex polygons (if any)
+	QVariantList polyList = map.value("skyConvexPolygons").toList();
+	if (polyList.empty())
+		polyList = map.value("worldCoords").toList();
+	else
+		qWarning() << "skyConvexPolygons in preview JSON files is deprecated. Replace with worldCoords.";
+
+	// Load the matching textures positions (if any)
+	QVariantList texCoordList = map.value("textureCoords").toList();
+	if (!texCoordList.isEmpty() && polyList.size()!=texCoordList.size())
+			throw std::runtime_error("the number of convex polygons does not match the number of texture space polygon");
+
+	bool ok=false;
+	for (int i=0;i<polyList.size();++i)
+	{
+		const QVariant& polyRaDec = polyList.at(i);
+		QVector<Vec3d> vertices;
+		foreach (const QVariant& vRaDec, polyRaDec.toList())
+		{
+			const QVariantList vl = vRaDec.toList();
+			Vec3d v;
+			StelUtils::spheToRect(vl.at(0).toFloat(&ok)*M_PI/180.f, vl.at(1).toFloat(&ok)*M_PI/180.f, v);
+			if (!ok)
+				throw std::runtime_error("wrong Ra and Dec, expect a double value");
+			vertices.append(v);
+		}
+		Q_ASSERT(vertices.size()==4);
+
+		if (!texCoordList.isEmpty())
+		{
+			const QVariant& polyXY = texCoordList.at(i);
+			QVector<Vec2f> texCoords;
+			foreach (const QVariant& vXY, polyXY.toList())
+			{
+				const QVariantList vl = vXY.toList();
+				texCoords.append(Vec2f(vl.at(0).toFloat(&ok), vl.at(1).toFloat(&ok)));
+				if (!ok)
+					throw std::runtime_error("wrong X and Y, expect a double value");
+			}
+			Q_ASSERT(texCoords.size()==4);
+
+			SphericalTexturedConvexPolygon* pol = new SphericalTexturedConvexPolygon(vertices, texCoords);
+			Q_ASSERT(pol->checkValid());
+			regions.append(SphericalRegionP(pol));
+		}
+		else
+		{
+			SphericalConvexPolygon* pol = new SphericalConvexPolygon(vertices);
+			Q_ASSERT(pol->checkValid());
+			regions.append(SphericalRegionP(pol));
+		}
+	}
+	return regions;
+}
+
+void MultiLevelJsonBase::compileWorldRegions(QVariantMap& map)
+{
+	if (map.contains("worldCoords") || map.contains("skyConvexPolygons"))
+	{
+		QVariantList regions;
+		foreach (const SphericalRegionP& reg, loadWorldRegions(map))
+			regions.append(QVariant::fromValue(reg));
+		map.remove("skyConvexPolygons");
+		map.remove("worldCoords");
+		map.remove("textureCoords");
+		map.insert("worldRegions", regions);
+	}
+
+	// The subtiles may be given inline instead of by URL
+	if (map.contains("subTiles"))
+	{
+		QVariantList subTiles = map.value("subTiles").toList();
+		for (int i=0;i<subTiles.size();++i)
+		{
+			if (subTiles.at(i).type()!=QVariant::Map)
+				continue;
+			QVariantMap subMap = subTiles.at(i).toMap();
+			compileWorldRegions(subMap);
+			subTiles[i] = subMap;
+		}
+		map.insert("subTiles", subTiles);
+	}
+}
+
 // Called when the download for the JSON file terminated
 void MultiLevelJsonBase::downloadFinished()
 {
@@ -315,11 +425,12 @@ void MultiLevelJsonBase::downloadFinished()
 
 	const bool qZcompressed = httpReply->request().url().path().endsWith(".qZ");
 	const bool gzCompressed = httpReply->request().url().path().endsWith(".gz");
+	const QString url = httpReply->request().url().toString();
 	httpReply->deleteLater();
 	httpReply=Q_NULLPTR;
 
 	Q_ASSERT(loadThread==Q_NULLPTR);
-	loadThread = new JsonLoadThread(this, content, qZcompressed, gzCompressed);
+	loadThread = new JsonLoadThread(this, url, content, qZcompressed, gzCompressed);
 	connect(loadThread, SIGNAL(finished()), this, SLOT(jsonLoadFinished()));
 	loadThread->start(QThread::LowestPriority);
 }
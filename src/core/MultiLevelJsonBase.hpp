@@ -20,6 +20,7 @@
 #define _MULTILEVELJSONBASE_HPP_
 
 #include "StelSkyLayer.hpp"
+#include "StelSphereGeometry.hpp"
 
 #include <QList>
 #include <QString>
@@ -112,10 +113,23 @@ protected:
 	//! Load the element information from a JSON file
 	static QVariantMap loadFromJSON(QIODevice& input, bool qZcompressed=false, bool gzCompressed=false);
 
+	//! Load the element information from the content of a JSON file, or from the binary cache if the same
+	//! content was already loaded. The polygons are converted to "worldRegions" before being cached,
+	//! so that neither the JSON parsing nor the creation of the polygons is done again.
+	//! @param key identifies the file in the cache, i.e. its path or URL.
+	static QVariantMap loadFromJSONCached(const QString& key, const QByteArray& content, bool qZcompressed=false, bool gzCompressed=false);
+
+	//! Get the sky polygons of an element. They are taken from "worldRegions" if they were already
+	//! created by loadFromJSONCached(), else from "worldCoords" and the optional "textureCoords".
+	static QList<SphericalRegionP> loadWorldRegions(const QVariantMap& map);
+
 private:
 	//! Return the base URL prefixed to relative URL
 	QString getBaseUrl() const {return baseUrl;}
 
+	//! Replace the polygon coordinates of the element and of its inline subtiles by "worldRegions".
+	static void compileWorldRegions(QVariantMap& map);
+
 	// Used to download remote JSON files if needed
 	class QNetworkReply* httpReply;
 
@@ -23,6 +23,8 @@
 #include "glues.h"
 
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 
 const Vec3d OctahedronPolygon::sideDirections[] = {	Vec3d(1,1,1), Vec3d(1,1,-1),Vec3d(-1,1,1),Vec3d(-1,1,-1),
 	Vec3d(1,-1,1),Vec3d(1,-1,-1),Vec3d(-1,-1,1),Vec3d(-1,-1,-1)};
@@ -110,7 +112,7 @@ OctahedronPolygon::OctahedronPolygon(const QVector<QVector<Vec3d> >& contours) :
 	updateVertexArray();
 }
 
-OctahedronPolygon::OctahedronPolygon(const SubContour& initContour)
+OctahedronPolygon::OctahedronPolygon(const SubContour& initContour) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines)
 {
 	sides.resize(8);
 	appendSubContour(initContour);
@@ -129,8 +131,9 @@ OctahedronPolygon::OctahedronPolygon(const QList<OctahedronPolygon>& octs) : fil
 			Q_ASSERT(oct.sides.size()==8);
 			sides[i] += oct.sides[i];
 		}
-		tesselate(WindingPositive);
 	}
+	// The positive winding rule gives the union of all the contours in one pass
+	tesselate(WindingPositive);
 	updateVertexArray();
 }
 
@@ -377,10 +380,60 @@ inline void unprojectOctahedron(Vec3d& v, const Vec3d& sideDirection)
 void OctahedronPolygon::updateVertexArray()
 {
 	Q_ASSERT(sides.size()==8);
-	fillCachedVertexArray.vertex.clear();
 	outlineCachedVertexArray.vertex.clear();
 
+	// Compute the outline contours, getting rid of non edge segments
+	for (int sidenb=0;sidenb<8;++sidenb)
+	{
+		const Vec3d& sideDirection = sideDirections[sidenb];
+		EdgeVertex previous;
+		foreach (const SubContour& c, sides[sidenb])
+		{
+			Q_ASSERT(!c.isEmpty());
+			previous = c.first();
+			unprojectOctahedron(previous.vertex, sideDirection);
+			for (int j=0;j<c.size()-1;++j)
+			{
+				if (previous.edgeFlag || c.at(j+1).edgeFlag)
+				{
+					outlineCachedVertexArray.vertex.append(previous.vertex);
+					previous=c.at(j+1);
+					unprojectOctahedron(previous.vertex, sideDirection);
+					outlineCachedVertexArray.vertex.append(previous.vertex);
+				}
+				else
+				{
+					previous=c.at(j+1);
+					unprojectOctahedron(previous.vertex, sideDirection);
+				}
+			}
+			// Last point connects with first point
+			if (previous.edgeFlag || c.first().edgeFlag)
+			{
+				outlineCachedVertexArray.vertex.append(previous.vertex);
+				outlineCachedVertexArray.vertex.append(c.first().vertex);
+				unprojectOctahedron(outlineCachedVertexArray.vertex.last(), sideDirection);
+			}
+		}
+	}
+	computeBoundingCap();
+
+	// The triangles are computed on demand
+	fillCachedVertexArray.vertex.clear();
+	fillCachedVertexArrayValid.storeRelease(0);
+}
+
+void OctahedronPolygon::updateFillVertexArray() const
+{
+	// Polygons may be shared by several threads, e.g. the sky image tiles
+	static QMutex mutex;
+	QMutexLocker locker(&mutex);
+	if (fillCachedVertexArrayValid.loadAcquire())
+		return;
+
 	Q_ASSERT(sides.size()==8);
+	QVector<Vec3d> triangles;
+
 	// Use GLUES tesselation functions to transform the polygon into a list of triangles
 	GLUEStesselator* tess = gluesNewTess();
 #ifndef NDEBUG
@@ -408,12 +461,12 @@ void OctahedronPolygon::updateVertexArray()
 			isTriangleConvexPositive2D(res.at(j+2), res.at(j+1), res.at(j)) :
 			isTriangleConvexPositive2D(res.at(j), res.at(j+1), res.at(j+2))))
 			{
-				fillCachedVertexArray.vertex+=res.at(j);
-				unprojectOctahedron(fillCachedVertexArray.vertex.last(), sideDirection);
-				fillCachedVertexArray.vertex+=res.at(j+1);
-				unprojectOctahedron(fillCachedVertexArray.vertex.last(), sideDirection);
-				fillCachedVertexArray.vertex+=res.at(j+2);
-				unprojectOctahedron(fillCachedVertexArray.vertex.last(), sideDirection);
+				triangles+=res.at(j);
+				unprojectOctahedron(triangles.last(), sideDirection);
+				triangles+=res.at(j+1);
+				unprojectOctahedron(triangles.last(), sideDirection);
+				triangles+=res.at(j+2);
+				unprojectOctahedron(triangles.last(), sideDirection);
 			}
 			else
 			{
@@ -421,50 +474,18 @@ void OctahedronPolygon::updateVertexArray()
 				//qDebug() << "Found a fucking CW triangle";
 			}
 		}
-
-		// Now compute the outline contours, getting rid of non edge segments
-		EdgeVertex previous;
-		foreach (const SubContour& c, sides[sidenb])
-		{
-			Q_ASSERT(!c.isEmpty());
-			previous = c.first();
-			unprojectOctahedron(previous.vertex, sideDirection);
-			for (int j=0;j<c.size()-1;++j)
-			{
-				if (previous.edgeFlag || c.at(j+1).edgeFlag)
-				{
-					outlineCachedVertexArray.vertex.append(previous.vertex);
-					previous=c.at(j+1);
-					unprojectOctahedron(previous.vertex, sideDirection);
-					outlineCachedVertexArray.vertex.append(previous.vertex);
-				}
-				else
-				{
-					previous=c.at(j+1);
-					unprojectOctahedron(previous.vertex, sideDirection);
-				}
-			}
-			// Last point connects with first point
-			if (previous.edgeFlag || c.first().edgeFlag)
-			{
-				outlineCachedVertexArray.vertex.append(previous.vertex);
-				outlineCachedVertexArray.vertex.append(c.first().vertex);
-				unprojectOctahedron(outlineCachedVertexArray.vertex.last(), sideDirection);
-			}
-		}
 	}
 	gluesDeleteTess(tess);
-	computeBoundingCap();
 
 #ifndef NDEBUG
 	// Check that all triangles are properly oriented
 	QVector<Vec3d> c;
 	c.resize(3);
-	for (int j=0;j<fillCachedVertexArray.vertex.size()/3;++j)
+	for (int j=0;j<triangles.size()/3;++j)
 	{
-		c[0]=fillCachedVertexArray.vertex.at(j*3);
-		c[1]=fillCachedVertexArray.vertex.at(j*3+1);
-		c[2]=fillCachedVertexArray.vertex.at(j*3+2);
+		c[0]=triangles.at(j*3);
+		c[1]=triangles.at(j*3+1);
+		c[2]=triangles.at(j*3+2);
 		Q_ASSERT(SphericalConvexPolygon::checkValidContour(c));
 	}
 #else
@@ -473,6 +494,9 @@ void OctahedronPolygon::updateVertexArray()
 	QVector<Vec3d> c;
 	c.resize(3);
 #endif
+
+	fillCachedVertexArray.vertex = triangles;
+	fillCachedVertexArrayValid.storeRelease(1);
 }
 
 struct OctTessLineLoopCallbackData
@@ -641,11 +665,12 @@ bool OctahedronPolygon::contains(const Vec3d& p) const
 {
 	if (sides[getSideNumber(p)].isEmpty())
 		return false;
-	for (int i=0;i<fillCachedVertexArray.vertex.size()/3;++i)
+	const QVector<Vec3d>& trianglesArray = getFillVertexArray().vertex;
+	for (int i=0;i<trianglesArray.size()/3;++i)
 	{
-		if (sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+1), fillCachedVertexArray.vertex.at(i*3), p) &&
-			sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+2), fillCachedVertexArray.vertex.at(i*3+1), p) &&
-			sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3), fillCachedVertexArray.vertex.at(i*3+2), p))
+		if (sideHalfSpaceContains(trianglesArray.at(i*3+1), trianglesArray.at(i*3), p) &&
+			sideHalfSpaceContains(trianglesArray.at(i*3+2), trianglesArray.at(i*3+1), p) &&
+			sideHalfSpaceContains(trianglesArray.at(i*3), trianglesArray.at(i*3+2), p))
 			return true;
 	}
 	return false;
@@ -881,7 +906,7 @@ QDataStream& operator<<(QDataStream& out, const OctahedronPolygon& p)
 	{
 		out << p.sides[i];
 	}
-	out << p.fillCachedVertexArray;
+	out << p.getFillVertexArray();
 	out << p.outlineCachedVertexArray;
 	out << p.capN;
 	out << p.capD;
@@ -897,6 +922,7 @@ QDataStream& operator>>(QDataStream& in, OctahedronPolygon& p)
 	}
 //	p.updateVertexArray();
 	in >> p.fillCachedVertexArray;
+	p.fillCachedVertexArrayValid.storeRelease(1);
 	in >> p.outlineCachedVertexArray;
 	in >> p.capN;
 	in >> p.capD;
@@ -23,6 +23,7 @@
 #include "StelVertexArray.hpp"
 #include "VecMath.hpp"
 
+#include <QAtomicInt>
 #include <QVector>
 #include <QDebug>
 #include <QVarLengthArray>
@@ -60,10 +61,12 @@ public:
 //! Manage a non-convex polygon which can extends on more than 180 deg.
 //! The contours defining the polygon are splitted and projected on the 8 sides of an Octahedron to enable 2D geometry
 //! algorithms to be used.
+//! The triangles of the fill vertex array are only computed the first time they are needed, so that the intermediate
+//! results of a series of boolean operations are never triangulated.
 class OctahedronPolygon
 {
 public:
-	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.)
+	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), fillCachedVertexArrayValid(1), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.)
 	{sides.resize(8);}
 
 	//! Create the OctahedronPolygon by splitting the passed SubContour on the 8 sides of the octahedron.
@@ -77,7 +80,12 @@ public:
 	Vec3d getPointInside() const;
 
 	//! Returns the list of triangles resulting from tesselating the contours.
-	StelVertexArray getFillVertexArray() const {return fillCachedVertexArray;}
+	StelVertexArray getFillVertexArray() const
+	{
+		if (!fillCachedVertexArrayValid.loadAcquire())
+			updateFillVertexArray();
+		return fillCachedVertexArray;
+	}
 	StelVertexArray getOutlineVertexArray() const {return outlineCachedVertexArray;}
 
 	void getBoundingCap(Vec3d& v, double& d) const {v=capN; d=capD;}
@@ -140,9 +148,12 @@ private:
 	QVector<Vec3d> tesselateOneSideTriangles(struct GLUEStesselator* tess, int sidenb) const;
 	QVarLengthArray<QVector<SubContour>,8 > sides;
 
-	//! Update the content of both cached vertex arrays.
+	//! Update the outline vertex array and the bounding cap, and invalidate the fill vertex array.
 	void updateVertexArray();
-	StelVertexArray fillCachedVertexArray;
+	//! Triangulate the contours into the fill vertex array. Thread safe.
+	void updateFillVertexArray() const;
+	mutable StelVertexArray fillCachedVertexArray;
+	mutable QAtomicInt fillCachedVertexArrayValid;
 	StelVertexArray outlineCachedVertexArray;
 	void computeBoundingCap();
 	Vec3d capN;
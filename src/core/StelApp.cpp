@@ -42,6 +42,8 @@
 #include "ToastMgr.hpp"
 #include "StelActionMgr.hpp"
 #include "StelPropertyMgr.hpp"
+#include "StelFrameProfiler.hpp"
+#include "StelStatePublisher.hpp"
 #include "StelProgressController.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelLocaleMgr.hpp"
@@ -213,6 +215,8 @@ StelApp::StelApp(StelMainView *parent)
 	, skyCultureMgr(Q_NULLPTR)
 	, actionMgr(Q_NULLPTR)
 	, propMgr(Q_NULLPTR)
+	, frameProfiler(Q_NULLPTR)
+	, statePublisher(Q_NULLPTR)
 	, textureMgr(Q_NULLPTR)
 	, stelObjectMgr(Q_NULLPTR)
 	, planetLocationMgr(Q_NULLPTR)
@@ -435,6 +439,10 @@ void StelApp::init(QSettings* conf)
 	localeMgr = new StelLocaleMgr();
 	skyCultureMgr = new StelSkyCultureMgr();
 	propMgr->registerObject(skyCultureMgr);
+	frameProfiler = new StelFrameProfiler(this);
+	propMgr->registerObject(frameProfiler);
+	statePublisher = new StelStatePublisher(this);
+	moduleMgr->setConcurrentUpdates(confSettings->value("main/flag_concurrent_updates", true).toBool());
 	planetLocationMgr = new StelLocationMgr();
 	actionMgr = new StelActionMgr();
 
@@ -628,6 +636,7 @@ void StelApp::deinit()
 	QCoreApplication::processEvents();
 	getModuleMgr().unloadAllPlugins();
 	QCoreApplication::processEvents();
+	frameProfiler->deinitGL();
 	StelPainter::deinitGLShaders();
 }
 
@@ -663,17 +672,25 @@ void StelApp::update(double deltaTime)
 		frameTimeAccum=0.;
 	}
 		
+	// Checked once, so that the profiler costs nothing when disabled
+	const bool profile = frameProfiler->isEnabled();
+	if (profile)
+		frameProfiler->beginPhase(StelFrameProfiler::Update);
+
 	core->update(deltaTime);
 
 	moduleMgr->update();
 
-	// Send the event to every StelModule
-	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionUpdate))
-	{
-		i->update(deltaTime);
-	}
+	// Send the event to every StelModule, in parallel where possible
+	moduleMgr->updateModules(deltaTime, profile ? frameProfiler : Q_NULLPTR);
 
 	stelObjectMgr->update(deltaTime);
+
+	// Publish the state of this frame, if anybody uses it
+	statePublisher->update(deltaTime);
+
+	if (profile)
+		frameProfiler->endPhase();
 }
 
 void StelApp::prepareRenderBuffer()
@@ -710,14 +727,29 @@ void StelApp::draw()
 	prepareRenderBuffer();
 	currentFbo = renderBuffer ? renderBuffer->handle() : drawFbo;
 
+	const bool profile = frameProfiler->isEnabled();
+	if (profile)
+		frameProfiler->beginPhase(StelFrameProfiler::Draw);
+
 	core->preDraw();
 
 	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionDraw);
 	foreach(StelModule* module, modules)
 	{
+		if (profile)
+			frameProfiler->beginModule(module);
 		module->draw(core);
+		if (profile)
+			frameProfiler->endModule();
 	}
 	core->postDraw();
+
+	if (profile)
+	{
+		frameProfiler->endPhase();
+		if (frameProfiler->isOverlayVisible())
+			frameProfiler->drawOverlay(core);
+	}
 #ifdef ENABLE_SPOUT
 	// At this point, the sky scene has been drawn, but no GUI panels.
 	if(spoutSender)
@@ -48,6 +48,8 @@ class StelMainScriptAPIProxy;
 class StelScriptMgr;
 class StelActionMgr;
 class StelPropertyMgr;
+class StelFrameProfiler;
+class StelStatePublisher;
 class StelProgressController;
 
 #ifdef 	ENABLE_SPOUT
@@ -139,6 +141,12 @@ public:
 	//! Return the property manager
 	StelPropertyMgr* getStelPropertyManager() {return propMgr;}
 
+	//! Return the profiler of the module updates and draws
+	StelFrameProfiler* getFrameProfiler() {return frameProfiler;}
+
+	//! Return the publisher of the state snapshots, which other threads can read without locking
+	StelStatePublisher* getStatePublisher() {return statePublisher;}
+
 	//! Get the video manager
 	StelVideoMgr* getStelVideoMgr() {return videoMgr;}
 
@@ -325,6 +333,12 @@ private:
 	//Property manager for the application
 	StelPropertyMgr* propMgr;
 
+	// Per module timing of update() and draw()
+	StelFrameProfiler* frameProfiler;
+
+	// Snapshots of the state for the other threads
+	StelStatePublisher* statePublisher;
+
 	// Textures manager for the application
 	StelTextureMgr* textureMgr;
 
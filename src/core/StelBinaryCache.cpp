@@ -0,0 +1,94 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelBinaryCache.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// "SBC1", and the version of the file format. Increase it when the serialization
+// of a type which can be stored changes, e.g. SphericalRegion or OctahedronPolygon.
+static const quint32 CacheFileMagic = 0x53424331;
+static const quint32 CacheFileVersion = 1;
+
+QByteArray StelBinaryCache::hash(const QByteArray& content)
+{
+	return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+QString StelBinaryCache::getFilePath(const QString& key)
+{
+	const QString name = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+	return StelFileMgr::getCacheDir() + "/binary/" + name + ".bin";
+}
+
+bool StelBinaryCache::load(const QString& key, const QByteArray& sourceHash, QVariant& value)
+{
+	QFile file(getFilePath(key));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_4);
+	quint32 magic = 0, version = 0;
+	QByteArray storedHash;
+	in >> magic >> version;
+	if (magic!=CacheFileMagic || version!=CacheFileVersion)
+		return false;
+	in >> storedHash;
+	if (storedHash!=sourceHash)
+		return false;
+	in >> value;
+	if (in.status()!=QDataStream::Ok || !value.isValid())
+	{
+		qWarning() << "Invalid binary cache file" << QDir::toNativeSeparators(file.fileName()) << "for" << key;
+		value = QVariant();
+		return false;
+	}
+	return true;
+}
+
+void StelBinaryCache::save(const QString& key, const QByteArray& sourceHash, const QVariant& value)
+{
+	const QString path = getFilePath(key);
+	const QString dir = QFileInfo(path).absolutePath();
+	if (!StelFileMgr::mkDir(dir))
+	{
+		qWarning() << "Cannot create the binary cache directory" << QDir::toNativeSeparators(dir);
+		return;
+	}
+
+	// Write to a temporary file first so that a concurrent load never reads a partial file
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "Cannot write binary cache file" << QDir::toNativeSeparators(path) << "for" << key;
+		return;
+	}
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_4);
+	out << CacheFileMagic << CacheFileVersion << sourceHash << value;
+	if (out.status()!=QDataStream::Ok || !file.commit())
+		qWarning() << "Cannot write binary cache file" << QDir::toNativeSeparators(path) << "for" << key;
+}
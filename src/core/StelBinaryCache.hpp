@@ -0,0 +1,58 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELBINARYCACHE_HPP_
+#define _STELBINARYCACHE_HPP_
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+
+//! @class StelBinaryCache
+//! On-disk cache of data which is slow to compute from a source file, like
+//! the parsed description of sky image tiles or the tesselated polygon of a
+//! landscape horizon.
+//!
+//! Values are stored as QVariant in the binary QDataStream format, so that they
+//! may contain any type with registered stream operators, e.g. SphericalRegionP.
+//! Each value is stored under a key (usually the path or the URL of the source)
+//! together with a hash of the source content, and is only returned while the
+//! source is unchanged.
+//!
+//! The cache is optional: all errors are logged and reported as cache misses.
+//! The methods can be called from any thread.
+class StelBinaryCache
+{
+public:
+	//! Compute the hash identifying the content of a source.
+	static QByteArray hash(const QByteArray& content);
+
+	//! Get the value stored for key.
+	//! @param sourceHash the hash of the current content of the source.
+	//! @return false if there is no value, or if it was computed from another content.
+	static bool load(const QString& key, const QByteArray& sourceHash, QVariant& value);
+
+	//! Store value for key, replacing the previous one.
+	static void save(const QString& key, const QByteArray& sourceHash, const QVariant& value);
+
+private:
+	//! Path of the cache file for key.
+	static QString getFilePath(const QString& key);
+};
+
+#endif // _STELBINARYCACHE_HPP_
@@ -70,12 +70,17 @@ const double StelCore::JD_DAY    = 1.;
 const double StelCore::ONE_OVER_JD_SECOND = 86400;		// 86400
 const double StelCore::TZ_ERA_BEGINNING = 2395996.5;		// December 1, 1847
 
+// Keys of the projector cache: 2 per frame type (with and without refraction) and the 2d projection
+static const int ProjectorCache2d = 2*(StelCore::FrameSupergalactic+1);
+static const int ProjectorCacheSize = ProjectorCache2d+1;
+
 StelCore::StelCore()
 	: skyDrawer(Q_NULLPTR)
 	, movementMgr(Q_NULLPTR)
 	, geodesicGrid(Q_NULLPTR)
 	, currentProjectionType(ProjectionStereographic)
 	, currentDeltaTAlgorithm(EspenakMeeus)
+	, projectorCache(ProjectorCacheSize)
 	, position(Q_NULLPTR)
 	, flagUseNutation(true)
 	, flagUseTopocentricCoordinates(true)	
@@ -237,6 +242,9 @@ void StelCore::init()
 
 	skyDrawer = new StelSkyDrawer(this);
 	skyDrawer->init();
+	// The refraction is copied into the projectors
+	connect(skyDrawer, SIGNAL(atmosphereTemperatureChanged(double)), this, SLOT(clearProjectorCache()));
+	connect(skyDrawer, SIGNAL(atmospherePressureChanged(double)), this, SLOT(clearProjectorCache()));
 
 	propMgr->registerObject(skyDrawer);
 	propMgr->registerObject(this);
@@ -337,54 +345,49 @@ const StelGeodesicGrid* StelCore::getGeodesicGrid(int maxLevel) const
 
 StelProjectorP StelCore::getProjection2d() const
 {
-	StelProjectorP prj(new StelProjector2d());
-	prj->init(currentProjectorParams);
+	StelProjectorP prj = projectorCache.find(ProjectorCache2d, -1, currentProjectorParams);
+	if (prj.isNull())
+		prj = projectorCache.insert(ProjectorCache2d, -1, currentProjectorParams, new StelProjector2d());
 	return prj;
 }
 
-StelProjectorP StelCore::getProjection(StelProjector::ModelViewTranformP modelViewTransform, ProjectionType projType) const
+StelProjector* StelCore::createProjector(StelProjector::ModelViewTranformP modelViewTransform, ProjectionType projType) const
 {
-	if (projType==1000)
-		projType = currentProjectionType;
-
-	StelProjectorP prj;
 	switch (projType)
 	{
 		case ProjectionPerspective:
-			prj = StelProjectorP(new StelProjectorPerspective(modelViewTransform));
-			break;
+			return new StelProjectorPerspective(modelViewTransform);
 		case ProjectionEqualArea:
-			prj = StelProjectorP(new StelProjectorEqualArea(modelViewTransform));
-			break;
+			return new StelProjectorEqualArea(modelViewTransform);
 		case ProjectionStereographic:
-			prj = StelProjectorP(new StelProjectorStereographic(modelViewTransform));
-			break;
+			return new StelProjectorStereographic(modelViewTransform);
 		case ProjectionFisheye:
-			prj = StelProjectorP(new StelProjectorFisheye(modelViewTransform));
-			break;
+			return new StelProjectorFisheye(modelViewTransform);
 		case ProjectionHammer:
-			prj = StelProjectorP(new StelProjectorHammer(modelViewTransform));
-			break;
+			return new StelProjectorHammer(modelViewTransform);
 		case ProjectionCylinder:
-			prj = StelProjectorP(new StelProjectorCylinder(modelViewTransform));
-			break;
+			return new StelProjectorCylinder(modelViewTransform);
 		case ProjectionMercator:
-			prj = StelProjectorP(new StelProjectorMercator(modelViewTransform));
-			break;
+			return new StelProjectorMercator(modelViewTransform);
 		case ProjectionOrthographic:
-			prj = StelProjectorP(new StelProjectorOrthographic(modelViewTransform));
-			break;
+			return new StelProjectorOrthographic(modelViewTransform);
 		case ProjectionSinusoidal:
-			prj = StelProjectorP(new StelProjectorSinusoidal(modelViewTransform));
-			break;
+			return new StelProjectorSinusoidal(modelViewTransform);
 		case ProjectionMiller:
-			prj = StelProjectorP(new StelProjectorMiller(modelViewTransform));
-			break;
+			return new StelProjectorMiller(modelViewTransform);
 		default:
 			qWarning() << "Unknown projection type: " << (int)(projType) << "using ProjectionStereographic instead";
-			prj = StelProjectorP(new StelProjectorStereographic(modelViewTransform));
 			Q_ASSERT(0);
+			return new StelProjectorStereographic(modelViewTransform);
 	}
+}
+
+StelProjectorP StelCore::getProjection(StelProjector::ModelViewTranformP modelViewTransform, ProjectionType projType) const
+{
+	if (projType==1000)
+		projType = currentProjectionType;
+
+	StelProjectorP prj(createProjector(modelViewTransform, projType));
 	prj->init(currentProjectorParams);
 	return prj;
 }
@@ -392,29 +395,54 @@ StelProjectorP StelCore::getProjection(StelProjector::ModelViewTranformP modelVi
 // Get an instance of projector using the current display parameters from Navigation, StelMovementMgr
 StelProjectorP StelCore::getProjection(FrameType frameType, RefractionMode refractionMode) const
 {
+	if (frameType<FrameAltAz || frameType>FrameSupergalactic)
+	{
+		qDebug() << "Unknown reference frame type: " << (int)frameType << ".";
+		Q_ASSERT(0);
+		return getProjection2d();
+	}
+
+	// RefractionAuto gives the same transform as one of the two others
+	const bool refraction = !(refractionMode==RefractionOff || skyDrawer==Q_NULLPTR || (refractionMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false));
+	const RefractionMode refMode = refraction ? RefractionOn : RefractionOff;
+	const int key = 2*frameType + (refraction ? 1 : 0);
+	StelProjectorP prj = projectorCache.find(key, currentProjectionType, currentProjectorParams);
+	if (!prj.isNull())
+		return prj;
+
+	StelProjector::ModelViewTranformP transform;
 	switch (frameType)
 	{
 		case FrameAltAz:
-			return getProjection(getAltAzModelViewTransform(refractionMode));
+			transform = getAltAzModelViewTransform(refMode);
+			break;
 		case FrameHeliocentricEclipticJ2000:
-			return getProjection(getHeliocentricEclipticModelViewTransform(refractionMode));
+			transform = getHeliocentricEclipticModelViewTransform(refMode);
+			break;
 		case FrameObservercentricEclipticJ2000:
-			return getProjection(getObservercentricEclipticJ2000ModelViewTransform(refractionMode));
+			transform = getObservercentricEclipticJ2000ModelViewTransform(refMode);
+			break;
 		case FrameObservercentricEclipticOfDate:
-			return getProjection(getObservercentricEclipticOfDateModelViewTransform(refractionMode));
+			transform = getObservercentricEclipticOfDateModelViewTransform(refMode);
+			break;
 		case FrameEquinoxEqu:
-			return getProjection(getEquinoxEquModelViewTransform(refractionMode));
+			transform = getEquinoxEquModelViewTransform(refMode);
+			break;
 		case FrameJ2000:
-			return getProjection(getJ2000ModelViewTransform(refractionMode));
+			transform = getJ2000ModelViewTransform(refMode);
+			break;
 		case FrameGalactic:
-			return getProjection(getGalacticModelViewTransform(refractionMode));
-		case FrameSupergalactic:
-			return getProjection(getSupergalacticModelViewTransform(refractionMode));
+			transform = getGalacticModelViewTransform(refMode);
+			break;
 		default:
-			qDebug() << "Unknown reference frame type: " << (int)frameType << ".";
+			transform = getSupergalacticModelViewTransform(refMode);
 	}
-	Q_ASSERT(0);
-	return getProjection2d();
+	return projectorCache.insert(key, currentProjectionType, currentProjectorParams, createProjector(transform, currentProjectionType));
+}
+
+void StelCore::clearProjectorCache()
+{
+	projectorCache.clear();
 }
 
 StelToneReproducer* StelCore::getToneReproducer()
@@ -719,6 +747,7 @@ void StelCore::lookAtJ2000(const Vec3d& pos, const Vec3d& aup)
 			      s[2],u[2],-f[2],0.,
 			      0.,0.,0.,1.);
 	invertMatAltAzModelView = matAltAzModelView.inverse();
+	projectorCache.clear();
 }
 
 Vec3d StelCore::altAzToEquinoxEqu(const Vec3d& v, RefractionMode refMode) const
@@ -997,6 +1026,9 @@ void StelCore::updateTransformMatrices()
 		matAltAzToHeliocentricEclipticJ2000 =  Mat4d::translation(position->getCenterVsop87Pos()) * tmp;
 		matHeliocentricEclipticJ2000ToAltAz =  tmp.transpose() * Mat4d::translation(-position->getCenterVsop87Pos());
 	}
+
+	// The projectors made with the old matrices are out of date
+	projectorCache.clear();
 }
 
 // Return the observer heliocentric position
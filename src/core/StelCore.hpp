@@ -22,6 +22,7 @@
 #define _STELCORE_HPP_
 
 #include "StelProjector.hpp"
+#include "StelProjectorCache.hpp"
 #include "StelProjectorType.hpp"
 #include "StelLocation.hpp"
 #include "StelSkyDrawer.hpp"
@@ -163,12 +164,14 @@ public:
 	//! Update core state after drawing modules.
 	void postDraw();
 
-	//! Get a new instance of a simple 2d projection. This projection cannot be used to project or unproject but
+	//! Get an instance of a simple 2d projection. This projection cannot be used to project or unproject but
 	//! only for 2d painting
 	StelProjectorP getProjection2d() const;
 
-	//! Get a new instance of projector using a modelview transformation corresponding to the given frame.
+	//! Get an instance of projector using a modelview transformation corresponding to the given frame.
 	//! If not specified the refraction effect is included if atmosphere is on.
+	//! The instance is shared by all the callers until the view, the projection or the time change,
+	//! i.e. usually for the duration of a frame.
 	StelProjectorP getProjection(FrameType frameType, RefractionMode refractionMode=RefractionAuto) const;
 
 	//! Get a new instance of projector using the given modelview transformation.
@@ -758,6 +761,11 @@ private:
 	// Parameters to use when creating new instances of StelProjector
 	StelProjector::StelProjectorParams currentProjectorParams;
 
+	// Projectors returned by getProjection(FrameType) and getProjection2d(), valid until the matrices change
+	mutable StelProjectorCache projectorCache;
+
+	//! Create a projector of the given type, not yet initialized.
+	StelProjector* createProjector(StelProjector::ModelViewTranformP modelViewTransform, ProjectionType projType) const;
 	void updateTransformMatrices();
 	void updateTime(double deltaTime);
 	void updateMaximumFov();
@@ -822,6 +830,10 @@ private:
 	bool de431Available; // ephem file found
 	bool de430Active;    // available and user-activated.
 	bool de431Active;    // available and user-activated.
+
+private slots:
+	//! Drop the shared projectors, e.g. when the refraction changes.
+	void clearProjectorCache();
 };
 
 #endif // _STELCORE_HPP_
@@ -0,0 +1,436 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelFrameProfiler.hpp"
+#include "StelCore.hpp"
+#include "StelModule.hpp"
+#include "StelOpenGL.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+
+#include <cmath>
+
+#include <QDebug>
+#include <QFont>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#ifndef QT_OPENGL_ES_2
+#include <QOpenGLTimerQuery>
+#endif
+
+// Number of frames of GPU timestamps in flight. The results of a frame
+// are usually available two or three frames later.
+static const int gpuFrameCount = 4;
+// Number of modules shown in the overlay, besides the totals.
+static const int overlayModuleCount = 12;
+// The overlay text is refreshed every overlayRefreshFrames frames.
+static const int overlayRefreshFrames = 30;
+
+void StelFrameProfiler::History::add(float value)
+{
+	if (values.isEmpty())
+		return;
+	values[next] = value;
+	next = (next + 1) % values.size();
+	if (count < values.size())
+		++count;
+}
+
+void StelFrameProfiler::History::resize(int size)
+{
+	values.fill(0.f, size);
+	clear();
+}
+
+float StelFrameProfiler::History::getPercentile(float p) const
+{
+	if (count == 0)
+		return 0.f;
+	QVector<float> sorted = values.mid(0, count);
+	qSort(sorted);
+	// Nearest rank
+	int rank = qBound(0, (int)std::ceil(p * count) - 1, count - 1);
+	return sorted.at(rank);
+}
+
+float StelFrameProfiler::History::getMean() const
+{
+	if (count == 0)
+		return 0.f;
+	double sum = 0.;
+	for (int i = 0; i < count; ++i)
+		sum += values.at(i);
+	return sum / count;
+}
+
+QVariantMap StelFrameProfiler::History::getStatistics() const
+{
+	QVariantMap map;
+	map.insert("mean", getMean());
+	if (count == 0)
+	{
+		map.insert("p50", 0.f);
+		map.insert("p95", 0.f);
+		map.insert("p99", 0.f);
+		map.insert("max", 0.f);
+		return map;
+	}
+	// Sort only once for all the percentiles
+	QVector<float> sorted = values.mid(0, count);
+	qSort(sorted);
+	map.insert("p50", sorted.at(qBound(0, (int)std::ceil(0.50 * count) - 1, count - 1)));
+	map.insert("p95", sorted.at(qBound(0, (int)std::ceil(0.95 * count) - 1, count - 1)));
+	map.insert("p99", sorted.at(qBound(0, (int)std::ceil(0.99 * count) - 1, count - 1)));
+	map.insert("max", sorted.last());
+	return map;
+}
+
+StelFrameProfiler::StelFrameProfiler(QObject* parent)
+	: QObject(parent)
+	, enabled(false)
+	, overlayVisible(false)
+	, historySize(600)
+	, currentPhase(Update)
+	, currentEntry(-1)
+	, gpuTiming(false)
+	, gpuTimingChecked(false)
+	, currentGpuFrame(Q_NULLPTR)
+	, overlayFrameCount(0)
+{
+	setObjectName("StelFrameProfiler");
+	for (int phase = Update; phase <= Draw; ++phase)
+	{
+		total[phase].name = "total";
+		total[phase].cpu.resize(historySize);
+		total[phase].gpu.resize(historySize);
+	}
+}
+
+StelFrameProfiler::~StelFrameProfiler()
+{
+#ifndef QT_OPENGL_ES_2
+	foreach (const GpuFrame& frame, gpuFrames)
+		qDeleteAll(frame.queries);
+#endif
+}
+
+void StelFrameProfiler::deinitGL()
+{
+#ifndef QT_OPENGL_ES_2
+	foreach (const GpuFrame& frame, gpuFrames)
+		qDeleteAll(frame.queries);
+#endif
+	gpuFrames.clear();
+	currentGpuFrame = Q_NULLPTR;
+	gpuTiming = false;
+}
+
+void StelFrameProfiler::setEnabled(bool b)
+{
+	if (b == enabled)
+		return;
+	enabled = b;
+	// Old measures would mix with the new ones
+	reset();
+	emit enabledChanged(b);
+}
+
+void StelFrameProfiler::setOverlayVisible(bool b)
+{
+	if (b == overlayVisible)
+		return;
+	overlayVisible = b;
+	overlayLines.clear();
+	overlayFrameCount = 0;
+	emit overlayVisibleChanged(b);
+}
+
+void StelFrameProfiler::setHistorySize(int size)
+{
+	size = qBound(10, size, 100000);
+	if (size == historySize)
+		return;
+	historySize = size;
+	for (int phase = Update; phase <= Draw; ++phase)
+	{
+		for (int i = 0; i < entries[phase].size(); ++i)
+		{
+			entries[phase][i].cpu.resize(size);
+			entries[phase][i].gpu.resize(size);
+		}
+		total[phase].cpu.resize(size);
+		total[phase].gpu.resize(size);
+	}
+	emit historySizeChanged(size);
+}
+
+void StelFrameProfiler::reset()
+{
+	for (int phase = Update; phase <= Draw; ++phase)
+	{
+		entries[phase].clear();
+		entryIndex[phase].clear();
+		total[phase].cpu.clear();
+		total[phase].gpu.clear();
+	}
+	// The pending GPU results refer to the old entries. The queries
+	// can't be deleted here without a current GL context, so they are kept.
+	for (int i = 0; i < gpuFrames.size(); ++i)
+		gpuFrames[i].pending = false;
+	currentGpuFrame = Q_NULLPTR;
+	currentEntry = -1;
+	overlayLines.clear();
+	overlayFrameCount = 0;
+}
+
+int StelFrameProfiler::findEntry(Phase phase, const QString& name)
+{
+	QHash<QString, int>::const_iterator it = entryIndex[phase].constFind(name);
+	if (it != entryIndex[phase].constEnd())
+		return it.value();
+
+	Entry entry;
+	entry.name = name;
+	entry.cpu.resize(historySize);
+	entry.gpu.resize(historySize);
+	entries[phase].append(entry);
+	entryIndex[phase].insert(name, entries[phase].size() - 1);
+	return entries[phase].size() - 1;
+}
+
+void StelFrameProfiler::beginPhase(Phase phase)
+{
+	currentPhase = phase;
+	currentEntry = -1;
+	currentGpuFrame = Q_NULLPTR;
+
+	if (phase == Draw)
+	{
+#ifndef QT_OPENGL_ES_2
+		if (!gpuTimingChecked)
+		{
+			gpuTimingChecked = true;
+			QOpenGLContext* context = QOpenGLContext::currentContext();
+			if (context && !context->isOpenGLES())
+			{
+				const QSurfaceFormat format = context->format();
+				gpuTiming = format.version() >= qMakePair(3, 3) || context->hasExtension("GL_ARB_timer_query");
+			}
+			if (!gpuTiming)
+				qDebug() << "StelFrameProfiler: OpenGL timer queries are not available, only CPU times are measured";
+			else
+				gpuFrames.resize(gpuFrameCount);
+			for (int i = 0; i < gpuFrames.size(); ++i)
+			{
+				gpuFrames[i].used = 0;
+				gpuFrames[i].pending = false;
+			}
+		}
+		if (gpuTiming)
+		{
+			collectGpuFrames();
+			// Skip the GPU measure of this frame if all the queries are still in flight
+			for (int i = 0; i < gpuFrames.size(); ++i)
+			{
+				if (!gpuFrames[i].pending)
+				{
+					currentGpuFrame = &gpuFrames[i];
+					break;
+				}
+			}
+			if (currentGpuFrame)
+			{
+				currentGpuFrame->used = 0;
+				recordTimestamp(-1);
+			}
+		}
+#endif
+	}
+
+	phaseTimer.start();
+}
+
+void StelFrameProfiler::endPhase()
+{
+	total[currentPhase].cpu.add(phaseTimer.nsecsElapsed() / 1e6);
+	if (currentGpuFrame)
+	{
+		currentGpuFrame->pending = currentGpuFrame->used > 1;
+		currentGpuFrame = Q_NULLPTR;
+	}
+
+	if (currentPhase == Draw && overlayVisible && --overlayFrameCount <= 0)
+	{
+		overlayLines = makeOverlayLines();
+		overlayFrameCount = overlayRefreshFrames;
+	}
+}
+
+void StelFrameProfiler::beginModule(const StelModule* module)
+{
+	currentEntry = findEntry(currentPhase, module->objectName());
+	moduleTimer.start();
+}
+
+void StelFrameProfiler::endModule()
+{
+	entries[currentPhase][currentEntry].cpu.add(moduleTimer.nsecsElapsed() / 1e6);
+	if (currentGpuFrame)
+		recordTimestamp(currentEntry);
+}
+
+void StelFrameProfiler::addModuleTime(const StelModule* module, qint64 nsecs)
+{
+	entries[currentPhase][findEntry(currentPhase, module->objectName())].cpu.add(nsecs / 1e6);
+}
+
+void StelFrameProfiler::recordTimestamp(int entry)
+{
+#ifndef QT_OPENGL_ES_2
+	GpuFrame& frame = *currentGpuFrame;
+	if (frame.used == frame.queries.size())
+	{
+		QOpenGLTimerQuery* query = new QOpenGLTimerQuery();
+		if (!query->create())
+		{
+			qWarning() << "StelFrameProfiler: cannot create an OpenGL timer query, GPU times will not be measured";
+			delete query;
+			// The queries already created are deleted by deinitGL()
+			gpuTiming = false;
+			frame.used = 0;
+			currentGpuFrame = Q_NULLPTR;
+			return;
+		}
+		frame.queries.append(query);
+		frame.entries.append(-1);
+	}
+	frame.queries[frame.used]->recordTimestamp();
+	frame.entries[frame.used] = entry;
+	++frame.used;
+#else
+	Q_UNUSED(entry);
+#endif
+}
+
+void StelFrameProfiler::collectGpuFrames()
+{
+#ifndef QT_OPENGL_ES_2
+	QVector<GLuint64> timestamps;
+	for (int i = 0; i < gpuFrames.size(); ++i)
+	{
+		GpuFrame& frame = gpuFrames[i];
+		// When a query result is available, the results of the previous ones are too
+		if (!frame.pending || !frame.queries.at(frame.used - 1)->isResultAvailable())
+			continue;
+
+		timestamps.resize(frame.used);
+		for (int j = 0; j < frame.used; ++j)
+			timestamps[j] = frame.queries.at(j)->waitForResult();
+		for (int j = 1; j < frame.used; ++j)
+		{
+			const int entry = frame.entries.at(j);
+			if (entry >= 0 && entry < entries[Draw].size())
+				entries[Draw][entry].gpu.add((timestamps.at(j) - timestamps.at(j - 1)) / 1e6);
+		}
+		total[Draw].gpu.add((timestamps.last() - timestamps.first()) / 1e6);
+		frame.pending = false;
+	}
+#endif
+}
+
+QVariantMap StelFrameProfiler::getStatistics() const
+{
+	QVariantMap map;
+	map.insert("frames", total[Update].cpu.getCount());
+	map.insert("gpuTiming", gpuTiming);
+	for (int phase = Update; phase <= Draw; ++phase)
+	{
+		const bool gpu = phase == Draw && gpuTiming;
+		QVariantList list;
+		QVector<Entry> phaseEntries = entries[phase];
+		phaseEntries.prepend(total[phase]);
+		foreach (const Entry& entry, phaseEntries)
+		{
+			QVariantMap item;
+			item.insert("name", entry.name);
+			item.insert("cpu", entry.cpu.getStatistics());
+			if (gpu)
+				item.insert("gpu", entry.gpu.getStatistics());
+			list.append(item);
+		}
+		map.insert(phase == Update ? "update" : "draw", list);
+	}
+	return map;
+}
+
+QStringList StelFrameProfiler::makeOverlayLines() const
+{
+	// Sort the modules by decreasing mean time, update and draw together
+	QList<QPair<float, QString> > modules;
+	for (int phase = Update; phase <= Draw; ++phase)
+	{
+		const QString prefix = phase == Update ? "update " : "draw   ";
+		foreach (const Entry& entry, entries[phase])
+		{
+			float mean = entry.cpu.getMean() + entry.gpu.getMean();
+			QString line = prefix + entry.name.left(20).leftJustified(21)
+				     + QString("%1 %2").arg(entry.cpu.getPercentile(0.5f), 7, 'f', 2).arg(entry.cpu.getPercentile(0.95f), 7, 'f', 2);
+			if (phase == Draw && gpuTiming)
+				line += QString("  %1 %2").arg(entry.gpu.getPercentile(0.5f), 7, 'f', 2).arg(entry.gpu.getPercentile(0.95f), 7, 'f', 2);
+			modules.append(qMakePair(-mean, line));
+		}
+	}
+	qSort(modules);
+
+	QStringList lines;
+	lines << QString("%1 CPU p50/p95 [ms]%2").arg("", 27).arg(gpuTiming ? "   GPU p50/p95 [ms]" : "");
+	for (int phase = Update; phase <= Draw; ++phase)
+	{
+		const Entry& entry = total[phase];
+		QString line = QString(phase == Update ? "update " : "draw   ") + entry.name.leftJustified(21)
+			     + QString("%1 %2").arg(entry.cpu.getPercentile(0.5f), 7, 'f', 2).arg(entry.cpu.getPercentile(0.95f), 7, 'f', 2);
+		if (phase == Draw && gpuTiming)
+			line += QString("  %1 %2").arg(entry.gpu.getPercentile(0.5f), 7, 'f', 2).arg(entry.gpu.getPercentile(0.95f), 7, 'f', 2);
+		lines << line;
+	}
+	for (int i = 0; i < modules.size() && i < overlayModuleCount; ++i)
+		lines << modules.at(i).second;
+	return lines;
+}
+
+void StelFrameProfiler::drawOverlay(StelCore* core)
+{
+	if (overlayLines.isEmpty())
+		return;
+
+	StelPainter sPainter(core->getProjection2d());
+	QFont font("Courier");
+	font.setStyleHint(QFont::Monospace);
+	font.setPixelSize(12);
+	sPainter.setFont(font);
+	sPainter.setBlending(true);
+
+	const int lineHeight = 14;
+	const int height = core->getProjection2d()->getViewportHeight();
+	// Dark background to keep the text readable over bright landscapes
+	sPainter.setColor(0.f, 0.f, 0.f, 0.6f);
+	sPainter.drawRect2d(5, height - 10 - lineHeight * overlayLines.size(), 8 * 62, lineHeight * overlayLines.size() + 5, false);
+	sPainter.setColor(1.f, 1.f, 0.6f, 1.f);
+	for (int i = 0; i < overlayLines.size(); ++i)
+		sPainter.drawText(10, height - 5 - lineHeight * (i + 1), overlayLines.at(i));
+}
@@ -0,0 +1,175 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELFRAMEPROFILER_HPP_
+#define _STELFRAMEPROFILER_HPP_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+class StelCore;
+class StelModule;
+class QOpenGLTimerQuery;
+
+//! @class StelFrameProfiler
+//! Measures the time spent by every StelModule in StelApp::update() and
+//! StelApp::draw().
+//!
+//! The CPU time of each call is measured with a QElapsedTimer. The GPU time
+//! of the draw calls is measured with OpenGL timestamp queries, which are
+//! read back a few frames later so that the measurement never stalls the
+//! pipeline. GPU timing needs OpenGL 3.3 or the ARB_timer_query extension
+//! and is silently left out when they are not available.
+//!
+//! The durations of the last frames are kept in ring buffers, from which
+//! the mean, the percentiles and the maximum are computed on demand.
+//! The profiler is registered as StelProperty object "StelFrameProfiler".
+//! When it is disabled StelApp only checks isEnabled() once per phase.
+class StelFrameProfiler : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+	Q_PROPERTY(bool overlayVisible READ isOverlayVisible WRITE setOverlayVisible NOTIFY overlayVisibleChanged)
+	Q_PROPERTY(int historySize READ getHistorySize WRITE setHistorySize NOTIFY historySizeChanged)
+
+public:
+	enum Phase
+	{
+		Update,
+		Draw
+	};
+
+	//! Fixed size history of durations, oldest values are overwritten.
+	class History
+	{
+	public:
+		History(int size = 0) : values(size, 0.f), next(0), count(0) {}
+		void add(float value);
+		void clear() { next = 0; count = 0; }
+		void resize(int size);
+		int getCount() const { return count; }
+		//! Mean, 50th, 95th, 99th percentiles and maximum of the stored values.
+		//! @return a map with keys "mean", "p50", "p95", "p99" and "max"
+		QVariantMap getStatistics() const;
+		//! Percentile p (in [0;1]) of the stored values, 0 if empty.
+		float getPercentile(float p) const;
+		float getMean() const;
+	private:
+		QVector<float> values;
+		int next;
+		int count;
+	};
+
+	StelFrameProfiler(QObject* parent = Q_NULLPTR);
+	~StelFrameProfiler();
+
+	bool isEnabled() const { return enabled; }
+	bool isOverlayVisible() const { return overlayVisible; }
+	int getHistorySize() const { return historySize; }
+
+	//! Start the measure of a phase. Must be called with a current GL context for Draw.
+	void beginPhase(Phase phase);
+	//! End the measure of the current phase.
+	void endPhase();
+	//! Start the measure of a module call in the current phase.
+	void beginModule(const StelModule* module);
+	//! End the measure of the module call started by beginModule().
+	void endModule();
+	//! Add the time of a module call of the current phase measured elsewhere,
+	//! e.g. for an update done in a worker thread.
+	//! @param nsecs the duration [ns]
+	void addModuleTime(const StelModule* module, qint64 nsecs);
+
+	//! Draw the table of the slowest modules in the upper left corner of the view.
+	void drawOverlay(StelCore* core);
+	//! Delete the GPU timer queries. Must be called with a current GL context.
+	void deinitGL();
+
+public slots:
+	void setEnabled(bool b);
+	void setOverlayVisible(bool b);
+	//! Set the number of frames kept for the statistics.
+	void setHistorySize(int size);
+	//! Forget all measures.
+	void reset();
+
+	//! Get the statistics of all measured modules, in milliseconds.
+	//! The returned map has the keys "frames" (number of frames in the history),
+	//! "gpuTiming" (whether GPU times are measured), "update" and "draw".
+	//! The two last ones are lists of maps with the keys "name", "cpu" and,
+	//! for draw with GPU timing, "gpu". "cpu" and "gpu" contain the values
+	//! of History::getStatistics(). The first entry of each list is the
+	//! whole phase and has the name "total".
+	QVariantMap getStatistics() const;
+
+signals:
+	void enabledChanged(bool b);
+	void overlayVisibleChanged(bool b);
+	void historySizeChanged(int size);
+
+private:
+	struct Entry
+	{
+		QString name;
+		History cpu;
+		History gpu;
+	};
+
+	//! The GPU timestamps of one frame. The first one is taken when the
+	//! phase begins, the next ones at the end of each module draw.
+	struct GpuFrame
+	{
+		QVector<QOpenGLTimerQuery*> queries;
+		QVector<int> entries;  // entry ending at each timestamp, -1 for none
+		int used;
+		bool pending;
+	};
+
+	int findEntry(Phase phase, const QString& name);
+	void recordTimestamp(int entry);
+	//! Read back the results of the pending GPU frames which are ready.
+	void collectGpuFrames();
+	QStringList makeOverlayLines() const;
+
+	bool enabled;
+	bool overlayVisible;
+	int historySize;
+
+	QVector<Entry> entries[2];
+	QHash<QString, int> entryIndex[2];
+	Entry total[2];
+
+	Phase currentPhase;
+	int currentEntry;
+	QElapsedTimer phaseTimer;
+	QElapsedTimer moduleTimer;
+
+	bool gpuTiming;
+	bool gpuTimingChecked;
+	QVector<GpuFrame> gpuFrames;
+	GpuFrame* currentGpuFrame;
+
+	QStringList overlayLines;
+	int overlayFrameCount;
+};
+
+#endif // _STELFRAMEPROFILER_HPP_
@@ -17,20 +17,26 @@
  */
 
 #include "StelJsonParser.hpp"
+#include <QBuffer>
 #include <QDebug>
 #include <QJsonDocument>
+#include <QStringList>
+#include <QtNumeric>
 #include <stdexcept>
 
 void StelJsonParser::write(const QVariant& v, QIODevice* output, int indentLevel)
 {
-	QByteArray json = write(v, indentLevel);
-	output->write(json);
+	StelJsonWriter writer(output, true, indentLevel);
+	writer.writeValue(v);
 }
 
 QByteArray StelJsonParser::write(const QVariant& jsonObject, int indentLevel)
 {
-	QJsonDocument doc = QJsonDocument::fromVariant(jsonObject);
-	return doc.toJson();
+	QByteArray json;
+	QBuffer buffer(&json);
+	buffer.open(QIODevice::WriteOnly);
+	write(jsonObject, &buffer, indentLevel);
+	return json;
 }
 
 QVariant StelJsonParser::parse(QIODevice* input)
@@ -49,3 +55,626 @@ QVariant StelJsonParser::parse(const QByteArray& aar)
 	}
 	return doc.toVariant();
 }
+
+// Size of the chunks read from the input of a StelJsonReader
+static const int readerChunkSize = 65536;
+
+StelJsonReader::StelJsonReader(QIODevice* input)
+	: input(input)
+	, pos(0)
+	, bufferOffset(0)
+	, needSeparator(false)
+	, afterKey(false)
+	, finished(false)
+	, skipping(false)
+	, currentType(QVariant::Invalid)
+	, currentNumber(0.)
+	, currentBool(false)
+{
+}
+
+bool StelJsonReader::fillBuffer()
+{
+	bufferOffset += buffer.size();
+	buffer = input->read(readerChunkSize);
+	pos = 0;
+	return !buffer.isEmpty();
+}
+
+inline int StelJsonReader::peekChar()
+{
+	if (pos>=buffer.size() && !fillBuffer())
+		return -1;
+	return static_cast<unsigned char>(buffer.at(pos));
+}
+
+void StelJsonReader::skipWhitespace()
+{
+	forever
+	{
+		const int c = peekChar();
+		if (c!=' ' && c!='\n' && c!='\r' && c!='\t')
+			return;
+		++pos;
+	}
+}
+
+void StelJsonReader::error(const char* message) const
+{
+	throw std::runtime_error(qPrintable(QString("%1 at offset %2").arg(message).arg(bufferOffset+pos)));
+}
+
+StelJsonReader::TokenType StelJsonReader::readNext()
+{
+	skipWhitespace();
+	int c = peekChar();
+	if (finished)
+	{
+		if (c>=0)
+			error("unexpected data after the end of the document");
+		return EndDocument;
+	}
+
+	if (!containers.isEmpty() && !afterKey)
+	{
+		const char container = containers.at(containers.size()-1);
+		if (c==(container=='{' ? '}' : ']'))
+		{
+			++pos;
+			containers.chop(1);
+			needSeparator = true;
+			finished = containers.isEmpty();
+			return container=='{' ? EndObject : EndArray;
+		}
+		if (needSeparator)
+		{
+			if (c!=',')
+				error("expected ',' or the end of the container");
+			++pos;
+			skipWhitespace();
+			c = peekChar();
+		}
+		if (container=='{')
+		{
+			if (c!='"')
+				error("expected the name of a member");
+			readString(currentKey);
+			skipWhitespace();
+			if (peekChar()!=':')
+				error("expected ':'");
+			++pos;
+			afterKey = true;
+			return Key;
+		}
+	}
+
+	afterKey = false;
+	switch (c)
+	{
+		case '{':
+		case '[':
+			++pos;
+			containers.append(static_cast<char>(c));
+			needSeparator = false;
+			return c=='{' ? StartObject : StartArray;
+		case '"':
+			readString(currentString);
+			currentType = QVariant::String;
+			break;
+		case 't':
+			readLiteral("true");
+			currentBool = true;
+			currentType = QVariant::Bool;
+			break;
+		case 'f':
+			readLiteral("false");
+			currentBool = false;
+			currentType = QVariant::Bool;
+			break;
+		case 'n':
+			readLiteral("null");
+			currentType = QVariant::Invalid;
+			break;
+		case -1:
+			error("unexpected end of the document");
+			break;
+		default:
+			readNumber();
+	}
+	needSeparator = true;
+	finished = containers.isEmpty();
+	return Value;
+}
+
+void StelJsonReader::readString(QString& target)
+{
+	// Skip the opening quote
+	++pos;
+
+	// Most strings have no escape sequence and are entirely in the buffer, they are converted from there directly
+	if (!skipping)
+	{
+		const char* data = buffer.constData();
+		int end = pos;
+		while (end<buffer.size() && data[end]!='"' && data[end]!='\\')
+			++end;
+		if (end<buffer.size() && data[end]=='"')
+		{
+			target = QString::fromUtf8(data+pos, end-pos);
+			pos = end+1;
+			return;
+		}
+	}
+
+	stringBuffer.resize(0);
+	forever
+	{
+		if (pos>=buffer.size() && !fillBuffer())
+			error("unterminated string");
+
+		// Copy all the characters up to the next quote or escape sequence at once
+		const char* data = buffer.constData();
+		int end = pos;
+		while (end<buffer.size() && data[end]!='"' && data[end]!='\\')
+			++end;
+		if (!skipping)
+			stringBuffer.append(data+pos, end-pos);
+		pos = end;
+		if (pos>=buffer.size())
+			continue;
+		if (data[pos]=='"')
+		{
+			++pos;
+			if (!skipping)
+				target = QString::fromUtf8(stringBuffer);
+			return;
+		}
+
+		++pos;
+		const int c = peekChar();
+		++pos;
+		if (skipping)
+		{
+			// The 4 digits of a unicode escape sequence are skipped like normal characters
+			if (c<0)
+				error("unterminated string");
+			continue;
+		}
+		switch (c)
+		{
+			case '"':
+			case '\\':
+			case '/':
+				stringBuffer.append(static_cast<char>(c));
+				break;
+			case 'b': stringBuffer.append('\b'); break;
+			case 'f': stringBuffer.append('\f'); break;
+			case 'n': stringBuffer.append('\n'); break;
+			case 'r': stringBuffer.append('\r'); break;
+			case 't': stringBuffer.append('\t'); break;
+			case 'u':
+			{
+				uint code = readHex();
+				if (code>=0xD800 && code<0xDC00)
+				{
+					// High surrogate, which must be followed by the low one
+					if (peekChar()!='\\')
+						error("invalid surrogate pair");
+					++pos;
+					if (peekChar()!='u')
+						error("invalid surrogate pair");
+					++pos;
+					const uint low = readHex();
+					if (low<0xDC00 || low>0xDFFF)
+						error("invalid surrogate pair");
+					code = 0x10000 + ((code-0xD800)<<10) + (low-0xDC00);
+				}
+				stringBuffer.append(QString::fromUcs4(&code, 1).toUtf8());
+				break;
+			}
+			default:
+				error("invalid escape sequence");
+		}
+	}
+}
+
+uint StelJsonReader::readHex()
+{
+	uint code = 0;
+	for (int i=0; i<4; ++i)
+	{
+		const int c = peekChar();
+		++pos;
+		code <<= 4;
+		if (c>='0' && c<='9')
+			code += c-'0';
+		else if (c>='a' && c<='f')
+			code += c-'a'+10;
+		else if (c>='A' && c<='F')
+			code += c-'A'+10;
+		else
+			error("invalid unicode escape sequence");
+	}
+	return code;
+}
+
+void StelJsonReader::readNumber()
+{
+	numberBuffer.resize(0);
+	forever
+	{
+		const int c = peekChar();
+		if ((c<'0' || c>'9') && c!='-' && c!='+' && c!='.' && c!='e' && c!='E')
+			break;
+		numberBuffer.append(static_cast<char>(c));
+		++pos;
+	}
+	if (numberBuffer.isEmpty())
+		error("invalid value");
+	if (skipping)
+		return;
+
+	// Like QJsonDocument, all the numbers are doubles
+	bool ok = false;
+	currentNumber = numberBuffer.toDouble(&ok);
+	if (!ok)
+		error("invalid value");
+	currentType = QVariant::Double;
+}
+
+void StelJsonReader::readLiteral(const char* literal)
+{
+	for (const char* c=literal; *c; ++c)
+	{
+		if (peekChar()!=*c)
+			error("invalid value");
+		++pos;
+	}
+}
+
+QVariant StelJsonReader::value() const
+{
+	switch (currentType)
+	{
+		case QVariant::String:
+			return currentString;
+		case QVariant::Double:
+			return currentNumber;
+		case QVariant::Bool:
+			return currentBool;
+		default:
+			return QVariant();
+	}
+}
+
+QVariant StelJsonReader::readValue()
+{
+	return readValue(readNext());
+}
+
+QVariant StelJsonReader::readValue(TokenType token)
+{
+	switch (token)
+	{
+		case Value:
+			return value();
+		case StartObject:
+		{
+			QVariantMap map;
+			while (readNext()==Key)
+			{
+				const QString name = currentKey;
+				map.insert(name, readValue());
+			}
+			return map;
+		}
+		case StartArray:
+		{
+			QVariantList list;
+			for (TokenType t=readNext(); t!=EndArray; t=readNext())
+				list.append(readValue(t));
+			return list;
+		}
+		case EndDocument:
+			error("unexpected end of the document");
+			break;
+		default:
+			error("expected a value");
+	}
+	return QVariant();
+}
+
+void StelJsonReader::skipValue()
+{
+	// The strings and numbers are checked, but not converted
+	skipping = true;
+	int depth = 0;
+	do
+	{
+		switch (readNext())
+		{
+			case StartObject:
+			case StartArray:
+				++depth;
+				break;
+			case EndObject:
+			case EndArray:
+				--depth;
+				break;
+			case EndDocument:
+				error("unexpected end of the document");
+				break;
+			default:
+				break;
+		}
+	} while (depth>0);
+	skipping = false;
+}
+
+// Size from which the output of a StelJsonWriter is written to its device
+static const int writerChunkSize = 65536;
+
+StelJsonWriter::StelJsonWriter(QIODevice* output, bool indented, int indentLevel)
+	: output(output)
+	, indented(indented)
+	, indentLevel(indentLevel)
+	, depth(0)
+	, needSeparator(false)
+	, afterKey(false)
+{
+}
+
+StelJsonWriter::~StelJsonWriter()
+{
+	flush();
+}
+
+void StelJsonWriter::flush()
+{
+	if (buffer.isEmpty())
+		return;
+	output->write(buffer);
+	buffer.resize(0);
+}
+
+void StelJsonWriter::newLine()
+{
+	if (!indented)
+		return;
+	buffer.append('\n');
+	for (int i=0; i<indentLevel+depth; ++i)
+		buffer.append("    ", 4);
+}
+
+void StelJsonWriter::beginValue()
+{
+	if (afterKey)
+	{
+		afterKey = false;
+		return;
+	}
+	if (depth>0)
+	{
+		if (needSeparator)
+			buffer.append(',');
+		newLine();
+	}
+}
+
+void StelJsonWriter::endValue()
+{
+	needSeparator = true;
+	if (depth==0)
+	{
+		if (indented)
+			buffer.append('\n');
+		flush();
+	}
+	else if (buffer.size()>=writerChunkSize)
+		flush();
+}
+
+void StelJsonWriter::beginObject()
+{
+	beginValue();
+	buffer.append('{');
+	++depth;
+	needSeparator = false;
+}
+
+void StelJsonWriter::endObject()
+{
+	--depth;
+	if (needSeparator)
+		newLine();
+	buffer.append('}');
+	endValue();
+}
+
+void StelJsonWriter::beginArray()
+{
+	beginValue();
+	buffer.append('[');
+	++depth;
+	needSeparator = false;
+}
+
+void StelJsonWriter::endArray()
+{
+	--depth;
+	if (needSeparator)
+		newLine();
+	buffer.append(']');
+	endValue();
+}
+
+void StelJsonWriter::writeKey(const QString& key)
+{
+	if (needSeparator)
+		buffer.append(',');
+	newLine();
+	appendString(key);
+	buffer.append(indented ? ": " : ":");
+	afterKey = true;
+}
+
+void StelJsonWriter::writeString(const QString& str)
+{
+	beginValue();
+	appendString(str);
+	endValue();
+}
+
+void StelJsonWriter::writeNumber(double value)
+{
+	beginValue();
+	if (!qIsFinite(value))
+	{
+		// Not representable in JSON
+		buffer.append("null");
+	}
+	else
+	{
+		// The shortest representation which reads back to the same value
+		QByteArray number = QByteArray::number(value, 'g', 15);
+		if (number.toDouble()!=value)
+			number = QByteArray::number(value, 'g', 17);
+		buffer.append(number);
+	}
+	endValue();
+}
+
+void StelJsonWriter::writeNumber(int value)
+{
+	beginValue();
+	buffer.append(QByteArray::number(value));
+	endValue();
+}
+
+void StelJsonWriter::writeBool(bool value)
+{
+	beginValue();
+	buffer.append(value ? "true" : "false");
+	endValue();
+}
+
+void StelJsonWriter::writeNull()
+{
+	beginValue();
+	buffer.append("null");
+	endValue();
+}
+
+void StelJsonWriter::appendString(const QString& str)
+{
+	const QByteArray utf8 = str.toUtf8();
+	const char* data = utf8.constData();
+	const int size = utf8.size();
+	buffer.append('"');
+	// Copy the runs of characters which need no escaping at once
+	int start = 0;
+	for (int i=0; i<size; ++i)
+	{
+		const unsigned char c = static_cast<unsigned char>(data[i]);
+		if (c>=0x20 && c!='"' && c!='\\')
+			continue;
+		buffer.append(data+start, i-start);
+		start = i+1;
+		switch (c)
+		{
+			case '"': buffer.append("\\\"", 2); break;
+			case '\\': buffer.append("\\\\", 2); break;
+			case '\n': buffer.append("\\n", 2); break;
+			case '\r': buffer.append("\\r", 2); break;
+			case '\t': buffer.append("\\t", 2); break;
+			case '\b': buffer.append("\\b", 2); break;
+			case '\f': buffer.append("\\f", 2); break;
+			default:
+			{
+				char escaped[7];
+				qsnprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				buffer.append(escaped, 6);
+			}
+		}
+	}
+	buffer.append(data+start, size-start);
+	buffer.append('"');
+}
+
+void StelJsonWriter::writeValue(const QVariant& value)
+{
+	switch (value.userType())
+	{
+		case QMetaType::UnknownType:
+			writeNull();
+			break;
+		case QMetaType::Bool:
+			writeBool(value.toBool());
+			break;
+		case QMetaType::Int:
+			writeNumber(value.toInt());
+			break;
+		case QMetaType::UInt:
+		case QMetaType::LongLong:
+		case QMetaType::ULongLong:
+			beginValue();
+			buffer.append(value.toByteArray());
+			endValue();
+			break;
+		case QMetaType::Double:
+		case QMetaType::Float:
+			writeNumber(value.toDouble());
+			break;
+		case QMetaType::QString:
+			writeString(value.toString());
+			break;
+		case QMetaType::QVariantMap:
+		{
+			const QVariantMap map = value.toMap();
+			beginObject();
+			for (QVariantMap::const_iterator it=map.constBegin(); it!=map.constEnd(); ++it)
+			{
+				writeKey(it.key());
+				writeValue(it.value());
+			}
+			endObject();
+			break;
+		}
+		case QMetaType::QVariantHash:
+		{
+			// Sorted like the members of a map, so that the output does not change from run to run
+			const QVariantHash hash = value.toHash();
+			QStringList keys = hash.keys();
+			keys.sort();
+			beginObject();
+			foreach (const QString& key, keys)
+			{
+				writeKey(key);
+				writeValue(hash.value(key));
+			}
+			endObject();
+			break;
+		}
+		case QMetaType::QVariantList:
+		{
+			beginArray();
+			foreach (const QVariant& element, value.toList())
+				writeValue(element);
+			endArray();
+			break;
+		}
+		case QMetaType::QStringList:
+		{
+			beginArray();
+			foreach (const QString& element, value.toStringList())
+				writeString(element);
+			endArray();
+			break;
+		}
+		default:
+			if (value.canConvert<QString>())
+				writeString(value.toString());
+			else
+				writeNull();
+	}
+}
@@ -22,6 +22,7 @@
 #include <QIODevice>
 #include <QVariant>
 #include <QByteArray>
+#include <QString>
 
 
 //! @class StelJsonParser
@@ -37,7 +38,9 @@ array         QVariantList (QVariant::List)
 boolean       QVariant::Bool
 string        QVariant::String
 number        QVariant::Int or QVariant::Double
-@endverbatim */
+@endverbatim
+Large documents can be read with a StelJsonReader and written with a StelJsonWriter,
+which process them one token at a time instead of as a whole QVariant. */
 class StelJsonParser
 {
 public:
@@ -46,6 +49,7 @@ public:
 	static QVariant parse(const QByteArray& input);
 
 	//! Serialize the passed QVariant as JSON into the output QIODevice.
+	//! The output is streamed to the device with a StelJsonWriter.
 	static void write(const QVariant& jsonObject, QIODevice* output, int indentLevel=0);
 
 	//! Serialize the passed QVariant as JSON in a QByteArray.
@@ -54,4 +58,129 @@ public:
 	// static void registerSerializerForType(int t, void (*func)(const QVariant&, QIODevice*, int)) {otherSerializer.insert(t, func);}
 };
 
+//! @class StelJsonReader
+//! Pull reader returning the tokens of a JSON document one after the other, without
+//! building the document in memory. The input is read in chunks when needed, so that
+//! a reader can stop once it found what it needs, e.g. the version of a large catalog.
+//! The values have the same types as with StelJsonParser::parse(), all the numbers being
+//! doubles, and syntax errors throw a std::runtime_error.
+class StelJsonReader
+{
+public:
+	enum TokenType
+	{
+		StartObject,	//!< Followed by pairs of a Key and a value, then by EndObject
+		EndObject,
+		StartArray,	//!< Followed by the values of the array, then by EndArray
+		EndArray,
+		Key,		//!< The name of an object member, see key()
+		Value,		//!< A string, number, boolean or null, see value()
+		EndDocument
+	};
+
+	explicit StelJsonReader(QIODevice* input);
+
+	//! Read the next token.
+	TokenType readNext();
+	//! The name read by the last Key token.
+	const QString& key() const {return currentKey;}
+	//! The value read by the last Value token.
+	QVariant value() const;
+	//! The type of the value read by the last Value token: QVariant::String,
+	//! QVariant::Double, QVariant::Bool, or QVariant::Invalid for null.
+	//! With the following accessors, the values can be used without creating QVariants.
+	QVariant::Type valueType() const {return currentType;}
+	const QString& stringValue() const {return currentString;}
+	//! The value of QVariant::Double numbers.
+	double numberValue() const {return currentNumber;}
+	bool boolValue() const {return currentBool;}
+
+	//! Read the next value, including all the members of an object or the elements of an array.
+	QVariant readValue();
+	//! Skip the next value, without creating the objects and arrays it contains.
+	void skipValue();
+
+private:
+	QVariant readValue(TokenType token);
+	bool fillBuffer();
+	int peekChar();
+	void skipWhitespace();
+	void readString(QString& target);
+	uint readHex();
+	void readNumber();
+	void readLiteral(const char* literal);
+	void error(const char* message) const;
+
+	QIODevice* input;
+	QByteArray buffer;
+	int pos;
+	//! Position of the buffer in the input
+	qint64 bufferOffset;
+	//! '{' or '[' for each of the enclosing objects and arrays
+	QByteArray containers;
+	//! Whether a value was read in the current container, so that a ',' is expected
+	bool needSeparator;
+	//! Whether the last token was a Key, so that a value is expected
+	bool afterKey;
+	//! Whether the top-level value was read
+	bool finished;
+	//! Whether the strings and numbers are only checked, not converted
+	bool skipping;
+	QString currentKey;
+	QVariant::Type currentType;
+	QString currentString;
+	double currentNumber;
+	bool currentBool;
+	QByteArray stringBuffer;
+	QByteArray numberBuffer;
+};
+
+//! @class StelJsonWriter
+//! Writes a JSON document token after token directly to a QIODevice, without building it
+//! as a QVariant first. The output is buffered, and written to the device in large chunks
+//! and when the writer is flushed or destroyed.
+//! The calls must form a valid document, e.g. writeKey() before each value in an object.
+class StelJsonWriter
+{
+public:
+	//! @param indented whether to write each member and array element on its own line.
+	//! @param indentLevel the indentation of the top-level value.
+	explicit StelJsonWriter(QIODevice* output, bool indented=true, int indentLevel=0);
+	~StelJsonWriter();
+
+	void beginObject();
+	void endObject();
+	void beginArray();
+	void endArray();
+	//! Write the name of the next member of an object.
+	void writeKey(const QString& key);
+
+	void writeString(const QString& str);
+	void writeNumber(double value);
+	void writeNumber(int value);
+	void writeBool(bool value);
+	void writeNull();
+	//! Write a value, with the same mapping of types as StelJsonParser.
+	void writeValue(const QVariant& value);
+
+	//! Write the buffered output to the device.
+	void flush();
+
+private:
+	//! Write the separator and indentation needed before a value.
+	void beginValue();
+	void endValue();
+	void newLine();
+	void appendString(const QString& str);
+
+	QIODevice* output;
+	QByteArray buffer;
+	bool indented;
+	int indentLevel;
+	int depth;
+	//! Whether the current container already has an element
+	bool needSeparator;
+	bool afterKey;
+};
+
 #endif // _STELJSONPARSER_HPP_
@@ -21,6 +21,7 @@
 #define _STELMODULE_HPP_
 
 #include <QString>
+#include <QStringList>
 #include <QObject>
 
 // Predeclaration
@@ -136,6 +137,23 @@ public:
 	//! @return the value defining the order. The closer to 0 the earlier the module's action will be called
 	virtual double getCallOrder(StelModuleActionName actionName) const {Q_UNUSED(actionName); return 0;}
 
+	//! Return true if update() can be called in a worker thread, in parallel with the update of other modules.
+	//! Such an update must not use OpenGL or widgets, nor emit signals connected directly to objects of the main thread.
+	//! The time, the location and the coordinate frames of StelCore are computed before the update
+	//! of the modules and can be read safely.
+	//! The updates of all modules are finished before the draw phase begins.
+	virtual bool isUpdateConcurrent() const {return false;}
+
+	//! Return the names of the modules whose data are read by update().
+	//! A module is updated after the modules it reads which come before it in the call order,
+	//! and before those which come after it. Modules updated in the main thread
+	//! only have to declare the modules updated concurrently. "*" stands for all modules.
+	virtual QStringList getUpdateReads() const {return QStringList();}
+
+	//! Return the names of the modules, other than this one, whose data are changed by update().
+	//! Two modules which write the same data are never updated at the same time.
+	virtual QStringList getUpdateWrites() const {return QStringList();}
+
 	//! Detect or show the configuration GUI elements for the module.  This is to be used with
 	//! plugins to display a configuration dialog from the plugin list window.
 	//! @param show if true, make the configuration GUI visible.  If false, hide the config GUI if there is one.
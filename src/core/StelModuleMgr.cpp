@@ -21,6 +21,8 @@
 #include <QPluginLoader>
 #include <QSettings>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QtConcurrent>
 
 #include "StelModuleMgr.hpp"
 #include "StelApp.hpp"
@@ -28,11 +30,12 @@
 #include "StelFileMgr.hpp"
 #include "StelPluginInterface.hpp"
 #include "StelPropertyMgr.hpp"
+#include "StelFrameProfiler.hpp"
 #include "StelIniParser.hpp"
 
 
 
-StelModuleMgr::StelModuleMgr() : callingListsToRegenerate(true), pluginDescriptorListLoaded(false)
+StelModuleMgr::StelModuleMgr() : concurrentUpdates(true), callingListsToRegenerate(true), pluginDescriptorListLoaded(false)
 {
 	qRegisterMetaType<StelModule::StelModuleSelectAction>("StelModule::StelModuleSelectAction");
 	// Initialize empty call lists for each possible actions
@@ -211,6 +214,142 @@ void StelModuleMgr::generateCallingLists()
 		}
 		qSort(mc.value().begin(), mc.value().end(), StelModuleOrderComparator(mc.key()));
 	}
+	generateUpdateSchedule();
+}
+
+// Return true if a name of the list a is in the list b, "*" matches all names
+static bool intersects(const QStringList& a, const QStringList& b)
+{
+	if (a.isEmpty() || b.isEmpty())
+		return false;
+	if (a.contains("*") || b.contains("*"))
+		return true;
+	foreach (const QString& name, a)
+	{
+		if (b.contains(name))
+			return true;
+	}
+	return false;
+}
+
+/*************************************************************************
+ Split the update calling list into the updates done in worker threads
+ and those done in the main thread
+*************************************************************************/
+void StelModuleMgr::generateUpdateSchedule()
+{
+	updateTasks.clear();
+	updateSteps.clear();
+	initialUpdateTasks.clear();
+
+	const QList<StelModule*>& order = callOrders[StelModule::ActionUpdate];
+	const int n = order.size();
+	QVector<QStringList> reads(n), writes(n);
+	for (int i=0; i<n; ++i)
+	{
+		reads[i] = order.at(i)->getUpdateReads();
+		writes[i] = order.at(i)->getUpdateWrites() << order.at(i)->objectName();
+	}
+
+	// The task or main thread step of each module, -1 if none
+	QVector<int> taskOf(n, -1), stepOf(n, -1);
+	// The step after which each task is started, -1 at the beginning
+	QVector<int> taskStart;
+	for (int i=0; i<n; ++i)
+	{
+		StelModule* m = order.at(i);
+		const bool concurrent = concurrentUpdates && m->isUpdateConcurrent();
+		QVector<int> waitFor;
+		int start = -1;
+		for (int j=0; j<i; ++j)
+		{
+			if (!intersects(writes[j], reads[i]) && !intersects(writes[i], reads[j]) && !intersects(writes[i], writes[j]))
+				continue;
+			if (taskOf[j]>=0)
+			{
+				waitFor.append(taskOf[j]);
+				// Start after the task we wait for, so that it is already queued
+				if (concurrent)
+					start = qMax(start, taskStart[taskOf[j]]);
+			}
+			else if (concurrent)
+				start = qMax(start, stepOf[j]);
+		}
+
+		if (concurrent)
+		{
+			UpdateTask task;
+			task.module = m;
+			task.dependencies = waitFor;
+			task.deltaTime = 0.;
+			task.elapsed = 0;
+			updateTasks.append(task);
+			taskStart.append(start);
+			taskOf[i] = updateTasks.size()-1;
+			if (start<0)
+				initialUpdateTasks.append(taskOf[i]);
+			else
+				updateSteps[start].start.append(taskOf[i]);
+		}
+		else
+		{
+			UpdateStep step;
+			step.module = m;
+			step.waitFor = waitFor;
+			updateSteps.append(step);
+			stepOf[i] = updateSteps.size()-1;
+		}
+	}
+}
+
+void StelModuleMgr::setConcurrentUpdates(bool b)
+{
+	concurrentUpdates = b;
+	callingListsToRegenerate = true;
+}
+
+void StelModuleMgr::runUpdateTask(UpdateTask* tasks, int index)
+{
+	UpdateTask& task = tasks[index];
+	// A task which is not yet running is run in this thread by waitForFinished()
+	foreach (int d, task.dependencies)
+		tasks[d].future.waitForFinished();
+
+	QElapsedTimer timer;
+	timer.start();
+	task.module->update(task.deltaTime);
+	task.elapsed = timer.nsecsElapsed();
+}
+
+void StelModuleMgr::updateModules(double deltaTime, StelFrameProfiler* profiler)
+{
+	// No reallocation of the tasks may happen while they run
+	UpdateTask* tasks = updateTasks.data();
+	for (int i=0; i<updateTasks.size(); ++i)
+		tasks[i].deltaTime = deltaTime;
+
+	foreach (int t, initialUpdateTasks)
+		tasks[t].future = QtConcurrent::run(&StelModuleMgr::runUpdateTask, tasks, t);
+
+	foreach (const UpdateStep& step, updateSteps)
+	{
+		foreach (int t, step.waitFor)
+			tasks[t].future.waitForFinished();
+		if (profiler)
+			profiler->beginModule(step.module);
+		step.module->update(deltaTime);
+		if (profiler)
+			profiler->endModule();
+		foreach (int t, step.start)
+			tasks[t].future = QtConcurrent::run(&StelModuleMgr::runUpdateTask, tasks, t);
+	}
+
+	for (int i=0; i<updateTasks.size(); ++i)
+	{
+		tasks[i].future.waitForFinished();
+		if (profiler)
+			profiler->addModuleTime(tasks[i].module, tasks[i].elapsed);
+	}
 }
 
 /*************************************************************************
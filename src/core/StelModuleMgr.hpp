@@ -23,6 +23,8 @@
 #include <QObject>
 #include <QMap>
 #include <QList>
+#include <QFuture>
+#include <QVector>
 #include "StelModule.hpp"
 #include "StelPluginInterface.hpp"
 
@@ -30,6 +32,8 @@
 //! Return a pointer on a StelModule from its QMetaObject name @a m
 #define GETSTELMODULE( m ) (( m *)StelApp::getInstance().getModuleMgr().getModule( #m ))
 
+class StelFrameProfiler;
+
 //! @class StelModuleMgr
 //! Manage a collection of StelModules including both core and plugin modules.
 //! The order in which some actions like draw or update are called for each module can be retrieved with the getCallOrders() method.
@@ -83,6 +87,20 @@ public:
 		return callOrders[action];
 	}
 
+	//! Call update() for all the modules and return when all the updates are finished.
+	//! The modules for which StelModule::isUpdateConcurrent() is true are updated on the
+	//! global thread pool, the others in the calling (main) thread in call order.
+	//! The dependencies declared with StelModule::getUpdateReads() and StelModule::getUpdateWrites()
+	//! are respected.
+	//! @param deltaTime the time increment in second since last call.
+	//! @param profiler if not Q_NULLPTR, receives the time spent by each module.
+	void updateModules(double deltaTime, StelFrameProfiler* profiler=Q_NULLPTR);
+
+	//! Define whether modules may be updated in worker threads.
+	//! If false, all modules are updated in the main thread in call order.
+	void setConcurrentUpdates(bool b);
+	bool getConcurrentUpdates() const {return concurrentUpdates;}
+
 	//! Contains the information read from the module.ini file
 	struct PluginDescriptor
 	{
@@ -115,6 +133,38 @@ private:
 	//! according to modules orders dependencies
 	void generateCallingLists();
 
+	//! The update of a module in a worker thread.
+	struct UpdateTask
+	{
+		StelModule* module;
+		//! The tasks to wait for before the update
+		QVector<int> dependencies;
+		QFuture<void> future;
+		double deltaTime;
+		//! Duration of the update [ns]
+		qint64 elapsed;
+	};
+
+	//! The update of a module in the main thread.
+	struct UpdateStep
+	{
+		StelModule* module;
+		//! The tasks to wait for before the update
+		QVector<int> waitFor;
+		//! The tasks to start after the update
+		QVector<int> start;
+	};
+
+	//! Split the update call order into tasks and main thread steps.
+	void generateUpdateSchedule();
+	static void runUpdateTask(UpdateTask* tasks, int index);
+
+	QVector<UpdateTask> updateTasks;
+	QVector<UpdateStep> updateSteps;
+	//! The tasks which don't wait for a main thread update
+	QVector<int> initialUpdateTasks;
+	bool concurrentUpdates;
+
 	//! The main module list associating name:pointer
 	QMap<QString, StelModule*> modules;
 
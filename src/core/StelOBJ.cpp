@@ -19,17 +19,22 @@
  */
 
 #include "StelApp.hpp"
+#include "StelBinaryCache.hpp"
 #include "StelOBJ.hpp"
 #include "StelTextureMgr.hpp"
 #include "StelUtils.hpp"
 
-#include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
-#include <QRegularExpression>
 #include <QTextStream>
+#include <QThread>
+#include <QtConcurrent>
+#include <cmath>
+#include <cstring>
 
 Q_LOGGING_CATEGORY(stelOBJ,"stel.OBJ")
 
@@ -50,6 +55,16 @@ void StelOBJ::clear()
 	*this = StelOBJ();
 }
 
+//version of the data written by serialize(), to be increased when its format or the post-processing changes
+static const qint32 meshCacheVersion = 1;
+
+//identifies the content of a file by its path, size and modification time
+static QByteArray getFileStamp(const QString& path)
+{
+	QFileInfo fi(path);
+	return QString("%1|%2|%3;").arg(fi.absoluteFilePath()).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch()).toUtf8();
+}
+
 bool StelOBJ::load(const QString& filename, const VertexOrder vertexOrder)
 {
 	qCDebug(stelOBJ)<<"Loading"<<filename;
@@ -60,6 +75,27 @@ bool StelOBJ::load(const QString& filename, const VertexOrder vertexOrder)
 	//construct base path
 	QFileInfo fi(filename);
 
+	//the post-processed data is reused while the file and the vertex order are unchanged
+	const QString cacheKey = "StelOBJ:" + fi.canonicalFilePath();
+	const QByteArray sourceHash = StelBinaryCache::hash(getFileStamp(filename) + QString("|%1|%2").arg(vertexOrder).arg(meshCacheVersion).toUtf8());
+	QVariant cached;
+	if(StelBinaryCache::load(cacheKey, sourceHash, cached))
+	{
+		const QVariantMap map = cached.toMap();
+		//the materials are part of the cached data, so their files must be unchanged too
+		QByteArray materialStamps;
+		foreach(const QString& mtlFile, map.value("materialFiles").toStringList())
+			materialStamps += getFileStamp(mtlFile);
+		if(materialStamps==map.value("materialStamps").toByteArray() && deserialize(map.value("mesh").toByteArray()))
+		{
+			m_sourceHash = sourceHash;
+			qCDebug(stelOBJ)<<"Loaded OBJ from cache in"<<timer.elapsed()<<"ms";
+			qCDebug(stelOBJ, "Created %d vertices, %d faces, %d objects", m_vertices.size(), getFaceCount(), m_objects.size());
+			return true;
+		}
+		clear();
+	}
+
 	//try to open the file
 	QFile file(filename);
 	if(!file.open(QIODevice::ReadOnly))
@@ -70,12 +106,13 @@ bool StelOBJ::load(const QString& filename, const VertexOrder vertexOrder)
 
 	qCDebug(stelOBJ)<<"Opened file in"<<timer.restart()<<"ms";
 
+	QByteArray data;
+	uchar* mappedData = Q_NULLPTR;
 	//check if this is a compressed file
 	if(filename.endsWith(".gz"))
 	{
 		//uncompress into memory
-		QByteArray data = StelUtils::uncompress(file);
-		file.close();
+		data = StelUtils::uncompress(file);
 		//check if decompressing was successful
 		if(data.isEmpty())
 		{
@@ -83,17 +120,41 @@ bool StelOBJ::load(const QString& filename, const VertexOrder vertexOrder)
 			return false;
 		}
 		qCDebug(stelOBJ)<<"Decompressed in"<<timer.elapsed()<<"ms";
-
-		//create and open a QBuffer for reading
-		QBuffer buf(&data);
-		buf.open(QIODevice::ReadOnly);
-
-		//perform actual load
-		return load(buf,fi.canonicalPath(),vertexOrder);
+	}
+	else
+	{
+		//map the file instead of copying it, fall back to reading it if this is not possible
+		if(file.size()>0)
+			mappedData = file.map(0, file.size());
+		if(mappedData)
+			data = QByteArray::fromRawData(reinterpret_cast<const char*>(mappedData), file.size());
+		else
+			data = file.readAll();
 	}
 
 	//perform actual load
-	return load(file,fi.canonicalPath(),vertexOrder);
+	QStringList materialFiles;
+	const bool ok = parseData(data, fi.canonicalPath(), vertexOrder, &materialFiles);
+
+	//the raw data must not be used after the file is unmapped
+	data.clear();
+	if(mappedData)
+		file.unmap(mappedData);
+	file.close();
+
+	if(ok)
+	{
+		QByteArray materialStamps;
+		foreach(const QString& mtlFile, materialFiles)
+			materialStamps += getFileStamp(mtlFile);
+		QVariantMap map;
+		map.insert("mesh", serialize());
+		map.insert("materialFiles", materialFiles);
+		map.insert("materialStamps", materialStamps);
+		StelBinaryCache::save(cacheKey, sourceHash, map);
+		m_sourceHash = sourceHash;
+	}
+	return ok;
 }
 
 //macro to test out different ways of comparison and their performance
@@ -280,83 +341,364 @@ int StelOBJ::getCurrentMaterialIndex(CurrentParserState &state)
 	return 0;
 }
 
-bool StelOBJ::parseFace(const ParseParams& params, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
-			CurrentParserState& state,
-			VertexCache& vertCache)
+//files smaller than this are parsed by a single thread
+static const int parallelParseThreshold = 1024*1024;
+//the minimal size of the chunks of larger files, which are parsed in parallel
+static const int minChunkSize = 256*1024;
+
+static inline bool isBlank(char c) { return c==' ' || c=='\t' || c=='\r' || c=='\f' || c=='\v'; }
+static inline bool isDigit(char c) { return c>='0' && c<='9'; }
+static inline const char* skipBlanks(const char* p, const char* end) { while(p<end && isBlank(*p)) ++p; return p; }
+static inline bool isTokenEnd(const char* p, const char* end) { return p==end || isBlank(*p); }
+
+static double powerOf10(int exponent)
 {
-	//The face definition can have 4 different variants
-	//Mode 1: Only position:		f v1 v2 v3
-	//Mode 2: Position+texcoords:		f v1/t1 v2/t2 v3/t3
-	//Mode 3: Position+texcoords+normals:	f v1/t1/n1 v2/t2/n2 v3/t3/n3
-	//Mode 4: Position+normals:		f v1//n1 v2//n2 v3//n3
-
-	// Zero is actually invalid in the face definition, so we use it for default values
-	int posIdx=0, texIdx=0, normIdx=0;
-	// Contains the vertex indices
-	QVarLengthArray<unsigned int,16> vIdx;
+	//all these are exactly representable, so that usual numbers are converted with a single rounding
+	static const double table[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+					1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	if(exponent>=0 && exponent<=22)
+		return table[exponent];
+	return std::pow(10.0, exponent);
+}
+
+//Parses a decimal number like "-1.25e-3" at p and moves p after it.
+//This is much faster than QStringRef::toDouble and does not depend on the locale.
+//The digits after the 19th significant one are ignored, which is far below float precision.
+static bool parseNumber(const char*& p, const char* end, double& out)
+{
+	const char* s = p;
+	bool negative = false;
+	if(s<end && (*s=='-' || *s=='+'))
+	{
+		negative = (*s=='-');
+		++s;
+	}
 
-	if(params.size()<4)
+	quint64 mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool anyDigit = false;
+	for(; s<end && isDigit(*s); ++s)
 	{
-		qCCritical(stelOBJ)<<"Invalid number of vertices in face statement"<<params;
+		anyDigit = true;
+		if(digits<19)
+		{
+			mantissa = mantissa*10 + (*s-'0');
+			if(mantissa)
+				++digits;
+		}
+		else
+			++exponent;
+	}
+	if(s<end && *s=='.')
+	{
+		for(++s; s<end && isDigit(*s); ++s)
+		{
+			anyDigit = true;
+			if(digits<19)
+			{
+				mantissa = mantissa*10 + (*s-'0');
+				if(mantissa)
+					++digits;
+				--exponent;
+			}
+		}
+	}
+	if(!anyDigit)
 		return false;
+
+	if(s<end && (*s=='e' || *s=='E'))
+	{
+		const char* e = s+1;
+		bool negativeExponent = false;
+		if(e<end && (*e=='-' || *e=='+'))
+		{
+			negativeExponent = (*e=='-');
+			++e;
+		}
+		if(e<end && isDigit(*e))
+		{
+			int value = 0;
+			for(; e<end && isDigit(*e); ++e)
+			{
+				if(value<10000)
+					value = value*10 + (*e-'0');
+			}
+			exponent += negativeExponent ? -value : value;
+			s = e;
+		}
 	}
 
-	int vtxAmount = params.size()-1;
+	double value = static_cast<double>(mantissa);
+	if(exponent<0)
+		value /= powerOf10(-exponent);
+	else if(exponent>0)
+		value *= powerOf10(exponent);
+	out = negative ? -value : value;
+	p = s;
+	return true;
+}
 
-	//parse each one seperately
-	int mode = 0;
-	bool ok = false;
-	//a macro for consistency check
-	#define CHK_MODE(a) if(mode && mode!=a) { qCCritical(stelOBJ)<<"Inconsistent face statement"<<params; return false; } else {mode = a;}
-	//a macro for checking number pasing
-	#define CHK_OK(a) do{ a; if(!ok) { qCCritical(stelOBJ)<<"Could not parse number in face statement"<<params; return false; } } while(0)
-	//negative indices indicate relative data, i.e. -1 would mean the last position/texture/normal that was parsed
-	//this macro fixes it up so that it always uses absolute numbers
-	//note: the indices start with 1, this is fixed up later
-	#define FIX_REL(a, list) if(a<0) {a += list.size()+1; }
+//Parses count whitespace separated numbers at p, and moves p to the next token
+static bool parseNumbers(const char*& p, const char* end, float* out, int count)
+{
+	for(int i=0;i<count;++i)
+	{
+		double value;
+		if(!parseNumber(p,end,value) || !isTokenEnd(p,end))
+			return false;
+		out[i] = value;
+		p = skipBlanks(p,end);
+	}
+	return true;
+}
 
-	//loop to parse each section seperately
-	for(int i =0; i<vtxAmount;++i)
+//Parses a face vertex index at p and moves p after it
+static bool parseIndex(const char*& p, const char* end, int& out)
+{
+	const char* s = p;
+	bool negative = false;
+	if(s<end && (*s=='-' || *s=='+'))
+	{
+		negative = (*s=='-');
+		++s;
+	}
+	if(s==end || !isDigit(*s))
+		return false;
+	qint64 value = 0;
+	for(; s<end && isDigit(*s); ++s)
 	{
-		//split on slash
-		QVector<QStringRef> split = params.at(i+1).split('/');
-		switch(split.size())
+		value = value*10 + (*s-'0');
+		if(value>std::numeric_limits<int>::max())
+			return false;
+	}
+	out = static_cast<int>(negative ? -value : value);
+	p = s;
+	return true;
+}
+
+static inline void applyVertexOrder(Vec3f& target, const StelOBJ::VertexOrder vertexOrder)
+{
+	switch(vertexOrder)
+	{
+		case StelOBJ::XYZ:
+			//no change
+			break;
+		case StelOBJ::XZY:
+			target.set(target[0],-target[2],target[1]);
+			break;
+		case StelOBJ::YXZ:
+			target.set(target[1],target[0],target[2]);
+			break;
+		case StelOBJ::YZX:
+			target.set(target[1],target[2],target[0]);
+			break;
+		case StelOBJ::ZXY:
+			target.set(target[2],target[0],target[1]);
+			break;
+		case StelOBJ::ZYX:
+			target.set(target[2],target[1],target[0]);
+			break;
+		default:
+			Q_ASSERT_X(0,"StelOBJ::load","invalid vertex order found");
+			break;
+	}
+}
+
+void StelOBJ::parseChunk(ParsedChunk& chunk)
+{
+	//macro to compare the command of the line
+	#define CHUNK_CMD(a) (cmdLength==int(sizeof(a))-1 && !memcmp(cmd,a,cmdLength))
+	//macro to record a statement, applied later in order
+	#define ADD_STATEMENT(t, a) do { ParsedStatement& st = INC_LIST(chunk.statements); st.type = t; st.faceIndex = chunk.faceCount; st.lineNr = lineNr; st.arg = a; } while(0)
+	//macro to stop parsing on an error
+	#define CHUNK_ERROR(msg) do { chunk.errorLine = lineNr; chunk.errorMessage = QString("%1: %2").arg(QLatin1String(msg), QString::fromUtf8(lineBegin, lineEnd-lineBegin).trimmed()); return; } while(0)
+
+	int lineNr = 0;
+	const char* p = chunk.begin;
+	while(p<chunk.end)
+	{
+		++lineNr;
+		chunk.lineCount = lineNr;
+		const char* lineBegin = p;
+		const char* lineEnd = static_cast<const char*>(memchr(p, '\n', chunk.end-p));
+		if(lineEnd)
+			p = lineEnd+1;
+		else
+			p = lineEnd = chunk.end;
+
+		//ignore front whitespace, empty lines and comments
+		const char* s = skipBlanks(lineBegin,lineEnd);
+		if(s==lineEnd || *s=='#')
+			continue;
+
+		const char* cmd = s;
+		while(s<lineEnd && !isBlank(*s))
+			++s;
+		const int cmdLength = s-cmd;
+		s = skipBlanks(s,lineEnd);
+
+		if(CHUNK_CMD("f"))
 		{
-			case 1: //no slash, only position
-				CHK_MODE(1);
-				CHK_OK(posIdx = split.at(0).toInt(&ok));
-				FIX_REL(posIdx, posList);
-				break;
-			case 2: //single slash, vert/tex
-				CHK_MODE(2);
-				CHK_OK(posIdx = split.at(0).toInt(&ok));
-				FIX_REL(posIdx, posList);
-				CHK_OK(texIdx = split.at(1).toInt(&ok));
-				FIX_REL(texIdx, texList);
-				break;
-			case 3: //2 slashes, either v/t/n or v//n
-				if(!split.at(1).isEmpty())
+			//The face definition can have 4 different variants
+			//Mode 1: Only position:		f v1 v2 v3
+			//Mode 2: Position+texcoords:		f v1/t1 v2/t2 v3/t3
+			//Mode 3: Position+texcoords+normals:	f v1/t1/n1 v2/t2/n2 v3/t3/n3
+			//Mode 4: Position+normals:		f v1//n1 v2//n2 v3//n3
+			const int recordStart = chunk.faces.size();
+			chunk.faces << 0 << lineNr << chunk.positions.size() << chunk.texCoords.size() << chunk.normals.size();
+			const char* error = Q_NULLPTR;
+			int vtxAmount = 0, mode = 0;
+			while(s<lineEnd)
+			{
+				// Zero is actually invalid in the face definition, so we use it for default values
+				int idx[3] = { 0, 0, 0 };
+				int vtxMode = 1;
+				bool ok = parseIndex(s,lineEnd,idx[0]);
+				if(ok && s<lineEnd && *s=='/')
 				{
-					CHK_MODE(3);
-					CHK_OK(posIdx = split.at(0).toInt(&ok));
-					FIX_REL(posIdx, posList);
-					CHK_OK(texIdx = split.at(1).toInt(&ok));
-					FIX_REL(texIdx, texList);
-					CHK_OK(normIdx = split.at(2).toInt(&ok));
-					FIX_REL(normIdx, normList);
+					++s;
+					if(s<lineEnd && *s=='/')
+					{
+						++s;
+						vtxMode = 4;
+						ok = parseIndex(s,lineEnd,idx[2]);
+					}
+					else
+					{
+						vtxMode = 2;
+						ok = parseIndex(s,lineEnd,idx[1]);
+						if(ok && s<lineEnd && *s=='/')
+						{
+							++s;
+							vtxMode = 3;
+							ok = parseIndex(s,lineEnd,idx[2]);
+						}
+					}
 				}
-				else
+				if(!ok || !isTokenEnd(s,lineEnd))
 				{
-					CHK_MODE(4);
-					CHK_OK(posIdx = split.at(0).toInt(&ok));
-					FIX_REL(posIdx, posList);
-					CHK_OK(normIdx = split.at(2).toInt(&ok));
-					FIX_REL(normIdx, normList);
+					error = "Could not parse number in face statement";
+					break;
 				}
-				break;
-			default: //invalid line
-				qCCritical(stelOBJ)<<"Invalid face statement"<<params;
-				return false;
+				if(mode && mode!=vtxMode)
+				{
+					error = "Inconsistent face statement";
+					break;
+				}
+				mode = vtxMode;
+				chunk.faces << idx[0] << idx[1] << idx[2];
+				++vtxAmount;
+				s = skipBlanks(s,lineEnd);
+			}
+			if(!error && vtxAmount<3)
+				error = "Invalid number of vertices in face statement";
+			if(error)
+			{
+				chunk.faces.resize(recordStart);
+				CHUNK_ERROR(error);
+			}
+			chunk.faces[recordStart] = vtxAmount;
+			++chunk.faceCount;
+		}
+		else if(CHUNK_CMD("v"))
+		{
+			Vec3f& target = INC_LIST(chunk.positions);
+			if(!parseNumbers(s,lineEnd,target.v,3))
+				CHUNK_ERROR("Error parsing Vec3");
+			//check the optional w coord if we have a vec4, must be 1
+			float w;
+			if(s<lineEnd && parseNumbers(s,lineEnd,&w,1) && !qFuzzyCompare(w,1.0f))
+				ADD_STATEMENT(ParsedStatement::Warning, QStringLiteral("Vertex w coordinates different from 1.0 are not supported, changed to 1.0"));
+			//we have to handle the vertex order
+			applyVertexOrder(target, chunk.vertexOrder);
+		}
+		else if(CHUNK_CMD("vt"))
+		{
+			Vec2f& target = INC_LIST(chunk.texCoords);
+			if(!parseNumbers(s,lineEnd,target.v,2))
+				CHUNK_ERROR("Error parsing Vec2");
+			//check the optional w coord if we have a vec3, must be 0
+			float w;
+			if(s<lineEnd && parseNumbers(s,lineEnd,&w,1) && !qFuzzyIsNull(w))
+				ADD_STATEMENT(ParsedStatement::Warning, QStringLiteral("Texture w coordinates are not supported"));
+		}
+		else if(CHUNK_CMD("vn"))
+		{
+			Vec3f& target = INC_LIST(chunk.normals);
+			if(!parseNumbers(s,lineEnd,target.v,3))
+				CHUNK_ERROR("Error parsing Vec3");
+			//we have to handle the vertex order
+			applyVertexOrder(target, chunk.vertexOrder);
+			//normalize is usually not needed so we skip it
+		}
+		else if(CHUNK_CMD("usemtl") || CHUNK_CMD("mtllib") || CHUNK_CMD("o") || CHUNK_CMD("g"))
+		{
+			//use the rest of the string
+			const QString arg = QString::fromUtf8(s, lineEnd-s).trimmed();
+			if(CHUNK_CMD("usemtl"))
+			{
+				if(arg.isEmpty())
+					CHUNK_ERROR("No material name given");
+				ADD_STATEMENT(ParsedStatement::UseMtl, arg);
+			}
+			else if(CHUNK_CMD("mtllib"))
+			{
+				if(arg.isEmpty())
+					CHUNK_ERROR("No material file name given");
+				ADD_STATEMENT(ParsedStatement::MtlLib, arg);
+			}
+			else if(CHUNK_CMD("o"))
+			{
+				if(arg.isEmpty())
+					CHUNK_ERROR("Object name is required");
+				ADD_STATEMENT(ParsedStatement::NewObject, arg);
+			}
+			else
+			{
+				if(arg.isEmpty())
+					CHUNK_ERROR("Group name is required");
+				ADD_STATEMENT(ParsedStatement::NewGroup, arg);
+			}
+		}
+		else if(CHUNK_CMD("s"))
+		{
+			chunk.smoothingGroups = true;
+		}
+		else
+		{
+			//unknown command, warn
+			ADD_STATEMENT(ParsedStatement::Warning, "Unknown OBJ statement: " + QString::fromUtf8(lineBegin, lineEnd-lineBegin).trimmed());
+		}
+	}
+	#undef CHUNK_CMD
+	#undef ADD_STATEMENT
+	#undef CHUNK_ERROR
+}
+
+bool StelOBJ::addFace(const int* face, const int* bases, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
+		      CurrentParserState& state,
+		      VertexCache& vertCache)
+{
+	const int vtxAmount = face[0];
+	// Contains the vertex indices
+	QVarLengthArray<unsigned int,16> vIdx;
+
+	//negative indices indicate relative data, i.e. -1 would mean the last position/texture/normal that was parsed before the face
+	//this macro fixes it up so that it always uses absolute numbers
+	//note: the indices start with 1, this is fixed up later
+	#define FIX_REL(a, n) if(a<0) { a += bases[n] + face[2+n] + 1; }
+
+	const int* idx = face+5;
+	for(int i =0; i<vtxAmount; ++i, idx+=3)
+	{
+		int posIdx = idx[0], texIdx = idx[1], normIdx = idx[2];
+		FIX_REL(posIdx, 0);
+		FIX_REL(texIdx, 1);
+		FIX_REL(normIdx, 2);
+		if(posIdx<0 || posIdx>posList.size() || texIdx<0 || texIdx>texList.size() || normIdx<0 || normIdx>normList.size())
+		{
+			qCCritical(stelOBJ)<<"Invalid vertex index in face statement";
+			return false;
 		}
 
 		//create a temporary Vertex by copying the info from the lists
@@ -388,12 +730,13 @@ bool StelOBJ::parseFace(const ParseParams& params, const V3Vec& posList, const V
 		else
 		{
 			//vertex unknown, add it to the vertex list and cache
-			unsigned int idx = m_vertices.size();
-			vertCache.insert(v,idx);
+			unsigned int newIdx = m_vertices.size();
+			vertCache.insert(v,newIdx);
 			m_vertices.append(v);
-			vIdx.append(idx);
+			vIdx.append(newIdx);
 		}
 	}
+	#undef FIX_REL
 
 	//get/create current material group
 	MaterialGroup* grp = getCurrentMaterialGroup(state);
@@ -687,7 +1030,48 @@ void StelOBJ::addObject(const QString &name, CurrentParserState &state)
 	state.currentMaterialGroup = Q_NULLPTR;
 }
 
-bool StelOBJ::load(QIODevice& device, const QString &basePath, const VertexOrder vertexOrder)
+bool StelOBJ::applyStatement(const ParsedStatement& statement, const QDir& baseDir, CurrentParserState& state, QStringList* materialFiles)
+{
+	switch(statement.type)
+	{
+		case ParsedStatement::UseMtl:
+			if(!m_materialMap.contains(statement.arg))
+			{
+				qCCritical(stelOBJ)<<"Unknown material"<<statement.arg<<"has been referenced";
+				return false;
+			}
+			//set material as active
+			state.currentMaterialIdx = m_materialMap.value(statement.arg);
+			return true;
+		case ParsedStatement::MtlLib:
+		{
+			//load external material file
+			const QString fileName = baseDir.absoluteFilePath(statement.arg);
+			MaterialList newMaterials = Material::loadFromFile(fileName);
+			foreach(const Material& m, newMaterials)
+			{
+				m_materials.append(m);
+				//the map has the index of the material
+				//because pointers may change during parsing
+				//because of list resizeing
+				m_materialMap.insert(m.name,m_materials.size()-1);
+			}
+			if(materialFiles)
+				materialFiles->append(fileName);
+			qCDebug(stelOBJ)<<newMaterials.size()<<"materials loaded from MTL file"<<statement.arg;
+			return true;
+		}
+		case ParsedStatement::NewObject:
+		case ParsedStatement::NewGroup:
+			addObject(statement.arg, state);
+			return true;
+		case ParsedStatement::Warning:
+			return true;
+	}
+	return true;
+}
+
+bool StelOBJ::parseData(const QByteArray& data, const QString& basePath, const VertexOrder vertexOrder, QStringList* materialFiles)
 {
 	clear();
 
@@ -695,9 +1079,36 @@ bool StelOBJ::load(QIODevice& device, const QString &basePath, const VertexOrder
 
 	QElapsedTimer timer;
 	timer.start();
-	QTextStream stream(&device);
 
-	bool smoothGroupWarned = false;
+	//split the data into chunks of whole lines, large files are parsed by several threads
+	QVector<ParsedChunk> chunks;
+	const char* begin = data.constData();
+	const char* end = begin + data.size();
+	int chunkCount = 1;
+	if(data.size()>parallelParseThreshold)
+		chunkCount = qBound(1, data.size()/minChunkSize, QThread::idealThreadCount()*4);
+	const int chunkSize = data.size()/chunkCount + 1;
+	for(const char* p = begin; p<end;)
+	{
+		const char* chunkEnd = end;
+		if(end-p > chunkSize)
+		{
+			const char* eol = static_cast<const char*>(memchr(p+chunkSize-1, '\n', end-(p+chunkSize-1)));
+			if(eol)
+				chunkEnd = eol+1;
+		}
+		ParsedChunk& chunk = INC_LIST(chunks);
+		chunk.begin = p;
+		chunk.end = chunkEnd;
+		chunk.vertexOrder = vertexOrder;
+		p = chunkEnd;
+	}
+	if(chunks.size()>1)
+		QtConcurrent::blockingMap(chunks, &StelOBJ::parseChunk);
+	else if(!chunks.isEmpty())
+		parseChunk(chunks.first());
+
+	qCDebug(stelOBJ)<<"Parsed"<<chunks.size()<<"chunks in"<<timer.restart()<<"ms";
 
 	//contains the parsed vertex positions
 	V3Vec posList;
@@ -705,207 +1116,74 @@ bool StelOBJ::load(QIODevice& device, const QString &basePath, const VertexOrder
 	V3Vec normalList;
 	//contains the parsed texture coords
 	V2Vec texList;
+	int posCount = 0, normalCount = 0, texCount = 0;
+	foreach(const ParsedChunk& chunk, chunks)
+	{
+		posCount += chunk.positions.size();
+		normalCount += chunk.normals.size();
+		texCount += chunk.texCoords.size();
+	}
+	posList.reserve(posCount);
+	normalList.reserve(normalCount);
+	texList.reserve(texCount);
 
 	VertexCache vertCache;
 	CurrentParserState state = CurrentParserState();
-	const QRegularExpression separator("\\s");
-	separator.optimize();
-
-	int lineNr=0;
+	bool smoothGroupWarned = false;
 
-	//read file line by line
-	while(!stream.atEnd())
+	//merge the chunks in order, resolving the indices and applying the statements between the faces
+	int lineBase = 0;
+	for(int c = 0; c<chunks.size(); ++c)
 	{
-		++lineNr;
-		//ignore front/back whitespace
-		QString line = stream.readLine().trimmed();
-
-		//split line by whitespace
-		QVector<QStringRef> splits = line.splitRef(separator,QString::SkipEmptyParts);
-		if(!splits.isEmpty())
+		const ParsedChunk& chunk = chunks.at(c);
+		const int bases[3] = { posList.size(), texList.size(), normalList.size() };
+		posList += chunk.positions;
+		texList += chunk.texCoords;
+		normalList += chunk.normals;
+
+		const int* face = chunk.faces.constData();
+		int statementIdx = 0;
+		for(int faceIdx = 0; faceIdx<=chunk.faceCount; ++faceIdx)
 		{
-			const QStringRef& cmd = splits.at(0);
-
-			bool ok = true;
-
-			if(CMD_CMP("f"))
-			{
-				ok = parseFace(splits,posList,normalList,texList,state,vertCache);
-			}
-			else if(CMD_CMP("v"))
+			//apply the statements found before this face
+			for(; statementIdx<chunk.statements.size() && chunk.statements.at(statementIdx).faceIndex==faceIdx; ++statementIdx)
 			{
-				//we have to handle the vertex order
-				Vec3f& target = INC_LIST(posList);
-				ok = parseVec3(splits,target);
-				//check the optional w coord if we have a vec4, must be 1
-				if(splits.size()>4)
+				const ParsedStatement& statement = chunk.statements.at(statementIdx);
+				if(statement.type==ParsedStatement::Warning)
 				{
-					float w;
-					parseFloat(splits,w,4);
-					if(!qFuzzyCompare(w,1.0f))
-						qWarning(stelOBJ)<<"Vertex w coordinates different from 1.0 are not supported, changed to 1.0, on line"<<lineNr;
+					qCWarning(stelOBJ)<<statement.arg<<"on line"<<lineBase+statement.lineNr;
 				}
-				switch(vertexOrder)
+				else if(!applyStatement(statement, baseDir, state, materialFiles))
 				{
-					case XYZ:
-						//no change
-						break;
-					case XZY:
-						target.set(target[0],-target[2],target[1]);
-						break;
-					case YXZ:
-						target.set(target[1],target[0],target[2]);
-						break;
-					case YZX:
-						target.set(target[1],target[2],target[0]);
-						break;
-					case ZXY:
-						target.set(target[2],target[0],target[1]);
-						break;
-					case ZYX:
-						target.set(target[2],target[1],target[0]);
-						break;
-					default:
-						Q_ASSERT_X(0,"StelOBJ::load","invalid vertex order found");
-						qCWarning(stelOBJ) << "Vertex order"<<vertexOrder<<"not implemented, assuming XYZ";
-						break;
+					qCCritical(stelOBJ)<<"Critical error on OBJ line"<<lineBase+statement.lineNr<<", cannot load OBJ data";
+					return false;
 				}
 			}
-			else if(CMD_CMP("vt"))
-			{
-				ok = parseVec2(splits,INC_LIST(texList));
-				//check the optional w coord if we have a vec3, must be 0
-				if(splits.size()>3)
-				{
-					float w;
-					parseFloat(splits,w,3);
-					if(!qFuzzyIsNull(w))
-						qWarning(stelOBJ)<<"Texture w coordinates are not supported, on line"<<lineNr;
-				}
-			}
-			else if(CMD_CMP("vn"))
-			{
-				//we have to handle the vertex order
-				Vec3f& target = INC_LIST(normalList);
-				ok = parseVec3(splits,target);
-				switch(vertexOrder)
-				{
-					case XYZ:
-						//no change
-						break;
-					case XZY:
-						target.set(target[0],-target[2],target[1]);
-						break;
-					case YXZ:
-						target.set(target[1],target[0],target[2]);
-						break;
-					case YZX:
-						target.set(target[1],target[2],target[0]);
-						break;
-					case ZXY:
-						target.set(target[2],target[0],target[1]);
-						break;
-					case ZYX:
-						target.set(target[2],target[1],target[0]);
-						break;
-					default:
-						Q_ASSERT_X(0,"StelOBJ::load","invalid vertex order found");
-						qCWarning(stelOBJ) << "Vertex order"<<vertexOrder<<"not implemented, assuming XYZ";
-						break;
-				}
-				//normalize is usually not needed so we skip it
-				//target.normalize();
-			}
-			else if(CMD_CMP("usemtl"))
-			{
-				//use the rest of the string
-				QString mtl = getRestOfString(QStringLiteral("usemtl"),line);
-				ok = !mtl.isEmpty();
-				if(ok)
-				{
-					if(m_materialMap.contains(mtl))
-					{
-						//set material as active
-						state.currentMaterialIdx = m_materialMap.value(mtl);
-					}
-					else
-					{
-						ok = false;
-						qCCritical(stelOBJ)<<"Unknown material"<<mtl<<"has been referenced";
-					}
-				}
-				else
-					qCCritical(stelOBJ)<<"No material name given";
-			}
-			else if(CMD_CMP("mtllib"))
-			{
-				//use the rest of the string
-				QString fileName = getRestOfString(QStringLiteral("mtllib"),line);
-				ok = !fileName.isEmpty();
-				if(ok)
-				{
-					//load external material file
-					MaterialList newMaterials = Material::loadFromFile(baseDir.absoluteFilePath(fileName));
-					foreach(const Material& m, newMaterials)
-					{
-						m_materials.append(m);
-						//the map has the index of the material
-						//because pointers may change during parsing
-						//because of list resizeing
-						m_materialMap.insert(m.name,m_materials.size()-1);
-					}
-					qCDebug(stelOBJ)<<newMaterials.size()<<"materials loaded from MTL file"<<fileName;
-				}
-				else
-					qCCritical(stelOBJ)<<"No material file name given";
-			}
-			else if(CMD_CMP("o"))
-			{
-				//use the rest of the string
-				QString objName = getRestOfString(QStringLiteral("o"),line);
-				ok = !objName.isEmpty();
-				if(ok)
-				{
-					addObject(objName, state);
-				}
-				else
-					qCCritical(stelOBJ)<<"Object name is required";
-			}
-			else if(CMD_CMP("g"))
-			{
-				//use the rest of the string
-				QString objName = getRestOfString(QStringLiteral("g"),line);
-				ok = !objName.isEmpty();
-				if(ok)
-				{
-					addObject(objName, state);
-				}
-				else
-					qCCritical(stelOBJ)<<"Group name is required";
-			}
-			else if(CMD_CMP("s"))
-			{
-				if(!smoothGroupWarned)
-				{
-					qCWarning(stelOBJ)<<"Smoothing groups are not supported, consider re-exporting your model from blender";
-					smoothGroupWarned = true;
-				}
-			}
-			else if(!cmd.startsWith('#'))
-			{
-				//unknown command, warn
-				qCWarning(stelOBJ)<<"Unknown OBJ statement:"<<line;
-			}
+			if(faceIdx==chunk.faceCount)
+				break;
 
-			if(!ok)
+			if(!addFace(face, bases, posList, normalList, texList, state, vertCache))
 			{
-				qCCritical(stelOBJ)<<"Critical error on OBJ line"<<lineNr<<", cannot load OBJ data: "<<line;
+				qCCritical(stelOBJ)<<"Critical error on OBJ line"<<lineBase+face[1]<<", cannot load OBJ data";
 				return false;
 			}
+			face += 5 + 3*face[0];
 		}
-	}
 
-	device.close();
+		if(chunk.smoothingGroups && !smoothGroupWarned)
+		{
+			qCWarning(stelOBJ)<<"Smoothing groups are not supported, consider re-exporting your model from blender";
+			smoothGroupWarned = true;
+		}
+
+		if(chunk.errorLine)
+		{
+			qCCritical(stelOBJ)<<chunk.errorMessage;
+			qCCritical(stelOBJ)<<"Critical error on OBJ line"<<lineBase+chunk.errorLine<<", cannot load OBJ data";
+			return false;
+		}
+		lineBase += chunk.lineCount;
+	}
 
 	//finished loading, squeeze the arrays to save some memory
 	m_vertices.squeeze();
@@ -924,6 +1202,13 @@ bool StelOBJ::load(QIODevice& device, const QString &basePath, const VertexOrder
 	return true;
 }
 
+bool StelOBJ::load(QIODevice& device, const QString &basePath, const VertexOrder vertexOrder)
+{
+	const QByteArray data = device.readAll();
+	device.close();
+	return parseData(data, basePath, vertexOrder, Q_NULLPTR);
+}
+
 void StelOBJ::Object::postprocess(const StelOBJ &obj, Vec3d &centroid)
 {
 	const VertexList& vList = obj.getVertexList();
@@ -1251,6 +1536,133 @@ void StelOBJ::performPostProcessing(bool genNormals)
 	qCDebug(stelOBJ)<<"Centroid is at "<<m_centroid;
 }
 
+QByteArray StelOBJ::serialize() const
+{
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_4);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	//the vertex and index lists are written as raw memory, check that they are read back on a compatible machine
+	stream << meshCacheVersion << qint32(QSysInfo::ByteOrder) << qint32(sizeof(Vertex));
+	stream << qint32(m_vertices.size());
+	stream.writeRawData(reinterpret_cast<const char*>(m_vertices.constData()), m_vertices.size()*sizeof(Vertex));
+	stream << qint32(m_indices.size());
+	stream.writeRawData(reinterpret_cast<const char*>(m_indices.constData()), m_indices.size()*sizeof(unsigned int));
+
+	stream << qint32(m_materials.size());
+	foreach(const Material& mat, m_materials)
+	{
+		stream << mat.name << qint32(mat.illum) << mat.Ka << mat.Kd << mat.Ks << mat.Ke << mat.Ns << mat.d;
+		stream << mat.map_Ka << mat.map_Kd << mat.map_Ks << mat.map_Ke << mat.map_bump << mat.map_height;
+		stream << mat.additionalParams;
+	}
+	stream << m_materialMap;
+
+	stream << qint32(m_objects.size());
+	foreach(const Object& obj, m_objects)
+	{
+		stream << obj.isDefaultObject << obj.name << obj.centroid << obj.boundingbox.min << obj.boundingbox.max;
+		stream << qint32(obj.groups.size());
+		foreach(const MaterialGroup& grp, obj.groups)
+		{
+			stream << qint32(grp.startIndex) << qint32(grp.indexCount) << qint32(grp.objectIndex) << qint32(grp.materialIndex);
+			stream << grp.centroid << grp.boundingbox.min << grp.boundingbox.max;
+		}
+	}
+	stream << m_objectMap;
+	stream << m_bbox.min << m_bbox.max << m_centroid;
+	return data;
+}
+
+bool StelOBJ::deserialize(const QByteArray &data)
+{
+	clear();
+
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_4);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	qint32 version, byteOrder, vertexSize;
+	stream >> version >> byteOrder >> vertexSize;
+	if(stream.status()!=QDataStream::Ok || version!=meshCacheVersion || byteOrder!=QSysInfo::ByteOrder || vertexSize!=qint32(sizeof(Vertex)))
+		return false;
+
+	qint32 count;
+	stream >> count;
+	if(count<0 || qint64(count)*sizeof(Vertex)>quint64(data.size()))
+		return false;
+	m_vertices.resize(count);
+	const int vertexBytes = count*sizeof(Vertex);
+	if(stream.readRawData(reinterpret_cast<char*>(m_vertices.data()), vertexBytes)!=vertexBytes)
+		return false;
+
+	stream >> count;
+	if(count<0 || count%3 || qint64(count)*sizeof(unsigned int)>quint64(data.size()))
+		return false;
+	m_indices.resize(count);
+	const int indexBytes = count*sizeof(unsigned int);
+	if(stream.readRawData(reinterpret_cast<char*>(m_indices.data()), indexBytes)!=indexBytes)
+		return false;
+	for(int i = 0; i<m_indices.size(); ++i)
+	{
+		if(m_indices.at(i)>=static_cast<unsigned int>(m_vertices.size()))
+			return false;
+	}
+
+	stream >> count;
+	if(count<0 || count>data.size())
+		return false;
+	m_materials.resize(count);
+	for(int i = 0; i<m_materials.size(); ++i)
+	{
+		Material& mat = m_materials[i];
+		qint32 illum;
+		stream >> mat.name >> illum >> mat.Ka >> mat.Kd >> mat.Ks >> mat.Ke >> mat.Ns >> mat.d;
+		stream >> mat.map_Ka >> mat.map_Kd >> mat.map_Ks >> mat.map_Ke >> mat.map_bump >> mat.map_height;
+		stream >> mat.additionalParams;
+		mat.illum = static_cast<Material::Illum>(illum);
+	}
+	stream >> m_materialMap;
+
+	stream >> count;
+	if(count<0 || count>data.size())
+		return false;
+	m_objects.resize(count);
+	for(int i = 0; i<m_objects.size(); ++i)
+	{
+		Object& obj = m_objects[i];
+		stream >> obj.isDefaultObject >> obj.name >> obj.centroid >> obj.boundingbox.min >> obj.boundingbox.max;
+		stream >> count;
+		if(count<0 || count>data.size())
+			return false;
+		obj.groups.resize(count);
+		for(int j = 0; j<obj.groups.size(); ++j)
+		{
+			MaterialGroup& grp = obj.groups[j];
+			qint32 startIndex, indexCount, objectIndex, materialIndex;
+			stream >> startIndex >> indexCount >> objectIndex >> materialIndex;
+			stream >> grp.centroid >> grp.boundingbox.min >> grp.boundingbox.max;
+			if(startIndex<0 || indexCount<0 || startIndex+indexCount>m_indices.size() || materialIndex<0 || materialIndex>=m_materials.size())
+				return false;
+			grp.startIndex = startIndex;
+			grp.indexCount = indexCount;
+			grp.objectIndex = objectIndex;
+			grp.materialIndex = materialIndex;
+		}
+	}
+	stream >> m_objectMap;
+	stream >> m_bbox.min >> m_bbox.max >> m_centroid;
+
+	if(stream.status()!=QDataStream::Ok)
+	{
+		clear();
+		return false;
+	}
+	m_isLoaded = true;
+	return true;
+}
+
 StelOBJ::ShortIndexList StelOBJ::getShortIndexList() const
 {
 	QElapsedTimer timer;
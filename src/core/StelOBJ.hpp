@@ -25,13 +25,17 @@
 
 #include <qopengl.h>
 #include <QLoggingCategory>
+#include <QByteArray>
 #include <QString>
+#include <QStringList>
 #include <QIODevice>
 #include <QVector>
 #include <QHash>
 
 Q_DECLARE_LOGGING_CATEGORY(stelOBJ)
 
+class QDir;
+
 //! Representation of a custom subset of a [Wavefront .obj file](https://en.wikipedia.org/wiki/Wavefront_.obj_file),
 //! including only triangle data and materials.
 class StelOBJ
@@ -241,11 +245,13 @@ public:
 	//! correspond to the geometric center/center of mass of the object
 	inline const Vec3f& getCentroid() const { return m_centroid; }
 
-	//! Loads an .obj file by name. Supports .gz decompression, and
-	//! then calls load(QIODevice) for the actual loading.
+	//! Loads an .obj file by name. Supports .gz decompression.
+	//! Uncompressed files are memory-mapped, and large files are parsed by several threads.
+	//! The post-processed data is kept in the binary cache (see StelBinaryCache), and is reused
+	//! instead of parsing the file again while the file, its material files and \p vertexOrder are unchanged.
 	//! @return true if load was successful
 	bool load(const QString& filename, const VertexOrder vertexOrder = VertexOrder::XYZ);
-	//! Loads an .obj file from the specified device.
+	//! Loads an .obj file from the specified device. The binary cache is not used.
 	//! @param device The device to load OBJ data from
 	//! @param basePath The path to use to find additional files (like material definitions)
 	//! @param vertexOrder The order to use for vertex positions
@@ -255,6 +261,10 @@ public:
 	//! Returns true if this object contains valid data from a load() method
 	bool isLoaded() const { return m_isLoaded; }
 
+	//! Returns a hash identifying the file and the options the data was loaded from by load(const QString&, const VertexOrder),
+	//! or an empty array if it was loaded from a device. Users can use it to cache their own data derived from the mesh.
+	inline const QByteArray& getSourceHash() const { return m_sourceHash; }
+
 	//! Rebuilds vertex normals as the average of face normals.
 	void rebuildNormals();
 
@@ -296,6 +306,12 @@ public:
 	//!
 	//! This is intended to be used together with splitVertexData(), when you want your own vertex format.
 	void clearVertexData();
+
+	//! Writes the loaded and post-processed data, as stored in the binary cache by load()
+	QByteArray serialize() const;
+	//! Restores the data written by serialize()
+	//! @return false if the data is invalid, or was written by another version
+	bool deserialize(const QByteArray& data);
 private:
 	typedef QVector<QStringRef> ParseParams;
 	typedef QHash<Vertex, int> VertexCache;
@@ -307,7 +323,51 @@ private:
 		Object* currentObject;
 	};
 
+	//! A statement changing the parser state, found while parsing a chunk and applied in order when the chunks are merged
+	struct ParsedStatement
+	{
+		enum Type { UseMtl, MtlLib, NewObject, NewGroup, Warning } type;
+		//! The number of faces of the chunk before this statement
+		int faceIndex;
+		//! The line number in the chunk
+		int lineNr;
+		//! The rest of the line, or the message of a warning
+		QString arg;
+	};
+
+	//! The data parsed from a range of lines of an .obj file.
+	//! Chunks are parsed independently from each other, the vertex indices of the faces are resolved when they are merged.
+	struct ParsedChunk
+	{
+		ParsedChunk()
+			: begin(Q_NULLPTR), end(Q_NULLPTR), vertexOrder(XYZ),
+			  lineCount(0), faceCount(0), smoothingGroups(false), errorLine(0)
+		{
+		}
+
+		const char* begin;
+		const char* end;
+		VertexOrder vertexOrder;
+
+		int lineCount;
+		V3Vec positions;
+		V3Vec normals;
+		V2Vec texCoords;
+		//! For each face: the number of vertices n, the line number, the number of positions,
+		//! texture coordinates and normals of the chunk before the face, and n position/texture/normal
+		//! index triples as written in the file (0 if not given)
+		QVector<int> faces;
+		int faceCount;
+		QVector<ParsedStatement> statements;
+		bool smoothingGroups;
+
+		//! The line number of the first error in the chunk, 0 if none. Parsing stops there.
+		int errorLine;
+		QString errorMessage;
+	};
+
 	bool m_isLoaded;
+	QByteArray m_sourceHash;
 	//all vertex data is contained in this list
 	VertexList m_vertices;
 	//all index data is contained in this list
@@ -348,8 +408,16 @@ private:
 	//! Only requirement is that operator[] is defined.
 	template<typename T>
 	inline static bool parseVec2(const ParseParams& params, T& out, int paramsStart=1);
-	inline bool parseFace(const ParseParams& params, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
-			      CurrentParserState &state, VertexCache& vertCache);
+	//! Parses the lines between chunk.begin and chunk.end. Called for the chunks in parallel.
+	static void parseChunk(ParsedChunk& chunk);
+	//! Adds the face parsed at \p face, with the vertex lists of the chunk starting at the given bases
+	inline bool addFace(const int* face, const int* bases, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
+			    CurrentParserState &state, VertexCache& vertCache);
+	//! Applies a statement of a chunk to the parser state
+	inline bool applyStatement(const ParsedStatement& statement, const QDir& baseDir, CurrentParserState& state, QStringList* materialFiles);
+	//! Parses the content of an .obj file, in several threads if it is large.
+	//! @param materialFiles if not null, receives the paths of the loaded .mtl files
+	bool parseData(const QByteArray& data, const QString& basePath, const VertexOrder vertexOrder, QStringList* materialFiles);
 
 	inline void addObject(const QString& name, CurrentParserState& state);
 
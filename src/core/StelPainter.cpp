@@ -28,7 +28,6 @@
 #include <QDebug>
 #include <QString>
 #include <QSettings>
-#include <QLinkedList>
 #include <QPainter>
 #include <QMutex>
 #include <QVarLengthArray>
@@ -50,10 +49,12 @@ QOpenGLShaderProgram* StelPainter::texturesShaderProgram=Q_NULLPTR;
 QOpenGLShaderProgram* StelPainter::basicShaderProgram=Q_NULLPTR;
 QOpenGLShaderProgram* StelPainter::colorShaderProgram=Q_NULLPTR;
 QOpenGLShaderProgram* StelPainter::texturesColorShaderProgram=Q_NULLPTR;
+QOpenGLShaderProgram* StelPainter::wideLineShaderProgram=Q_NULLPTR;
 StelPainter::BasicShaderVars StelPainter::basicShaderVars;
 StelPainter::TexturesShaderVars StelPainter::texturesShaderVars;
 StelPainter::BasicShaderVars StelPainter::colorShaderVars;
 StelPainter::TexturesColorShaderVars StelPainter::texturesColorShaderVars;
+StelPainter::WideLineShaderVars StelPainter::wideLineShaderVars;
 
 StelPainter::GLState::GLState(QOpenGLFunctions* gl)
 	: blend(false),
@@ -110,7 +111,7 @@ bool StelPainter::linkProg(QOpenGLShaderProgram* prog, const QString& name)
 	return ret;
 }
 
-StelPainter::StelPainter(const StelProjectorP& proj) : QOpenGLFunctions(QOpenGLContext::currentContext()), glState(this)
+StelPainter::StelPainter(const StelProjectorP& proj) : QOpenGLFunctions(QOpenGLContext::currentContext()), glState(this), lineBatchEnabled(false)
 {
 	Q_ASSERT(proj);
 
@@ -140,6 +141,8 @@ StelPainter::StelPainter(const StelProjectorP& proj) : QOpenGLFunctions(QOpenGLC
 
 void StelPainter::setProjector(const StelProjectorP& p)
 {
+	// The batched lines are already projected with the previous viewport
+	flushLineBatch();
 	prj=p;
 	// Init GL viewport to current projector values
 	glViewport(prj->viewportXywh[0], prj->viewportXywh[1], prj->viewportXywh[2], prj->viewportXywh[3]);
@@ -148,6 +151,8 @@ void StelPainter::setProjector(const StelProjectorP& p)
 
 StelPainter::~StelPainter()
 {
+	endLineBatch();
+
 	//reset opengl state
 	glState.reset();
 
@@ -172,6 +177,8 @@ void StelPainter::setFont(const QFont& font)
 
 void StelPainter::setColor(float r, float g, float b, float a)
 {
+	if (!lineBatchVertexArray.isEmpty() && currentColor!=Vec4f(r,g,b,a))
+		flushLineBatch();
 	currentColor.set(r,g,b,a);
 }
 
@@ -187,6 +194,8 @@ QFontMetrics StelPainter::getFontMetrics() const
 
 void StelPainter::setBlending(bool enableBlending, GLenum blendSrc, GLenum blendDst)
 {
+	if(enableBlending != glState.blend || (enableBlending && (blendSrc!=glState.blendSrc || blendDst!=glState.blendDst)))
+		flushLineBatch();
 	if(enableBlending != glState.blend)
 	{
 		glState.blend = enableBlending;
@@ -244,17 +253,19 @@ void StelPainter::setCullFace(bool enable)
 
 void StelPainter::setLineSmooth(bool enable)
 {
+	if (enable==glState.lineSmooth)
+		return;
+	flushLineBatch();
+	// Also recorded on OpenGL ES, where the lines are smoothed by the wide line shader only
+	glState.lineSmooth = enable;
 #ifdef GL_LINE_SMOOTH
-	if (!QOpenGLContext::currentContext()->isOpenGLES() && enable!=glState.lineSmooth)
+	if (!QOpenGLContext::currentContext()->isOpenGLES())
 	{
-		glState.lineSmooth = enable;
 		if(enable)
 			glEnable(GL_LINE_SMOOTH);
 		else
 			glDisable(GL_LINE_SMOOTH);
 	}
-#else
-	Q_UNUSED(enable); //noop
 #endif
 }
 
@@ -262,6 +273,7 @@ void StelPainter::setLineWidth(float width)
 {
 	if(glState.lineWidth != width)
 	{
+		flushLineBatch();
 		glState.lineWidth = width;
 		glLineWidth(width);
 	}
@@ -752,16 +764,18 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
 	}
 }
 
-// Recursive method cutting a small circle in small segments
-inline void fIter(const StelProjectorP& prj, const Vec3d& p1, const Vec3d& p2, Vec3d& win1, Vec3d& win2, QLinkedList<Vec3d>& vertexList, const QLinkedList<Vec3d>::iterator& iter, double radius, const Vec3d& center, int nbI=0, bool checkCrossDiscontinuity=true)
+// Recursive method cutting a small circle in small segments.
+// The vertices strictly between p1 and p2 are appended in order to vertexList, so that a
+// preallocated array can be filled without inserting in the middle of a list.
+inline void fIter(const StelProjectorP& prj, const Vec3d& p1, const Vec3d& p2, Vec3d& win1, Vec3d& win2, QVector<Vec3d>& vertexList, double radius, const Vec3d& center, int nbI=0, bool checkCrossDiscontinuity=true)
 {
 	const bool crossDiscontinuity = checkCrossDiscontinuity && prj->intersectViewportDiscontinuity(p1+center, p2+center);
 	if (crossDiscontinuity && nbI>=10)
 	{
 		win1[2]=-2.;
 		win2[2]=-2.;
-		vertexList.insert(iter, win1);
-		vertexList.insert(iter, win2);
+		vertexList.append(win1);
+		vertexList.append(win2);
 		return;
 	}
 
@@ -782,14 +796,18 @@ inline void fIter(const StelProjectorP& prj, const Vec3d& p1, const Vec3d& p2, V
 	{
 		// Use the 3rd component of the vector to store whether the vertex is valid
 		win3[2]= isValidVertex ? 1.0 : -1.;
-		fIter(prj, p1, newVertex, win1, win3, vertexList, vertexList.insert(iter, win3), radius, center, nbI+1, crossDiscontinuity || dist>50*50);
-		fIter(prj, newVertex, p2, win3, win2, vertexList, iter, radius, center, nbI+1, crossDiscontinuity || dist>50*50 );
+		// The first half may flag win3 as a discontinuity, the middle vertex itself keeps its validity
+		const Vec3d middle(win3);
+		fIter(prj, p1, newVertex, win1, win3, vertexList, radius, center, nbI+1, crossDiscontinuity || dist>50*50);
+		vertexList.append(middle);
+		fIter(prj, newVertex, p2, win3, win2, vertexList, radius, center, nbI+1, crossDiscontinuity || dist>50*50 );
 	}
 }
 
 // Used by the method below
 QVector<Vec2f> StelPainter::smallCircleVertexArray;
 QVector<Vec4f> StelPainter::smallCircleColorArray;
+QVector<Vec2f> StelPainter::lineBatchVertexArray;
 
 void StelPainter::drawSmallCircleVertexArray()
 {
@@ -798,6 +816,19 @@ void StelPainter::drawSmallCircleVertexArray()
 
 	Q_ASSERT(smallCircleVertexArray.size()>1);
 
+	if (lineBatchEnabled && smallCircleColorArray.isEmpty())
+	{
+		// Store the strip as independent segments, so that all the strips can be drawn at once
+		// without primitive restart, which OpenGL ES 2 lacks.
+		for (int i=1; i<smallCircleVertexArray.size(); ++i)
+		{
+			lineBatchVertexArray.append(smallCircleVertexArray.at(i-1));
+			lineBatchVertexArray.append(smallCircleVertexArray.at(i));
+		}
+		smallCircleVertexArray.resize(0);
+		return;
+	}
+
 	enableClientStates(true, false, !smallCircleColorArray.isEmpty());
 	setVertexPointer(2, GL_FLOAT, smallCircleVertexArray.constData());
 	if (!smallCircleColorArray.isEmpty())
@@ -808,6 +839,30 @@ void StelPainter::drawSmallCircleVertexArray()
 	smallCircleColorArray.resize(0);
 }
 
+void StelPainter::beginLineBatch()
+{
+	lineBatchEnabled = true;
+}
+
+void StelPainter::endLineBatch()
+{
+	flushLineBatch();
+	lineBatchEnabled = false;
+}
+
+void StelPainter::flushLineBatch()
+{
+	if (lineBatchVertexArray.isEmpty())
+		return;
+
+	enableClientStates(true);
+	setVertexPointer(2, GL_FLOAT, lineBatchVertexArray.constData());
+	drawFromArray(Lines, lineBatchVertexArray.size(), 0, false);
+	enableClientStates(false);
+	// Keep the allocated memory for the next frame
+	lineBatchVertexArray.resize(0);
+}
+
 static Vec3d pt1, pt2;
 void StelPainter::drawGreatCircleArc(const Vec3d& start, const Vec3d& stop, const SphericalCap* clippingCap,
 	void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData)
@@ -832,39 +887,44 @@ void StelPainter::drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, cons
 {
 	Q_ASSERT(smallCircleVertexArray.empty());
 
-	QLinkedList<Vec3d> tessArc;	// Contains the list of projected points from the tesselated arc
+	// Contains the list of projected points from the tesselated arc. An arc has at most 2^10+1 vertices
+	// (a few more at discontinuities), the array is static so that it is allocated only once.
+	static QVector<Vec3d> tessArc;
+	tessArc.resize(0);
 	Vec3d win1, win2;
 	win1[2] = prj->project(start, win1) ? 1.0 : -1.;
 	win2[2] = prj->project(stop, win2) ? 1.0 : -1.;
 	tessArc.append(win1);
-
+	// The recursion may flag win2 as a discontinuity, the last vertex itself keeps its validity
+	const Vec3d last(win2);
 
 	if (rotCenter.lengthSquared()<1e-11)
 	{
 		// Great circle
 		// Perform the tesselation of the arc in small segments in a way so that the lines look smooth
-		fIter(prj, start, stop, win1, win2, tessArc, tessArc.insert(tessArc.end(), win2), 1, rotCenter);
+		fIter(prj, start, stop, win1, win2, tessArc, 1, rotCenter);
 	}
 	else
 	{
 		Vec3d tmp = (rotCenter^start)/rotCenter.length();
 		const double radius = fabs(tmp.length());
 		// Perform the tesselation of the arc in small segments in a way so that the lines look smooth
-		fIter(prj, start-rotCenter, stop-rotCenter, win1, win2, tessArc, tessArc.insert(tessArc.end(), win2), radius, rotCenter);
+		fIter(prj, start-rotCenter, stop-rotCenter, win1, win2, tessArc, radius, rotCenter);
 	}
+	tessArc.append(last);
 
 	// And draw.
-	QLinkedList<Vec3d>::ConstIterator i = tessArc.constBegin();
-	while (i+1 != tessArc.constEnd())
+	const int count = tessArc.size();
+	for (int i=1; i<count; ++i)
 	{
-		const Vec3d& p1 = *i;
-		const Vec3d& p2 = *(++i);
+		const Vec3d& p1 = tessArc.at(i-1);
+		const Vec3d& p2 = tessArc.at(i);
 		const bool p1InViewport = prj->checkInViewport(p1);
 		const bool p2InViewport = prj->checkInViewport(p2);
 		if ((p1[2]>0 && p1InViewport) || (p2[2]>0 && p2InViewport))
 		{
 			smallCircleVertexArray.append(Vec2f(p1[0], p1[1]));
-			if (i+1==tessArc.constEnd())
+			if (i+1==count)
 			{
 				smallCircleVertexArray.append(Vec2f(p2[0], p2[1]));
 				drawSmallCircleVertexArray();
@@ -2086,6 +2146,65 @@ void StelPainter::initGLShaders()
 	texturesColorShaderVars.vertex = texturesColorShaderProgram->attributeLocation("vertex");
 	texturesColorShaderVars.color = texturesColorShaderProgram->attributeLocation("color");
 	texturesColorShaderVars.texture = texturesColorShaderProgram->uniformLocation("tex");
+
+	// Wide and smooth lines: each segment is expanded into a quad in screen space,
+	// the antialiasing is computed from the distance to the center of the line.
+	QOpenGLShader vshaderWideLine(QOpenGLShader::Vertex);
+	const char *vshaderWideLineSrc =
+		"attribute highp vec3 vertex;\n"
+		"attribute highp vec3 otherVertex;\n"
+		"attribute mediump vec2 corner;\n"
+		"attribute mediump vec4 color;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"uniform mediump float halfWidth;\n"
+		"varying mediump vec4 fragcolor;\n"
+		"varying mediump float dist;\n"
+		"void main(void)\n"
+		"{\n"
+		"    highp vec2 dir = (otherVertex.xy-vertex.xy)*(-corner.x);\n"
+		"    highp float len = length(dir);\n"
+		"    dir = len>0.0001 ? dir/len : vec2(1., 0.);\n"
+		"    dist = corner.y*halfWidth;\n"
+		"    gl_Position = projectionMatrix*vec4(vertex.xy+vec2(-dir.y, dir.x)*dist, vertex.z, 1.);\n"
+		"    fragcolor = color;\n"
+		"}\n";
+	vshaderWideLine.compileSourceCode(vshaderWideLineSrc);
+	if (!vshaderWideLine.log().isEmpty()) {
+	  qWarning() << "StelPainter: Warnings while compiling vshaderWideLine: " << vshaderWideLine.log();
+	}
+	QOpenGLShader fshaderWideLine(QOpenGLShader::Fragment);
+	const char *fshaderWideLineSrc =
+		"varying mediump vec4 fragcolor;\n"
+		"varying mediump float dist;\n"
+		"uniform mediump float lineHalfWidth;\n"
+		"uniform mediump float smoothing;\n"
+		"void main(void)\n"
+		"{\n"
+		"    mediump float coverage = clamp(lineHalfWidth+0.5-abs(dist), 0., 1.);\n"
+		"    gl_FragColor = vec4(fragcolor.rgb, fragcolor.a*mix(1., coverage, smoothing));\n"
+		"}\n";
+	fshaderWideLine.compileSourceCode(fshaderWideLineSrc);
+	if (!fshaderWideLine.log().isEmpty()) {
+	  qWarning() << "StelPainter: Warnings while compiling fshaderWideLine: " << fshaderWideLine.log();
+	}
+	wideLineShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+	wideLineShaderProgram->addShader(&vshaderWideLine);
+	wideLineShaderProgram->addShader(&fshaderWideLine);
+	if (!linkProg(wideLineShaderProgram, "wideLineShaderProgram"))
+	{
+		// Fall back to the OpenGL lines
+		delete wideLineShaderProgram;
+		wideLineShaderProgram = Q_NULLPTR;
+		return;
+	}
+	wideLineShaderVars.projectionMatrix = wideLineShaderProgram->uniformLocation("projectionMatrix");
+	wideLineShaderVars.halfWidth = wideLineShaderProgram->uniformLocation("halfWidth");
+	wideLineShaderVars.lineHalfWidth = wideLineShaderProgram->uniformLocation("lineHalfWidth");
+	wideLineShaderVars.smoothing = wideLineShaderProgram->uniformLocation("smoothing");
+	wideLineShaderVars.vertex = wideLineShaderProgram->attributeLocation("vertex");
+	wideLineShaderVars.otherVertex = wideLineShaderProgram->attributeLocation("otherVertex");
+	wideLineShaderVars.corner = wideLineShaderProgram->attributeLocation("corner");
+	wideLineShaderVars.color = wideLineShaderProgram->attributeLocation("color");
 }
 
 
@@ -2099,6 +2218,8 @@ void StelPainter::deinitGLShaders()
 	texturesShaderProgram = Q_NULLPTR;
 	delete texturesColorShaderProgram;
 	texturesColorShaderProgram = Q_NULLPTR;
+	delete wideLineShaderProgram;
+	wideLineShaderProgram = Q_NULLPTR;
 	texCache.clear();
 }
 
@@ -2141,11 +2262,18 @@ void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool do
 			projectedVertexArray = projectArray(vertexArray, offset, count, Q_NULLPTR);
 	}
 
-	QOpenGLShaderProgram* pr=Q_NULLPTR;
-
 	const Mat4f& m = getProjector()->getProjectionMatrix();
 	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
 
+	if ((mode==Lines || mode==LineStrip || mode==LineLoop) && (glState.lineWidth>1.f || glState.lineSmooth)
+	    && wideLineShaderProgram && !texCoordArray.enabled && !normalArray.enabled)
+	{
+		drawWideLines(mode, count, offset, projectedVertexArray, indices, qMat);
+		return;
+	}
+
+	QOpenGLShaderProgram* pr=Q_NULLPTR;
+
 	if (!texCoordArray.enabled && !colorArray.enabled && !normalArray.enabled)
 	{
 		pr = basicShaderProgram;
@@ -2227,6 +2355,106 @@ void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool do
 }
 
 
+// Read the vertex or color i of an array passed to drawFromArray(), the missing components are set to def.
+static inline Vec4f readArrayElement(int size, int type, const void* pointer, int i, const Vec4f& def)
+{
+	Vec4f v(def);
+	const int n = qMin(size, 4);
+	if (type==GL_DOUBLE)
+	{
+		const double* p = static_cast<const double*>(pointer)+i*size;
+		for (int k=0; k<n; ++k)
+			v[k] = p[k];
+	}
+	else
+	{
+		Q_ASSERT(type==GL_FLOAT);
+		const float* p = static_cast<const float*>(pointer)+i*size;
+		for (int k=0; k<n; ++k)
+			v[k] = p[k];
+	}
+	return v;
+}
+
+void StelPainter::drawWideLines(DrawingMode mode, int count, int offset, const ArrayDesc& projectedVertexArray, const unsigned short* indices, const QMatrix4x4& projectionMatrix)
+{
+	// One quad made of 2 triangles per segment. Each vertex knows the other end of its segment,
+	// so that the vertex shader can offset it perpendicularly to the segment on screen.
+	struct WideLineVertex
+	{
+		Vec3f vertex;
+		Vec3f otherVertex;
+		Vec2f corner;	// x: -1 at the start of the segment, 1 at its end, y: side of the line
+		Vec4f color;
+	};
+	static QVector<WideLineVertex> vertices;
+	vertices.resize(0);
+
+	const int nbSegments = mode==Lines ? count/2 : (mode==LineLoop && count>2 ? count : count-1);
+	if (nbSegments<=0)
+		return;
+	vertices.reserve(6*nbSegments);
+
+	const Vec4f origin(0.f, 0.f, 0.f, 1.f);
+	for (int s=0; s<nbSegments; ++s)
+	{
+		const int i1 = mode==Lines ? 2*s : s;
+		const int i2 = mode==Lines ? 2*s+1 : (s+1)%count;
+		const int j1 = indices ? indices[offset+i1] : offset+i1;
+		const int j2 = indices ? indices[offset+i2] : offset+i2;
+		const Vec4f p1 = readArrayElement(projectedVertexArray.size, projectedVertexArray.type, projectedVertexArray.pointer, j1, origin);
+		const Vec4f p2 = readArrayElement(projectedVertexArray.size, projectedVertexArray.type, projectedVertexArray.pointer, j2, origin);
+		Vec4f c1(currentColor), c2(currentColor);
+		if (colorArray.enabled)
+		{
+			c1 = readArrayElement(colorArray.size, colorArray.type, colorArray.pointer, j1, origin);
+			c2 = readArrayElement(colorArray.size, colorArray.type, colorArray.pointer, j2, origin);
+		}
+
+		WideLineVertex a1 = {Vec3f(p1[0], p1[1], p1[2]), Vec3f(p2[0], p2[1], p2[2]), Vec2f(-1.f, 1.f), c1};
+		WideLineVertex b1 = a1;
+		b1.corner[1] = -1.f;
+		WideLineVertex a2 = {Vec3f(p2[0], p2[1], p2[2]), Vec3f(p1[0], p1[1], p1[2]), Vec2f(1.f, 1.f), c2};
+		WideLineVertex b2 = a2;
+		b2.corner[1] = -1.f;
+		vertices << a1 << b1 << b2 << a1 << b2 << a2;
+	}
+
+	const float lineHalfWidth = 0.5f*glState.lineWidth;
+	// Leave room for the antialiased fringe of smooth lines
+	const float halfWidth = glState.lineSmooth ? lineHalfWidth+1.f : lineHalfWidth;
+	const int stride = sizeof(WideLineVertex);
+	const GLfloat* data = reinterpret_cast<const GLfloat*>(vertices.constData());
+
+	QOpenGLShaderProgram* pr = wideLineShaderProgram;
+	pr->bind();
+	pr->setUniformValue(wideLineShaderVars.projectionMatrix, projectionMatrix);
+	pr->setUniformValue(wideLineShaderVars.halfWidth, halfWidth);
+	pr->setUniformValue(wideLineShaderVars.lineHalfWidth, lineHalfWidth);
+	pr->setUniformValue(wideLineShaderVars.smoothing, glState.lineSmooth ? 1.f : 0.f);
+	pr->setAttributeArray(wideLineShaderVars.vertex, data, 3, stride);
+	pr->setAttributeArray(wideLineShaderVars.otherVertex, data+3, 3, stride);
+	pr->setAttributeArray(wideLineShaderVars.corner, data+6, 2, stride);
+	pr->setAttributeArray(wideLineShaderVars.color, data+8, 4, stride);
+	pr->enableAttributeArray(wideLineShaderVars.vertex);
+	pr->enableAttributeArray(wideLineShaderVars.otherVertex);
+	pr->enableAttributeArray(wideLineShaderVars.corner);
+	pr->enableAttributeArray(wideLineShaderVars.color);
+
+	// The winding of the quads depends on the direction of the segments
+	if (glState.cullFace)
+		glDisable(GL_CULL_FACE);
+	glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+	if (glState.cullFace)
+		glEnable(GL_CULL_FACE);
+
+	pr->disableAttributeArray(wideLineShaderVars.vertex);
+	pr->disableAttributeArray(wideLineShaderVars.otherVertex);
+	pr->disableAttributeArray(wideLineShaderVars.corner);
+	pr->disableAttributeArray(wideLineShaderVars.color);
+	pr->release();
+}
+
 StelPainter::ArrayDesc StelPainter::projectArray(const StelPainter::ArrayDesc& array, int offset, int count, const unsigned short* indices)
 {
 	// XXX: we should use a more generic way to test whether or not to do the projection.
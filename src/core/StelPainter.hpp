@@ -30,6 +30,7 @@
 #include <QFontMetrics>
 
 class QOpenGLShaderProgram;
+class QMatrix4x4;
 
 //! @class StelPainter
 //! Provides functions for performing openGL drawing operations.
@@ -127,6 +128,18 @@ public:
 	//! The algorithm take care of cutting the path if it crosses a viewport discontinuity.
 	void drawPath(const QVector<Vec3d> &points, const QVector<Vec4f> &colors);
 
+	//! Start collecting the lines of the following drawSmallCircleArc(), drawGreatCircleArc() and drawGreatCircleArcs()
+	//! calls in one buffer, instead of drawing each visible part of each arc on its own.
+	//! The collected lines are drawn at once when the color, line width, line smoothing, blending or projector
+	//! is changed, and at the latest by endLineBatch() or the destruction of the painter. This is meant for modules
+	//! drawing many arcs with a few styles, like grids and boundaries. Note that other primitives drawn meanwhile,
+	//! e.g. the labels drawn by the viewport edge callbacks, may end up below the lines.
+	void beginLineBatch();
+	//! Draw the lines collected since beginLineBatch() and go back to drawing each arc immediately.
+	void endLineBatch();
+	//! Draw the lines collected so far, if any.
+	void flushLineBatch();
+
 	//! Draw a simple circle, 2d viewport coordinates in pixel
 	void drawCircle(float x, float y, float r);
 
@@ -249,6 +262,8 @@ public:
 	void setLineSmooth(bool enable);
 
 	//! Sets the line width. Default is 1.0f.
+	//! Lines wider than one pixel or smoothed are drawn as screen-space quads by a shader, so they
+	//! do not depend on the line width range and smoothing support of the OpenGL implementation.
 	void setLineWidth(float width);
 
 	//! Create the OpenGL shaders programs used by the StelPainter.
@@ -366,11 +381,19 @@ private:
 
 	void drawTextGravity180(float x, float y, const QString& str, float xshift = 0, float yshift = 0);
 
+	//! Draw the lines of a drawFromArray() call with the wide line shader.
+	//! Each segment is expanded into a quad of the current line width, with antialiased edges if line smoothing is enabled.
+	void drawWideLines(DrawingMode mode, int count, int offset, const ArrayDesc& projectedVertexArray, const unsigned short* indices, const QMatrix4x4& projectionMatrix);
+
 	// Used by the method below
 	static QVector<Vec2f> smallCircleVertexArray;
 	static QVector<Vec4f> smallCircleColorArray;
 	void drawSmallCircleVertexArray();
 
+	//! Lines collected between beginLineBatch() and endLineBatch(), as pairs of segment ends in window coordinates.
+	static QVector<Vec2f> lineBatchVertexArray;
+	bool lineBatchEnabled;
+
 	//! The associated instance of projector
 	StelProjectorP prj;
 
@@ -414,6 +437,19 @@ private:
 	};
 	static TexturesColorShaderVars texturesColorShaderVars;
 
+	static QOpenGLShaderProgram* wideLineShaderProgram;
+	struct WideLineShaderVars {
+		int projectionMatrix;
+		int halfWidth;
+		int lineHalfWidth;
+		int smoothing;
+		int vertex;
+		int otherVertex;
+		int corner;
+		int color;
+	};
+	static WideLineShaderVars wideLineShaderVars;
+
 
 	//! The descriptor for the current opengl vertex array
 	ArrayDesc vertexArray;
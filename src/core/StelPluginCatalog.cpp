@@ -0,0 +1,340 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelPluginCatalog.hpp"
+#include "StelBinaryCache.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <cstring>
+#include <stdexcept>
+
+// Version of the compiled records, to be increased when their format changes
+static const int catalogCacheVersion = 2;
+
+// The type of a value in a record, followed by its data:
+// nothing for null and booleans, a double for numbers,
+// the quint32 index in the pool for strings, and for lists and maps the quint32
+// number of elements followed by the elements (each preceded by the index of its
+// name for maps).
+// The cache is local to the computer, so the numbers are in native byte order.
+enum RecordValueType
+{
+	NullValue,
+	FalseValue,
+	TrueValue,
+	DoubleValue,
+	StringValue,
+	ListValue,
+	MapValue
+};
+
+template<typename T> static inline void appendRaw(QByteArray& data, T value)
+{
+	data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T> static inline T readRaw(const char*& data)
+{
+	T value;
+	std::memcpy(&value, data, sizeof(T));
+	data += sizeof(T);
+	return value;
+}
+
+//identifies the content of a file by its path, size and modification time
+static QByteArray getFileStamp(const QString& path)
+{
+	QFileInfo fi(path);
+	return QString("%1|%2|%3;").arg(fi.absoluteFilePath()).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch()).toUtf8();
+}
+
+StelPluginCatalog::StelPluginCatalog(const QString& jsonPath, const QString& entriesKey)
+	: jsonPath(jsonPath)
+	, entriesKey(entriesKey)
+{
+}
+
+void StelPluginCatalog::clear()
+{
+	header.clear();
+	strings.clear();
+	entries.clear();
+	records.clear();
+}
+
+bool StelPluginCatalog::load()
+{
+	clear();
+	if (!QFileInfo(jsonPath).isFile())
+	{
+		qWarning() << "Cannot open catalog" << QDir::toNativeSeparators(jsonPath);
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	const QString cacheKey = "StelPluginCatalog:" + QFileInfo(jsonPath).canonicalFilePath();
+	const QByteArray sourceHash = StelBinaryCache::hash(getFileStamp(jsonPath) + QString("|%1|%2").arg(entriesKey).arg(catalogCacheVersion).toUtf8());
+	QVariant cached;
+	if (StelBinaryCache::load(cacheKey, sourceHash, cached))
+	{
+		if (fromVariant(cached.toMap()))
+		{
+			qDebug() << "Loaded compiled catalog" << QDir::toNativeSeparators(jsonPath) << "in" << timer.elapsed() << "ms";
+			return true;
+		}
+		qWarning() << "Invalid compiled catalog for" << QDir::toNativeSeparators(jsonPath);
+		clear();
+	}
+
+	if (!compile())
+	{
+		clear();
+		return false;
+	}
+	qDebug() << "Compiled catalog" << QDir::toNativeSeparators(jsonPath) << "(" << entries.size() << "entries ) in" << timer.elapsed() << "ms";
+	StelBinaryCache::save(cacheKey, sourceHash, toVariant());
+	return true;
+}
+
+bool StelPluginCatalog::compile()
+{
+	QFile file(jsonPath);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Cannot open catalog" << QDir::toNativeSeparators(jsonPath);
+		return false;
+	}
+
+	QHash<QString, quint32> indices;
+	// Sorted by name, and like with a QVariantMap the last of duplicated names wins
+	QMap<QString, quint32> offsets;
+	try
+	{
+		StelJsonReader reader(&file);
+		if (reader.readNext()!=StelJsonReader::StartObject)
+			throw std::runtime_error("the catalog is not an object");
+		while (reader.readNext()==StelJsonReader::Key)
+		{
+			if (reader.key()!=entriesKey)
+			{
+				header.insert(reader.key(), reader.readValue());
+				continue;
+			}
+
+			if (reader.readNext()!=StelJsonReader::StartObject)
+				throw std::runtime_error(qPrintable(QString("%1 is not an object").arg(entriesKey)));
+			// The entries are compiled directly from the tokens, without creating QVariants
+			while (reader.readNext()==StelJsonReader::Key)
+			{
+				offsets.insert(reader.key(), records.size());
+				compileValue(reader, reader.readNext(), indices);
+			}
+		}
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Invalid catalog" << QDir::toNativeSeparators(jsonPath) << "-" << e.what();
+		return false;
+	}
+
+	entries.reserve(offsets.size());
+	for (QMap<QString, quint32>::const_iterator it=offsets.constBegin(); it!=offsets.constEnd(); ++it)
+	{
+		Entry entry;
+		entry.name = addString(it.key(), indices);
+		entry.offset = it.value();
+		entries.append(entry);
+	}
+	records.squeeze();
+	return true;
+}
+
+quint32 StelPluginCatalog::addString(const QString& str, QHash<QString, quint32>& indices)
+{
+	QHash<QString, quint32>::const_iterator it = indices.constFind(str);
+	if (it!=indices.constEnd())
+		return it.value();
+	const quint32 index = strings.size();
+	strings.append(str);
+	indices.insert(str, index);
+	return index;
+}
+
+void StelPluginCatalog::compileValue(StelJsonReader& reader, StelJsonReader::TokenType token, QHash<QString, quint32>& indices)
+{
+	switch (token)
+	{
+		case StelJsonReader::Value:
+			switch (reader.valueType())
+			{
+				case QVariant::Bool:
+					appendRaw<quint8>(records, reader.boolValue() ? TrueValue : FalseValue);
+					break;
+				case QVariant::Double:
+					appendRaw<quint8>(records, DoubleValue);
+					appendRaw<double>(records, reader.numberValue());
+					break;
+				case QVariant::String:
+					appendRaw<quint8>(records, StringValue);
+					appendRaw<quint32>(records, addString(reader.stringValue(), indices));
+					break;
+				default:
+					appendRaw<quint8>(records, NullValue);
+			}
+			break;
+		case StelJsonReader::StartObject:
+		case StelJsonReader::StartArray:
+		{
+			appendRaw<quint8>(records, token==StelJsonReader::StartObject ? MapValue : ListValue);
+			// The number of elements is only known at the end
+			const int countPos = records.size();
+			appendRaw<quint32>(records, 0);
+			quint32 count = 0;
+			if (token==StelJsonReader::StartObject)
+			{
+				while (reader.readNext()==StelJsonReader::Key)
+				{
+					appendRaw<quint32>(records, addString(reader.key(), indices));
+					compileValue(reader, reader.readNext(), indices);
+					++count;
+				}
+			}
+			else
+			{
+				for (StelJsonReader::TokenType t=reader.readNext(); t!=StelJsonReader::EndArray; t=reader.readNext())
+				{
+					compileValue(reader, t, indices);
+					++count;
+				}
+			}
+			std::memcpy(records.data()+countPos, &count, sizeof(count));
+			break;
+		}
+		default:
+			throw std::runtime_error("expected a value");
+	}
+}
+
+QVariant StelPluginCatalog::readValue(const char*& data) const
+{
+	switch (readRaw<quint8>(data))
+	{
+		case FalseValue:
+			return false;
+		case TrueValue:
+			return true;
+		case DoubleValue:
+			return readRaw<double>(data);
+		case StringValue:
+			// The strings of the pool are shared, not copied
+			return strings.at(readRaw<quint32>(data));
+		case ListValue:
+		{
+			const quint32 count = readRaw<quint32>(data);
+			QVariantList list;
+			list.reserve(count);
+			for (quint32 i=0; i<count; ++i)
+				list.append(readValue(data));
+			return list;
+		}
+		case MapValue:
+		{
+			const quint32 count = readRaw<quint32>(data);
+			QVariantMap map;
+			for (quint32 i=0; i<count; ++i)
+			{
+				const QString& name = strings.at(readRaw<quint32>(data));
+				map.insert(name, readValue(data));
+			}
+			return map;
+		}
+		default:
+			return QVariant();
+	}
+}
+
+QVariantMap StelPluginCatalog::getEntry(int i) const
+{
+	const char* data = records.constData() + entries.at(i).offset;
+	return readValue(data).toMap();
+}
+
+QVariant StelPluginCatalog::toVariant() const
+{
+	QVariantMap map;
+	map.insert("header", header);
+	map.insert("strings", strings);
+	map.insert("entries", QByteArray(reinterpret_cast<const char*>(entries.constData()), entries.size()*sizeof(Entry)));
+	map.insert("records", records);
+	return map;
+}
+
+bool StelPluginCatalog::fromVariant(const QVariantMap& map)
+{
+	header = map.value("header").toMap();
+	strings = map.value("strings").toStringList();
+	records = map.value("records").toByteArray();
+	const QByteArray entriesData = map.value("entries").toByteArray();
+	if (entriesData.size()%sizeof(Entry)!=0)
+		return false;
+	entries.resize(entriesData.size()/sizeof(Entry));
+	std::memcpy(entries.data(), entriesData.constData(), entriesData.size());
+	foreach (const Entry& entry, entries)
+	{
+		if (entry.name>=static_cast<quint32>(strings.size()) || entry.offset>=static_cast<quint32>(records.size()))
+			return false;
+	}
+	return true;
+}
+
+QVariantMap StelPluginCatalog::readHeader(const QString& jsonPath, const QStringList& keys)
+{
+	QVariantMap values;
+	QFile file(jsonPath);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Cannot open catalog" << QDir::toNativeSeparators(jsonPath);
+		return values;
+	}
+
+	try
+	{
+		StelJsonReader reader(&file);
+		if (reader.readNext()!=StelJsonReader::StartObject)
+			return values;
+		while (values.size()<keys.size() && reader.readNext()==StelJsonReader::Key)
+		{
+			if (keys.contains(reader.key()))
+				values.insert(reader.key(), reader.readValue());
+			else
+				reader.skipValue();
+		}
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Invalid catalog" << QDir::toNativeSeparators(jsonPath) << "-" << e.what();
+	}
+	return values;
+}
@@ -0,0 +1,97 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELPLUGINCATALOG_HPP_
+#define _STELPLUGINCATALOG_HPP_
+
+#include "StelJsonParser.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+//! @class StelPluginCatalog
+//! The JSON catalog of a plugin (pulsars, quasars, exoplanets...), compiled for fast loading.
+//! Such a catalog is an object with a few header members (version, shortName...) and
+//! one member holding the entries by name, e.g.:
+//! @code
+//! { "version": "2", "shortName": "...", "pulsars": { "PSR J0002+6216": {...}, ... } }
+//! @endcode
+//! The JSON file is compiled into one flat binary record per entry, with all the strings
+//! (member names and string values) stored once in a pool. The compiled catalog is saved
+//! in the StelBinaryCache, and loaded from there until the JSON file changes, so that the
+//! JSON is only parsed after an update of the catalog. Even then, it is compiled directly
+//! from the tokens of a StelJsonReader, and never kept in memory as QVariants.
+class StelPluginCatalog
+{
+public:
+	//! @param jsonPath path of the JSON catalog.
+	//! @param entriesKey name of the member of the top-level object holding the entries, e.g. "pulsars".
+	StelPluginCatalog(const QString& jsonPath, const QString& entriesKey);
+
+	//! Load the catalog, compiling the JSON file if it changed since it was last compiled.
+	//! The compiled catalog is written to the cache as a side effect, so validating a JSON
+	//! file with load() also makes the next load of the same catalog read the cache.
+	//! @return false if the JSON file cannot be read or is not valid.
+	bool load();
+
+	//! The members of the top-level object other than the entries.
+	const QVariantMap& getHeader() const {return header;}
+	//! The number of entries.
+	int size() const {return entries.size();}
+	//! The name of entry i, i.e. its key in the JSON file. The entries are sorted by name.
+	QString getName(int i) const {return strings.at(entries.at(i).name);}
+	//! Rebuild the data of entry i, as it would be read from the JSON file.
+	QVariantMap getEntry(int i) const;
+
+	//! Read some members of the top-level object of a JSON catalog, e.g. its version.
+	//! The other members are skipped without being parsed, and the reading stops as soon as all the keys were found.
+	//! @return the values of the keys which were found.
+	static QVariantMap readHeader(const QString& jsonPath, const QStringList& keys);
+
+private:
+	struct Entry
+	{
+		quint32 name;	// index in strings
+		quint32 offset;	// position of the record in records
+	};
+
+	void clear();
+	//! Parse the JSON file into the records.
+	bool compile();
+	quint32 addString(const QString& str, QHash<QString, quint32>& indices);
+	void compileValue(StelJsonReader& reader, StelJsonReader::TokenType token, QHash<QString, quint32>& indices);
+	QVariant readValue(const char*& data) const;
+
+	//! The compiled catalog, as stored in the cache.
+	QVariant toVariant() const;
+	bool fromVariant(const QVariantMap& map);
+
+	QString jsonPath;
+	QString entriesKey;
+	QVariantMap header;
+	//! The pool of all the strings of the entries
+	QStringList strings;
+	QVector<Entry> entries;
+	QByteArray records;
+};
+
+#endif // _STELPLUGINCATALOG_HPP_
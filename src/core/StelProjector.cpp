@@ -24,6 +24,7 @@
 #include "StelProjectorClasses.hpp"
 
 #include <QDebug>
+#include <QMutexLocker>
 #include <QString>
 
 StelProjector::Mat4dTransform::Mat4dTransform(const Mat4d& m)
@@ -198,6 +199,19 @@ int StelProjector::getViewportHeight() const
  current frame
 *************************************************************************/
 SphericalRegionP StelProjector::getViewportConvexPolygon(float marginX, float marginY) const
+{
+	// Projectors are shared by all the modules drawing in the same frame, so most calls ask for the same polygon
+	QMutexLocker locker(&viewportPolygonMutex);
+	if (viewportPolygon.isNull() || marginX!=viewportPolygonMarginX || marginY!=viewportPolygonMarginY)
+	{
+		viewportPolygon = computeViewportConvexPolygon(marginX, marginY);
+		viewportPolygonMarginX = marginX;
+		viewportPolygonMarginY = marginY;
+	}
+	return viewportPolygon;
+}
+
+SphericalRegionP StelProjector::computeViewportConvexPolygon(float marginX, float marginY) const
 {
 	Vec3d e0, e1, e2, e3;
 	const Vec4i& vp = viewportXywh;
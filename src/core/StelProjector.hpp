@@ -25,6 +25,8 @@
 #include "VecMath.hpp"
 #include "StelSphereGeometry.hpp"
 
+#include <QMutex>
+
 //! @class StelProjector
 //! Provide the main interface to all operations of projecting coordinates from sky to screen.
 //! The StelProjector also defines the viewport size and position.
@@ -39,6 +41,7 @@ class StelProjector
 public:
 	friend class StelPainter;
 	friend class StelCore;
+	friend class StelProjectorCache;
 
 	class ModelViewTranform;
 	//! @typedef ModelViewTranformP
@@ -109,6 +112,16 @@ public:
 			, devicePixelsPerPixel(1.f)
 			, widthStretch(1.f) {;}
 
+		bool operator==(const StelProjectorParams& p) const
+		{
+			return viewportXywh==p.viewportXywh && fov==p.fov && gravityLabels==p.gravityLabels
+				&& defaultAngleForGravityText==p.defaultAngleForGravityText && maskType==p.maskType
+				&& zNear==p.zNear && zFar==p.zFar && viewportCenter==p.viewportCenter
+				&& viewportCenterOffset==p.viewportCenterOffset && viewportFovDiameter==p.viewportFovDiameter
+				&& flipHorz==p.flipHorz && flipVert==p.flipVert && devicePixelsPerPixel==p.devicePixelsPerPixel
+				&& widthStretch==p.widthStretch;
+		}
+
 		Vector4<int> viewportXywh;       //! posX, posY, width, height
 		float fov;                       //! FOV in degrees
 		bool gravityLabels;              //! the flag to use gravity labels or not
@@ -189,6 +202,7 @@ public:
 	//! @param marginY an extra margin in pixel which extends the polygon size in the Y direction.
 	//! @return a SphericalConvexPolygon or the special fullSky region if the viewport cannot be
 	//! represented by a convex polygon (e.g. if aperture > 180 deg).
+	//! The polygon is computed once for the last margins asked, so the returned region must not be modified.
 	SphericalRegionP getViewportConvexPolygon(float marginX=0., float marginY=0.) const;
 
 	//! Return a SphericalCap containing the whole viewport
@@ -299,7 +313,9 @@ protected:
 		  gravityLabels(true),
 		  defaultAngleForGravityText(0.f),
 		  devicePixelsPerPixel(1.f),
-		  widthStretch(1.0f) {;}
+		  widthStretch(1.0f),
+		  viewportPolygonMarginX(0.f),
+		  viewportPolygonMarginY(0.f) {;}
 
 	//! Return whether the projection presents discontinuities. Used for optimization.
 	virtual bool hasDiscontinuity() const =0;
@@ -333,6 +349,13 @@ protected:
 private:
 	//! Initialise the StelProjector from a param instance.
 	void init(const StelProjectorParams& param);
+
+	SphericalRegionP computeViewportConvexPolygon(float marginX, float marginY) const;
+
+	// Last result of getViewportConvexPolygon()
+	mutable QMutex viewportPolygonMutex;
+	mutable SphericalRegionP viewportPolygon;
+	mutable float viewportPolygonMarginX, viewportPolygonMarginY;
 };
 
 #endif // _STELPROJECTOR_HPP_
@@ -0,0 +1,80 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelProjectorCache.hpp"
+
+#include <QMutexLocker>
+
+StelProjectorCache::StelProjectorCache(int size)
+	: entries(size)
+	, hitCount(0)
+	, allocationCount(0)
+{
+}
+
+StelProjectorP StelProjectorCache::find(int key, int projectionType, const StelProjector::StelProjectorParams& params) const
+{
+	Q_ASSERT(key>=0 && key<entries.size());
+	QMutexLocker locker(&mutex);
+	const Entry& entry = entries.at(key);
+	if (entry.prj.isNull() || entry.projectionType!=projectionType || !(entry.params==params))
+		return StelProjectorP();
+	++hitCount;
+	return entry.prj;
+}
+
+StelProjectorP StelProjectorCache::insert(int key, int projectionType, const StelProjector::StelProjectorParams& params, StelProjector* prj)
+{
+	Q_ASSERT(key>=0 && key<entries.size());
+	StelProjectorP p(prj);
+	p->init(params);
+
+	QMutexLocker locker(&mutex);
+	Entry& entry = entries[key];
+	entry.prj = p;
+	entry.projectionType = projectionType;
+	entry.params = params;
+	++allocationCount;
+	return p;
+}
+
+void StelProjectorCache::clear()
+{
+	QMutexLocker locker(&mutex);
+	for (int i=0; i<entries.size(); ++i)
+		entries[i].prj.clear();
+}
+
+int StelProjectorCache::getHitCount() const
+{
+	QMutexLocker locker(&mutex);
+	return hitCount;
+}
+
+int StelProjectorCache::getAllocationCount() const
+{
+	QMutexLocker locker(&mutex);
+	return allocationCount;
+}
+
+void StelProjectorCache::resetCounters()
+{
+	QMutexLocker locker(&mutex);
+	hitCount = 0;
+	allocationCount = 0;
+}
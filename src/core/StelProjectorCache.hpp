@@ -0,0 +1,78 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELPROJECTORCACHE_HPP_
+#define _STELPROJECTORCACHE_HPP_
+
+#include "StelProjector.hpp"
+
+#include <QMutex>
+#include <QVector>
+
+//! @class StelProjectorCache
+//! Keeps the projectors created by StelCore for the standard frames, so that
+//! the many calls to StelCore::getProjection() done during a frame share the
+//! same instance instead of allocating and initializing a new one each time.
+//!
+//! A projector is stored under an integer key chosen by the caller (StelCore
+//! uses the frame and the refraction mode) together with the projection type
+//! and the projector parameters it was initialized with. It is only returned
+//! while they are unchanged. The model view transform is not checked, so the
+//! cache must be cleared when the transformation matrices change.
+//!
+//! All methods are thread safe.
+class StelProjectorCache
+{
+public:
+	//! @param size the number of keys, which go from 0 to size-1
+	StelProjectorCache(int size);
+
+	//! Get the projector stored for key.
+	//! @return Q_NULLPTR if there is none or if it was made for another projection type or other parameters.
+	StelProjectorP find(int key, int projectionType, const StelProjector::StelProjectorParams& params) const;
+
+	//! Initialize prj with params and store it for key.
+	//! @param prj a new projector, not yet initialized. The cache takes its ownership.
+	//! @return the initialized projector
+	StelProjectorP insert(int key, int projectionType, const StelProjector::StelProjectorParams& params, StelProjector* prj);
+
+	//! Forget all projectors.
+	void clear();
+
+	//! Number of projectors returned by find() since the last resetCounters().
+	int getHitCount() const;
+	//! Number of projectors stored by insert() since the last resetCounters().
+	int getAllocationCount() const;
+	void resetCounters();
+
+private:
+	struct Entry
+	{
+		Entry() : projectionType(-1) {}
+		StelProjectorP prj;
+		int projectionType;
+		StelProjector::StelProjectorParams params;
+	};
+
+	QVector<Entry> entries;
+	mutable QMutex mutex;
+	mutable int hitCount;
+	int allocationCount;
+};
+
+#endif // _STELPROJECTORCACHE_HPP_
@@ -427,56 +427,7 @@ void StelSkyImageTile::loadFromQVariantMap(const QVariantMap& map)
 	}
 
 	// Load the convex polygons (if any)
-	QVariantList polyList = map.value("skyConvexPolygons").toList();
-	if (polyList.empty())
-		polyList = map.value("worldCoords").toList();
-	else
-		qWarning() << "skyConvexPolygons in preview JSON files is deprecated. Replace with worldCoords.";
-
-	// Load the matching textures positions (if any)
-	QVariantList texCoordList = map.value("textureCoords").toList();
-	if (!texCoordList.isEmpty() && polyList.size()!=texCoordList.size())
-			throw std::runtime_error("the number of convex polygons does not match the number of texture space polygon");
-
-	for (int i=0;i<polyList.size();++i)
-	{
-		const QVariant& polyRaDec = polyList.at(i);
-		QVector<Vec3d> vertices;
-		foreach (const QVariant& vRaDec, polyRaDec.toList())
-		{
-			const QVariantList vl = vRaDec.toList();
-			Vec3d v;
-			StelUtils::spheToRect(vl.at(0).toFloat(&ok)*M_PI/180.f, vl.at(1).toFloat(&ok)*M_PI/180.f, v);
-			if (!ok)
-				throw std::runtime_error("wrong Ra and Dec, expect a double value");
-			vertices.append(v);
-		}
-		Q_ASSERT(vertices.size()==4);
-
-		if (!texCoordList.isEmpty())
-		{
-			const QVariant& polyXY = texCoordList.at(i);
-			QVector<Vec2f> texCoords;
-			foreach (const QVariant& vXY, polyXY.toList())
-			{
-				const QVariantList vl = vXY.toList();
-				texCoords.append(Vec2f(vl.at(0).toFloat(&ok), vl.at(1).toFloat(&ok)));
-				if (!ok)
-					throw std::runtime_error("wrong X and Y, expect a double value");
-			}
-			Q_ASSERT(texCoords.size()==4);
-
-			SphericalTexturedConvexPolygon* pol = new SphericalTexturedConvexPolygon(vertices, texCoords);
-			Q_ASSERT(pol->checkValid());
-			skyConvexPolygons.append(SphericalRegionP(pol));
-		}
-		else
-		{
-			SphericalConvexPolygon* pol = new SphericalConvexPolygon(vertices);
-			Q_ASSERT(pol->checkValid());
-			skyConvexPolygons.append(SphericalRegionP(pol));
-		}
-	}
+	skyConvexPolygons = loadWorldRegions(map);
 
 	if (map.contains("imageUrl"))
 	{
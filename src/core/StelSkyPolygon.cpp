@@ -200,21 +200,10 @@ void StelSkyPolygon::loadFromQVariantMap(const QVariantMap& map)
 		throw std::runtime_error(qPrintable(QString("minResolution expect a double value, found: %1").arg(map.value("minResolution").toString())));
 
 	// Load the convex polygons (if any)
-	QVariantList polyList = map.value("worldCoords").toList();
-	foreach (const QVariant& polyRaDec, polyList)
+	foreach (const SphericalRegionP& reg, loadWorldRegions(map))
 	{
-		QList<Vec3d> vertices;
-		foreach (QVariant vRaDec, polyRaDec.toList())
-		{
-			const QVariantList vl = vRaDec.toList();
-			Vec3d v;
-			StelUtils::spheToRect(vl.at(0).toFloat(&ok)*M_PI/180.f, vl.at(1).toFloat(&ok)*M_PI/180.f, v);
-			if (!ok)
-				throw std::runtime_error("wrong Ra and Dec, expect a double value");
-			vertices.append(v);
-		}
-		Q_ASSERT(vertices.size()==4);
-		skyConvexPolygons.append(SphericalConvexPolygon(vertices[0], vertices[1], vertices[2], vertices[3]));
+		Q_ASSERT(reg->getType()==SphericalRegion::ConvexPolygon);
+		skyConvexPolygons.append(*static_cast<const SphericalConvexPolygon*>(reg.data()));
 	}
 
 	// This is a list of URLs to the child tiles or a list of already loaded map containing child information
@@ -0,0 +1,100 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELSNAPSHOTBUFFER_HPP_
+#define _STELSNAPSHOTBUFFER_HPP_
+
+#include <QAtomicInt>
+
+//! @class StelSnapshotBuffer
+//! Passes copies of a value from one writer thread to any number of reader threads, without locking.
+//!
+//! The writer copies the value into one of three slots which is neither published nor being read, and then
+//! publishes the slot. A reader marks the published slot as being read, checks that it is still the published
+//! one (else it tries again), copies the value and unmarks the slot.
+//! The writer never waits: if the two other slots are still being read, publish() fails and the readers
+//! keep getting the previous value.
+//! T must be copyable; implicitly shared Qt types are fine, as their reference counts are atomic.
+template <class T> class StelSnapshotBuffer
+{
+public:
+	StelSnapshotBuffer() : published(-1) {}
+
+	//! Publish a copy of value. Must always be called by the same thread.
+	//! @return false if all the slots were being read, in which case the previous value stays published.
+	bool publish(const T& value)
+	{
+		const int current = published.loadAcquire();
+		for (int i = 0; i < slotCount; ++i)
+		{
+			if (i == current)
+				continue;
+			// A full barrier: a reader which marks the slot after this also sees that it is not published
+			if (slots[i].readers.fetchAndAddOrdered(0) != 0)
+				continue;
+			slots[i].value = value;
+			published.fetchAndStoreOrdered(i);
+			return true;
+		}
+		return false;
+	}
+
+	//! Stop publishing: read() fails until the next publish(). Must be called by the writer thread.
+	void clear()
+	{
+		published.fetchAndStoreOrdered(-1);
+	}
+
+	//! Copy the last published value into value. Can be called by any thread.
+	//! @return false if nothing is published.
+	bool read(T& value) const
+	{
+		for (;;)
+		{
+			const int i = published.loadAcquire();
+			if (i < 0)
+				return false;
+			slots[i].readers.ref();
+			// The slot can't be written anymore if it is still the published one
+			if (published.fetchAndAddOrdered(0) == i)
+			{
+				value = slots[i].value;
+				slots[i].readers.deref();
+				return true;
+			}
+			slots[i].readers.deref();
+		}
+	}
+
+private:
+	Q_DISABLE_COPY(StelSnapshotBuffer)
+
+	static const int slotCount = 3;
+	struct Slot
+	{
+		Slot() : readers(0) {}
+		T value;
+		//! The number of readers copying the value
+		mutable QAtomicInt readers;
+	};
+	Slot slots[slotCount];
+	//! Index of the published slot, -1 if none
+	mutable QAtomicInt published;
+};
+
+#endif // _STELSNAPSHOTBUFFER_HPP_
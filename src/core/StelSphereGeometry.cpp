@@ -36,7 +36,11 @@ int SphericalRegionP::initialize()
 
 QDataStream& operator<<(QDataStream& out, const SphericalRegionP& region)
 {
-	out << (quint8)region->getType();
+	// Textured polygons behave as convex polygons but must keep their texture coordinates
+	if (dynamic_cast<const SphericalTexturedConvexPolygon*>(region.data())!=Q_NULLPTR)
+		out << (quint8)SphericalRegion::TexturedConvexPolygon;
+	else
+		out << (quint8)region->getType();
 	region->serialize(out);
 	return out;
 }
@@ -59,6 +63,9 @@ QDataStream& operator>>(QDataStream& in, SphericalRegionP& region)
 		case SphericalRegion::ConvexPolygon:
 			region = SphericalConvexPolygon::deserialize(in);
 			return in;
+		case SphericalRegion::TexturedConvexPolygon:
+			region = SphericalTexturedConvexPolygon::deserialize(in);
+			return in;
 		case SphericalRegion::Polygon:
 			region = SphericalPolygon::deserialize(in);
 			return in;
@@ -994,6 +1001,74 @@ bool SphericalConvexPolygon::intersects(const SphericalPolygon& poly) const
 	return false;
 }
 
+void SphericalConvexPolygon::clipConvexContour(const QVector<Vec3d>& in, const Vec3d& n, QVector<Vec3d>& out)
+{
+	// Tolerance on the distance to the great circle
+	static const double eps = 1e-15;
+	out.clear();
+	if (in.isEmpty())
+		return;
+	Vec3d previous = in.last();
+	double dPrevious = n*previous;
+	foreach (const Vec3d& v, in)
+	{
+		const double d = n*v;
+		if ((dPrevious>eps && d<-eps) || (dPrevious<-eps && d>eps))
+		{
+			// The edge crosses the great circle: add the point where n*p=0, which is a positive
+			// combination of the 2 vertices so it lays on the edge and not on the opposite side.
+			Vec3d p = (v*dPrevious - previous*d)*(1./(dPrevious-d));
+			p.normalize();
+			out << p;
+		}
+		if (d>=-eps)
+			out << v;
+		previous = v;
+		dPrevious = d;
+	}
+}
+
+SphericalRegionP SphericalConvexPolygon::getIntersection(const SphericalConvexPolygon& r) const
+{
+	if (!cachedBoundingCap.intersects(r.cachedBoundingCap))
+		return EmptySphericalRegion::staticInstance;
+
+	// Clip this contour successively by each side of r
+	QVector<Vec3d> res = contour;
+	QVector<Vec3d> tmp;
+	const QVector<Vec3d>& rContour = r.contour;
+	for (int i=0;i<rContour.size() && res.size()>=3;++i)
+	{
+		Vec3d n = rContour.at((i+1)%rContour.size())^rContour.at(i);
+		const double l = n.length();
+		if (l<1e-15)
+			continue;	// Two identical vertices don't define a side
+		n*=1./l;
+		clipConvexContour(res, n, tmp);
+		res.swap(tmp);
+	}
+
+	// Remove the duplicated vertices
+	tmp.clear();
+	foreach (const Vec3d& v, res)
+	{
+		if (tmp.isEmpty() || (v-tmp.last()).lengthSquared()>1e-24)
+			tmp << v;
+	}
+	if (tmp.size()>1 && (tmp.first()-tmp.last()).lengthSquared()<=1e-24)
+		tmp.removeLast();
+	if (tmp.size()<3)
+		return EmptySphericalRegion::staticInstance;
+
+	// The polygons may only share a side or a vertex, check that the result is not flat
+	double volume = 0.;
+	for (int i=1;i<tmp.size()-1;++i)
+		volume += (tmp.at(i)^tmp.at(i+1))*tmp.at(0);
+	if (std::fabs(volume)<1e-18)
+		return EmptySphericalRegion::staticInstance;
+	return SphericalRegionP(new SphericalConvexPolygon(tmp));
+}
+
 // This algo is wrong
 void SphericalConvexPolygon::updateBoundingCap()
 {
@@ -1043,6 +1118,14 @@ SphericalRegionP SphericalConvexPolygon::deserialize(QDataStream& in)
 ///////////////////////////////////////////////////////////////////////////////
 // Methods for SphericalTexturedConvexPolygon
 ///////////////////////////////////////////////////////////////////////////////
+SphericalRegionP SphericalTexturedConvexPolygon::deserialize(QDataStream& in)
+{
+	QVector<Vec3d> contour;
+	QVector<Vec2f> texCoords;
+	in >> contour >> texCoords;
+	return SphericalRegionP(new SphericalTexturedConvexPolygon(contour, texCoords));
+}
+
 QVariantList SphericalTexturedConvexPolygon::toQVariant() const
 {
 	QVariantList res = SphericalConvexPolygon::toQVariant();
@@ -142,7 +142,8 @@ public:
 		Polygon = 3,
 		ConvexPolygon = 4,
 		Empty = 5,
-		Invalid = 6
+		Invalid = 6,
+		TexturedConvexPolygon = 7	//!< Only used in the binary format, getType() returns ConvexPolygon for textured polygons.
 	};
 
 	virtual ~SphericalRegion() {;}
@@ -624,12 +625,14 @@ private:
 
 //! @class SphericalConvexPolygon
 //! A special case of SphericalPolygon for which the polygon is convex.
+//! The intersection of two convex polygons is computed directly by clipping, without going through the OctahedronPolygon.
 class SphericalConvexPolygon : public SphericalRegion
 {
 public:
 	// Avoid name hiding when overloading the virtual methods.
 	using SphericalRegion::intersects;
 	using SphericalRegion::contains;
+	using SphericalRegion::getIntersection;
 
 	//! Default constructor.
 	SphericalConvexPolygon() {;}
@@ -672,9 +675,11 @@ public:
 	virtual bool intersects(const SphericalPoint& r) const {return contains(r.n);}
 	virtual bool intersects(const AllSkySphericalRegion&) const {return true;}
 
+	//! Clip this polygon by the sides of r. The result is a SphericalConvexPolygon, or an empty region.
+	virtual SphericalRegionP getIntersection(const SphericalConvexPolygon& r) const;
+
 	////////////////////////// TODO
 //	virtual SphericalRegionP getIntersection(const SphericalPolygon& r) const;
-//	virtual SphericalRegionP getIntersection(const SphericalConvexPolygon& r) const;
 //	virtual SphericalRegionP getIntersection(const SphericalCap& r) const;
 //	virtual SphericalRegionP getIntersection(const SphericalPoint& r) const;
 //	virtual SphericalRegionP getIntersection(const AllSkySphericalRegion& r) const;
@@ -732,6 +737,12 @@ protected:
 	}
 
 	bool containsConvexContour(const Vec3d* vertice, int nbVertex) const;
+
+	//! Clip a convex contour by the half space n*v>=0.
+	//! Vertices closer than a small tolerance to the great circle are considered inside, so that shared
+	//! edges and vertices don't create new vertices or degenerated edges.
+	//! @param n the normalized direction of the half space.
+	static void clipConvexContour(const QVector<Vec3d>& in, const Vec3d& n, QVector<Vec3d>& out);
 };
 
 
@@ -882,6 +893,9 @@ public:
 
 	virtual void serialize(QDataStream& out) const {out << contour << textureCoords;}
 
+	//! Deserialize the region. This method must allow as fast as possible deserialization.
+	static SphericalRegionP deserialize(QDataStream& in);
+
 protected:
 	//! A list of uv textures coordinates corresponding to the triangle vertices.
 	//! There should be 1 uv position per vertex.
@@ -0,0 +1,157 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelStatePublisher.hpp"
+#include "StelActionMgr.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelLocaleMgr.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelPropertyMgr.hpp"
+
+#include <QThread>
+
+const double StelStatePublisher::selectionInfoInterval = 0.5;
+
+StelStatePublisher::StelStatePublisher(QObject* parent)
+	: QObject(parent)
+	, userCount(0)
+	, selectionInfoAge(0.)
+	, selectionDirty(true)
+{
+}
+
+void StelStatePublisher::addUser()
+{
+	Q_ASSERT(QThread::currentThread() == thread());
+	if (userCount++ > 0)
+		return;
+
+	StelApp& app = StelApp::getInstance();
+	StelActionMgr* actionMgr = app.getStelActionManager();
+	StelPropertyMgr* propMgr = app.getStelPropertyManager();
+
+	// The actions and properties are followed by their signals rather than read each frame
+	state.actions.clear();
+	foreach (StelAction* action, actionMgr->getActionList())
+	{
+		if (action->isCheckable())
+			state.actions.insert(action->getId(), action->isChecked());
+	}
+	state.properties.clear();
+	const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
+	for (StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it)
+		state.properties.insert(it.key(), (*it)->getValue());
+
+	connect(actionMgr, SIGNAL(actionToggled(QString,bool)), this, SLOT(actionToggled(QString,bool)));
+	connect(propMgr, SIGNAL(stelPropertyChanged(StelProperty*,QVariant)), this, SLOT(propertyChanged(StelProperty*,QVariant)));
+	connect(&app.getStelObjectMgr(), SIGNAL(selectedObjectChanged(StelModule::StelModuleSelectAction)), this, SLOT(selectionChanged(StelModule::StelModuleSelectAction)));
+
+	selectionDirty = true;
+	update(0.);
+}
+
+void StelStatePublisher::removeUser()
+{
+	Q_ASSERT(QThread::currentThread() == thread());
+	Q_ASSERT(userCount > 0);
+	if (--userCount > 0)
+		return;
+
+	StelApp& app = StelApp::getInstance();
+	disconnect(app.getStelActionManager(), Q_NULLPTR, this, Q_NULLPTR);
+	disconnect(app.getStelPropertyManager(), Q_NULLPTR, this, Q_NULLPTR);
+	disconnect(&app.getStelObjectMgr(), Q_NULLPTR, this, Q_NULLPTR);
+
+	buffer.clear();
+	state.actions.clear();
+	state.properties.clear();
+}
+
+void StelStatePublisher::update(double deltaTime)
+{
+	if (userCount == 0)
+		return;
+
+	fill();
+	selectionInfoAge += deltaTime;
+	if (selectionDirty || selectionInfoAge >= selectionInfoInterval)
+		updateSelection();
+
+	++state.frame;
+	if (!buffer.publish(state))
+	{
+		// All the other slots are being read, the readers keep the previous snapshot for one more frame
+		--state.frame;
+	}
+}
+
+void StelStatePublisher::fill()
+{
+	StelApp& app = StelApp::getInstance();
+	const StelCore* core = app.getCore();
+	const StelMovementMgr* mvmgr = core->getMovementMgr();
+
+	state.jd = core->getJD();
+	state.deltaT = core->getDeltaT() * StelCore::JD_SECOND;
+	state.utcOffset = core->getUTCOffset(state.jd);
+	state.timeZone = app.getLocaleMgr().getPrintableTimeZoneLocal(state.jd);
+	state.timeRate = core->getTimeRate();
+	state.isTimeNow = core->getIsTimeNow();
+
+	state.location = core->getCurrentLocation();
+
+	state.viewDirectionJ2000 = mvmgr->getViewDirectionJ2000();
+	// the aim fov may lie outside the min/max bounds, so constrain it
+	state.fov = qBound(mvmgr->getMinFov(), mvmgr->getAimFov(), mvmgr->getMaxFov());
+}
+
+void StelStatePublisher::updateSelection()
+{
+	const QList<StelObjectP>& selection = StelApp::getInstance().getStelObjectMgr().getSelectedObject();
+	if (selection.isEmpty())
+	{
+		state.selectedObject.clear();
+		state.selectionInfo.clear();
+	}
+	else
+	{
+		const StelObjectP& object = selection.first();
+		state.selectedObject = object->getEnglishName();
+		state.selectionInfo = object->getInfoString(StelApp::getInstance().getCore(), StelObject::AllInfo | StelObject::NoFont);
+	}
+	selectionInfoAge = 0.;
+	selectionDirty = false;
+}
+
+void StelStatePublisher::actionToggled(const QString& id, bool val)
+{
+	state.actions.insert(id, val);
+}
+
+void StelStatePublisher::propertyChanged(StelProperty* prop, const QVariant& val)
+{
+	state.properties.insert(prop->getId(), val);
+}
+
+void StelStatePublisher::selectionChanged(StelModule::StelModuleSelectAction action)
+{
+	Q_UNUSED(action);
+	selectionDirty = true;
+}
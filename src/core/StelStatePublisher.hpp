@@ -0,0 +1,120 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELSTATEPUBLISHER_HPP_
+#define _STELSTATEPUBLISHER_HPP_
+
+#include "StelLocation.hpp"
+#include "StelModule.hpp"
+#include "StelSnapshotBuffer.hpp"
+#include "VecMath.hpp"
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+class StelProperty;
+
+//! @struct StelStateSnapshot
+//! A copy of the commonly queried state of the program, as it was at the end of StelApp::update().
+struct StelStateSnapshot
+{
+	StelStateSnapshot() : frame(0), jd(0.), deltaT(0.), utcOffset(0.), timeRate(0.), isTimeNow(false), fov(0.) {}
+
+	//! Number of the published snapshot, starting at 1
+	quint64 frame;
+
+	//! Julian day (UT)
+	double jd;
+	//! Delta T [seconds]
+	double deltaT;
+	//! Offset of the local time from UTC [hours]
+	double utcOffset;
+	//! Printable time zone of the local time
+	QString timeZone;
+	double timeRate;
+	bool isTimeNow;
+
+	StelLocation location;
+
+	Vec3d viewDirectionJ2000;
+	//! The aim field of view, constrained to the allowed range [degrees]
+	double fov;
+
+	//! English name of the first selected object, empty if nothing is selected
+	QString selectedObject;
+	//! Info string of the first selected object, built with StelObject::AllInfo | StelObject::NoFont
+	QString selectionInfo;
+
+	//! The states of the checkable StelActions, by ID
+	QMap<QString, bool> actions;
+	//! The values of the StelProperties, by ID
+	QVariantMap properties;
+};
+
+//! @class StelStatePublisher
+//! Publishes a StelStateSnapshot at the end of each StelApp::update(), so that other threads (e.g. the
+//! HTTP threads of the RemoteControl plugin) can read the program state without waiting for the main thread.
+//! The snapshots are passed through a StelSnapshotBuffer: neither the main thread nor the readers ever block.
+//!
+//! Nothing is done as long as nobody uses the snapshots, see addUser(). The info string of the selection,
+//! which is expensive to build, is only updated when the selection changes and twice per second.
+class StelStatePublisher : public QObject
+{
+	Q_OBJECT
+
+public:
+	StelStatePublisher(QObject* parent = Q_NULLPTR);
+
+	//! Start publishing the snapshots. Each call must be matched by a call of removeUser().
+	//! A first snapshot is published at once, so that getSnapshot() succeeds from then on.
+	//! Must be called in the main thread, after the modules are initialized.
+	void addUser();
+	//! Stop publishing the snapshots when the last user is removed. Must be called in the main thread.
+	void removeUser();
+
+	//! Called by StelApp at the end of each update.
+	void update(double deltaTime);
+
+	//! Copy the last published snapshot into snapshot. Can be called from any thread.
+	//! @return false if no snapshot is published, i.e. there is no user.
+	bool getSnapshot(StelStateSnapshot& snapshot) const { return buffer.read(snapshot); }
+
+private slots:
+	void actionToggled(const QString& id, bool val);
+	void propertyChanged(StelProperty* prop, const QVariant& val);
+	void selectionChanged(StelModule::StelModuleSelectAction action);
+
+private:
+	//! Fill the snapshot state which is not updated by signals
+	void fill();
+	//! Rebuild the info string of the selection
+	void updateSelection();
+
+	//! Interval between two updates of the info string of the selection [s]
+	static const double selectionInfoInterval;
+
+	int userCount;
+	StelStateSnapshot state;
+	double selectionInfoAge;
+	bool selectionDirty;
+	StelSnapshotBuffer<StelStateSnapshot> buffer;
+};
+
+#endif // _STELSTATEPUBLISHER_HPP_
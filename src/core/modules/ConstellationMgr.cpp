@@ -584,6 +584,8 @@ void ConstellationMgr::draw(StelCore* core)
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter sPainter(prj);
 	sPainter.setFont(asterFont);
+	// The lines and boundaries of all the constellations share a few colors, draw them together
+	sPainter.beginLineBatch();
 	drawLines(sPainter, core);
 	drawNames(sPainter);
 	drawArt(sPainter);
@@ -411,6 +411,8 @@ void SkyGrid::draw(const StelCore* core) const
 	StelPainter sPainter(prj);
 	sPainter.setBlending(true);
 	sPainter.setLineSmooth(true);
+	// Collect the meridians and parallels, they are drawn in one call between the labels
+	sPainter.beginLineBatch();
 
 	// make text colors just a bit brighter. (But if >1, QColor::setRgb fails and makes text invisible.)
 	Vec4f textColor(qMin(1.0f, 1.25f*color[0]), qMin(1.0f, 1.25f*color[1]), qMin(1.0f, 1.25f*color[2]), fader.getInterstate());
@@ -715,6 +717,7 @@ void SkyLine::draw(StelCore *core) const
 	sPainter.setColor(color[0], color[1], color[2], fader.getInterstate());
 	sPainter.setBlending(true);
 	sPainter.setLineSmooth(true);
+	sPainter.beginLineBatch();
 
 	Vec4f textColor(color[0], color[1], color[2], 0);		
 	textColor[3]=fader.getInterstate();
@@ -21,6 +21,7 @@
 
 #include "Landscape.hpp"
 #include "StelApp.hpp"
+#include "StelBinaryCache.hpp"
 #include "StelTextureMgr.hpp"
 #include "StelFileMgr.hpp"
 #include "StelIniParser.hpp"
@@ -162,8 +163,11 @@ void Landscape::createPolygonalHorizon(const QString& lineFileName, const float
 		qWarning() << "Landscape Horizon line data file" << QDir::toNativeSeparators(lineFileName) << "not found.";
 		return;
 	}
+	const QByteArray content = file.readAll();
+	file.close();
+
 	QRegExp emptyLine("^\\s*$");
-	QTextStream in(&file);
+	QTextStream in(content);
 	while (!in.atEnd())
 	{
 		// Build list of vertices. The checks can certainly become more robust.
@@ -221,9 +225,18 @@ void Landscape::createPolygonalHorizon(const QString& lineFileName, const float
 		else
 			horiPoints.append(point);
 	}
-	file.close();
 	//horiPoints.append(horiPoints.at(0)); // close loop? Apparently not necessary.
 
+	// Tesselating a detailed horizon takes time, reuse the polygon made the last time if the file and settings are unchanged
+	const QByteArray sourceHash = StelBinaryCache::hash(content + QString("|%1|%2|%3").arg(polyAngleRotateZ).arg(listMode).arg(polygonInverted).toUtf8());
+	QVariant cached;
+	if (StelBinaryCache::load(lineFileName, sourceHash, cached))
+	{
+		horizonPolygon = cached.value<SphericalRegionP>();
+		horizonTable.create(horiPoints, horizonPolygon);
+		return;
+	}
+
 	//qDebug() << "created horiPoints with " << horiPoints.count() << "points:";
 	//for (int i=0; i<horiPoints.count(); ++i)
 	//	qDebug() << horiPoints.at(i)[0] << "/" << horiPoints.at(i)[1] << "/" << horiPoints.at(i)[2] ;
@@ -237,6 +250,17 @@ void Landscape::createPolygonalHorizon(const QString& lineFileName, const float
 		horizonPolygon = allskyRegion2.getSubtraction(horizonPolygon);
 		//horizonPolygon=&aboveHorizonPolygon;
 	}
+	StelBinaryCache::save(lineFileName, sourceHash, QVariant::fromValue(horizonPolygon));
+	horizonTable.create(horiPoints, horizonPolygon);
+}
+
+float Landscape::getPolygonOpacity(const Vec3d& azalt) const
+{
+	Q_ASSERT(horizonPolygon);
+	const int opacity = horizonTable.lookup(azalt);
+	if (opacity>=0)
+		return (float) opacity;
+	return (horizonPolygon->contains(azalt) ? 1.0f : 0.0f);
 }
 
 #include <iostream>
@@ -375,11 +399,6 @@ LandscapeOldStyle::~LandscapeOldStyle()
 	}
 
 	if (sides) delete [] sides;
-	if (sidesImages.size()>0)
-	{
-		qDeleteAll(sidesImages);
-		sidesImages.clear();
-	}
 	landscapeLabels.clear();
 }
 
@@ -421,12 +440,12 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 		QString textureName = landscapeIni.value(textureKey).toString();
 		const QString texturePath = getTexturePath(textureName, landscapeId);
 		sideTexs[i] = StelApp::getInstance().getTextureManager().createTexture(texturePath);
-		// GZ: To query the textures, also keep an array of QImage*, but only
+		// GZ: To query the textures, also keep their alpha channels, but only
 		// if that query is not going to be prevented by the polygon that already has been loaded at that point...
 		if ( (!horizonPolygon) && calibrated ) { // for uncalibrated landscapes the texture is currently never queried, so no need to store.
-			QImage *image = new QImage(texturePath);
-			sidesImages.append(image); // indices identical to those in sideTexs
-			memorySize+=image->byteCount();
+			sidesAlpha.append(LandscapeAlphaMap()); // indices identical to those in sideTexs
+			sidesAlpha.last().create(QImage(texturePath));
+			memorySize+=sidesAlpha.last().getMemorySize();
 		}
 		// Also allow light textures. The light textures must cover the same geometry as the sides. It is allowed that not all or even any light textures are present!
 		textureKey = QString("landscape/light%1").arg(i);
@@ -443,7 +462,7 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 	}
 	if ( (!horizonPolygon) && calibrated )
 	{
-		Q_ASSERT(sidesImages.size()==nbSideTexs);
+		Q_ASSERT(sidesAlpha.size()==nbSideTexs);
 	}
 	QMap<int, int> texToSide;
 	// Init sides parameters
@@ -741,9 +760,7 @@ float LandscapeOldStyle::getOpacity(Vec3d azalt) const
 
 	// in case we also have a horizon polygon defined, this is trivial and fast.
 	if (horizonPolygon)
-	{
-		if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
-	}
+		return getPolygonOpacity(azalt);
 	// Else, sample the images...
 	float az, alt_rad;
 	StelUtils::rectToSphe(&az, &alt_rad, azalt);
@@ -774,7 +791,7 @@ float LandscapeOldStyle::getOpacity(Vec3d azalt) const
 	Q_ASSERT(currentSide>=0);
 	Q_ASSERT(currentSide<nbSideTexs);
 	int x= (sides[currentSide].texCoords[0] + x_in_panel*(sides[currentSide].texCoords[2]-sides[currentSide].texCoords[0]))
-			* sidesImages[currentSide]->width(); // pixel X from left.
+			* sidesAlpha.at(currentSide).getWidth(); // pixel X from left.
 
 	// QImage has pixel 0/0 in top left corner. We must find image Y for optionally cropped images.
 	// It should no longer be possible that sample position is outside cropped texture. in this case, assert(0) but again assume full transparency and exit early.
@@ -801,19 +818,19 @@ float LandscapeOldStyle::getOpacity(Vec3d azalt) const
 	}
 	// x0/y0 is lower left, x1/y1 upper right corner.
 	float y_baseImg_1 = sides[currentSide].texCoords[1]+ y_img_1*(sides[currentSide].texCoords[3]-sides[currentSide].texCoords[1]);
-	int y=(1.0-y_baseImg_1)*sidesImages[currentSide]->height();           // pixel Y from top.
-	QRgb pixVal=sidesImages[currentSide]->pixel(x, y);
+	int y=(1.0-y_baseImg_1)*sidesAlpha.at(currentSide).getHeight();           // pixel Y from top.
+	const float opacity=sidesAlpha.at(currentSide).getOpacity(x, y);
 /*
 #ifndef NDEBUG
 	// GZ: please leave the comment available for further development!
 	qDebug() << "Oldstyle Landscape sampling: az=" << az*180.0 << "° alt=" << alt_rad*180.0f/M_PI
 			 << "°, xShift[-1..+1]=" << xShift << " az_phot[0..1]=" << az_phot
 			 << " --> current side panel " << currentSide
-			 << ", w=" << sidesImages[currentSide]->width() << " h=" << sidesImages[currentSide]->height()
-			 << " --> x:" << x << " y:" << y << " alpha:" << qAlpha(pixVal)/255.0f;
+			 << ", w=" << sidesAlpha.at(currentSide).getWidth() << " h=" << sidesAlpha.at(currentSide).getHeight()
+			 << " --> x:" << x << " y:" << y << " alpha:" << opacity;
 #endif
 */
-	return qAlpha(pixVal)/255.0f;
+	return opacity;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -881,7 +898,7 @@ float LandscapePolygonal::getOpacity(Vec3d azalt) const
 	if (angleRotateZOffset!=0.0f)
 		azalt.transfo4d(Mat4d::zrotation(angleRotateZOffset));
 
-	if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
+	return getPolygonOpacity(azalt);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -893,14 +910,12 @@ LandscapeFisheye::LandscapeFisheye(float _radius)
 	, mapTex(StelTextureSP())
 	, mapTexFog(StelTextureSP())
 	, mapTexIllum(StelTextureSP())
-	, mapImage(Q_NULLPTR)
 	, texFov(360.)
 	, memorySize(0)
 {}
 
 LandscapeFisheye::~LandscapeFisheye()
 {
-	if (mapImage) delete mapImage;
 	landscapeLabels.clear();
 }
 
@@ -935,8 +950,8 @@ void LandscapeFisheye::create(const QString _name, float _texturefov, const QStr
 
 	if (!horizonPolygon)
 	{
-		mapImage = new QImage(_maptex);
-		memorySize+=mapImage->byteCount();
+		mapAlpha.create(QImage(_maptex));
+		memorySize+=mapAlpha.getMemorySize();
 	}
 	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
 	memorySize+=mapTex.data()->getGlSize();
@@ -1005,9 +1020,7 @@ float LandscapeFisheye::getOpacity(Vec3d azalt) const
 
 	// in case we also have a horizon polygon defined, this is trivial and fast.
 	if (horizonPolygon)
-	{
-		if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
-	}
+		return getPolygonOpacity(azalt);
 	// Else, sample the image...
 	float az, alt_rad;
 	StelUtils::rectToSphe(&az, &alt_rad, azalt);
@@ -1017,23 +1030,23 @@ float LandscapeFisheye::getOpacity(Vec3d azalt) const
 	// It is possible that sample position is outside. in this case, assume full opacity and exit early.
 	if (M_PI/2-alt_rad > texFov/2.0f ) return 1.0f; // outside fov, in the clamped texture zone: always opaque.
 
-	float radius=(M_PI/2-alt_rad)*2.0f/texFov; // radius in units of mapImage.height/2
+	float radius=(M_PI/2-alt_rad)*2.0f/texFov; // radius in units of mapAlpha.height/2
 
 	az = (M_PI-az) - angleRotateZ; // 0..+2pi -angleRotateZ, real azimuth. NESW
 	//  The texture map has south on top, east at right (if anglerotateZ=0)
-	int x= mapImage->height()/2*(1 + radius*std::sin(az));
-	int y= mapImage->height()/2*(1 + radius*std::cos(az));
+	int x= mapAlpha.getHeight()/2*(1 + radius*std::sin(az));
+	int y= mapAlpha.getHeight()/2*(1 + radius*std::cos(az));
 
-	QRgb pixVal=mapImage->pixel(x, y);
+	const float opacity=mapAlpha.getOpacity(x, y);
 /*
 #ifndef NDEBUG
 	// GZ: please leave the comment available for further development!
 	qDebug() << "Landscape sampling: az=" << (az+angleRotateZ)/M_PI*180.0f << "° alt=" << alt_rad/M_PI*180.f
-			 << "°, w=" << mapImage->width() << " h=" << mapImage->height()
-			 << " --> x:" << x << " y:" << y << " alpha:" << qAlpha(pixVal)/255.0f;
+			 << "°, w=" << mapAlpha.getWidth() << " h=" << mapAlpha.getHeight()
+			 << " --> x:" << x << " y:" << y << " alpha:" << opacity;
 #endif
 */
-	return qAlpha(pixVal)/255.0f;
+	return opacity;
 
 
 }
@@ -1051,13 +1064,14 @@ LandscapeSpherical::LandscapeSpherical(float _radius)
 	, fogTexBottom(0.)
 	, illumTexTop(0.)
 	, illumTexBottom(0.)
-	, mapImage(Q_NULLPTR)
+	, tilesLevels(0)
+	, tiledMap(Q_NULLPTR)
 	, memorySize(sizeof(LandscapeSpherical))
 {}
 
 LandscapeSpherical::~LandscapeSpherical()
 {
-	if (mapImage) delete mapImage;
+	delete tiledMap;
 	landscapeLabels.clear();
 }
 
@@ -1079,6 +1093,14 @@ void LandscapeSpherical::load(const QSettings& landscapeIni, const QString& land
 		return;
 	}
 
+	// Very large panoramas may be given as a pyramid of tiles instead of the single maptex.
+	const QString tiles = landscapeIni.value("landscape/maptex_tiles").toString();
+	if (!tiles.isEmpty())
+	{
+		tilesPattern = StelFileMgr::findFile("landscapes/" + landscapeId, StelFileMgr::Directory) + "/" + tiles;
+		tilesLevels = landscapeIni.value("landscape/maptex_tiles_levels", 1).toInt();
+	}
+
 	create(name,
 	       getTexturePath(landscapeIni.value("landscape/maptex").toString(), landscapeId),
 	       getTexturePath(landscapeIni.value("landscape/maptex_fog").toString(), landscapeId),
@@ -1110,13 +1132,27 @@ void LandscapeSpherical::create(const QString _name, const QString& _maptex, con
 	fogTexBottom  = (90.f-_fogTexBottom)  *M_PI/180.f;
 	illumTexTop   = (90.f-_illumTexTop)   *M_PI/180.f;
 	illumTexBottom= (90.f-_illumTexBottom)*M_PI/180.f;
-	if (!horizonPolygon)
+	if (!tilesPattern.isEmpty())
 	{
-		mapImage = new QImage(_maptex);
-		memorySize+=mapImage->byteCount();
+		tiledMap = new LandscapeTiledPanorama(tilesPattern, tilesLevels, mapTexTop, mapTexBottom);
+		if (!horizonPolygon)
+		{
+			tiledMap->createAlphaMap(mapAlpha, maxTiledAlphaMapWidth);
+			memorySize+=mapAlpha.getMemorySize();
+		}
+		// The tiles of the finer levels come and go, only level 0 is counted.
+		memorySize+=tiledMap->getMemorySize();
+	}
+	else
+	{
+		if (!horizonPolygon)
+		{
+			mapAlpha.create(QImage(_maptex));
+			memorySize+=mapAlpha.getMemorySize();
+		}
+		mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
+		memorySize+=mapTex.data()->getGlSize();
 	}
-	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
-	memorySize+=mapTex.data()->getGlSize();
 
 	if (_maptexIllum.length() && (!_maptexIllum.endsWith("/")))
 	{
@@ -1147,11 +1183,16 @@ void LandscapeSpherical::draw(StelCore* core)
 	sPainter.setBlending(true);
 	sPainter.setCullFace(true);
 
-	mapTex->bind();
+	if (tiledMap)
+		tiledMap->draw(sPainter, radius);
+	else
+	{
+		mapTex->bind();
 
-	// TODO: verify that this works correctly for custom projections [comment not by GZ]
-	// seam is at East, except if angleRotateZ has been given.
-	sPainter.sSphere(radius, 1.0, cols, rows, 1, true, mapTexTop, mapTexBottom);
+		// TODO: verify that this works correctly for custom projections [comment not by GZ]
+		// seam is at East, except if angleRotateZ has been given.
+		sPainter.sSphere(radius, 1.0, cols, rows, 1, true, mapTexTop, mapTexBottom);
+	}
 	// Since 0.13: Fog also for sphericals...
 	if ((mapTexFog) && (core->getSkyDrawer()->getFlagHasAtmosphere()))
 	{
@@ -1202,9 +1243,7 @@ float LandscapeSpherical::getOpacity(Vec3d azalt) const
 
 	// in case we also have a horizon polygon defined, this is trivial and fast.
 	if (horizonPolygon)
-	{
-		if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
-	}
+		return getPolygonOpacity(azalt);
 	// Else, sample the image...
 	float az, alt_rad;
 	StelUtils::rectToSphe(&az, &alt_rad, azalt);
@@ -1222,7 +1261,7 @@ float LandscapeSpherical::getOpacity(Vec3d azalt) const
 	Q_ASSERT(y_img_1<=1.f);
 	Q_ASSERT(y_img_1>=0.f);
 
-	int y=(1.0-y_img_1)*mapImage->height();           // pixel Y from top.
+	int y=(1.0-y_img_1)*mapAlpha.getHeight();         // pixel Y from top.
 
 	az = (M_PI-az) / M_PI;                            //  0..2 = N.E.S.W.N
 
@@ -1231,18 +1270,18 @@ float LandscapeSpherical::getOpacity(Vec3d azalt) const
 	az_phot=fmodf(az_phot, 2.0f);
 	if (az_phot<0) az_phot+=2.0f;                                //  0..2 = image-X
 
-	int x=(az_phot/2.0f) * mapImage->width(); // pixel X from left.
+	int x=(az_phot/2.0f) * mapAlpha.getWidth(); // pixel X from left.
 
-	QRgb pixVal=mapImage->pixel(x, y);
+	const float opacity=mapAlpha.getOpacity(x, y);
 /*
 #ifndef NDEBUG
 	// GZ: please leave the comment available for further development!
 	qDebug() << "Landscape sampling: az=" << az*180.0 << "° alt=" << alt_pm1*90.0f
 			 << "°, xShift[-2..+2]=" << xShift << " az_phot[0..2]=" << az_phot
-			 << ", w=" << mapImage->width() << " h=" << mapImage->height()
-			 << " --> x:" << x << " y:" << y << " alpha:" << qAlpha(pixVal)/255.0f;
+			 << ", w=" << mapAlpha.getWidth() << " h=" << mapAlpha.getHeight()
+			 << " --> x:" << x << " y:" << y << " alpha:" << opacity;
 #endif
 */
-	return qAlpha(pixVal)/255.0f;
+	return opacity;
 
 }
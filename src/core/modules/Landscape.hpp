@@ -28,6 +28,8 @@
 #include "StelUtils.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelLocation.hpp"
+#include "LandscapeOpacity.hpp"
+#include "LandscapeTiledPanorama.hpp"
 
 #include <QMap>
 #include <QImage>
@@ -202,6 +204,10 @@ protected:
 	//! @param polygonInverted Must be true to use horizons which are on average below mathematical horizon (Solution for bug LP:1554639)
 	void createPolygonalHorizon(const QString& lineFileName, const float polyAngleRotateZ=0.0f, const QString &listMode="azDeg_altDeg", const bool polygonInverted=false);
 
+	//! Opacity in direction azalt given by the horizon polygon, which must exist.
+	//! Most directions are answered by horizonTable, only those close to the horizon line are tested against the polygon.
+	float getPolygonOpacity(const Vec3d& azalt) const;
+
 	//! search for a texture in landscape directory, else global textures directory
 	//! @param basename The name of a texture file, e.g. "fog.png"
 	//! @param landscapeId The landscape ID (directory name) to which the texture belongs
@@ -240,6 +246,7 @@ protected:
 	SphericalRegionP horizonPolygon;   //! Optional element describing the horizon line.
 					   //! Data shall be read from the file given as landscape.ini[landscape]polygonal_horizon_list
 					   //! For LandscapePolygonal, this is the only horizon data item.
+	LandscapeHorizonTable horizonTable; //! Altitude bounds of the horizon line per azimuth, made with horizonPolygon.
 	Vec3f horizonPolygonLineColor;     //! for all horizon types, the horizonPolygon line, if specified, will be drawn in this color
 					   //! specified in landscape.ini[landscape]horizon_line_color. Negative red (default) indicated "don't draw".
 	// Optional element: labels for landscape features.
@@ -294,7 +301,7 @@ private:
 	landscapeTexCoord* sides;
 	StelTextureSP fogTex;
 	StelTextureSP groundTex;
-	QVector<QImage*> sidesImages; // Required for opacity lookup
+	QVector<LandscapeAlphaMap> sidesAlpha; // Required for opacity lookup
 	int nbDecorRepeat;
 	float fogAltAngle;
 	float fogAngleShift;
@@ -371,7 +378,7 @@ private:
 				   //!< can also be smaller, just the texture is again mapped onto the same geometry.
 	StelTextureSP mapTexIllum; //!< Optional fisheye image of identical size (create as layer in your favorite image processor) or at least, proportions.
 				   //!< To simulate light pollution (skyglow), street lights, light in windows, ... at night
-	QImage *mapImage;          //!< The same image as mapTex, but stored in-mem for sampling.
+	LandscapeAlphaMap mapAlpha; //!< The alpha channel of mapTex, stored in-mem for sampling.
 
 	float texFov;
 	unsigned int memorySize;
@@ -386,7 +393,10 @@ private:
 //! It is possible to remove empty top or bottom parts of the textures (main texture: only top part should meaningfully be cut away!)
 //! The textures should still be power-of-two, so maybe 8192x1024 for the fog, or 8192x2048 for the light pollution.
 //! (It's OK to stretch the textures. They just have to fit, geometrically!)
-//! TODO: Allow a horizontal split for 2 or even 4 parts, i.e. super-large, super-accurate panos.
+//! Larger panoramas can be cut into a pyramid of tiles (see LandscapeTiledPanorama), which are only loaded when in view:
+//! @param landscape/maptex_tiles path of the tiles relative to the landscape directory, e.g. tiles/%1/%2_%3.png for level, row and column.
+//!        maptex is not used in this case, maptex_top and maptex_bottom apply to the whole pyramid.
+//! @param landscape/maptex_tiles_levels number of levels of the pyramid.
 class LandscapeSpherical : public Landscape
 {
 public:
@@ -429,7 +439,12 @@ private:
 	float fogTexBottom;	   //!< zenithal bottom angle of the fog texture, radians
 	float illumTexTop;	   //!< zenithal top angle of the illumination texture, radians
 	float illumTexBottom;	   //!< zenithal bottom angle of the illumination texture, radians
-	QImage *mapImage;          //!< The same image as mapTex, but stored in-mem for opacity sampling.
+	LandscapeAlphaMap mapAlpha; //!< The alpha channel of mapTex, stored in-mem for opacity sampling.
+	QString tilesPattern;      //!< path of the tiles of a tiled panorama, read from landscape.ini before create() is called
+	int tilesLevels;           //!< number of levels of a tiled panorama
+	LandscapeTiledPanorama* tiledMap; //!< replaces mapTex for tiled panoramas
+	//! Width of the opacity map of tiled panoramas, i.e. about 0.1 degree per pixel.
+	static const int maxTiledAlphaMapWidth = 4096;
 	unsigned int memorySize;   //!< holds an approximate value of memory consumption (for cache cost estimate)
 };
 
@@ -0,0 +1,218 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "LandscapeOpacity.hpp"
+#include "StelUtils.hpp"
+
+#include <QImage>
+#include <cmath>
+#include <cstring>
+
+void LandscapeAlphaMap::create(const QImage& image)
+{
+	clear();
+	if (image.isNull())
+		return;
+	create(image.width(), image.height());
+	setImage(0, 0, image);
+	updateRows();
+}
+
+void LandscapeAlphaMap::create(int w, int h)
+{
+	clear();
+	width=w;
+	height=h;
+	alpha.fill(0, width*height);
+}
+
+void LandscapeAlphaMap::setImage(int x, int y, const QImage& image)
+{
+	const int x0=qMax(0, x);
+	const int x1=qMin(width, x+image.width());
+	if (x0>=x1)
+		return;
+	const int y0=qMax(0, y);
+	const int y1=qMin(height, y+image.height());
+
+	if (!image.hasAlphaChannel())
+	{
+		for (int j=y0; j<y1; ++j)
+			memset(alpha.data()+j*width+x0, 255, x1-x0);
+		return;
+	}
+
+	// A no-op if the image was already loaded as ARGB32, which is the usual case for PNG files.
+	const QImage argb=image.convertToFormat(QImage::Format_ARGB32);
+	for (int j=y0; j<y1; ++j)
+	{
+		const QRgb* src=reinterpret_cast<const QRgb*>(argb.constScanLine(j-y))+(x0-x);
+		quint8* dst=alpha.data()+j*width+x0;
+		for (int i=x0; i<x1; ++i)
+			*dst++=qAlpha(*src++);
+	}
+}
+
+void LandscapeAlphaMap::updateRows()
+{
+	transparentRows.fill(height, width);
+	opaqueRows.fill(0, width);
+	const quint8* a=alpha.constData();
+	for (int y=0; y<height; ++y)
+	{
+		for (int x=0; x<width; ++x, ++a)
+		{
+			if (*a>0 && transparentRows.at(x)==height)
+				transparentRows[x]=y;
+			if (*a<255)
+				opaqueRows[x]=y+1;
+		}
+	}
+}
+
+void LandscapeAlphaMap::clear()
+{
+	width=0;
+	height=0;
+	alpha.clear();
+	transparentRows.clear();
+	opaqueRows.clear();
+}
+
+unsigned int LandscapeAlphaMap::getMemorySize() const
+{
+	return sizeof(LandscapeAlphaMap)+alpha.size()+(transparentRows.size()+opaqueRows.size())*sizeof(int);
+}
+
+// 1024 bins of about 0.35 degrees: a detailed horizon line crosses each bin with a few points only.
+const int LandscapeHorizonTable::nbBins=1024;
+
+int LandscapeHorizonTable::binIndex(float az)
+{
+	const int i=(int)std::floor((az+M_PI)/(2.*M_PI)*nbBins);
+	return ((i%nbBins)+nbBins)%nbBins;
+}
+
+void LandscapeHorizonTable::create(const QVector<Vec3d>& points, const SphericalRegionP& region)
+{
+	bins.clear();
+	if (points.size()<2 || region.isNull())
+		return;
+
+	// Safety margin for the bounds, larger than the bulge of the line between the samples below.
+	static const float margin=1.0e-4f;
+	// Longest sample step along the line, and altitude from which azimuths are meaningless.
+	static const double step=0.2*M_PI/180.;
+	static const float poleAlt=89.f*M_PI/180.f;
+
+	QVector<float> lowAlt(nbBins, 10.f);
+	QVector<float> highAlt(nbBins, -10.f);
+	float poleLow=10.f, poleHigh=-10.f;
+
+	// Walk along the closed line. Points linearly interpolated between two vertices and normalized
+	// are on the great circle arc joining them, so each sample is exactly on the horizon line.
+	Vec3d prev=points.last();
+	prev.normalize();
+	float prevAz, prevAlt;
+	StelUtils::rectToSphe(&prevAz, &prevAlt, prev);
+	foreach (const Vec3d& v, points)
+	{
+		Vec3d b=v;
+		b.normalize();
+		const Vec3d a=prev;
+		const int nbSteps=qMax(1, (int)std::ceil(std::acos(qBound(-1., a.dot(b), 1.))/step));
+		for (int i=1; i<=nbSteps; ++i)
+		{
+			Vec3d p=a*(1.-(double)i/nbSteps)+b*((double)i/nbSteps);
+			p.normalize();
+			float az, alt;
+			StelUtils::rectToSphe(&az, &alt, p);
+			const float lo=qMin(alt, prevAlt)-margin;
+			const float hi=qMax(alt, prevAlt)+margin;
+			if (qAbs(alt)>poleAlt || qAbs(prevAlt)>poleAlt)
+			{
+				// Near the zenith or the nadir, the segment may cross any azimuth.
+				poleLow=qMin(poleLow, lo);
+				poleHigh=qMax(poleHigh, hi);
+			}
+			else
+			{
+				// Mark the bins between the two samples, the short way around.
+				const int i0=binIndex(prevAz);
+				int d=binIndex(az)-i0;
+				if (d>nbBins/2) d-=nbBins;
+				if (d<-nbBins/2) d+=nbBins;
+				const int dir=(d<0 ? -1 : 1);
+				for (int k=0; k<=qAbs(d); ++k)
+				{
+					const int j=(i0+dir*k+nbBins)%nbBins;
+					lowAlt[j]=qMin(lowAlt.at(j), lo);
+					highAlt[j]=qMax(highAlt.at(j), hi);
+				}
+			}
+			prevAz=az;
+			prevAlt=alt;
+		}
+		prev=b;
+	}
+
+	// Find the side of the line above and below the bounds in each bin, once and for all.
+	bins.resize(nbBins);
+	for (int j=0; j<nbBins; ++j)
+	{
+		Bin& bin=bins[j];
+		bin.lowAlt=qMin(lowAlt.at(j), poleLow);
+		bin.highAlt=qMax(highAlt.at(j), poleHigh);
+		const float az=(j+0.5f)*2.f*M_PI/nbBins-M_PI;
+		Vec3d dir;
+		if (bin.lowAlt>bin.highAlt)
+		{
+			// The line does not cross this bin: the whole column is on the same side.
+			bin.lowAlt=bin.highAlt=0.f;
+			StelUtils::spheToRect(az, 0.f, dir);
+			bin.below=bin.above=(region->contains(dir) ? 1 : 0);
+			continue;
+		}
+		bin.above=-1;
+		if (bin.highAlt<M_PI_2)
+		{
+			StelUtils::spheToRect(az, 0.5f*(bin.highAlt+M_PI_2), dir);
+			bin.above=(region->contains(dir) ? 1 : 0);
+		}
+		bin.below=-1;
+		if (bin.lowAlt>-M_PI_2)
+		{
+			StelUtils::spheToRect(az, 0.5f*(bin.lowAlt-M_PI_2), dir);
+			bin.below=(region->contains(dir) ? 1 : 0);
+		}
+	}
+}
+
+int LandscapeHorizonTable::lookup(const Vec3d& azalt) const
+{
+	if (bins.isEmpty())
+		return -1;
+	float az, alt;
+	StelUtils::rectToSphe(&az, &alt, azalt);
+	const Bin& bin=bins.at(binIndex(az));
+	if (alt>bin.highAlt)
+		return bin.above;
+	if (alt<bin.lowAlt)
+		return bin.below;
+	return -1;
+}
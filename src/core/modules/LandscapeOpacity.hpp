@@ -0,0 +1,120 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _LANDSCAPEOPACITY_HPP_
+#define _LANDSCAPEOPACITY_HPP_
+
+#include "VecMath.hpp"
+#include "StelSphereGeometry.hpp"
+
+#include <QVector>
+
+class QImage;
+
+//! @class LandscapeAlphaMap
+//! The alpha channel of a landscape texture, kept in memory for Landscape::getOpacity().
+//! It replaces a full copy of the RGBA image by one byte per pixel, i.e. a quarter of the memory.
+//! For each column, the rows at the top which are fully transparent and the rows at the
+//! bottom which are fully opaque are counted, so that most lookups above or below the
+//! landscape horizon are answered without reading the pixels.
+class LandscapeAlphaMap
+{
+public:
+	LandscapeAlphaMap() : width(0), height(0) {}
+
+	//! Keep the alpha channel of image. The image is not needed afterwards.
+	void create(const QImage& image);
+	//! Create a fully transparent map, to be filled by setImage() and finished by updateRows().
+	//! This allows to assemble a map from tiles without a full size RGBA image.
+	void create(int width, int height);
+	//! Copy the alpha channel of image, with its top left corner at pixel x,y. Parts outside the map are ignored.
+	void setImage(int x, int y, const QImage& image);
+	//! Count the fully transparent and opaque rows of each column after setImage().
+	void updateRows();
+	void clear();
+	bool isNull() const {return alpha.isEmpty();}
+
+	int getWidth() const {return width;}
+	int getHeight() const {return height;}
+
+	//! Opacity of a pixel. Coordinates outside the image are clamped to the border.
+	//! An empty map, e.g. when the texture could not be loaded, is fully transparent.
+	//! @param x pixel column from left
+	//! @param y pixel row from top
+	//! @return alpha (0=fully transparent, 1=fully opaque)
+	float getOpacity(int x, int y) const
+	{
+		if (isNull()) return 0.0f;
+		x=qBound(0, x, width-1);
+		y=qBound(0, y, height-1);
+		if (y<transparentRows.at(x)) return 0.0f;
+		if (y>=opaqueRows.at(x)) return 1.0f;
+		return alpha.at(y*width+x)/255.0f;
+	}
+
+	//! Return approximate memory footprint in bytes.
+	unsigned int getMemorySize() const;
+
+private:
+	int width;
+	int height;
+	QVector<quint8> alpha;         // row by row, from top left
+	QVector<int> transparentRows;  // per column: number of fully transparent rows at the top
+	QVector<int> opaqueRows;       // per column: first row from which the column is fully opaque down to the bottom
+};
+
+//! @class LandscapeHorizonTable
+//! Bounds of the altitude of a polygonal horizon line for a fixed number of azimuth bins.
+//! In each bin, all directions above the upper bound or below the lower bound are
+//! on the same side of the horizon line, so that the opacity found for one of them at
+//! creation time holds for all. Only directions between the bounds need a test of the
+//! horizon polygon itself.
+class LandscapeHorizonTable
+{
+public:
+	//! Build the table.
+	//! @param points the closed horizon line, in the alt-az frame
+	//! @param region the horizon polygon whose boundary is the line (the ground)
+	void create(const QVector<Vec3d>& points, const SphericalRegionP& region);
+	void clear() {bins.clear();}
+	bool isEmpty() const {return bins.isEmpty();}
+
+	//! Find the opacity of direction azalt without testing the horizon polygon if possible.
+	//! @return 1 (below the horizon), 0 (above the horizon) or -1 when azalt is close to the horizon line
+	//! and must be tested against the horizon polygon.
+	int lookup(const Vec3d& azalt) const;
+
+	//! Return approximate memory footprint in bytes.
+	unsigned int getMemorySize() const {return sizeof(LandscapeHorizonTable)+bins.size()*sizeof(Bin);}
+
+	//! Number of azimuth bins.
+	static const int nbBins;
+
+private:
+	struct Bin
+	{
+		float lowAlt;    // [radians] no part of the line is below this altitude
+		float highAlt;   // [radians] no part of the line is above this altitude
+		qint8 below;     // opacity below lowAlt, -1 if unknown
+		qint8 above;     // opacity above highAlt, -1 if unknown
+	};
+	static int binIndex(float az);
+	QVector<Bin> bins;
+};
+
+#endif // _LANDSCAPEOPACITY_HPP_
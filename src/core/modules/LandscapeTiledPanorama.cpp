@@ -0,0 +1,255 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "LandscapeTiledPanorama.hpp"
+#include "LandscapeOpacity.hpp"
+#include "StelApp.hpp"
+#include "StelPainter.hpp"
+#include "StelTexture.hpp"
+#include "StelTextureMgr.hpp"
+
+#include <QDebug>
+#include <QImage>
+#include <QImageReader>
+#include <cmath>
+
+const double LandscapeTiledPanorama::deletionDelay=2.;
+
+// Largest angle between two vertices of the tile meshes.
+static const float maxMeshStep=5.f*M_PI/180.f;
+
+// Direction of the point of the panorama at s (0..1 from the left/east edge) and zenithal angle z.
+// This is the same mapping as StelPainter::sSphere() with orientInside and flipTexture.
+static Vec3d panoramaDirection(float s, float z)
+{
+	const float theta=2.f*M_PI*(1.f-s);
+	return Vec3d(-std::sin(theta)*std::sin(z), std::cos(theta)*std::sin(z), std::cos(z));
+}
+
+LandscapeTiledPanorama::LandscapeTiledPanorama(const QString& pattern, int nbLevels, float texTop, float texBottom)
+	: pattern(pattern)
+	, nbLevels(qBound(1, nbLevels, 12))
+	, texTop(texTop)
+	, texBottom(texBottom)
+	, tileSize(512)
+{
+	QImageReader reader(tilePath(0, 0, 0));
+	if (reader.canRead())
+		tileSize=reader.size().width();
+	else
+		qWarning() << "Cannot read the first tile of the landscape panorama" << tilePath(0, 0, 0);
+
+	// Level 0 is always drawn as a fall back: start loading it now.
+	for (int col=0; col<nbCols(0); ++col)
+		getTile(0, 0, col);
+}
+
+QString LandscapeTiledPanorama::tilePath(int level, int row, int col) const
+{
+	return pattern.arg(level).arg(row).arg(col);
+}
+
+LandscapeTiledPanorama::Tile& LandscapeTiledPanorama::getTile(int level, int row, int col)
+{
+	const quint32 key=tileKey(level, row, col);
+	QHash<quint32, Tile>::iterator it=tiles.find(key);
+	if (it==tiles.end())
+	{
+		it=tiles.insert(key, Tile());
+		// A null texture is kept for missing tiles, so that they are not searched again.
+		it->tex=StelApp::getInstance().getTextureManager().createTextureThread(tilePath(level, row, col), StelTexture::StelTextureParams(true), false);
+	}
+	return it.value();
+}
+
+int LandscapeTiledPanorama::findLevel(const StelProjectorP& prj)
+{
+	const float pixelsPerRad=prj->getPixelPerRadAtCenter();
+	int level=0;
+	while (level<nbLevels-1 && tileSize*nbCols(level)/(2.f*M_PI)<pixelsPerRad)
+		++level;
+	return level;
+}
+
+bool LandscapeTiledPanorama::isVisible(int level, int row, int col, const SphericalRegionP& viewport) const
+{
+	const float ds=1.f/nbCols(level);
+	if (ds*2.f*M_PI>=M_PI_2)
+		return true;
+	const float dz=(texBottom-texTop)/nbRows(level);
+	const float s0=col*ds;
+	const float z0=texTop+row*dz;
+
+	// Bounding cap of the tile: the farthest points from its center are the corners,
+	// the middles of the edges are only added as a safety margin near the zenith.
+	const Vec3d center=panoramaDirection(s0+0.5f*ds, z0+0.5f*dz);
+	double minCos=1.;
+	for (int i=0; i<=2; ++i)
+	{
+		for (int j=0; j<=2; ++j)
+		{
+			if (i==1 && j==1)
+				continue;
+			minCos=qMin(minCos, center.dot(panoramaDirection(s0+0.5f*i*ds, z0+0.5f*j*dz)));
+		}
+	}
+	return viewport->intersects(SphericalCap(center, minCos-1e-3));
+}
+
+void LandscapeTiledPanorama::drawTile(StelPainter& painter, float radius, int level, int row, int col, int texLevel) const
+{
+	Q_ASSERT(texLevel<=level);
+	const float ds=1.f/nbCols(level);
+	const float dz=(texBottom-texTop)/nbRows(level);
+	const float s0=col*ds;
+	const float zBottom=texTop+(row+1)*dz;
+	const int slices=qMax(2, (int)std::ceil(ds*2.f*M_PI/maxMeshStep));
+	const int stacks=qMax(2, (int)std::ceil(dz/maxMeshStep));
+
+	// Part of the bound texture covering the tile, in texture coordinates (t=1 at the top of the image).
+	const int shift=level-texLevel;
+	const float f=1.f/(1<<shift);
+	const float u0=(col-((col>>shift)<<shift))*f;
+	const float t0=1.f-(row-((row>>shift)<<shift)+1)*f;
+
+	static QVector<double> vertexArr;
+	static QVector<float> texCoordArr;
+	static QVector<unsigned short> indiceArr;
+	vertexArr.resize(0);
+	texCoordArr.resize(0);
+	indiceArr.resize(0);
+
+	// Rows from bottom to top, columns from right to left, with the same winding as StelPainter::sSphere().
+	for (int i=0; i<=stacks; ++i)
+	{
+		const float z=zBottom-i*dz/stacks;
+		for (int j=0; j<=slices; ++j)
+		{
+			const float s=s0+ds*(1.f-(float)j/slices);
+			const Vec3d v=panoramaDirection(s, z)*radius;
+			vertexArr << v[0] << v[1] << v[2];
+			texCoordArr << u0+(1.f-(float)j/slices)*f << t0+(float)i/stacks*f;
+		}
+	}
+	for (int i=0; i<stacks; ++i)
+	{
+		const unsigned short lower=i*(slices+1);
+		const unsigned short upper=lower+slices+1;
+		for (int j=1; j<=slices; ++j)
+		{
+			indiceArr << lower+j-1 << upper+j-1 << lower+j;
+			indiceArr << lower+j << upper+j-1 << upper+j;
+		}
+	}
+
+	painter.setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
+	painter.drawFromArray(StelPainter::Triangles, indiceArr.size(), 0, true, indiceArr.constData());
+}
+
+void LandscapeTiledPanorama::draw(StelPainter& painter, float radius)
+{
+	const double now=StelApp::getTotalRunTime();
+	const StelProjectorP prj=painter.getProjector();
+	const SphericalRegionP viewport=prj->getViewportConvexPolygon();
+	const int level=findLevel(prj);
+
+	for (int row=0; row<nbRows(level); ++row)
+	{
+		for (int col=0; col<nbCols(level); ++col)
+		{
+			if (!isVisible(level, row, col, viewport))
+				continue;
+			// Draw the tile if it is loaded, else the part of the nearest loaded ancestor covering it.
+			for (int texLevel=level; texLevel>=0; --texLevel)
+			{
+				Tile& tile=getTile(texLevel, row>>(level-texLevel), col>>(level-texLevel));
+				tile.lastDrawTime=now;
+				if (tile.tex && tile.tex->bind())
+				{
+					drawTile(painter, radius, level, row, col, texLevel);
+					break;
+				}
+			}
+		}
+	}
+
+	deleteUnusedTiles(now);
+}
+
+void LandscapeTiledPanorama::deleteUnusedTiles(double now)
+{
+	QHash<quint32, Tile>::iterator it=tiles.begin();
+	while (it!=tiles.end())
+	{
+		const int level=it.key()>>26;
+		if (level>0 && it->tex && now-it->lastDrawTime>deletionDelay)
+			it=tiles.erase(it);
+		else
+			++it;
+	}
+}
+
+void LandscapeTiledPanorama::createAlphaMap(LandscapeAlphaMap& alphaMap, int maxWidth) const
+{
+	int level=0;
+	while (level<nbLevels-1 && tileSize*nbCols(level+1)<=maxWidth)
+		++level;
+
+	// Fall back to the lower levels if the tiles of a level cannot be read
+	QSize size;
+	for (; level>=0; --level)
+	{
+		QImageReader reader(tilePath(level, 0, 0));
+		if (reader.canRead())
+		{
+			size=reader.size();
+			break;
+		}
+		qWarning() << "Cannot read the tiles of level" << level << "of the landscape panorama" << pattern;
+	}
+	if (level<0)
+	{
+		// an empty map is fully transparent
+		alphaMap.clear();
+		return;
+	}
+	alphaMap.create(size.width()*nbCols(level), size.height()*nbRows(level));
+	for (int row=0; row<nbRows(level); ++row)
+	{
+		for (int col=0; col<nbCols(level); ++col)
+		{
+			const QImage image(tilePath(level, row, col));
+			if (image.isNull())
+				qWarning() << "Missing landscape panorama tile" << tilePath(level, row, col);
+			else
+				alphaMap.setImage(col*size.width(), row*size.height(), image);
+		}
+	}
+	alphaMap.updateRows();
+}
+
+unsigned int LandscapeTiledPanorama::getMemorySize() const
+{
+	unsigned int size=sizeof(LandscapeTiledPanorama);
+	foreach (const Tile& tile, tiles)
+	{
+		if (tile.tex)
+			size+=tile.tex->getGlSize();
+	}
+	return size;
+}
@@ -0,0 +1,101 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _LANDSCAPETILEDPANORAMA_HPP_
+#define _LANDSCAPETILEDPANORAMA_HPP_
+
+#include "StelProjector.hpp"
+#include "StelTextureTypes.hpp"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class StelPainter;
+class LandscapeAlphaMap;
+
+//! @class LandscapeTiledPanorama
+//! An equirectangular landscape panorama cut into a pyramid of tiles, for panoramas too large
+//! to be loaded as a single texture.
+//! Level 0 has 2x1 tiles covering the whole panorama, each further level has twice as many
+//! tiles in both directions. The tile files are found by a pattern like "tiles/%1/%2_%3.png",
+//! where %1 is the level, %2 the row (from top) and %3 the column (from left, i.e. from east).
+//! Like the single texture of LandscapeSpherical, the panorama may be cropped at the top and bottom.
+//!
+//! Only the tiles in the field of view are drawn, at the level whose resolution matches
+//! the screen. They are loaded in the background by the texture manager; until a tile is
+//! ready, the part of its lowest resolution loaded ancestor is drawn instead. Level 0 is kept
+//! in memory, the other tiles are released a few seconds after they left the field of view.
+class LandscapeTiledPanorama
+{
+public:
+	//! @param pattern absolute path of the tile files, with the placeholders %1 (level), %2 (row) and %3 (column).
+	//! @param nbLevels number of levels in the pyramid
+	//! @param texTop zenithal angle of the top edge of the panorama [radians]
+	//! @param texBottom zenithal angle of the bottom edge of the panorama [radians]
+	LandscapeTiledPanorama(const QString& pattern, int nbLevels, float texTop, float texBottom);
+
+	//! Draw the visible tiles. The projector of painter must be in the frame of the panorama,
+	//! i.e. alt-az rotated by the landscape azimuth rotation.
+	//! @param radius the radius of the sphere on which the panorama is drawn
+	void draw(StelPainter& painter, float radius);
+
+	//! Assemble the alpha channel of the largest level not wider than maxWidth into alphaMap.
+	//! The tiles are loaded one after the other, so that no full size image is ever in memory.
+	void createAlphaMap(LandscapeAlphaMap& alphaMap, int maxWidth) const;
+
+	//! Approximate texture memory currently used by the loaded tiles [bytes].
+	unsigned int getMemorySize() const;
+
+	//! Delay after which a tile which is not drawn anymore is released [s].
+	static const double deletionDelay;
+
+private:
+	struct Tile
+	{
+		Tile() : lastDrawTime(0.) {}
+		StelTextureSP tex;
+		double lastDrawTime;
+	};
+
+	static quint32 tileKey(int level, int row, int col) {return (quint32(level)<<26) | (quint32(row)<<13) | quint32(col);}
+	static int nbCols(int level) {return 2<<level;}
+	static int nbRows(int level) {return 1<<level;}
+	QString tilePath(int level, int row, int col) const;
+
+	//! Return the tile, starting its loading if needed.
+	Tile& getTile(int level, int row, int col);
+	//! Choose the level whose texel size is just smaller than the screen pixels.
+	int findLevel(const StelProjectorP& prj);
+	//! Whether a tile may be in the viewport.
+	bool isVisible(int level, int row, int col, const SphericalRegionP& viewport) const;
+	//! Draw the part of the texture currently bound which covers the tile at level, row, col.
+	//! @param texLevel the level of the bound texture, smaller or equal to level.
+	void drawTile(StelPainter& painter, float radius, int level, int row, int col, int texLevel) const;
+	//! Release the tiles not drawn for deletionDelay seconds, except level 0.
+	void deleteUnusedTiles(double now);
+
+	QString pattern;
+	int nbLevels;
+	float texTop;
+	float texBottom;
+	int tileSize;     // width in pixels of the tiles, found when the first tile is loaded
+	QHash<quint32, Tile> tiles;
+};
+
+#endif // _LANDSCAPETILEDPANORAMA_HPP_
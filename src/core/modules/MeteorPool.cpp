@@ -0,0 +1,517 @@
+/*
+ * Stellarium
+ * Copyright (C) 2013-2015 Marcos Cardinot
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MeteorPool.hpp"
+#include "StelCore.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelTexture.hpp"
+#include "StelUtils.hpp"
+
+#include <QtMath>
+#include <algorithm>
+
+int MeteorRandom::poisson(float mean)
+{
+	if (mean <= 0.f)
+	{
+		return 0;
+	}
+
+	if (mean < 30.f)
+	{
+		// count the uniform numbers whose product stays above exp(-mean)
+		const float limit = std::exp(-mean);
+		int k = 0;
+		float p = uniform();
+		while (p > limit)
+		{
+			++k;
+			p *= uniform();
+		}
+		return k;
+	}
+
+	// normal approximation, for meteor storms at high time rates
+	const float u1 = 1.f - uniform(); // ]0, 1]
+	const float u2 = uniform();
+	const float n = std::sqrt(-2.f * std::log(u1)) * std::cos(2.f * M_PI * u2);
+	return qMax(0, qRound(mean + std::sqrt(mean) * n));
+}
+
+MeteorPool::MeteorPool(int capacity)
+	: capacity(capacity)
+	, count(0)
+{
+}
+
+bool MeteorPool::spawn(const StelCore* core, float radiantAlpha, float radiantDelta, float speedKms,
+		       const QList<ColorPair>& colors, float pidx, MeteorRandom& rng)
+{
+	if (count >= capacity)
+	{
+		return false;
+	}
+
+	// the arrays are allocated with the first meteor, as many sources never produce any
+	if (speed.isEmpty())
+	{
+		speed.resize(capacity);
+		matAltAzToRadiant.resize(capacity);
+		position.resize(capacity);
+		trainZ.resize(capacity);
+		initialZ.resize(capacity);
+		finalZ.resize(capacity);
+		minDist.resize(capacity);
+		absMag.resize(capacity);
+		aptMag.resize(capacity);
+		segmentColors.resize(capacity * segments);
+	}
+
+	// the new meteor is only counted at the end, if it is visible
+	const int i = count;
+
+	// meteor speed in km/s
+	speed[i] = speedKms;
+
+	// find the radiant in horizontal coordinates
+	Vec3d radiantAltAz;
+	StelUtils::spheToRect(radiantAlpha, radiantDelta, radiantAltAz);
+	radiantAltAz = core->j2000ToAltAz(radiantAltAz);
+	float radiantAlt, radiantAz;
+	// S is zero, E is 90 degrees (SDSS)
+	StelUtils::rectToSphe(&radiantAz, &radiantAlt, radiantAltAz);
+
+	// meteors won't be visible if radiant is below 0degrees
+	if (radiantAlt < 0.f)
+	{
+		return false;
+	}
+
+	// define the radiant coordinate system
+	// rotation matrix to align z axis with radiant
+	matAltAzToRadiant[i] = Mat4d::zrotation(radiantAz) * Mat4d::yrotation(M_PI_2 - radiantAlt);
+
+	// select a random initial meteor altitude in the horizontal system [MIN_ALTITUDE, MAX_ALTITUDE]
+	float initialAlt = MIN_ALTITUDE + (MAX_ALTITUDE - MIN_ALTITUDE) * rng.uniform();
+
+	// calculates the max z-coordinate for the currrent radiant
+	float maxZ = meteorZ(M_PI_2 - radiantAlt, initialAlt);
+
+	// meteor trajectory
+	// select a random xy position in polar coordinates (radiant system)
+	float xyDist = maxZ * rng.uniform(); // [0, maxZ]
+	float theta = 2 * M_PI * rng.uniform(); // [0, 2pi]
+
+	// initial meteor coordinates (radiant system)
+	Vec3d& pos = position[i];
+	pos[0] = xyDist * qCos(theta);
+	pos[1] = xyDist * qSin(theta);
+	pos[2] = maxZ;
+	trainZ[i] = pos[2];
+
+	// store the initial z-component (radiant system)
+	initialZ[i] = pos[2];
+
+	// find the initial meteor coordinates in the horizontal system
+	Vec3d positionAltAz = pos;
+	positionAltAz.transfo4d(matAltAzToRadiant.at(i));
+
+	// find the angle from horizon to meteor
+	float meteorAlt = qAsin(positionAltAz[2] / positionAltAz.length());
+
+	// this meteor should not be visible if it is above the maximum altitude
+	// or if it's below the horizon!
+	if (positionAltAz[2] > MAX_ALTITUDE || meteorAlt <= 0.f)
+	{
+		return false;
+	}
+
+	// determine the final z-component and the min distance between meteor and observer
+	if (radiantAlt < 0.0262f) // (<1.5 degrees) earth grazing meteor ?
+	{
+		// earth-grazers are rare!
+		// introduce a probabilistic factor just to make them a bit harder to occur
+		if (rng.uniform() > 0.3f)
+		{
+			return false;
+		}
+
+		// limit lifetime to 12sec
+		finalZ[i] = qMax(pos[2] - speedKms * 12.f, -pos[2]);
+
+		minDist[i] = xyDist;
+	}
+	else
+	{
+		// limit lifetime to 12sec
+		finalZ[i] = qMax(pos[2] - speedKms * 12.f, (double) meteorZ(M_PI_2 - meteorAlt, MIN_ALTITUDE));
+
+		minDist[i] = qSqrt(finalZ.at(i) * finalZ.at(i) + xyDist * xyDist);
+	}
+
+	// a meteor cannot hit the observer!
+	if (minDist.at(i) < MIN_ALTITUDE)
+	{
+		return false;
+	}
+
+	// select random magnitude [-3; 4.5]
+	float mag = rng.uniform() * 7.5f - 3.f;
+
+	// compute RMag and CMag
+	RCMag rcMag;
+	core->getSkyDrawer()->computeRCMag(mag, &rcMag);
+	absMag[i] = rcMag.radius <= 1.2f ? 0.f : rcMag.luminance;
+	if (absMag.at(i) == 0.f)
+	{
+		return false;
+	}
+
+	// most visible meteors are under about 184km distant
+	// scale max mag down if outside this range
+	float scale = qPow(184.0 / minDist.at(i), 2);
+	absMag[i] *= qMin(scale, 1.0f);
+	aptMag[i] = 0.f;
+
+	// implements the population index (pidx) - usually a decimal between 2 and 4
+	if (pidx > 1.f)
+	{
+		// higher pidx implies a larger fraction of faint meteors than average
+		if (rng.uniform() > 1.f / pidx)
+		{
+			// Increase the absolute magnitude ([-3; 4.5]) in 1.5!
+			// As we are working on a 0-1 scale (where 1 is brighter),
+			// more 1.5 means less 0.2!
+			absMag[i] -= 0.2f;
+		}
+	}
+
+	buildColors(i, colors, rng);
+
+	++count;
+	return true;
+}
+
+void MeteorPool::update(const StelCore* core, double deltaTime)
+{
+	const bool realTimeSpeed = core->getRealTimeSpeed();
+
+	int i = 0;
+	while (i < count)
+	{
+		Vec3d& pos = position[i];
+		if (!realTimeSpeed || pos[2] < finalZ.at(i))
+		{
+			// burning has stopped so magnitude fades out
+			// assume linear fade out
+			absMag[i] -= deltaTime * 2.f;
+		}
+
+		// no longer visible: the last meteor takes its place, and is updated next
+		if (absMag.at(i) <= 0.f)
+		{
+			--count;
+			if (i < count)
+			{
+				move(count, i);
+			}
+			continue;
+		}
+
+		pos[2] -= speed.at(i) * deltaTime;
+
+		// train doesn't extend beyond start of burn
+		if (pos[2] + speed.at(i) * 0.5f > initialZ.at(i))
+		{
+			trainZ[i] = initialZ.at(i);
+		}
+		else
+		{
+			trainZ[i] -= speed.at(i) * deltaTime;
+		}
+
+		// update apparent magnitude based on distance to observer
+		float scale = qPow(minDist.at(i) / pos.length(), 2);
+		aptMag[i] = qMax(absMag.at(i) * qMin(scale, 1.f), 0.f);
+
+		++i;
+	}
+}
+
+void MeteorPool::move(int from, int to)
+{
+	speed[to] = speed.at(from);
+	matAltAzToRadiant[to] = matAltAzToRadiant.at(from);
+	position[to] = position.at(from);
+	trainZ[to] = trainZ.at(from);
+	initialZ[to] = initialZ.at(from);
+	finalZ[to] = finalZ.at(from);
+	minDist[to] = minDist.at(from);
+	absMag[to] = absMag.at(from);
+	aptMag[to] = aptMag.at(from);
+	std::copy(segmentColors.constBegin() + from * segments, segmentColors.constBegin() + (from + 1) * segments,
+		  segmentColors.begin() + to * segments);
+}
+
+Vec3f MeteorPool::getColorFromName(const QString& colorName)
+{
+	int R, G, B; // 0-255
+	if (colorName == "violet")
+	{ // Calcium
+		R = 176;
+		G = 67;
+		B = 172;
+	}
+	else if (colorName == "blueGreen")
+	{ // Magnesium
+		R = 0;
+		G = 255;
+		B = 152;
+	}
+	else if (colorName == "yellow")
+	{ // Iron
+		R = 255;
+		G = 255;
+		B = 0;
+	}
+	else if (colorName == "orangeYellow")
+	{ // Sodium
+		R = 255;
+		G = 160;
+		B = 0;
+	}
+	else if (colorName == "red")
+	{ // atmospheric nitrogen and oxygen
+		R = 255;
+		G = 30;
+		B = 0;
+	}
+	else
+	{ // white
+		R = 255;
+		G = 255;
+		B = 255;
+	}
+
+	return Vec3f(R/255.f, G/255.f, B/255.f);
+}
+
+void MeteorPool::buildColors(int i, const QList<ColorPair>& colors, MeteorRandom& rng)
+{
+	Vec3f* segmentColor = segmentColors.data() + i * segments;
+	int n = 0;
+	foreach (const ColorPair& color, colors)
+	{
+		// segments to be painted with the current color
+		const int segs = qRound(segments * (color.second / 100.f)); // rounds to nearest integer
+		const Vec3f rgb = getColorFromName(color.first);
+		for (int s = 0; s < segs && n < segments; ++s)
+		{
+			segmentColor[n++] = rgb;
+		}
+	}
+
+	// make sure that all segments have been painted!
+	// use the last color to paint the last segments
+	const Vec3f lastColor = getColorFromName(colors.isEmpty() ? QString() : colors.last().first);
+	while (n < segments)
+	{
+		segmentColor[n++] = lastColor;
+	}
+
+	// multi-color ?
+	// select a random segment to be the first (to alternate colors)
+	if (colors.size() > 1)
+	{
+		const int firstSegment = (segments - 1) * rng.uniform(); // [0, segments-1]
+		std::rotate(segmentColor, segmentColor + firstSegment, segmentColor + segments);
+	}
+}
+
+float MeteorPool::meteorZ(float zenithAngle, float altitude)
+{
+	float distance;
+
+	if (zenithAngle > 1.13446401f) // > 65 degrees?
+	{
+		float zcos = qCos(zenithAngle);
+		distance = qSqrt(EARTH_RADIUS2 * qPow(zcos, 2)
+				 + 2 * EARTH_RADIUS * altitude
+				 + qPow(altitude, 2));
+		distance -= EARTH_RADIUS * zcos;
+	}
+	else
+	{
+		// (first order approximation)
+		distance = altitude / qCos(zenithAngle);
+	}
+
+	return distance;
+}
+
+Vec3d MeteorPool::radiantToAltAz(int i, Vec3d pos) const
+{
+	pos /= 1242.0; // 1242 to scale down under 1
+	pos.transfo4d(matAltAzToRadiant.at(i));
+	return pos;
+}
+
+// Append a triangle strip made of the vertices a[s], b[s] (in this order) as independent triangles
+static void appendStrip(const Vec3d* a, const Vec3d* b, const Vec4f* colors, int n,
+			QVector<Vec3d>& vertices, QVector<Vec4f>& vertexColors)
+{
+	for (int s = 0; s + 1 < n; ++s)
+	{
+		vertices << a[s] << b[s] << a[s+1] << b[s] << a[s+1] << b[s+1];
+		vertexColors << colors[s] << colors[s] << colors[s+1] << colors[s] << colors[s+1] << colors[s+1];
+	}
+}
+
+void MeteorPool::draw(const StelCore* core, StelPainter& sPainter, const StelTextureSP& bolideTexture) const
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// the train thickness and bolide size only depend on the field of view
+	float maxFOV = core->getMovementMgr()->getMaxFov();
+	float FOV = core->getMovementMgr()->getCurrentFov();
+	float thickness = 2*log(FOV + 0.25)/(1.2*maxFOV - (FOV + 0.25)) + 0.01;
+	if (FOV <= 0.5)
+	{
+		thickness = 0.013 * FOV; // decreasing faster
+	}
+	else if (FOV > 100.0)
+	{
+		thickness = 0; // remove prism
+	}
+	const float bolideSize = thickness*3;
+	const bool drawBolides = bolideSize && bolideTexture;
+
+	// kept between frames to avoid reallocations
+	static QVector<Vec3d> trainVertices, lineVertices, bolideVertices;
+	static QVector<Vec4f> trainColors, lineColors, bolideColors;
+	static QVector<Vec2f> bolideTexCoords;
+	trainVertices.resize(0);
+	trainColors.resize(0);
+	lineVertices.resize(0);
+	lineColors.resize(0);
+	bolideVertices.resize(0);
+	bolideColors.resize(0);
+	bolideTexCoords.resize(0);
+
+	for (int i = 0; i < count; ++i)
+	{
+		const Vec3d& pos = position.at(i);
+		const Vec3f* segmentColor = segmentColors.constData() + i * segments;
+
+		// train (triangular prism)
+		//
+		Vec3d posTrain(pos[0], pos[1], trainZ.at(i));
+		Vec3d posTrainB = posTrain;
+		posTrainB[0] += thickness*0.7;
+		posTrainB[1] += thickness*0.7;
+		Vec3d posTrainL = posTrain;
+		posTrainL[1] -= thickness;
+		Vec3d posTrainR = posTrain;
+		posTrainR[0] -= thickness;
+
+		Vec3d line[segments], edgeB[segments], edgeL[segments], edgeR[segments];
+		Vec4f color[segments];
+		for (int s = 0; s < segments; ++s)
+		{
+			const double height = trainZ.at(i) + s*(pos[2] - trainZ.at(i))/(segments-1);
+			posTrain[2] = posTrainB[2] = posTrainL[2] = posTrainR[2] = height;
+			line[s] = radiantToAltAz(i, posTrain);
+			edgeB[s] = radiantToAltAz(i, posTrainB);
+			edgeL[s] = radiantToAltAz(i, posTrainL);
+			edgeR[s] = radiantToAltAz(i, posTrainR);
+
+			const Vec3f& rgb = segmentColor[s];
+			color[s].set(rgb[0], rgb[1], rgb[2], aptMag.at(i) * ((float) s / (float) (segments-1)));
+		}
+
+		if (thickness)
+		{
+			appendStrip(edgeB, edgeL, color, segments, trainVertices, trainColors);
+			appendStrip(edgeB, edgeR, color, segments, trainVertices, trainColors);
+			appendStrip(edgeL, edgeR, color, segments, trainVertices, trainColors);
+		}
+		for (int s = 0; s + 1 < segments; ++s)
+		{
+			lineVertices << line[s] << line[s+1];
+			lineColors << color[s] << color[s+1];
+		}
+
+		// bolide
+		//
+		if (drawBolides)
+		{
+			const Vec4f bolideColor(1, 1, 1, aptMag.at(i));
+
+			Vec3d topLeft = pos;
+			topLeft[1] -= bolideSize;
+			Vec3d topRight = pos;
+			topRight[0] -= bolideSize;
+			Vec3d bottomRight = pos;
+			bottomRight[1] += bolideSize;
+			Vec3d bottomLeft = pos;
+			bottomLeft[0] += bolideSize;
+			const Vec3d corners[4] = {radiantToAltAz(i, topLeft), radiantToAltAz(i, topRight),
+						  radiantToAltAz(i, bottomRight), radiantToAltAz(i, bottomLeft)};
+			static const Vec2f texCoords[4] = {Vec2f(1.f, 0.f), Vec2f(0.f, 0.f), Vec2f(0.f, 1.f), Vec2f(1.f, 1.f)};
+			static const int fan[6] = {0, 1, 2, 0, 2, 3};
+			for (int k = 0; k < 6; ++k)
+			{
+				bolideVertices << corners[fan[k]];
+				bolideTexCoords << texCoords[fan[k]];
+				bolideColors << bolideColor;
+			}
+		}
+	}
+
+	sPainter.setBlending(true);
+	sPainter.enableClientStates(true, false, true);
+	if (!trainVertices.isEmpty())
+	{
+		sPainter.setColorPointer(4, GL_FLOAT, trainColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, trainVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, trainVertices.size(), 0, true);
+	}
+	sPainter.setColorPointer(4, GL_FLOAT, lineColors.constData());
+	sPainter.setVertexPointer(3, GL_DOUBLE, lineVertices.constData());
+	sPainter.drawFromArray(StelPainter::Lines, lineVertices.size(), 0, true);
+
+	if (!bolideVertices.isEmpty())
+	{
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		sPainter.enableClientStates(true, true, true);
+		bolideTexture->bind();
+		sPainter.setTexCoordPointer(2, GL_FLOAT, bolideTexCoords.constData());
+		sPainter.setColorPointer(4, GL_FLOAT, bolideColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, bolideVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, bolideVertices.size(), 0, true);
+	}
+
+	sPainter.setBlending(false);
+	sPainter.enableClientStates(false);
+}
@@ -0,0 +1,134 @@
+/*
+ * Stellarium
+ * Copyright (C) 2013-2015 Marcos Cardinot
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _METEORPOOL_HPP_
+#define _METEORPOOL_HPP_
+
+#include "StelTextureTypes.hpp"
+#include "VecMath.hpp"
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <random>
+
+class StelCore;
+class StelPainter;
+
+#define EARTH_RADIUS 6378.f          //! earth_radius in km
+#define EARTH_RADIUS2 40678884.f     //! earth_radius^2 in km
+#define MAX_ALTITUDE 120.f           //! max meteor altitude in km
+#define MIN_ALTITUDE 80.f            //! min meteor altitude in km
+
+//! @class MeteorRandom
+//! Random number generator of a meteor source.
+//! Each source (a meteor shower, the sporadic meteors) has its own seeded generator,
+//! so that the meteors it produces do not depend on the other users of qrand().
+class MeteorRandom
+{
+public:
+	explicit MeteorRandom(quint32 seed=0) : engine(seed) {}
+
+	//! Restart the sequence.
+	void seed(quint32 seed) { engine.seed(seed); }
+
+	//! Uniformly distributed in [0, 1).
+	//! The distributions of the standard library are not used, as their results differ between implementations.
+	float uniform() { return (engine() >> 8) * (1.f/16777216.f); }
+
+	//! Number of events in an interval during which mean events are expected (Poisson distribution).
+	int poisson(float mean);
+
+private:
+	std::mt19937 engine;
+};
+
+//! @class MeteorPool
+//! The meteors of one source, as a particle system of fixed capacity.
+//! The state of the meteors is kept in one array per property, the alive meteors
+//! being the first size() entries: a meteor which dies is replaced by the last one,
+//! so that nothing is allocated or shifted while meteors come and go.
+//! All the meteors are drawn together, with one call for the trains, one for the
+//! lines along the trains and one for the bolides.
+class MeteorPool
+{
+public:
+	//! <colorName, intensity>
+	typedef QPair<QString, int> ColorPair;
+
+	//! @param capacity the maximum number of meteors alive at the same time.
+	explicit MeteorPool(int capacity);
+
+	//! The number of alive meteors.
+	int size() const { return count; }
+	//! The maximum number of alive meteors. New meteors are ignored when the pool is full.
+	int getCapacity() const { return capacity; }
+	//! Remove all the meteors.
+	void clear() { count = 0; }
+
+	//! Create a meteor coming from the given radiant.
+	//! @param radiantAlpha, radiantDelta the radiant in J2000 equatorial coordinates [rad].
+	//! @param speed the meteor speed in km/s.
+	//! @param colors the colors of the meteor train, with their share in percents.
+	//! @param pidx the population index, usually between 2 and 4 (0 to ignore).
+	//! @return false if the meteor would not be visible (or the pool is full), in which case it is not created.
+	bool spawn(const StelCore* core, float radiantAlpha, float radiantDelta, float speed,
+		   const QList<ColorPair>& colors, float pidx, MeteorRandom& rng);
+
+	//! Move the meteors and expire the ones which are not visible anymore.
+	//! @param deltaTime the time increment in seconds since the last call.
+	void update(const StelCore* core, double deltaTime);
+
+	//! Draw all the meteors. The projector of the painter must be in the alt-az frame.
+	void draw(const StelCore* core, StelPainter& sPainter, const StelTextureSP& bolideTexture) const;
+
+private:
+	//! Number of segments along the train (useful to curve along projection distortions)
+	static const int segments = 10;
+
+	//! Get RGB from color name
+	static Vec3f getColorFromName(const QString& colorName);
+	//! Fill the colors of the train segments of meteor i.
+	void buildColors(int i, const QList<ColorPair>& colors, MeteorRandom& rng);
+	//! Calculates the z-component of a meteor as a function of meteor zenith angle
+	static float meteorZ(float zenithAngle, float altitude);
+	//! Find the position of meteor i in the horizontal coordinate system
+	Vec3d radiantToAltAz(int i, Vec3d position) const;
+	//! Copy meteor from to the entry to.
+	void move(int from, int to);
+
+	int capacity;
+	int count;
+
+	// The properties of the meteors, indexed by meteor
+	QVector<float> speed;                 //! Velocity of meteor in km/s.
+	QVector<Mat4d> matAltAzToRadiant;     //! Rotation matrix to convert from horizontal to radiant coordinate system.
+	QVector<Vec3d> position;              //! Meteor position in radiant coordinate system.
+	QVector<double> trainZ;               //! z-component of the end of the train in radiant coordinate system.
+	QVector<float> initialZ;              //! Initial z-component of the meteor in radiant coordinates.
+	QVector<float> finalZ;                //! Final z-component of the meteor in radiant coordinates.
+	QVector<float> minDist;               //! Shortest distance between meteor and observer.
+	QVector<float> absMag;                //! Absolute magnitude [0, 1]
+	QVector<float> aptMag;                //! Apparent magnitude [0, 1]
+	//! The colors of the train segments, segments entries per meteor.
+	QVector<Vec3f> segmentColors;
+};
+
+#endif // _METEORPOOL_HPP_
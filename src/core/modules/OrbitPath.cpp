@@ -0,0 +1,188 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "OrbitPath.hpp"
+
+#include <QtConcurrent>
+#include <cmath>
+
+const int OrbitPath::minSegments = 64;
+const int OrbitPath::maxSamples = 4096;
+
+// Subdivision depth below one of the minSegments initial segments.
+static const int maxRefineDepth = 8;
+
+OrbitPath::OrbitPath()
+	: startJDE(0.)
+	, endJDE(0.)
+	, sampledTolerance(0.)
+	, hasPending(false)
+	, pendingStartJDE(0.)
+	, pendingEndJDE(0.)
+	, pendingTolerance(0.)
+{
+}
+
+OrbitPath::~OrbitPath()
+{
+	waitForFinished();
+}
+
+void OrbitPath::waitForFinished()
+{
+	if (hasPending)
+		pending.waitForFinished();
+}
+
+void OrbitPath::invalidate()
+{
+	waitForFinished();
+	hasPending = false;
+	samples.clear();
+}
+
+void OrbitPath::collectPending()
+{
+	if (!hasPending || !pending.isFinished())
+		return;
+	samples = pending.result();
+	startJDE = pendingStartJDE;
+	endJDE = pendingEndJDE;
+	sampledTolerance = pendingTolerance;
+	hasPending = false;
+}
+
+void OrbitPath::update(double centerJDE, double halfSpan, double tolerance,
+		       PositionFunc func, void* userData, bool threadSafe)
+{
+	collectPending();
+	if (hasPending || halfSpan<=0.)
+		return;
+
+	const double newStartJDE = centerJDE - halfSpan;
+	const double newEndJDE = centerJDE + halfSpan;
+	const double shift = newStartJDE - startJDE;
+	// The window is not moved for shifts smaller than this.
+	const double granularity = 2.*halfSpan/(4*minSegments);
+
+	const bool needFullSampling = samples.isEmpty()
+			|| std::fabs(shift) >= halfSpan
+			|| std::fabs((endJDE-startJDE) - 2.*halfSpan) > granularity
+			|| tolerance < 0.5*sampledTolerance
+			|| (tolerance > 8.*sampledTolerance && samples.size() > 4*minSegments);
+
+	if (needFullSampling)
+	{
+		if (threadSafe)
+		{
+			SampleRequest request = { newStartJDE, newEndJDE, tolerance, func, userData };
+			pending = QtConcurrent::run(&OrbitPath::sampleRequest, request);
+			pendingStartJDE = newStartJDE;
+			pendingEndJDE = newEndJDE;
+			pendingTolerance = tolerance;
+			hasPending = true;
+		}
+		else
+		{
+			samples = sampleRange(newStartJDE, newEndJDE, tolerance, minSegments, func, userData, true);
+			startJDE = newStartJDE;
+			endJDE = newEndJDE;
+			sampledTolerance = tolerance;
+		}
+		return;
+	}
+
+	if (std::fabs(shift) < granularity)
+		return;
+
+	// Incremental update: keep what is still inside the window (plus one
+	// sample at each end for continuity), sample only the uncovered part.
+	const int segments = qMax(1, (int)std::ceil(minSegments*std::fabs(shift)/(2.*halfSpan)));
+	if (shift > 0.)
+	{
+		int first = 0;
+		while (first+1 < samples.size() && samples.at(first+1).jde <= newStartJDE)
+			++first;
+		samples.remove(0, first);
+		if (samples.last().jde < newEndJDE)
+			samples += sampleRange(samples.last().jde, newEndJDE, sampledTolerance, segments, func, userData, false);
+	}
+	else
+	{
+		int last = samples.size()-1;
+		while (last > 0 && samples.at(last-1).jde >= newEndJDE)
+			--last;
+		samples.resize(last+1);
+		if (samples.first().jde > newStartJDE)
+		{
+			QVector<Sample> head = sampleRange(newStartJDE, samples.first().jde, sampledTolerance, segments, func, userData, true);
+			head.removeLast(); // already there
+			samples = head + samples;
+		}
+	}
+	startJDE = newStartJDE;
+	endJDE = newEndJDE;
+}
+
+OrbitPath::Sample OrbitPath::evaluate(double jde, PositionFunc func, void* userData)
+{
+	Sample s;
+	s.jde = jde;
+	func(jde, s.pos, userData);
+	return s;
+}
+
+QVector<OrbitPath::Sample> OrbitPath::sampleRange(double startJDE, double endJDE, double tolerance, int segments,
+						  PositionFunc func, void* userData, bool includeStart)
+{
+	QVector<Sample> out;
+	out.reserve(4*segments);
+	Sample a = evaluate(startJDE, func, userData);
+	if (includeStart)
+		out << a;
+	for (int i=1; i<=segments; ++i)
+	{
+		Sample b = evaluate(startJDE + (endJDE-startJDE)*i/segments, func, userData);
+		refine(out, a, b, tolerance, 0, func, userData);
+		out << b;
+		a = b;
+	}
+	return out;
+}
+
+void OrbitPath::refine(QVector<Sample>& out, const Sample& a, const Sample& b, double tolerance, int depth,
+		       PositionFunc func, void* userData)
+{
+	if (depth >= maxRefineDepth || out.size() >= maxSamples)
+		return;
+
+	const Sample m = evaluate(0.5*(a.jde+b.jde), func, userData);
+	// Distance of the curve from the chord, relative to the distance from the origin.
+	const double error = (m.pos - (a.pos+b.pos)*0.5).length();
+	if (error <= tolerance*m.pos.length())
+		return;
+
+	refine(out, a, m, tolerance, depth+1, func, userData);
+	out << m;
+	refine(out, m, b, tolerance, depth+1, func, userData);
+}
+
+QVector<OrbitPath::Sample> OrbitPath::sampleRequest(SampleRequest request)
+{
+	return sampleRange(request.startJDE, request.endJDE, request.tolerance, minSegments, request.func, request.userData, true);
+}
@@ -0,0 +1,112 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _ORBITPATH_HPP_
+#define _ORBITPATH_HPP_
+
+#include "VecMath.hpp"
+
+#include <QFuture>
+#include <QVector>
+
+//! @class OrbitPath
+//! Adaptive, cached sampling of an orbit line around a given date.
+//! The line covers the time window [centerJDE-halfSpan, centerJDE+halfSpan].
+//! Instead of evaluating the position at a fixed number of equidistant dates,
+//! segments are subdivided only where the chord deviates from the curve by
+//! more than the tolerance, so that nearly circular orbits need few points
+//! while the perihelion passage of an eccentric orbit gets many.
+//!
+//! Samples are kept between frames. When the window moves, only the newly
+//! uncovered part is sampled. If the position function is thread-safe, a full
+//! resampling (first use, large date jumps, tighter tolerance) is run on the
+//! global thread pool while the previous samples remain available for drawing.
+class OrbitPath
+{
+public:
+	//! Same signature as posFuncType of the Planet class.
+	typedef void (*PositionFunc)(double jde, double* xyz, void* userData);
+
+	struct Sample
+	{
+		double jde;
+		Vec3d pos;
+	};
+
+	OrbitPath();
+	//! Waits for a pending background job.
+	~OrbitPath();
+
+	//! Bring the samples up to date for the given window.
+	//! @param tolerance the largest accepted chord error, as an angle [rad]
+	//! seen from the origin of the coordinate system of the position function.
+	//! @param threadSafe set to true if func may be called from a worker thread.
+	void update(double centerJDE, double halfSpan, double tolerance,
+		    PositionFunc func, void* userData, bool threadSafe);
+
+	//! The current samples, sorted by time. May lag behind the requested window
+	//! by a few frames while a background job is running.
+	const QVector<Sample>& getSamples() const { return samples; }
+
+	//! Discard all samples, e.g. because the orbit elements were changed.
+	void invalidate();
+
+	//! Block until a pending background job is done. Must be called before
+	//! destroying the data passed as userData to update().
+	void waitForFinished();
+
+	//! Smallest number of segments used for a window.
+	static const int minSegments;
+	//! Largest number of samples kept for a window.
+	static const int maxSamples;
+
+private:
+	//! Arguments of a full resampling, bundled for QtConcurrent::run().
+	struct SampleRequest
+	{
+		double startJDE;
+		double endJDE;
+		double tolerance;
+		PositionFunc func;
+		void* userData;
+	};
+	static QVector<Sample> sampleRequest(SampleRequest request);
+
+	//! Adaptively sample [startJDE, endJDE]. The last sample is at endJDE.
+	//! The first one (at startJDE) is only emitted if includeStart is true.
+	static QVector<Sample> sampleRange(double startJDE, double endJDE, double tolerance, int segments,
+					   PositionFunc func, void* userData, bool includeStart);
+	static void refine(QVector<Sample>& out, const Sample& a, const Sample& b, double tolerance, int depth,
+			   PositionFunc func, void* userData);
+	static Sample evaluate(double jde, PositionFunc func, void* userData);
+
+	void collectPending();
+
+	QVector<Sample> samples;
+	double startJDE;
+	double endJDE;
+	double sampledTolerance;
+
+	QFuture<QVector<Sample> > pending;
+	bool hasPending;
+	double pendingStartJDE;
+	double pendingEndJDE;
+	double pendingTolerance;
+};
+
+#endif // _ORBITPATH_HPP_
@@ -0,0 +1,396 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "PhenomenaFinder.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelObserver.hpp"
+#include "StelUtils.hpp"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <cmath>
+#include <limits>
+
+const int PhenomenaFinder::samplesPerPeriod = 40;
+
+// Guards the ephemerides which are not reentrant.
+static QMutex ephemerisMutex;
+// Light time for 1 AU [days]
+static const double lightTimePerAU = AU / (SPEED_OF_LIGHT * 86400.);
+// Precision of the dates of the events [days]
+static const double timeTolerance = 1./86400.;
+// Longest step of the coarse grid [days]
+static const double maxStep = 365.25;
+
+static bool eventLessThan(const PhenomenaFinder::Event& e1, const PhenomenaFinder::Event& e2)
+{
+	return e1.jd < e2.jd;
+}
+
+PhenomenaFinder::PhenomenaFinder(const PlanetP& observer, const PlanetP& object, bool lightTravelTime)
+	: observer(observer)
+	, object(object)
+	, lightTravelTime(lightTravelTime)
+	, topocentric(false)
+	, rhoCosPhi(0.)
+	, rhoSinPhi(0.)
+	, longitude(0.)
+{
+	// Like StelCore, for the location of the current observer only
+	const StelCore* core = StelApp::getInstance().getCore();
+	if (core->getUseTopocentricCoordinates() && observer==core->getCurrentPlanet() && observer->getRadius()>0.)
+	{
+		const Vec3d offset = core->getCurrentObserver()->getTopographicOffsetFromCenter(); // [rho cosPhi', rho sinPhi', phi'_rad]
+		topocentric = true;
+		rhoCosPhi = offset[0];
+		rhoSinPhi = offset[1];
+		longitude = core->getCurrentLocation().longitude;
+		// The orientation of the axis changes little during a search, only the rotation is followed.
+		rotEquatorialToVsop87 = observer->getRotEquatorialToVsop87();
+	}
+}
+
+QList<PhenomenaFinder::Event> PhenomenaFinder::find(const QList<PlanetP>& targets, double startJD, double stopJD,
+						    double maxSeparation, bool opposition) const
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const double startJDE = startJD + core->computeDeltaT(startJD)/86400.;
+	const double stopJDE = stopJD + core->computeDeltaT(stopJD)/86400.;
+	if (stopJDE <= startJDE)
+		return QList<Event>();
+
+	const Grid grid = makeGrid(startJDE, stopJDE);
+	QList<Job> jobs;
+	for (int i=0; i<targets.size(); ++i)
+	{
+		const PlanetP& p = targets.at(i);
+		if (p.isNull() || p==observer || p==object)
+			continue;
+		Job job;
+		job.finder = this;
+		job.grid = &grid;
+		job.target = i;
+		job.planet = p;
+		job.stopJDE = stopJDE;
+		job.deltaT = startJDE - startJD;
+		job.maxSeparation = maxSeparation;
+		job.opposition = opposition;
+		jobs.append(job);
+	}
+	return run(jobs);
+}
+
+QList<PhenomenaFinder::Event> PhenomenaFinder::find(const QList<FixedTarget>& targets, double startJD, double stopJD,
+						    double maxSeparation) const
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const double startJDE = startJD + core->computeDeltaT(startJD)/86400.;
+	const double stopJDE = stopJD + core->computeDeltaT(stopJD)/86400.;
+	if (stopJDE <= startJDE)
+		return QList<Event>();
+
+	const Grid grid = makeGrid(startJDE, stopJDE);
+	QList<Job> jobs;
+	for (int i=0; i<targets.size(); ++i)
+	{
+		Job job;
+		job.finder = this;
+		job.grid = &grid;
+		job.target = i;
+		// The positions of the bodies are in VSOP87 coordinates.
+		job.fixed = targets.at(i);
+		job.fixed.startPos = StelCore::matJ2000ToVsop87.multiplyWithoutTranslation(job.fixed.startPos);
+		job.fixed.stopPos = StelCore::matJ2000ToVsop87.multiplyWithoutTranslation(job.fixed.stopPos);
+		job.stopJDE = stopJDE;
+		job.deltaT = startJDE - startJD;
+		job.maxSeparation = maxSeparation;
+		job.opposition = false;
+		jobs.append(job);
+	}
+	return run(jobs);
+}
+
+QList<PhenomenaFinder::Event> PhenomenaFinder::run(const QList<Job>& jobs) const
+{
+	QFuture<QList<Event> > future = QtConcurrent::mapped(jobs, &PhenomenaFinder::searchTarget);
+	future.waitForFinished();
+
+	StelCore* core = StelApp::getInstance().getCore();
+	QList<Event> events;
+	foreach (const QList<Event>& targetEvents, future.results())
+	{
+		foreach (Event event, targetEvents)
+		{
+			// event.jd is a JDE so far
+			event.jd -= core->computeDeltaT(event.jd)/86400.;
+			events.append(event);
+		}
+	}
+	qSort(events.begin(), events.end(), eventLessThan);
+	return events;
+}
+
+PhenomenaFinder::Grid PhenomenaFinder::makeGrid(double startJDE, double stopJDE) const
+{
+	// The observer and the object set the step. Faster targets get
+	// intermediate samples in searchTarget().
+	double shortestPeriod = std::numeric_limits<double>::max();
+	if (observer->getSiderealPeriod()>0.)
+		shortestPeriod = qMin(shortestPeriod, observer->getSiderealPeriod());
+	if (object->getSiderealPeriod()>0.)
+		shortestPeriod = qMin(shortestPeriod, object->getSiderealPeriod());
+
+	double step = qMin(shortestPeriod/samplesPerPeriod, maxStep);
+	step = qMin(step, (stopJDE - startJDE)/12.);
+	const int count = static_cast<int>(std::ceil((stopJDE - startJDE)/step)) + 1;
+
+	Grid grid;
+	grid.startJDE = startJDE;
+	grid.step = (stopJDE - startJDE)/(count - 1);
+	grid.observerPos.resize(count);
+	grid.objectPos.resize(count);
+	for (int i=0; i<count; ++i)
+	{
+		const double jde = startJDE + i*grid.step;
+		grid.observerPos[i] = position(observer.data(), jde);
+		grid.objectPos[i] = position(object.data(), jde) - grid.observerPos[i];
+	}
+	return grid;
+}
+
+QList<PhenomenaFinder::Event> PhenomenaFinder::searchTarget(const Job& job)
+{
+	const PhenomenaFinder& finder = *job.finder;
+	const Grid& grid = *job.grid;
+	QList<Event> events;
+
+	// subdivide the grid for targets which move faster than the object
+	int subdivision = 1;
+	if (job.planet && job.planet->getSiderealPeriod()>0.)
+		subdivision = qMax(1, static_cast<int>(std::ceil(grid.step*samplesPerPeriod/job.planet->getSiderealPeriod())));
+	const double step = grid.step/subdivision;
+	const int count = (grid.observerPos.size() - 1)*subdivision + 1;
+
+	double f0 = 0., f1 = 0.;
+	for (int i=0; i<count; ++i)
+	{
+		// Coarse samples are seen from the center of the planet and not corrected for light time.
+		const double jde = grid.startJDE + i*step;
+		Vec3d observerPos, objectPos;
+		if (i % subdivision == 0)
+		{
+			observerPos = grid.observerPos.at(i/subdivision);
+			objectPos = grid.objectPos.at(i/subdivision);
+		}
+		else
+		{
+			observerPos = position(finder.observer.data(), jde);
+			objectPos = position(finder.object.data(), jde) - observerPos;
+		}
+		Vec3d targetPos;
+		if (job.planet)
+			targetPos = position(job.planet.data(), jde) - observerPos;
+		else
+			targetPos = finder.targetPosition(job, jde, observerPos);
+		double f2 = objectPos.angle(targetPos);
+		if (job.opposition)
+			f2 = M_PI - f2;
+
+		if (i>=2 && f1<=f0 && f1<f2)
+		{
+			double separation;
+			const double jdeMin = finder.minimize(job, jde - 2.*step, jde - step, jde, &separation);
+			if (separation < job.maxSeparation)
+			{
+				Event event;
+				event.type = finder.classify(job, jdeMin, separation);
+				event.target = job.target;
+				event.jd = jdeMin;
+				event.separation = job.opposition ? M_PI - separation : separation;
+				events.append(event);
+			}
+		}
+		f0 = f1;
+		f1 = f2;
+	}
+	return events;
+}
+
+Vec3d PhenomenaFinder::position(const Planet* planet, double jde)
+{
+	if (planet->hasThreadSafePosition())
+		return planet->computeHeliocentricEclipticPos(jde);
+	QMutexLocker locker(&ephemerisMutex);
+	return planet->computeHeliocentricEclipticPos(jde);
+}
+
+Vec3d PhenomenaFinder::observerPosition(const Job& job, double jde) const
+{
+	const Vec3d center = position(observer.data(), jde);
+	if (!topocentric)
+		return center;
+	double siderealTime;
+	{
+		// The sidereal time of the Earth uses the cached nutation
+		QMutexLocker locker(&ephemerisMutex);
+		siderealTime = observer->getSiderealTime(jde - job.deltaT, jde);
+	}
+	const double theta = (siderealTime + longitude)*M_PI/180.;
+	const Vec3d offset(rhoCosPhi*std::cos(theta), rhoCosPhi*std::sin(theta), rhoSinPhi);
+	return center + rotEquatorialToVsop87.multiplyWithoutTranslation(offset);
+}
+
+Vec3d PhenomenaFinder::apparentPosition(const Planet* planet, double jde, const Vec3d& observerPos) const
+{
+	if (!planet->getParent())
+	{
+		// The Sun: same approximation as SolarSystem::computePositions()
+		if (lightTravelTime)
+		{
+			const Vec3d center = position(observer.data(), jde);
+			return center - observerPos - position(observer.data(), jde - observerPos.length()*lightTimePerAU);
+		}
+		return -observerPos;
+	}
+	Vec3d pos = position(planet, jde) - observerPos;
+	if (lightTravelTime)
+		pos = position(planet, jde - pos.length()*lightTimePerAU) - observerPos;
+	return pos;
+}
+
+Vec3d PhenomenaFinder::targetPosition(const Job& job, double jde, const Vec3d& observerPos) const
+{
+	if (job.planet)
+		return apparentPosition(job.planet.data(), jde, observerPos);
+	const double f = qBound(0., (jde - job.grid->startJDE)/(job.stopJDE - job.grid->startJDE), 1.);
+	return job.fixed.startPos*(1.-f) + job.fixed.stopPos*f;
+}
+
+double PhenomenaFinder::separation(const Job& job, double jde) const
+{
+	const Vec3d observerPos = observerPosition(job, jde);
+	const double angle = apparentPosition(object.data(), jde, observerPos).angle(targetPosition(job, jde, observerPos));
+	return job.opposition ? M_PI - angle : angle;
+}
+
+double PhenomenaFinder::minimize(const Job& job, double a, double x, double b, double* fmin) const
+{
+	// Brent's method (parabolic interpolation with golden section fallback).
+	// Abscissae are relative to the initial x, Julian Days are too large for
+	// the relative tolerance of the textbook version.
+	static const double cgold = 0.3819660112501051;
+	const double origin = x;
+	a -= origin;
+	b -= origin;
+	double v = 0., w = 0., u = 0.;
+	x = 0.;
+	double fx = separation(job, origin);
+	double fv = fx, fw = fx;
+	double d = 0., e = 0.;
+	for (int iter=0; iter<100; ++iter)
+	{
+		const double xm = 0.5*(a + b);
+		const double tol1 = timeTolerance;
+		const double tol2 = 2.*tol1;
+		if (std::fabs(x - xm) <= tol2 - 0.5*(b - a))
+			break;
+		bool golden = true;
+		if (std::fabs(e) > tol1)
+		{
+			double r = (x - w)*(fx - fv);
+			double q = (x - v)*(fx - fw);
+			double p = (x - v)*q - (x - w)*r;
+			q = 2.*(q - r);
+			if (q > 0.)
+				p = -p;
+			q = std::fabs(q);
+			const double etemp = e;
+			e = d;
+			if (std::fabs(p) < std::fabs(0.5*q*etemp) && p > q*(a - x) && p < q*(b - x))
+			{
+				d = p/q;
+				u = x + d;
+				if (u - a < tol2 || b - u < tol2)
+					d = xm >= x ? tol1 : -tol1;
+				golden = false;
+			}
+		}
+		if (golden)
+		{
+			e = x >= xm ? a - x : b - x;
+			d = cgold*e;
+		}
+		u = std::fabs(d) >= tol1 ? x + d : x + (d >= 0. ? tol1 : -tol1);
+		const double fu = separation(job, origin + u);
+		if (fu <= fx)
+		{
+			if (u >= x)
+				a = x;
+			else
+				b = x;
+			v = w; fv = fw;
+			w = x; fw = fx;
+			x = u; fx = fu;
+		}
+		else
+		{
+			if (u < x)
+				a = u;
+			else
+				b = u;
+			if (fu <= fw || w == x)
+			{
+				v = w; fv = fw;
+				w = u; fw = fu;
+			}
+			else if (fu <= fv || v == x || v == w)
+			{
+				v = u; fv = fu;
+			}
+		}
+	}
+	*fmin = fx;
+	return origin + x;
+}
+
+PhenomenaFinder::EventType PhenomenaFinder::classify(const Job& job, double jde, double separation) const
+{
+	if (job.opposition)
+		return Opposition;
+
+	const Vec3d observerPos = observerPosition(job, jde);
+	const double d1 = apparentPosition(object.data(), jde, observerPos).length();
+	const double s1 = std::atan2(object->getRadius(), d1);
+	if (!job.planet)
+		return (separation < s1 || separation < job.fixed.angularRadius) ? Occultation : Conjunction;
+
+	const double d2 = apparentPosition(job.planet.data(), jde, observerPos).length();
+	const double s2 = std::atan2(job.planet->getRadius(), d2);
+	if (separation >= s1 && separation >= s2)
+		return Conjunction;
+
+	// Bodies of about the same apparent size (within 0.05 degrees), one of them the Sun.
+	if (std::fabs(s1-s2) <= 0.05*M_PI/180. && (object->getEnglishName()=="Sun" || job.planet->getEnglishName()=="Sun"))
+		return Eclipse;
+	// the nearer body is the smaller one
+	if ((d1<d2 && s1<=s2) || (d1>d2 && s1>s2))
+		return Transit;
+	return Occultation;
+}
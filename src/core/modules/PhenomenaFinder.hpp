@@ -0,0 +1,150 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _PHENOMENAFINDER_HPP_
+#define _PHENOMENAFINDER_HPP_
+
+#include "Planet.hpp"
+#include "VecMath.hpp"
+
+#include <QList>
+#include <QVector>
+
+//! @class PhenomenaFinder
+//! Search of conjunctions, oppositions and occultations of a solar system
+//! body with other objects, as seen by the observer. When StelCore uses
+//! topocentric coordinates, the position of the observer on the surface of the
+//! planet is taken into account, e.g. for the parallax of the Moon. Otherwise
+//! the phenomena are seen from the center of the planet.
+//!
+//! The angular separation is tabulated on a coarse grid, fine enough to
+//! separate two consecutive close approaches of the fastest body involved.
+//! Each local minimum (maximum for oppositions) is then refined with
+//! Brent's method, with the topocentric and light time corrections if requested.
+//! Positions come directly from the ephemerides of the bodies involved,
+//! so neither the time nor the state of StelCore and SolarSystem are changed.
+//!
+//! The targets are processed in parallel on the global thread pool. The
+//! theories of the major planets and their moons keep static caches, so their
+//! evaluation is serialized; this is safe because find() blocks the calling
+//! (main) thread until the search is done.
+class PhenomenaFinder
+{
+public:
+	enum EventType
+	{
+		Conjunction,
+		Opposition,
+		Occultation,
+		Transit,
+		Eclipse
+	};
+
+	struct Event
+	{
+		EventType type;
+		int target;          //!< index of the other object in the list given to find()
+		double jd;           //!< UT Julian Day
+		double separation;   //!< [rad]
+	};
+
+	//! An object with a fixed direction, like a star or a deep-sky object.
+	//! The direction is interpolated linearly between the start and the stop date,
+	//! which takes care of the proper motion of stars.
+	struct FixedTarget
+	{
+		Vec3d startPos;          //!< J2000 equatorial direction at the start date
+		Vec3d stopPos;           //!< J2000 equatorial direction at the stop date
+		double angularRadius;    //!< [rad]
+	};
+
+	//! @param observer the planet of the observer
+	//! @param object the body for which phenomena are searched
+	//! @param lightTravelTime whether positions are corrected for light time
+	PhenomenaFinder(const PlanetP& observer, const PlanetP& object, bool lightTravelTime);
+
+	//! Find the conjunctions (oppositions if opposition is true) of the object
+	//! with each of the targets between startJD and stopJD (UT).
+	//! @param maxSeparation the largest separation (from 180 degrees for oppositions) reported [rad]
+	//! @return the events sorted by date
+	QList<Event> find(const QList<PlanetP>& targets, double startJD, double stopJD,
+			  double maxSeparation, bool opposition) const;
+	//! Find the conjunctions of the object with fixed targets.
+	QList<Event> find(const QList<FixedTarget>& targets, double startJD, double stopJD, double maxSeparation) const;
+
+	//! Number of coarse samples per orbital period of the fastest body involved.
+	static const int samplesPerPeriod;
+
+private:
+	//! The coarse grid, shared by all targets.
+	struct Grid
+	{
+		double startJDE;
+		double step;
+		QVector<Vec3d> observerPos;   // heliocentric, no light time
+		QVector<Vec3d> objectPos;     // relative to the observer, no light time
+	};
+
+	//! Work item of one target, for QtConcurrent::mapped().
+	struct Job
+	{
+		const PhenomenaFinder* finder;
+		const Grid* grid;
+		int target;
+		PlanetP planet;           // null for fixed targets
+		FixedTarget fixed;        // in VSOP87 coordinates
+		double stopJDE;
+		double deltaT;            // [days] at the start, for the rotation of the observer's planet
+		double maxSeparation;
+		bool opposition;
+	};
+
+	static QList<Event> searchTarget(const Job& job);
+	//! Process the jobs in parallel and collect the events.
+	QList<Event> run(const QList<Job>& jobs) const;
+	//! Fill the grid for [startJDE, stopJDE], with the step adapted to the
+	//! orbital periods of the observer's planet and of the object.
+	Grid makeGrid(double startJDE, double stopJDE) const;
+
+	//! Heliocentric position, locking the ephemerides if needed.
+	static Vec3d position(const Planet* planet, double jde);
+	//! Heliocentric position of the observer, on the surface of the planet if topocentric.
+	Vec3d observerPosition(const Job& job, double jde) const;
+	//! Position of the planet relative to the observer, light time corrected if requested.
+	Vec3d apparentPosition(const Planet* planet, double jde, const Vec3d& observerPos) const;
+	//! Direction of the target relative to the observer at jde.
+	Vec3d targetPosition(const Job& job, double jde, const Vec3d& observerPos) const;
+	//! The function to minimize: the separation, or its supplement for oppositions.
+	double separation(const Job& job, double jde) const;
+	//! Brent's minimization of separation() in [a, b], with the best coarse sample at x.
+	double minimize(const Job& job, double a, double x, double b, double* fmin) const;
+	EventType classify(const Job& job, double jde, double separation) const;
+
+	PlanetP observer;
+	PlanetP object;
+	bool lightTravelTime;
+	//! Whether the observer is on the surface of the planet
+	bool topocentric;
+	//! Position of the observer in the equatorial frame of the planet, at longitude 0 [AU]
+	double rhoCosPhi, rhoSinPhi;
+	//! Longitude of the observer [degrees]
+	double longitude;
+	Mat4d rotEquatorialToVsop87;
+};
+
+#endif // _PHENOMENAFINDER_HPP_
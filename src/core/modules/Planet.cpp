@@ -184,10 +184,12 @@ Planet::Planet(const QString& englishName,
 	       const QString& pTypeStr)
 	: flagNativeName(true),
 	  flagTranslatedName(true),
+	  orbitPathFunc(coordFunc),
+	  orbitPathThreadSafe(false),
+	  orbitPathTolerance(4e-5),
 	  lastOrbitJDE(0.0),
 	  deltaJDE(StelCore::JD_SECOND),
 	  deltaOrbitJDE(0.0),
-	  orbitCached(false),
 	  closeOrbit(acloseOrbit),
 	  englishName(englishName),
 	  nameI18(englishName),
@@ -684,6 +686,7 @@ void Planet::setRotationElements(float _period, float _offset, double _epoch, fl
 	re.siderealPeriod = _siderealPeriod;  // used for drawing orbit lines
 
 	deltaOrbitJDE = re.siderealPeriod/ORBIT_SEGMENTS;
+	orbitPath.invalidate();
 }
 
 Vec3d Planet::getJ2000EquatorialPos(const StelCore *core) const
@@ -779,130 +782,37 @@ void Planet::computePosition(const double dateJDE)
 	if (parent)
 		parent->computePositionWithoutOrbits(dateJDE);
 
-	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJDE > 0 && (fabs(lastOrbitJDE-dateJDE)>deltaOrbitJDE || !orbitCached))
+	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJDE > 0)
 	{
-		StelCore *core=StelApp::getInstance().getCore();
-
-		double calc_date;
-		// int delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		int delta_points;
-
-		if( dateJDE > lastOrbitJDE )
-		{
-			delta_points = (int)(0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		else
-		{
-			delta_points = (int)(-0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		double new_date = lastOrbitJDE + delta_points*deltaOrbitJDE;
-
-		// qDebug( "Updating orbit coordinates for %s (delta %f) (%d points)\n", getEnglishName().toUtf8().data(), deltaOrbitJDE, delta_points);
-
-		if( delta_points > 0 && delta_points < ORBIT_SEGMENTS && orbitCached)
-		{
-
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				if(d + delta_points >= ORBIT_SEGMENTS-1 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-
-					// date increments between points will not be completely constant though
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc)
-					{
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJDE = new_date;
-		}
-		else if( delta_points < 0 && abs(delta_points) < ORBIT_SEGMENTS  && orbitCached)
-		{
-
-			for( int d=ORBIT_SEGMENTS-1; d>=0; d-- )
-			{
-				if(d + delta_points < 0 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc) {
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJDE = new_date;
-
-		}
-		else if( delta_points || !orbitCached)
+		// The orbit line is kept in parent coordinates, so it only has to be
+		// resampled when the time window moves, not when the parent moves.
+		if (osculatingFunc)
 		{
-
-			// update all points (less efficient)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
+			// The elements depend on the date: resample the whole line with
+			// the elements of the current date after a noticeable change only.
+			if (fabs(lastOrbitJDE-dateJDE)>deltaOrbitJDE || orbitPath.getSamples().isEmpty())
 			{
-				calc_date = dateJDE + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-				computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-				if (osculatingFunc)
-				{
-					(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-				}
-				else
-				{
-					coordFunc(calc_date, eclipticPos, orbitPtr);
-				}
-				orbitP[d] = eclipticPos;
-				orbit[d] = getHeliocentricEclipticPos();
+				orbitPath.invalidate();
+				lastOrbitJDE = dateJDE;
+				orbitPath.update(dateJDE, 0.5*re.siderealPeriod, orbitPathTolerance, &Planet::osculatingOrbitPathFunc, this, false);
 			}
-
-			lastOrbitJDE = dateJDE;
-			if (!osculatingFunc) orbitCached = 1;
 		}
-
-
-		// calculate actual Planet position
-		coordFunc(dateJDE, eclipticPos, orbitPtr);
-
-		lastJDE = dateJDE;
-
+		else
+			orbitPath.update(dateJDE, 0.5*re.siderealPeriod, orbitPathTolerance, orbitPathFunc, orbitPtr, orbitPathThreadSafe);
 	}
-	else if (fabs(lastJDE-dateJDE)>deltaJDE)
+
+	if (fabs(lastJDE-dateJDE)>deltaJDE)
 	{
 		// calculate actual Planet position
 		coordFunc(dateJDE, eclipticPos, orbitPtr);
-		if (orbitFader.getInterstate()>0.000001)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-				orbit[d]=getHeliocentricPos(orbitP[d]);
 		lastJDE = dateJDE;
 	}
+}
 
+void Planet::osculatingOrbitPathFunc(double jde, double* xyz, void* planet)
+{
+	Planet* p = static_cast<Planet*>(planet);
+	(*p->osculatingFunc)(p->lastOrbitJDE, jde, xyz);
 }
 
 // Compute the transformation matrix from the local Planet coordinate system to the parent Planet coordinate system.
@@ -1095,6 +1005,25 @@ void Planet::setHeliocentricEclipticPos(const Vec3d &pos)
 	}
 }
 
+Vec3d Planet::computeHeliocentricEclipticPos(double dateJDE) const
+{
+	// The root of the hierarchy (the Sun) is the origin.
+	if (!parent)
+		return Vec3d(0.);
+	Vec3d pos = eclipticPos;
+	// the transitional ArtificialPlanet has no position function
+	if (orbitPathFunc)
+		orbitPathFunc(dateJDE, pos, orbitPtr);
+	return pos + parent->computeHeliocentricEclipticPos(dateJDE);
+}
+
+bool Planet::hasThreadSafePosition() const
+{
+	if (!parent)
+		return true;
+	return (orbitPathThreadSafe || !orbitPathFunc) && parent->hasThreadSafePosition();
+}
+
 // Compute the distance to the given position in heliocentric coordinate (in AU)
 // This is called by SolarSystem::draw()
 double Planet::computeDistance(const Vec3d& obsHelioPos)
@@ -3028,22 +2957,48 @@ void Planet::drawOrbit(const StelCore* core)
 
 	// Normal transparency mode
 	sPainter.setBlending(true);
+	// Smoothed by the wide line shader, which costs about the same as aliased lines
+	sPainter.setLineSmooth(true);
 
 	Vec3f orbColor = getCurrentOrbitColor();
 
 	sPainter.setColor(orbColor[0], orbColor[1], orbColor[2], orbitFader.getInterstate());
+
+	// Adapt the sampling tolerance for the next update to about half a pixel
+	// at the distance of the planet. When the observer is much closer to the
+	// planet than its parent is, the line must be finer than seen from the parent.
+	const double distanceRatio = eclipticPos.length()>0. ? (getHeliocentricEclipticPos()-core->getObserverHeliocentricEclipticPos()).length()/eclipticPos.length() : 1.;
+	orbitPathTolerance = qBound(1e-6, 0.5/prj->getPixelPerRadAtCenter()*qBound(0.05, distanceRatio, 1.0), 1e-3);
+
+	const QVector<OrbitPath::Sample>& samples = orbitPath.getSamples();
+	if (samples.size()<2)
+		return;
+
+	// The samples are relative to the parent. Special case: the current Planet
+	// position is inserted so that it is drawn on its orbit all the time.
+	const Vec3d offset = getHeliocentricPos(Vec3d(0.));
+	QVector<Vec3d> orbit;
+	orbit.reserve(samples.size()+2);
+	bool currentPosInserted = false;
+	foreach (const OrbitPath::Sample& sample, samples)
+	{
+		if (!currentPosInserted && sample.jde>lastJDE)
+		{
+			if (!orbit.isEmpty())
+				orbit << getHeliocentricEclipticPos();
+			currentPosInserted = true;
+		}
+		orbit << sample.pos+offset;
+	}
+	if (closeOrbit)
+		orbit << orbit.first();
+
 	Vec3d onscreen;
-	// special case - use current Planet position as center vertex so that draws
-	// on its orbit all the time (since segmented rather than smooth curve)
-	Vec3d savePos = orbit[ORBIT_SEGMENTS/2];
-	orbit[ORBIT_SEGMENTS/2]=getHeliocentricEclipticPos();
-	orbit[ORBIT_SEGMENTS]=orbit[0];
-	int nbIter = closeOrbit ? ORBIT_SEGMENTS : ORBIT_SEGMENTS-1;
 	QVarLengthArray<float, 1024> vertexArray;
 
 	sPainter.enableClientStates(true, false, false);
 
-	for (int n=0; n<=nbIter; ++n)
+	for (int n=0; n<orbit.size(); ++n)
 	{
 		if (prj->project(orbit[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit[n-1], orbit[n])))
 		{
@@ -3057,7 +3012,6 @@ void Planet::drawOrbit(const StelCore* core)
 			vertexArray.clear();
 		}
 	}
-	orbit[ORBIT_SEGMENTS/2]=savePos;
 	if (!vertexArray.isEmpty())
 	{
 		sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
@@ -27,6 +27,7 @@
 #include "StelFader.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelProjectorType.hpp"
+#include "OrbitPath.hpp"
 
 #include <QString>
 
@@ -294,6 +295,13 @@ public:
 	// Return the heliocentric transformation for local coordinate
 	Vec3d getHeliocentricPos(Vec3d) const;
 	void setHeliocentricEclipticPos(const Vec3d &pos);
+	//! Compute the heliocentric ecliptical position at dateJDE without changing
+	//! the state of this planet or of its parents. No light time correction.
+	//! @see hasThreadSafePosition()
+	Vec3d computeHeliocentricEclipticPos(double dateJDE) const;
+	//! Whether computeHeliocentricEclipticPos() may be called from a worker thread.
+	//! The theories of the major planets and their moons keep static caches.
+	bool hasThreadSafePosition() const;
 
 	// Compute the distance to the given position in heliocentric coordinate (in AU)
 	double computeDistance(const Vec3d& obsHelioPos);
@@ -334,15 +342,18 @@ public:
 	LinearFader orbitFader;
 	// draw orbital path of Planet
 	void drawOrbit(const StelCore*);
-	Vec3d orbit[ORBIT_SEGMENTS+1];  // store heliocentric coordinates for drawing the orbit
-	Vec3d orbitP[ORBIT_SEGMENTS+1]; // store local coordinate for orbit
-	double lastOrbitJDE;
+	OrbitPath orbitPath;            // adaptively sampled orbit line, in the coordinates of the parent
+	posFuncType orbitPathFunc;      // position function for the orbit line. Same as coordFunc unless set by SolarSystem.
+	bool orbitPathThreadSafe;       // whether orbitPathFunc may be evaluated in a worker thread
+	double orbitPathTolerance;      // chord tolerance of the orbit line [rad], adjusted to the view in drawOrbit()
+	double lastOrbitJDE;            // for osculating orbits: date of the elements used for the orbit line
 	double deltaJDE;                // time difference between positional updates.
 	double deltaOrbitJDE;
-	bool orbitCached;               // whether orbit calculations are cached for drawing orbit yet
 	bool closeOrbit;                // whether to connect the beginning of the orbit line to
 					// the end: good for elliptical orbits, bad for parabolic
 					// and hyperbolic orbits
+	//! Orbit line position function for osculating orbits. userData is the Planet.
+	static void osculatingOrbitPathFunc(double jde, double* xyz, void* planet);
 
 	static Vec3f orbitColor;
 	static void setOrbitColor(const Vec3f& oc) {orbitColor = oc;}
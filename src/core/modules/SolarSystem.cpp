@@ -35,6 +35,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelIniParser.hpp"
 #include "Planet.hpp"
+#include "PhenomenaFinder.hpp"
 #include "MinorPlanet.hpp"
 #include "Comet.hpp"
 #include "StelMainView.hpp"
@@ -99,6 +100,9 @@ SolarSystem::~SolarSystem()
 {
 	// release selected:
 	selected.clear();
+	// orbit lines may still be sampled in the background
+	foreach (const PlanetP& p, systemPlanets)
+		p->orbitPath.waitForFinished();
 	foreach (Orbit* orb, orbits)
 	{
 		delete orb;
@@ -399,6 +403,12 @@ void cometOrbitPosFunc(double jd,double xyz[3], void* userDataPtr)
 {
 	static_cast<CometOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
 }
+// Same as cometOrbitPosFunc, but leaves the velocity of the comet alone,
+// so that orbit lines can be sampled in a worker thread.
+void cometOrbitPathPosFunc(double jd,double xyz[3], void* userDataPtr)
+{
+	static_cast<CometOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz, false);
+}
 
 // Init and load the solar system data (2 files)
 void SolarSystem::loadPlanets()
@@ -1105,6 +1115,16 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		}
 
 
+		// Positions on Keplerian orbits can be computed in worker threads
+		// (orbit lines, phenomena). The Sun is fixed at the origin.
+		if (posfunc==&ellipticalOrbitPosFunc || posfunc==&get_sun_helio_coordsv)
+			p->orbitPathThreadSafe = true;
+		else if (posfunc==&cometOrbitPosFunc)
+		{
+			p->orbitPathFunc = &cometOrbitPathPosFunc;
+			p->orbitPathThreadSafe = true;
+		}
+
 		if (!parent.isNull())
 		{
 			parent->satellites.append(p);
@@ -1455,6 +1475,34 @@ float SolarSystem::getPhaseForPlanet(QString planetName) const
 	return r;
 }
 
+QVariantList SolarSystem::findPhenomena(QString planetName, QString otherName, double startJD, double stopJD,
+					double maxSeparation, bool opposition) const
+{
+	QVariantList r;
+	PlanetP p1 = searchByEnglishName(planetName);
+	if (p1.isNull()) // Possible was asked the common name of minor planet?
+		p1 = searchMinorPlanetByEnglishName(planetName);
+	PlanetP p2 = searchByEnglishName(otherName);
+	if (p2.isNull())
+		p2 = searchMinorPlanetByEnglishName(otherName);
+	if (p1.isNull() || p2.isNull())
+		return r;
+
+	static const char* types[] = { "Conjunction", "Opposition", "Occultation", "Transit", "Eclipse" };
+	PhenomenaFinder finder(StelApp::getInstance().getCore()->getCurrentPlanet(), p1, flagLightTravelTime);
+	QList<PhenomenaFinder::Event> events = finder.find(QList<PlanetP>() << p2, startJD, stopJD,
+							   maxSeparation*M_PI/180., opposition);
+	foreach (const PhenomenaFinder::Event& event, events)
+	{
+		QVariantMap map;
+		map.insert("type", types[event.type]);
+		map.insert("jd", event.jd);
+		map.insert("separation", event.separation*180./M_PI);
+		r.append(map);
+	}
+	return r;
+}
+
 QStringList SolarSystem::getObjectsList(QString objType) const
 {
 	QStringList r;
@@ -2229,6 +2277,9 @@ void SolarSystem::reloadPlanets()
 	selected.clear();//Release the selected one
 
 	// GZ TODO in case this methods gets converted to only reload minor bodies: Only delete Orbits which are not referenced by some Planet.
+	// orbit lines may still be sampled in the background
+	foreach (const PlanetP& p, systemPlanets)
+		p->orbitPath.waitForFinished();
 	foreach (Orbit* orb, orbits)
 	{
 		delete orb;
@@ -694,6 +694,18 @@ public slots:
 	//! @return a phase
 	float getPhaseForPlanet(QString planetName) const;
 
+	//! Find conjunctions, occultations and oppositions of two Solar system bodies
+	//! as seen from the current planet, e.g. from scripts. The time of the program is not changed.
+	//! @param planetName, otherName the case in-sensistive English names of the bodies.
+	//! @param startJD, stopJD the time window (UT)
+	//! @param maxSeparation the largest separation reported (in degrees). For oppositions,
+	//! the largest difference to 180 degrees.
+	//! @param opposition search oppositions instead of conjunctions
+	//! @return a list of maps with the keys "type" (Conjunction, Opposition, Occultation,
+	//! Transit or Eclipse), "jd" and "separation" (in degrees), sorted by date.
+	QVariantList findPhenomena(QString planetName, QString otherName, double startJD, double stopJD,
+				   double maxSeparation, bool opposition=false) const;
+
 	//! Set the algorithm for computation of apparent magnitudes for planets in case observer on the Earth.
 	//! Possible values:
 	//! @li @c Mueller1893 [Explanatory Supplement to the Astronomical Ephemeris, 1961] (visual magnitudes, based on visual observations by G. Mueller, 1877-91)
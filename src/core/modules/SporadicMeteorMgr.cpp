@@ -26,11 +26,18 @@
 #include "StelModuleMgr.hpp"
 #include "StelPainter.hpp"
 #include "StelTextureMgr.hpp"
+#include "StelUtils.hpp"
 
+#include <QHash>
 #include <QSettings>
 
+// About 40 meteors per second at the highest ZHR of the GUI, which last a few seconds each
+static const int maxSporadicMeteors = 1024;
+
 SporadicMeteorMgr::SporadicMeteorMgr(int zhr, int maxv)
-	: m_zhr(zhr)
+	: m_meteors(maxSporadicMeteors)
+	, m_rng(qHash(QStringLiteral("SporadicMeteorMgr")))
+	, m_zhr(zhr)
 	, m_maxVelocity(maxv)
 	, m_flagShow(true)
 	, m_flagForcedShow(false)
@@ -40,8 +47,6 @@ SporadicMeteorMgr::SporadicMeteorMgr(int zhr, int maxv)
 
 SporadicMeteorMgr::~SporadicMeteorMgr()
 {
-	qDeleteAll(activeMeteors);
-	activeMeteors.clear();
 	m_bolideTexture.clear();
 }
 
@@ -72,19 +77,11 @@ void SporadicMeteorMgr::update(double deltaTime)
 		return;
 	}
 
-	// step through and update all active meteors
-	foreach (SporadicMeteor* m, activeMeteors)
-	{
-		if (!m->update(deltaTime))
-		{
-			//important to delete when no longer active
-			delete m;
-			activeMeteors.removeOne(m);
-		}
-	}
-
 	StelCore* core = StelApp::getInstance().getCore();
 
+	// update all active meteors
+	m_meteors.update(core, deltaTime);
+
 	// going forward/backward OR current ZHR is zero ?
 	// don't create new meteors
 	if(!core->getRealTimeSpeed() || m_zhr < 1)
@@ -92,30 +89,61 @@ void SporadicMeteorMgr::update(double deltaTime)
 		return;
 	}
 
-	// average meteors per frame
-	float mpf = m_zhr * deltaTime / 3600.f;
+	// number of meteors for the current frame, drawn once from the average meteors per frame
+	const int newMeteors = m_rng.poisson(m_zhr * deltaTime / 3600.f);
+	for (int i = 0; i < newMeteors; ++i)
+	{
+		spawnMeteor(core);
+	}
+}
 
-	// maximum amount of meteors for the current frame
-	int maxMpf = qRound(mpf);
-	maxMpf = maxMpf < 1 ? 1 : maxMpf;
+void SporadicMeteorMgr::spawnMeteor(const StelCore* core)
+{
+	// meteor velocity
+	// (see line 460 in StelApp.cpp)
+	float speed = 11 + (m_maxVelocity - 11) * m_rng.uniform(); // [11, maxVel]
+
+	// select a random radiant in a visible area
+	float rAlt = M_PI_2 * m_rng.uniform();  // [0, pi/2]
+	float rAz = 2 * M_PI * m_rng.uniform();  // [0, 2pi]
+	Vec3d pos;
+	StelUtils::spheToRect(rAz, rAlt, pos);
+
+	// convert to J2000
+	float rAlpha, rDelta;
+	pos = core->altAzToJ2000(pos);
+	StelUtils::rectToSphe(&rAlpha, &rDelta, pos);
+
+	m_meteors.spawn(core, rAlpha, rDelta, speed, getRandColor(), 0.f, m_rng);
+}
 
-	float rate = mpf / (float) maxMpf;
-	for (int i = 0; i < maxMpf; ++i)
+QList<MeteorPool::ColorPair> SporadicMeteorMgr::getRandColor()
+{
+	QList<MeteorPool::ColorPair> colors;
+	float prob = m_rng.uniform();
+	if (prob > 0.9f)
 	{
-		float prob = (float) qrand() / (float) RAND_MAX;
-		if (prob < rate)
-		{
-			SporadicMeteor* m = new SporadicMeteor(core, m_maxVelocity, m_bolideTexture);
-			if (m->isAlive())
-			{
-				activeMeteors.append(m);
-			}
-			else
-			{
-				delete m;
-			}
-		}
+		colors.push_back(MeteorPool::ColorPair("white", 70));
+		colors.push_back(MeteorPool::ColorPair("orangeYellow", 10));
+		colors.push_back(MeteorPool::ColorPair("yellow", 10));
+		colors.push_back(MeteorPool::ColorPair("blueGreen", 10));
 	}
+	else if (prob > 0.85f)
+	{
+		colors.push_back(MeteorPool::ColorPair("white", 80));
+		colors.push_back(MeteorPool::ColorPair("violet", 20));
+	}
+	else if (prob > 0.80f)
+	{
+		colors.push_back(MeteorPool::ColorPair("white", 80));
+		colors.push_back(MeteorPool::ColorPair("orangeYellow", 20));
+	}
+	else
+	{
+		colors.push_back(MeteorPool::ColorPair("white", 100));
+	}
+
+	return colors;
 }
 
 void SporadicMeteorMgr::draw(StelCore* core)
@@ -131,12 +159,14 @@ void SporadicMeteorMgr::draw(StelCore* core)
 		return;
 	}
 
-	// step through and draw all active meteors
-	StelPainter sPainter(core->getProjection(StelCore::FrameAltAz));
-	foreach (SporadicMeteor* m, activeMeteors)
+	if (m_meteors.size() == 0)
 	{
-		m->draw(core, sPainter);
+		return;
 	}
+
+	// draw all active meteors at once
+	StelPainter sPainter(core->getProjection(StelCore::FrameAltAz));
+	m_meteors.draw(core, sPainter, m_bolideTexture);
 }
 
 void SporadicMeteorMgr::setZHR(int zhr)
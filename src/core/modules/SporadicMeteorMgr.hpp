@@ -20,7 +20,7 @@
 #ifndef _SPORADICMETEORMGR_HPP_
 #define _SPORADICMETEORMGR_HPP_
 
-#include "SporadicMeteor.hpp"
+#include "MeteorPool.hpp"
 #include "StelModule.hpp"
 
 //! @class SporadicMeteorMgr
@@ -42,6 +42,7 @@ public:
 	virtual void draw(StelCore* core);
 	virtual void update(double deltaTime);
 	virtual double getCallOrder(StelModuleActionName actionName) const;
+	virtual bool isUpdateConcurrent() const {return true;}
 
 public slots:
 	// Methods callable from script and GUI
@@ -69,7 +70,13 @@ signals:
 	void zhrChanged(int);
 
 private:
-	QList<SporadicMeteor*> activeMeteors;
+	//! Create a meteor with a random color and a random radiant in the visible sky.
+	void spawnMeteor(const StelCore* core);
+	//! Random colors of a sporadic meteor
+	QList<MeteorPool::ColorPair> getRandColor();
+
+	MeteorPool m_meteors;
+	MeteorRandom m_rng;
 	StelTextureSP m_bolideTexture;
 	int m_zhr;
 	int m_maxVelocity;
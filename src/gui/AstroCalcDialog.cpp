@@ -2034,47 +2034,72 @@ void AstroCalcDialog::calculatePhenomena()
 		coordsLimit += separation*M_PI/180;
 		double ra, dec;
 
+		PhenomenaFinder finder(core->getCurrentPlanet(), planet, solarSystem->getFlagLightTravelTime());
+		QStringList names;
 		if (obj2Type<10)
 		{
 			// Solar system objects
-			foreach (PlanetP obj, objects)
-			{
-				// conjunction
-				fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation, false), planet, obj, false);
-				// opposition
-				if (opposition)
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation, true), planet, obj, true);
-			}
+			foreach (const PlanetP& obj, objects)
+				names << obj->getNameI18n();
+			// conjunction
+			fillPhenomenaTable(finder.find(objects, startJD, stopJD, separation*M_PI/180., false), planet, names);
+			// opposition
+			if (opposition)
+				fillPhenomenaTable(finder.find(objects, startJD, stopJD, separation*M_PI/180., true), planet, names);
 		}
-		else if (obj2Type==10 || obj2Type==11 || obj2Type==12)
+		else
 		{
-			// Stars
-			foreach (StelObjectP obj, star)
+			// Stars and deep-sky objects
+			QList<StelObjectP> fixedObjects;
+			if (obj2Type==10 || obj2Type==11 || obj2Type==12)
 			{
-				StelUtils::rectToSphe(&ra, &dec, obj->getEquinoxEquatorialPos(core));
-				// Add limits on coordinates for speed-up calculations
-				if (dec<=coordsLimit && dec>=-coordsLimit)
+				foreach (const StelObjectP& obj, star)
 				{
-					// conjunction
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation), planet, obj);
+					StelUtils::rectToSphe(&ra, &dec, obj->getEquinoxEquatorialPos(core));
+					// Add limits on coordinates for speed-up calculations
+					if (dec<=coordsLimit && dec>=-coordsLimit)
+					{
+						fixedObjects.append(obj);
+						names << obj->getNameI18n();
+					}
 				}
 			}
-		}
-		else
-		{
-			// Deep-sky objects
-			foreach (NebulaP obj, dso)
+			else
 			{
-				StelUtils::rectToSphe(&ra, &dec, obj->getEquinoxEquatorialPos(core));
-				// Add limits on coordinates for speed-up calculations
-				if (dec<=coordsLimit && dec>=-coordsLimit)
+				foreach (const NebulaP& obj, dso)
 				{
-					// conjunction
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation), planet, obj);
+					StelUtils::rectToSphe(&ra, &dec, obj->getEquinoxEquatorialPos(core));
+					// Add limits on coordinates for speed-up calculations
+					if (dec<=coordsLimit && dec>=-coordsLimit)
+					{
+						fixedObjects.append(obj);
+						if (!obj->getNameI18n().isEmpty())
+							names << obj->getNameI18n();
+						else
+							names << obj->getDSODesignation();
+					}
 				}
 			}
-		}
 
+			// The directions are only needed at both ends of the time range (proper motion).
+			QList<PhenomenaFinder::FixedTarget> targets;
+			core->setJD(startJD);
+			core->update(0);
+			foreach (const StelObjectP& obj, fixedObjects)
+			{
+				PhenomenaFinder::FixedTarget target;
+				target.startPos = obj->getJ2000EquatorialPos(core);
+				target.angularRadius = obj->getAngularSize(core)*M_PI/180.;
+				targets.append(target);
+			}
+			core->setJD(stopJD);
+			core->update(0);
+			for (int i=0; i<targets.size(); ++i)
+				targets[i].stopPos = fixedObjects.at(i)->getJ2000EquatorialPos(core);
+
+			// conjunction
+			fillPhenomenaTable(finder.find(targets, startJD, stopJD, separation*M_PI/180.), planet, names);
+		}
 
 		core->setJD(currentJD); // restore time
 		core->update(0);
@@ -2125,497 +2150,48 @@ void AstroCalcDialog::savePhenomena()
 	phenomena.close();
 }
 
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const PlanetP object2, bool opposition)
+void AstroCalcDialog::fillPhenomenaTable(const QList<PhenomenaFinder::Event>& events, const PlanetP object1, const QStringList& names)
 {
-	QMap<double, double>::ConstIterator it;
-	for (it=list.constBegin(); it!=list.constEnd(); ++it)
+	foreach (const PhenomenaFinder::Event& event, events)
 	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
+		QString phenomenType;
 		bool occultation = false;
-		double s1 = object1->getSpheroidAngularSize(core);
-		double s2 = object2->getSpheroidAngularSize(core);
-		if (opposition)
+		switch (event.type)
 		{
-			phenomenType = q_("Opposition");
-			separation += M_PI;
-		}
-		else if (separation<(s2*M_PI/180.) || separation<(s1*M_PI/180.))
-		{
-			double d1 = object1->getJ2000EquatorialPos(core).length();
-			double d2 = object2->getJ2000EquatorialPos(core).length();
-			if ((d1<d2 && s1<=s2) || (d1>d2 && s1>s2))
-				phenomenType = q_("Transit");
-			else
+			case PhenomenaFinder::Conjunction:
+				phenomenType = q_("Conjunction");
+				break;
+			case PhenomenaFinder::Opposition:
+				phenomenType = q_("Opposition");
+				break;
+			case PhenomenaFinder::Occultation:
 				phenomenType = q_("Occultation");
-
-			// Added a special case - eclipse
-			if (qAbs(s1-s2)<=0.05 && (object1->getEnglishName()=="Sun" || object2->getEnglishName()=="Sun")) // 5% error of difference of sizes
+				occultation = true;
+				break;
+			case PhenomenaFinder::Transit:
+				phenomenType = q_("Transit");
+				occultation = true;
+				break;
+			case PhenomenaFinder::Eclipse:
 				phenomenType = q_("Eclipse");
-
-			occultation = true;
-		}
-
-		ACPhenTreeWidgetItem *treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
-		treeItem->setText(PhenomenaType, phenomenType);
-		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole,  it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, QChar(0x2014));
-		else
-			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation));
-	}
-}
-
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, PlanetP &object2, double startJD, double stopJD, double maxSeparation, bool opposition)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD)/12.0;
-	if (step0>24.8*365.25)
-		step0 = 24.8*365.25;
-
-	if (object1->getEnglishName()=="Neptune" || object2->getEnglishName()=="Neptune" || object1->getEnglishName()=="Uranus" || object2->getEnglishName()=="Uranus")
-		if (step0 > 3652.5)
-			step0 = 3652.5;
-	if (object1->getEnglishName()=="Jupiter" || object2->getEnglishName()=="Jupiter" || object1->getEnglishName()=="Saturn" || object2->getEnglishName()=="Saturn")
-		if (step0 > 365.25)
-			step0 = 365.f;
-	if (object1->getEnglishName()=="Mars" || object2->getEnglishName()=="Mars")
-		if (step0 > 10.f)
-			step0 = 10.f;
-	if (object1->getEnglishName()=="Venus" || object2->getEnglishName()=="Venus" || object1->getEnglishName()=="Mercury" || object2->getEnglishName()=="Mercury")
-		if (step0 > 5.f)
-			step0 = 5.f;
-	if (object1->getEnglishName()=="Moon" || object2->getEnglishName()=="Moon")
-		if (step0 > 0.25)
-			step0 = 0.25;
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2, opposition);
-	jd += step;
-	while(jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2, opposition);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist)/dist);
-		if (factor>10.f)
-			step = step0 * factor/10.f;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while(jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2, opposition);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn!=prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn, opposition))
-			{
-				double sep = extremum.second*180./M_PI;
-				if (sep<maxSeparation)
-					separations.insert(extremum.first, extremum.second);
-			}
-
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
-	}
-
-	return separations;
-}
-
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, PlanetP object2, double JD, double step, int prevSign, bool opposition)
-{
-	int sgn;
-	double dist, prevDist;
-
-	if (out==Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2, opposition);
-	step = -step/2.f;
-	prevSign = -prevSign;
-
-	while(true)
-	{
-		JD += step;
-		dist = findDistance(JD, object1, object2, opposition);
-
-		if (qAbs(step)< 1.f/1440.f)
-		{
-			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2, opposition);
-			if (out->second < findDistance(JD - 5.0, object1, object2, opposition))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn!=prevSign)
-		{
-			step = -step/2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
-	}
-}
-
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition)
-{
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	double angle = obj1.angle(obj2);
-	if (opposition)
-		angle = M_PI - angle;
-	return angle;
-}
-
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const NebulaP object2)
-{
-	QMap<double, double>::ConstIterator it;
-	for (it=list.constBegin(); it!=list.constEnd(); ++it)
-	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		if (separation<(object2->getAngularSize(core)*M_PI/180.) || separation<(object1->getSpheroidAngularSize(core)*M_PI/180.))
-		{
-			phenomenType = q_("Occultation");
-			occultation = true;
-		}
-
-		ACPhenTreeWidgetItem *treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
-		treeItem->setText(PhenomenaType, phenomenType);
-		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole, it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		if (!object2->getNameI18n().isEmpty())
-			treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		else
-			treeItem->setText(PhenomenaObject2, object2->getDSODesignation());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, QChar(0x2014));
-		else
-			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation));
-	}
-}
-
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, NebulaP &object2, double startJD, double stopJD, double maxSeparation)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD)/8.0;
-	if (step0>24.8*365.25)
-		step0 = 24.8*365.25;
-
-	if (object1->getEnglishName()=="Neptune" || object1->getEnglishName()=="Uranus")
-		if (step0 > 3652.5)
-			step0 = 3652.5;
-	if (object1->getEnglishName()=="Jupiter" || object1->getEnglishName()=="Saturn")
-		if (step0 > 365.25)
-			step0 = 365.f;
-	if (object1->getEnglishName()=="Mars")
-		if (step0 > 10.f)
-			step0 = 10.f;
-	if (object1->getEnglishName()=="Venus" || object1->getEnglishName()=="Mercury")
-		if (step0 > 5.f)
-			step0 = 5.f;
-	if (object1->getEnglishName()=="Moon")
-		if (step0 > 0.25)
-			step0 = 0.25;
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2);
-	jd += step;
-	while(jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist)/dist);
-		if (factor>10.f)
-			step = step0 * factor/10.f;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while(jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn!=prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn))
-			{
-				double sep = extremum.second*180./M_PI;
-				if (sep<maxSeparation)
-					separations.insert(extremum.first, extremum.second);
-			}
-
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
-	}
-
-	return separations;
-}
-
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign)
-{
-	int sgn;
-	double dist, prevDist;
-
-	if (out==Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2);
-	step = -step/2.f;
-	prevSign = -prevSign;
-
-	while(true)
-	{
-		JD += step;
-		dist = findDistance(JD, object1, object2);
-
-		if (qAbs(step)< 1.f/1440.f)
-		{
-			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2);
-			if (out->second < findDistance(JD - 5.0, object1, object2))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn!=prevSign)
-		{
-			step = -step/2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
-	}
-}
-
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, NebulaP object2)
-{
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	return obj1.angle(obj2);
-}
-
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const StelObjectP object2)
-{
-	QMap<double, double>::ConstIterator it;
-	for (it=list.constBegin(); it!=list.constEnd(); ++it)
-	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		if (separation<(object2->getAngularSize(core)*M_PI/180.) || separation<(object1->getSpheroidAngularSize(core)*M_PI/180.))
-		{
-			phenomenType = q_("Occultation");
-			occultation = true;
+				occultation = true;
+				break;
 		}
 
 		ACPhenTreeWidgetItem *treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
 		treeItem->setText(PhenomenaType, phenomenType);
 		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole, it.key());
+		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(event.jd), localeMgr->getPrintableTimeLocal(event.jd)));
+		treeItem->setData(PhenomenaDate, Qt::UserRole, event.jd);
 		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		treeItem->setText(PhenomenaObject2, object2->getNameI18n());
+		treeItem->setText(PhenomenaObject2, names.at(event.target));
 		if (occultation)
 			treeItem->setText(PhenomenaSeparation, QChar(0x2014));
 		else
-			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation));
+			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(event.separation));
 	}
 }
 
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, StelObjectP &object2, double startJD, double stopJD, double maxSeparation)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD)/8.0;
-	if (step0>24.8*365.25)
-		step0 = 24.8*365.25;
-
-	if (object1->getEnglishName()=="Neptune" || object1->getEnglishName()=="Uranus")
-		if (step0 > 1811.25)
-			step0 = 1811.25;
-	if (object1->getEnglishName()=="Jupiter" || object1->getEnglishName()=="Saturn")
-		if (step0 > 181.125)
-			step0 = 181.125;
-	if (object1->getEnglishName()=="Mars")
-		if (step0 > 5.f)
-			step0 = 5.0;
-	if (object1->getEnglishName()=="Venus" || object1->getEnglishName()=="Mercury")
-		if (step0 > 2.5f)
-			step0 = 2.5;
-	if (object1->getEnglishName()=="Moon")
-		if (step0 > 0.25)
-			step0 = 0.25;
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2);
-	jd += step;
-	while(jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist)/dist);
-		if (factor>10.f)
-			step = step0 * factor/10.f;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while(jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn!=prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn))
-			{
-				double sep = extremum.second*180./M_PI;
-				if (sep<maxSeparation)
-					separations.insert(extremum.first, extremum.second);
-			}
-
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
-	}
-
-	return separations;
-}
-
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, StelObjectP object2, double JD, double step, int prevSign)
-{
-	int sgn;
-	double dist, prevDist;
-
-	if (out==Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2);
-	step = -step/2.f;
-	prevSign = -prevSign;
-
-	while(true)
-	{
-		JD += step;
-		dist = findDistance(JD, object1, object2);
-
-		if (qAbs(step)< 1.f/1440.f)
-		{
-			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2);
-			if (out->second < findDistance(JD - 5.0, object1, object2))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn!=prevSign)
-		{
-			step = -step/2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
-	}
-}
-
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, StelObjectP object2)
-{
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	return obj1.angle(obj2);
-}
-
 void AstroCalcDialog::changePage(QListWidgetItem *current, QListWidgetItem *previous)
 {
 	if (!current)
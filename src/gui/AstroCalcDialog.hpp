@@ -31,6 +31,7 @@
 #include "StelDialog.hpp"
 #include "StelCore.hpp"
 #include "Planet.hpp"
+#include "PhenomenaFinder.hpp"
 #include "SolarSystem.hpp"
 #include "Nebula.hpp"
 #include "NebulaMgr.hpp"
@@ -217,24 +218,9 @@ private:
 
 	void populateFunctionsList();
 
-	//! Calculation conjunctions and oppositions.
-	//! @note Ported from KStars, should be improved, because this feature calculate
-	//! angular separation ("conjunction" defined as equality of right ascension
-	//! of two body) and current solution is not accurate and slow.
-	QMap<double, double> findClosestApproach(PlanetP& object1, PlanetP& object2, double startJD, double stopJD, double maxSeparation, bool opposition);
-	double findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, PlanetP object2, double JD, double step, int prevSign, bool opposition);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const PlanetP object2, bool opposition);
-
-	QMap<double, double> findClosestApproach(PlanetP& object1, NebulaP& object2, double startJD, double stopJD, double maxSeparation);
-	double findDistance(double JD, PlanetP object1, NebulaP object2);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const NebulaP object2);
-
-	QMap<double, double> findClosestApproach(PlanetP& object1, StelObjectP& object2, double startJD, double stopJD, double maxSeparation);
-	double findDistance(double JD, PlanetP object1, StelObjectP object2);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, StelObjectP object2, double JD, double step, int prevSign);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const StelObjectP object2);
+	//! Fill the phenomena table.
+	//! @param names the localized names of the targets of the search
+	void fillPhenomenaTable(const QList<PhenomenaFinder::Event>& events, const PlanetP object1, const QStringList& names);
 
 	QString delimiter, acEndl;
 	QStringList ephemerisHeader, phenomenaHeader, positionsHeader;
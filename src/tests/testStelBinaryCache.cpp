@@ -0,0 +1,135 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelBinaryCache.hpp"
+#include "StelBinaryCache.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+QTEST_GUILESS_MAIN(TestStelBinaryCache)
+
+void TestStelBinaryCache::initTestCase()
+{
+	// don't touch the cache of the user
+	QStandardPaths::setTestModeEnabled(true);
+	cacheDir = StelFileMgr::getCacheDir() + "/binary";
+	QDir(cacheDir).removeRecursively();
+
+	QVariantMap map;
+	map.insert("name", "test");
+	map.insert("values", QVariantList() << 1.5 << -2 << "x");
+	value = map;
+}
+
+void TestStelBinaryCache::cleanupTestCase()
+{
+	QDir(cacheDir).removeRecursively();
+}
+
+QString TestStelBinaryCache::cacheFile() const
+{
+	const QStringList files = QDir(cacheDir).entryList(QDir::Files);
+	return files.size()==1 ? cacheDir + "/" + files.first() : QString();
+}
+
+void TestStelBinaryCache::testRoundTrip()
+{
+	const QByteArray sourceHash = StelBinaryCache::hash("source");
+	StelBinaryCache::save("roundtrip", sourceHash, value);
+	QVariant loaded;
+	QVERIFY(StelBinaryCache::load("roundtrip", sourceHash, loaded));
+	QCOMPARE(loaded, value);
+
+	// a new value replaces the previous one
+	StelBinaryCache::save("roundtrip", sourceHash, QVariant(42));
+	QVERIFY(StelBinaryCache::load("roundtrip", sourceHash, loaded));
+	QCOMPARE(loaded, QVariant(42));
+	QDir(cacheDir).removeRecursively();
+}
+
+void TestStelBinaryCache::testMissing()
+{
+	QVariant loaded;
+	QVERIFY(!StelBinaryCache::load("missing", StelBinaryCache::hash("source"), loaded));
+	QVERIFY(!loaded.isValid());
+}
+
+void TestStelBinaryCache::testStaleSource()
+{
+	StelBinaryCache::save("stale", StelBinaryCache::hash("source"), value);
+	QVariant loaded;
+	QVERIFY(!StelBinaryCache::load("stale", StelBinaryCache::hash("changed source"), loaded));
+	QVERIFY(!loaded.isValid());
+	// another key
+	QVERIFY(!StelBinaryCache::load("other", StelBinaryCache::hash("source"), loaded));
+	QDir(cacheDir).removeRecursively();
+}
+
+void TestStelBinaryCache::testTruncatedFile()
+{
+	const QByteArray sourceHash = StelBinaryCache::hash("source");
+	StelBinaryCache::save("truncated", sourceHash, value);
+	QFile file(cacheFile());
+	QVERIFY(file.exists());
+	QVERIFY(file.resize(file.size()/2));
+
+	QVariant loaded;
+	QVERIFY(!StelBinaryCache::load("truncated", sourceHash, loaded));
+	QVERIFY(!loaded.isValid());
+
+	// only the header left
+	QVERIFY(file.resize(8));
+	QVERIFY(!StelBinaryCache::load("truncated", sourceHash, loaded));
+	QVERIFY(!loaded.isValid());
+	QDir(cacheDir).removeRecursively();
+}
+
+void TestStelBinaryCache::testCorruptFile()
+{
+	const QByteArray sourceHash = StelBinaryCache::hash("source");
+	StelBinaryCache::save("corrupt", sourceHash, value);
+	const QString path = cacheFile();
+	QVERIFY(!path.isEmpty());
+
+	// not a cache file
+	QFile file(path);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(QByteArray(64, '\xff'));
+	file.close();
+	QVariant loaded;
+	QVERIFY(!StelBinaryCache::load("corrupt", sourceHash, loaded));
+	QVERIFY(!loaded.isValid());
+
+	// valid header and hash, garbage instead of the value
+	StelBinaryCache::save("corrupt", sourceHash, value);
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QByteArray data = file.readAll();
+	const int headerSize = 8 + 4 + sourceHash.size();
+	for (int i=headerSize; i<data.size(); ++i)
+		data[i] = '\xff';
+	QVERIFY(file.seek(0));
+	file.write(data);
+	file.close();
+	QVERIFY(!StelBinaryCache::load("corrupt", sourceHash, loaded));
+	QVERIFY(!loaded.isValid());
+	QDir(cacheDir).removeRecursively();
+}
@@ -46,6 +46,15 @@ void TestStelJsonParser::initTestCase()
  \"test12\": {\"worldCoords\": [[[-0.5,0.5],[0.5,0.5],[0.5,-0.5],[-0.5,-0.5]], [[-0.2,-0.2],[0.2,-0.2],[0.2,0.2],[-0.2,0.2]]]}}";
 
 	listJsonBuff = "[{\"project\":\"GOODS\",\"license\":\"ESO Data License : http://www.myLicenseToBeDefinedAtSomePoint.html\",\"copyright\":\"(c) GOODS Sep 10 2007 12:00AM\",\"creator\":\"C. Cesarsky\",\"dataType\":\"image\",\"characterization\":{\"spatialAxis\":{\"footprint\":{\"worldCoords\":[[[53.111991,-27.725812],[53.164780,-27.725812],[53.164780,-27.772234],[53.111991,-27.772234]]]},\"boundingBox\":[[53.111991,-27.725812],[53.164780,-27.725812],[53.164780,-27.772234],[53.111991,-27.772234]],\"centralPos\":[53.138382,-27.749026]},\"temporalAxis\":{\"boundingBox\":[52220.243068,52263.181794],\"integratedCoverage\":0.208333,\"centralPos\":52241.712431,\"coverage\":[52220.243068,52263.181794]}},\"publisher\":\"ESO SAF\",\"collection\":\"168.A-0485(A\",\"targetSource\":{\"names\":[\"GOODS_09\"]},\"ESO\":{\"NGASFileId\":\"GOODS_ISAAC_09_H_V2.0\",\"metadataType\":\"DataProduct\",\"processingType\":\"HighlyProcessed\"},\"acquisitionSetup\":{\"filter\":\"H\",\"instrument\":\"ISAAC\",\"facility\":\"ESO-Paranal\",\"telescope\":\"ESO-VLT-U1\",\"mode\":\"Short Wavelength\"},\"title\":\"GOODS_ISAAC_09_H_v2.0\",\"id\":\"GOODS_ISAAC_09_H_V2.0\"},{\"project\":\"GOODS\",\"license\":\"ESO Data License : http://www.myLicenseToBeDefinedAtSomePoint.html\",\"copyright\":\"(c) GOODS Sep 10 2007 12:00AM\",\"creator\":\"C. Cesarsky\",\"dataType\":\"image\",\"characterization\":{\"spatialAxis\":{\"footprint\":{\"worldCoords\":[[[53.121222,-27.641601],[53.174252,-27.641601],[53.174252,-27.687943],[53.121222,-27.687943]]]},\"boundingBox\":[[53.121222,-27.641601],[53.174252,-27.641601],[53.174252,-27.687943],[53.121222,-27.687943]],\"centralPos\":[53.147732,-27.664775]},\"temporalAxis\":{\"boundingBox\":[53729.079417,53747.174968],\"integratedCoverage\":0.122222,\"centralPos\":53738.127193,\"coverage\":[53729.079417,53747.174968]}},\"publisher\":\"ESO SAF\",\"collection\":\"168.A-0485(G)\",\"targetSource\":{\"names\":[\"GOODS_01\"]},\"ESO\":{\"NGASFileId\":\"GOODS_ISAAC_01_J_V2.0\",\"metadataType\":\"DataProduct\",\"processingType\":\"HighlyProcessed\"},\"acquisitionSetup\":{\"filter\":\"J\",\"instrument\":\"ISAAC\",\"facility\":\"ESO-Paranal\",\"telescope\":\"ESO-VLT-U1\",\"mode\":\"Short Wavelength\"},\"title\":\"GOODS_ISAAC_01_J_v2.0\",\"id\":\"GOODS_ISAAC_01_J_V2.0\"},{\"project\":\"GOODS\",\"license\":\"ESO Data License : http://www.myLicenseToBeDefinedAtSomePoint.html\",\"copyright\":\"(c) GOODS Sep 10 2007 12:00AM\",\"creator\":\"C. Cesarsky\",\"dataType\":\"image\",\"characterization\":{\"spatialAxis\":{\"footprint\":{\"worldCoords\":[[[53.121081,-27.641392],[53.174488,-27.641392],[53.174488,-27.688027],[53.121081,-27.688027]]]},\"boundingBox\":[[53.121081,-27.641392],[53.174488,-27.641392],[53.174488,-27.688027],[53.121081,-27.688027]],\"centralPos\":[53.147779,-27.664712]},\"temporalAxis\":{\"boundingBox\":[53729.179656,53749.175133],\"integratedCoverage\":0.207292,\"centralPos\":53739.177395,\"coverage\":[53729.179656,53749.175133]}},\"publisher\":\"ESO SAF\",\"collection\":\"168.A-0485(G)\",\"targetSource\":{\"names\":[\"GOODS_01\"]},\"ESO\":{\"NGASFileId\":\"GOODS_ISAAC_01_KS_V2.0\",\"metadataType\":\"DataProduct\",\"processingType\":\"HighlyProcessed\"},\"acquisitionSetup\":{\"filter\":\"Ks\",\"instrument\":\"ISAAC\",\"facility\":\"ESO-Paranal\",\"telescope\":\"ESO-VLT-U1\",\"mode\":\"Short Wavelength\"},\"title\":\"GOODS_ISAAC_01_Ks_v2.0\",\"id\":\"GOODS_ISAAC_01_KS_V2.0\"}]";
+
+	streamJsonBuff = "[";
+	for (int i=0; i<1000; ++i)
+	{
+		if (i>0)
+			streamJsonBuff += ",\n";
+		streamJsonBuff += listJsonBuff.mid(1, listJsonBuff.size()-2);
+	}
+	streamJsonBuff += "]";
 }
 
 void TestStelJsonParser::testBase()
@@ -105,6 +114,107 @@ void TestStelJsonParser::testErrors()
 	QVERIFY(result.isNull());
 }
 
+void TestStelJsonParser::testReader()
+{
+	QBuffer buf;
+	buf.setData(largeJsonBuff);
+	buf.open(QIODevice::ReadOnly);
+	StelJsonReader reader(&buf);
+	QCOMPARE(reader.readValue(), StelJsonParser::parse(largeJsonBuff));
+	QVERIFY(reader.readNext()==StelJsonReader::EndDocument);
+
+	QBuffer listBuf;
+	listBuf.setData(listJsonBuff);
+	listBuf.open(QIODevice::ReadOnly);
+	StelJsonReader listReader(&listBuf);
+	QCOMPARE(listReader.readValue(), StelJsonParser::parse(listJsonBuff));
+
+	// Tokens, and the members which are skipped
+	QBuffer headerBuf;
+	headerBuf.setData("{\"version\": 2, \"data\": {\"a\": [1, {\"b\": null}], \"c\": \"x\\u00e9\\n\"}, \"limit\": -1.5, \"ok\": true}");
+	headerBuf.open(QIODevice::ReadOnly);
+	StelJsonReader headerReader(&headerBuf);
+	QVERIFY(headerReader.readNext()==StelJsonReader::StartObject);
+	QVERIFY(headerReader.readNext()==StelJsonReader::Key);
+	QCOMPARE(headerReader.key(), QString("version"));
+	QVERIFY(headerReader.readNext()==StelJsonReader::Value);
+	QCOMPARE(headerReader.value().toInt(), 2);
+	// integers are doubles, as with parse()
+	QCOMPARE(headerReader.value().type(), StelJsonParser::parse("[2]").toList().at(0).type());
+	QVERIFY(headerReader.readNext()==StelJsonReader::Key);
+	QCOMPARE(headerReader.key(), QString("data"));
+	headerReader.skipValue();
+	QVERIFY(headerReader.readNext()==StelJsonReader::Key);
+	QCOMPARE(headerReader.key(), QString("limit"));
+	QCOMPARE(headerReader.readValue().toDouble(), -1.5);
+	QVERIFY(headerReader.readNext()==StelJsonReader::Key);
+	QCOMPARE(headerReader.readValue().toBool(), true);
+	QVERIFY(headerReader.readNext()==StelJsonReader::EndObject);
+	QVERIFY(headerReader.readNext()==StelJsonReader::EndDocument);
+
+	headerBuf.seek(0);
+	StelJsonReader valueReader(&headerBuf);
+	const QVariantMap data = valueReader.readValue().toMap().value("data").toMap();
+	QCOMPARE(data.value("c").toString(), QString::fromUtf8("x\xc3\xa9\n"));
+	QCOMPARE(data.value("a").toList().size(), 2);
+
+	// Syntax errors
+	const char* invalid[] = {"{val: 1}", "[1 2]", "[1,]", "{\"a\" 1}", "[\"abc", "{\"a\": tru}", "[1] 2"};
+	for (unsigned int i=0; i<sizeof(invalid)/sizeof(invalid[0]); ++i)
+	{
+		QBuffer invalidBuf;
+		invalidBuf.setData(invalid[i]);
+		invalidBuf.open(QIODevice::ReadOnly);
+		StelJsonReader invalidReader(&invalidBuf);
+		bool wasCatched = false;
+		try
+		{
+			invalidReader.readValue();
+			invalidReader.readNext();
+		}
+		catch (std::runtime_error&)
+		{
+			wasCatched = true;
+		}
+		QVERIFY2(wasCatched, invalid[i]);
+	}
+}
+
+void TestStelJsonParser::testWriter()
+{
+	// Round trip of the documents through the writer
+	const QVariant large = StelJsonParser::parse(largeJsonBuff);
+	QCOMPARE(StelJsonParser::parse(StelJsonParser::write(large)), large);
+	const QVariant list = StelJsonParser::parse(listJsonBuff);
+	QCOMPARE(StelJsonParser::parse(StelJsonParser::write(list)), list);
+
+	QByteArray json;
+	QBuffer buf(&json);
+	buf.open(QIODevice::WriteOnly);
+	{
+		StelJsonWriter writer(&buf, false);
+		writer.beginObject();
+		writer.writeKey("name");
+		writer.writeString(QString::fromUtf8("a \"b\"\\\n\xc3\xa9\x01"));
+		writer.writeKey("values");
+		writer.beginArray();
+		writer.writeNumber(1);
+		writer.writeNumber(-0.25);
+		writer.writeNumber(0.1);
+		writer.writeBool(true);
+		writer.writeNull();
+		writer.beginObject();
+		writer.endObject();
+		writer.endArray();
+		writer.endObject();
+	}
+	QCOMPARE(json, QByteArray("{\"name\":\"a \\\"b\\\"\\\\\\n\xc3\xa9\\u0001\",\"values\":[1,-0.25,0.1,true,null,{}]}"));
+
+	const QVariantMap values = StelJsonParser::parse(json).toMap();
+	QCOMPARE(values.value("name").toString(), QString::fromUtf8("a \"b\"\\\n\xc3\xa9\x01"));
+	QCOMPARE(values.value("values").toList().at(2).toDouble(), 0.1);
+}
+
 void TestStelJsonParser::benchmarkParse()
 {
 	QBuffer buf;
@@ -116,3 +226,131 @@ void TestStelJsonParser::benchmarkParse()
 		result = StelJsonParser::parse(&buf);
 	}
 }
+
+void TestStelJsonParser::benchmarkParseStream()
+{
+	QBuffer buf;
+	buf.setData(streamJsonBuff);
+	buf.open(QIODevice::ReadOnly);
+	QVariant result;
+	QBENCHMARK {
+		buf.seek(0);
+		result = StelJsonParser::parse(&buf);
+	}
+	QCOMPARE(result.toList().size(), 3000);
+}
+
+void TestStelJsonParser::benchmarkReader()
+{
+	// All the tokens, with their typed values, but without any QVariant
+	QBuffer buf;
+	buf.setData(streamJsonBuff);
+	buf.open(QIODevice::ReadOnly);
+	int strings = 0;
+	double sum = 0.;
+	QBENCHMARK {
+		buf.seek(0);
+		strings = 0;
+		sum = 0.;
+		StelJsonReader reader(&buf);
+		for (StelJsonReader::TokenType t=reader.readNext(); t!=StelJsonReader::EndDocument; t=reader.readNext())
+		{
+			if (t!=StelJsonReader::Value)
+				continue;
+			if (reader.valueType()==QVariant::String)
+				strings += reader.stringValue().size()>0;
+			else
+				sum += reader.numberValue();
+		}
+	}
+	QVERIFY(strings>0);
+	QVERIFY(sum!=0.);
+}
+
+void TestStelJsonParser::benchmarkReaderSkip()
+{
+	// Only the "id" of each element
+	QBuffer buf;
+	buf.setData(streamJsonBuff);
+	buf.open(QIODevice::ReadOnly);
+	QStringList ids;
+	QBENCHMARK {
+		buf.seek(0);
+		ids.clear();
+		StelJsonReader reader(&buf);
+		reader.readNext();
+		while (reader.readNext()==StelJsonReader::StartObject)
+		{
+			while (reader.readNext()==StelJsonReader::Key)
+			{
+				if (reader.key()=="id")
+					ids.append(reader.readValue().toString());
+				else
+					reader.skipValue();
+			}
+		}
+	}
+	QCOMPARE(ids.size(), 3000);
+}
+
+void TestStelJsonParser::benchmarkReaderValue()
+{
+	QBuffer buf;
+	buf.setData(streamJsonBuff);
+	buf.open(QIODevice::ReadOnly);
+	QVariant result;
+	QBENCHMARK {
+		buf.seek(0);
+		StelJsonReader reader(&buf);
+		result = reader.readValue();
+	}
+	QCOMPARE(result.toList().size(), 3000);
+}
+
+void TestStelJsonParser::benchmarkWrite()
+{
+	const QVariant value = StelJsonParser::parse(streamJsonBuff);
+	QByteArray json;
+	QBENCHMARK {
+		json = StelJsonParser::write(value);
+	}
+	QVERIFY(json.size()>streamJsonBuff.size()/2);
+}
+
+void TestStelJsonParser::benchmarkWriter()
+{
+	// Streaming of the tokens read from the document, without any QVariant
+	QBuffer in;
+	in.setData(streamJsonBuff);
+	in.open(QIODevice::ReadOnly);
+	QByteArray json;
+	QBENCHMARK {
+		in.seek(0);
+		json.clear();
+		QBuffer out(&json);
+		out.open(QIODevice::WriteOnly);
+		StelJsonReader reader(&in);
+		StelJsonWriter writer(&out, false);
+		for (StelJsonReader::TokenType t=reader.readNext(); t!=StelJsonReader::EndDocument; t=reader.readNext())
+		{
+			switch (t)
+			{
+				case StelJsonReader::StartObject: writer.beginObject(); break;
+				case StelJsonReader::EndObject: writer.endObject(); break;
+				case StelJsonReader::StartArray: writer.beginArray(); break;
+				case StelJsonReader::EndArray: writer.endArray(); break;
+				case StelJsonReader::Key: writer.writeKey(reader.key()); break;
+				default:
+					if (reader.valueType()==QVariant::String)
+						writer.writeString(reader.stringValue());
+					else if (reader.valueType()==QVariant::Bool)
+						writer.writeBool(reader.boolValue());
+					else if (reader.valueType()==QVariant::Invalid)
+						writer.writeNull();
+					else
+						writer.writeNumber(reader.numberValue());
+			}
+		}
+	}
+	QCOMPARE(StelJsonParser::parse(json).toList().size(), 3000);
+}
@@ -31,9 +31,19 @@ private slots:
 	void testBase();
 	void benchmarkParse();
 	void testErrors();
+	void testReader();
+	void testWriter();
+	void benchmarkParseStream();
+	void benchmarkReader();
+	void benchmarkReaderSkip();
+	void benchmarkReaderValue();
+	void benchmarkWrite();
+	void benchmarkWriter();
 private:
 	QByteArray largeJsonBuff;
 	QByteArray listJsonBuff;
+	//! The elements of listJsonBuff repeated in a large array, for the throughput benchmarks
+	QByteArray streamJsonBuff;
 };
 
 #endif // _TESTSTELJSONPARSER_HPP_
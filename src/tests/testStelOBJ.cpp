@@ -0,0 +1,150 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelOBJ.hpp"
+
+#include <QBuffer>
+#include <QtDebug>
+#include <QTest>
+
+#include "StelOBJ.hpp"
+
+QTEST_GUILESS_MAIN(TestStelOBJ)
+
+static bool loadData(StelOBJ& obj, const QByteArray& data)
+{
+	QBuffer buf;
+	buf.setData(data);
+	buf.open(QIODevice::ReadOnly);
+	return obj.load(buf, QString());
+}
+
+// A grid of size x size quads, large enough to be parsed in several chunks
+static QByteArray gridData(int size)
+{
+	QByteArray data("# generated grid\r\no grid\r\n");
+	for (int y=0; y<=size; ++y)
+	{
+		for (int x=0; x<=size; ++x)
+		{
+			data += QString("v %1 %2 %3\r\n").arg(x*0.5).arg(y*0.5).arg((x+y)%7*1.0e-2).toLatin1();
+			data += QString("vt %1 %2\r\n").arg((float)x/size).arg((float)y/size).toLatin1();
+		}
+	}
+	data += "vn 0 0 1\r\n";
+	for (int y=0; y<size; ++y)
+	{
+		for (int x=0; x<size; ++x)
+		{
+			const int i = y*(size+1)+x+1;
+			data += QString("f %1/%1/1 %2/%2/1 %3/%3/1 %4/%4/1\r\n").arg(i).arg(i+1).arg(i+size+2).arg(i+size+1).toLatin1();
+		}
+	}
+	return data;
+}
+
+void TestStelOBJ::testParse()
+{
+	StelOBJ obj;
+	const QByteArray data(
+		"# comment\n"
+		"v 0 0 0\n"
+		"v 1.0 0 0\n"
+		"  v 1 1e0 -0.0\t\n"
+		"v 0 1 0 1.0\n"
+		"vn 0 0 1\n"
+		"o quad\n"
+		"f 1//1 2//1 3//1 4//1\n"
+		"g tri\n"
+		"f -4//-1 -3//-1 -2//-1\n");
+	QVERIFY(loadData(obj, data));
+	QVERIFY(obj.isLoaded());
+	QCOMPARE(obj.getObjectList().size(), 2);
+	QCOMPARE(obj.getObjectList().at(0).name, QString("quad"));
+	QCOMPARE(obj.getObjectList().at(1).name, QString("tri"));
+	// the quad is split into 2 triangles, the triangle uses the same vertices as the quad
+	QCOMPARE(obj.getFaceCount(), 3u);
+	QCOMPARE(obj.getVertexList().size(), 4);
+	QCOMPARE(obj.getIndexList().at(6), 0u);
+	QCOMPARE(obj.getIndexList().at(8), 2u);
+	QCOMPARE(obj.getVertexList().at(2).position[1], 1.0f);
+	QCOMPARE(obj.getAABBox().max, Vec3f(1.f, 1.f, 0.f));
+
+	StelOBJ reordered;
+	QBuffer buf;
+	buf.setData("v 1 2 3\nv 2 3 4\nv 3 4 6\nf 1 2 3\n");
+	buf.open(QIODevice::ReadOnly);
+	QVERIFY(reordered.load(buf, QString(), StelOBJ::ZXY));
+	QCOMPARE(reordered.getVertexList().at(0).position[0], 3.0f);
+	QCOMPARE(reordered.getVertexList().at(0).position[1], 1.0f);
+	QCOMPARE(reordered.getVertexList().at(0).position[2], 2.0f);
+}
+
+void TestStelOBJ::testErrors()
+{
+	StelOBJ obj;
+	QVERIFY(!loadData(obj, "v 0 0 0\nv 1 0 0\nf 1 2\n"));
+	QVERIFY(!loadData(obj, "v 0 0 0\nv 1 0 0\nv 1 1 a\n"));
+	QVERIFY(!loadData(obj, "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n"));
+	QVERIFY(!loadData(obj, "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1/1 2 3\n"));
+	QVERIFY(!loadData(obj, "v 0 0 0\nv 1 0 0\nv 1 1 0\nusemtl unknown\nf 1 2 3\n"));
+	QVERIFY(!obj.isLoaded());
+}
+
+void TestStelOBJ::testLargeFile()
+{
+	const int size = 200;
+	const QByteArray data = gridData(size);
+	QVERIFY(data.size() > 2*1024*1024);
+
+	StelOBJ obj;
+	QVERIFY(loadData(obj, data));
+	QCOMPARE(obj.getFaceCount(), 2u*size*size);
+	QCOMPARE(obj.getVertexList().size(), (size+1)*(size+1));
+	QCOMPARE(obj.getObjectList().size(), 1);
+	QCOMPARE(obj.getAABBox().min, Vec3f(0.f, 0.f, 0.f));
+	QCOMPARE(obj.getAABBox().max[0], size*0.5f);
+	// the faces at the end of the file must reference the right vertices
+	const StelOBJ::Vertex& last = obj.getVertexList().at(obj.getIndexList().last());
+	QCOMPARE(last.position[0], (size-1)*0.5f);
+	QCOMPARE(last.position[1], size*0.5f);
+
+	QByteArray broken = data;
+	broken += "f 1 2\n";
+	QVERIFY(!loadData(obj, broken));
+}
+
+void TestStelOBJ::testSerialize()
+{
+	StelOBJ obj;
+	QVERIFY(loadData(obj, gridData(20)));
+	const QByteArray serialized = obj.serialize();
+
+	StelOBJ copy;
+	QVERIFY(copy.deserialize(serialized));
+	QCOMPARE(copy.getFaceCount(), obj.getFaceCount());
+	QCOMPARE(copy.getIndexList(), obj.getIndexList());
+	QVERIFY(copy.getVertexList() == obj.getVertexList());
+	QCOMPARE(copy.getMaterialList().size(), obj.getMaterialList().size());
+	QCOMPARE(copy.getObjectList().size(), obj.getObjectList().size());
+	QCOMPARE(copy.getObjectList().at(0).groups.size(), obj.getObjectList().at(0).groups.size());
+	QCOMPARE(copy.getCentroid(), obj.getCentroid());
+
+	QVERIFY(!copy.deserialize(serialized.left(serialized.size()/2)));
+	QVERIFY(!copy.isLoaded());
+}
@@ -0,0 +1,134 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelProjectorCache.hpp"
+
+#include <QtDebug>
+#include <QTest>
+
+#include "StelProjectorCache.hpp"
+#include "StelProjectorClasses.hpp"
+
+QTEST_GUILESS_MAIN(TestStelProjectorCache)
+
+// Number of getProjection() calls in a typical frame, all modules together
+static const int callsPerFrame = 150;
+static const int projectionType = 2;
+
+static StelProjectorCache cache(9);
+
+// StelProjector::init() is private, a new projector is initialized through a cache of its own
+static StelProjectorP newProjection(const StelProjector::ModelViewTranformP& transform, const StelProjector::StelProjectorParams& params)
+{
+	StelProjectorCache single(1);
+	return single.insert(0, projectionType, params, new StelProjectorStereographic(transform));
+}
+
+void TestStelProjectorCache::initTestCase()
+{
+	params.viewportXywh.set(0, 0, 1920, 1080);
+	params.viewportCenter.set(960.f, 540.f);
+	params.viewportFovDiameter = 1080.f;
+	params.fov = 60.f;
+	params.zNear = 0.000001f;
+	params.zFar = 500.f;
+	for (int i=0; i<9; ++i)
+		transforms[i] = StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(Mat4d::zrotation(0.1*i)*Mat4d::xrotation(0.2)));
+}
+
+StelProjectorP TestStelProjectorCache::getCachedProjection(int frame) const
+{
+	StelProjectorP prj = cache.find(frame, projectionType, params);
+	if (prj.isNull())
+		prj = cache.insert(frame, projectionType, params, new StelProjectorStereographic(transforms[frame]));
+	return prj;
+}
+
+void TestStelProjectorCache::testFind()
+{
+	cache.clear();
+	cache.resetCounters();
+	QVERIFY(cache.find(0, projectionType, params).isNull());
+	StelProjectorP prj = getCachedProjection(0);
+	QVERIFY(!prj.isNull());
+	QCOMPARE(getCachedProjection(0), prj);
+	QVERIFY(getCachedProjection(1)!=prj);
+	QCOMPARE(cache.getAllocationCount(), 2);
+	QCOMPARE(cache.getHitCount(), 1);
+
+	// The cached projector must behave like a new one
+	StelProjectorP ref = newProjection(transforms[0], params);
+	Vec3d win1, win2;
+	const Vec3d v(0.8, 0.1, 0.3);
+	QVERIFY(prj->project(v, win1)==ref->project(v, win2));
+	QVERIFY((win1-win2).length()<1e-9);
+}
+
+void TestStelProjectorCache::testInvalidation()
+{
+	cache.clear();
+	StelProjectorP prj = getCachedProjection(3);
+	QCOMPARE(cache.find(3, projectionType, params), prj);
+	QVERIFY(cache.find(3, projectionType+1, params).isNull());
+
+	StelProjector::StelProjectorParams other = params;
+	other.fov = 30.f;
+	QVERIFY(cache.find(3, projectionType, other).isNull());
+	other = params;
+	other.flipHorz = true;
+	QVERIFY(cache.find(3, projectionType, other).isNull());
+
+	// The projectors already handed out stay usable after a clear
+	cache.clear();
+	QVERIFY(cache.find(3, projectionType, params).isNull());
+	QCOMPARE(prj->getFov(), params.fov);
+}
+
+void TestStelProjectorCache::testViewportPolygon()
+{
+	StelProjectorP prj = newProjection(transforms[2], params);
+	SphericalRegionP p1 = prj->getViewportConvexPolygon();
+	QCOMPARE(prj->getViewportConvexPolygon().data(), p1.data());
+	SphericalRegionP p2 = prj->getViewportConvexPolygon(10.f, 10.f);
+	QVERIFY(p2.data()!=p1.data());
+	QVERIFY(p2->contains(p1));
+	QCOMPARE(prj->getViewportConvexPolygon(10.f, 10.f).data(), p2.data());
+}
+
+void TestStelProjectorCache::benchmarkFrameUncached()
+{
+	QBENCHMARK {
+		for (int i=0; i<callsPerFrame; ++i)
+			newProjection(transforms[i%9], params)->getViewportConvexPolygon();
+	}
+}
+
+void TestStelProjectorCache::benchmarkFrameCached()
+{
+	int frames = 0;
+	cache.resetCounters();
+	QBENCHMARK {
+		// StelCore clears the cache when the matrices change, i.e. once per frame
+		cache.clear();
+		for (int i=0; i<callsPerFrame; ++i)
+			getCachedProjection(i%9)->getViewportConvexPolygon();
+		++frames;
+	}
+	qDebug() << "Cached: projectors allocated per frame:" << (double)cache.getAllocationCount()/frames;
+	QCOMPARE(cache.getAllocationCount(), 9*frames);
+}
@@ -0,0 +1,156 @@
+/*
+ * Stellarium
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelSnapshotBuffer.hpp"
+#include "StelSnapshotBuffer.hpp"
+
+#include <QAtomicInt>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+QTEST_GUILESS_MAIN(TestStelSnapshotBuffer)
+
+namespace
+{
+//! All the members hold the same number, unless a copy was torn
+struct Value
+{
+	Value(int n = 0) : a(n), b(n), c(n), text(QString::number(n)) {}
+	bool isConsistent() const { return a == b && b == c && text == QString::number(a); }
+	int a;
+	int b;
+	int c;
+	QString text;
+};
+
+class Writer : public QThread
+{
+public:
+	Writer(StelSnapshotBuffer<Value>& buffer, int count) : buffer(buffer), count(count), failures(0) {}
+	void run() Q_DECL_OVERRIDE
+	{
+		for (int i = 1; i <= count; ++i)
+		{
+			if (!buffer.publish(Value(i)))
+				++failures;
+		}
+	}
+	StelSnapshotBuffer<Value>& buffer;
+	int count;
+	int failures;
+};
+
+class Reader : public QThread
+{
+public:
+	Reader(StelSnapshotBuffer<Value>& buffer, const QAtomicInt& done) : buffer(buffer), done(done), reads(0), errors(0) {}
+	void run() Q_DECL_OVERRIDE
+	{
+		int last = 0;
+		while (!done.loadAcquire())
+		{
+			Value value;
+			if (!buffer.read(value))
+				continue;
+			// the values are published in increasing order, a reader must never go back
+			if (!value.isConsistent() || value.a < last)
+				++errors;
+			last = value.a;
+			++reads;
+		}
+	}
+	StelSnapshotBuffer<Value>& buffer;
+	const QAtomicInt& done;
+	int reads;
+	int errors;
+};
+}
+
+void TestStelSnapshotBuffer::testEmpty()
+{
+	StelSnapshotBuffer<Value> buffer;
+	Value value(7);
+	QVERIFY(!buffer.read(value));
+	QCOMPARE(value.a, 7);
+}
+
+void TestStelSnapshotBuffer::testPublish()
+{
+	StelSnapshotBuffer<Value> buffer;
+	for (int i = 1; i < 10; ++i)
+	{
+		QVERIFY(buffer.publish(Value(i)));
+		Value value;
+		QVERIFY(buffer.read(value));
+		QCOMPARE(value.a, i);
+		QVERIFY(value.isConsistent());
+	}
+
+	buffer.clear();
+	Value value;
+	QVERIFY(!buffer.read(value));
+	QVERIFY(buffer.publish(Value(10)));
+	QVERIFY(buffer.read(value));
+	QCOMPARE(value.a, 10);
+}
+
+void TestStelSnapshotBuffer::testRepublish()
+{
+	// Without readers, a slot besides the published one is always free
+	StelSnapshotBuffer<Value> buffer;
+	QVERIFY(buffer.publish(Value(1)));
+	QVERIFY(buffer.publish(Value(2)));
+	QVERIFY(buffer.publish(Value(3)));
+	Value value;
+	QVERIFY(buffer.read(value));
+	QCOMPARE(value.a, 3);
+}
+
+void TestStelSnapshotBuffer::testConcurrentReads()
+{
+	const int count = 200000;
+	StelSnapshotBuffer<Value> buffer;
+	QAtomicInt done(0);
+
+	QVector<Reader*> readers;
+	for (int i = 0; i < 3; ++i)
+	{
+		readers.append(new Reader(buffer, done));
+		readers.last()->start();
+	}
+	Writer writer(buffer, count);
+	writer.start();
+	writer.wait();
+	done.storeRelease(1);
+
+	int reads = 0;
+	foreach (Reader* reader, readers)
+	{
+		reader->wait();
+		QCOMPARE(reader->errors, 0);
+		reads += reader->reads;
+		delete reader;
+	}
+	qDebug() << "Published" << count - writer.failures << "of" << count << "values, read" << reads;
+	QVERIFY(writer.failures < count);
+
+	Value value;
+	QVERIFY(buffer.read(value));
+	QVERIFY(value.isConsistent());
+}
@@ -298,6 +298,87 @@ void TestStelSphericalGeometry::benchmarkGetIntersection()
 	}
 }
 
+// Make a convex quad of size 2*r centered on (ra, dec)
+static SphericalConvexPolygon makeQuad(double ra, double dec, double r)
+{
+	QVector<Vec3d> c(4);
+	StelUtils::spheToRect(ra-r, dec-r, c[0]);
+	StelUtils::spheToRect(ra-r, dec+r, c[1]);
+	StelUtils::spheToRect(ra+r, dec+r, c[2]);
+	StelUtils::spheToRect(ra+r, dec-r, c[3]);
+	return SphericalConvexPolygon(c);
+}
+
+void TestStelSphericalGeometry::testConvexIntersection()
+{
+	// Compare the clipping of convex polygons with the generic OctahedronPolygon algorithm
+	QList<SphericalConvexPolygon> polys;
+	polys << bigSquareConvex << smallSquareConvex << triangle
+		  << makeQuad(0.3, 0.2, 0.4) << makeQuad(-0.4, 0.1, 0.2) << makeQuad(1.2, 0.5, 0.6)
+		  << makeQuad(0.1, M_PI/2.-0.3, 0.2) << makeQuad(M_PI, 0., 0.5);
+	foreach (const SphericalConvexPolygon& p1, polys)
+	{
+		QVERIFY(p1.checkValid());
+		foreach (const SphericalConvexPolygon& p2, polys)
+		{
+			SphericalRegionP res = p1.getIntersection(p2);
+			OctahedronPolygon oct(p1.getOctahedronPolygon());
+			oct.inPlaceIntersection(p2.getOctahedronPolygon());
+			const double area = p1.getBoundingCap().intersects(p2.getBoundingCap()) ? oct.getArea() : 0.;
+			QVERIFY2(std::fabs(res->getArea()-area)<1e-9, qPrintable(QString("%1 != %2").arg(res->getArea()).arg(area)));
+			if (res->getType()==SphericalRegion::ConvexPolygon)
+			{
+				QVERIFY(static_cast<const SphericalConvexPolygon*>(res.data())->checkValid());
+				QVERIFY(p1.contains(res->getPointInside()));
+				QVERIFY(p2.contains(res->getPointInside()));
+			}
+		}
+	}
+
+	// Polygons sharing a side or a vertex don't intersect
+	QCOMPARE(makeQuad(0., 0., 0.1).getIntersection(makeQuad(0.2, 0., 0.1))->getType(), SphericalRegion::Empty);
+	QCOMPARE(makeQuad(0., 0., 0.1).getIntersection(makeQuad(0.2, 0.2, 0.1))->getType(), SphericalRegion::Empty);
+	QCOMPARE(makeQuad(0., 0., 0.1).getIntersection(makeQuad(1., 1., 0.1))->getType(), SphericalRegion::Empty);
+	// A polygon contained in the other is returned unchanged
+	SphericalRegionP res = bigSquareConvex.getIntersection(smallSquareConvex);
+	QCOMPARE(res->getType(), SphericalRegion::ConvexPolygon);
+	QVERIFY(std::fabs(res->getArea()-smallSquareConvex.getArea())<1e-12);
+}
+
+void TestStelSphericalGeometry::benchmarkConvexIntersection()
+{
+	const SphericalConvexPolygon p1 = makeQuad(0.3, 0.2, 0.4);
+	const SphericalConvexPolygon p2 = makeQuad(0.1, 0.1, 0.3);
+	SphericalRegionP res;
+	QBENCHMARK {
+		res = p1.getIntersection(p2);
+	}
+}
+
+void TestStelSphericalGeometry::benchmarkConvexIntersectionOctahedron()
+{
+	// The same intersection as benchmarkConvexIntersection() through the generic algorithm
+	const SphericalConvexPolygon p1 = makeQuad(0.3, 0.2, 0.4);
+	const SphericalConvexPolygon p2 = makeQuad(0.1, 0.1, 0.3);
+	QBENCHMARK {
+		OctahedronPolygon oct(p1.getOctahedronPolygon());
+		oct.inPlaceIntersection(p2.getOctahedronPolygon());
+	}
+}
+
+void TestStelSphericalGeometry::benchmarkChainedOperations()
+{
+	// Only the final result needs to be triangulated
+	QList<SphericalRegionP> regions;
+	for (int i=0;i<10;++i)
+		regions << SphericalRegionP(new SphericalPolygon(makeQuad(0.05*i, 0.03*i, 0.2).getConvexContour()));
+	double area = 0.;
+	QBENCHMARK {
+		area = SphericalPolygon::multiUnion(regions)->getArea();
+	}
+	QVERIFY(area>makeQuad(0., 0., 0.2).getArea());
+}
+
 void TestStelSphericalGeometry::testEnlarge()
 {
 	Vec3d vx(1,0,0);
@@ -522,6 +603,34 @@ void TestStelSphericalGeometry::testSerialize()
 	reg2 = readVCapReg.value<SphericalRegionP>();
 	QCOMPARE(capReg->getArea(), reg2->getArea());
 	QVERIFY(capReg->getType()==reg2->getType());
+
+	// Textured polygons keep their texture coordinates
+	QVector<Vec2f> texCoords;
+	texCoords << Vec2f(0.f, 0.f) << Vec2f(1.f, 0.f) << Vec2f(1.f, 1.f) << Vec2f(0.f, 1.f);
+	SphericalRegionP texReg(new SphericalTexturedConvexPolygon(makeQuad(0.1, 0.2, 0.05).getConvexContour(), texCoords));
+	ar.clear();
+	buf.open(QIODevice::WriteOnly);
+	out << QVariant::fromValue(texReg);
+	buf.close();
+	QVariant readVTexReg;
+	buf.open(QIODevice::ReadOnly);
+	in >> readVTexReg;
+	buf.close();
+	reg2 = readVTexReg.value<SphericalRegionP>();
+	QVERIFY(dynamic_cast<const SphericalTexturedConvexPolygon*>(reg2.data())!=Q_NULLPTR);
+	QCOMPARE(reg2->getFillVertexArray().texCoords, texReg->getFillVertexArray().texCoords);
+	QCOMPARE(reg2->getFillVertexArray().vertex, texReg->getFillVertexArray().vertex);
+
+	// The triangles of a polygon are serialized, deserializing doesn't tesselate again
+	ar.clear();
+	buf.open(QIODevice::WriteOnly);
+	out << QVariant::fromValue(holyReg);
+	buf.close();
+	buf.open(QIODevice::ReadOnly);
+	in >> readVHolyReg;
+	buf.close();
+	reg2 = readVHolyReg.value<SphericalRegionP>();
+	QCOMPARE(reg2->getFillVertexArray().vertex, holyReg->getFillVertexArray().vertex);
 }
 
 void TestStelSphericalGeometry::benchmarkCreatePolygon()
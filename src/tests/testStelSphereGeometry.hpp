@@ -42,6 +42,10 @@ private slots:
 	void benchmarkCheckValid();
 	void benchmarkSphericalCap();
 	void benchmarkGetIntersection();
+	void testConvexIntersection();
+	void benchmarkConvexIntersection();
+	void benchmarkConvexIntersectionOctahedron();
+	void benchmarkChainedOperations();
 	void testSerialize();
 	void benchmarkCreatePolygon();
 private: